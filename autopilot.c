@@ -0,0 +1,243 @@
+/*! \file autopilot.c
+ * \brief Autopilot
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#include <string.h>
+#include "autopilot.h"
+
+/*! \fn static uint32_t cellNumber(const autopilot * ap, const coord * position)
+ * \brief Number of the cell of a position
+ */
+static uint32_t cellNumber(const autopilot * ap, const coord * position) {
+    return (uint32_t) position->y * (uint32_t) ap->width + (uint32_t) position->x;
+}
+
+/*! \fn static uint32_t ahead(const autopilot * ap, uint32_t from, uint32_t cell)
+ * \brief Number of steps along the cycle from one cell to another
+ */
+static uint32_t ahead(const autopilot * ap, uint32_t from, uint32_t cell) {
+    return ap->order[cell] >= ap->order[from] ? ap->order[cell] - ap->order[from] : ap->order[cell] + ap->cells - ap->order[from];
+}
+
+/*! \fn static unsigned char stepDirection(uint32_t from, uint32_t to)
+ * \brief Direction u, d, l, r from a cell to a neighbour cell
+ */
+static unsigned char stepDirection(uint32_t from, uint32_t to) {
+    if (to == from + 1) {
+        return 'r';
+    }
+    if (to + 1 == from) {
+        return 'l';
+    }
+    return to > from ? 'd' : 'u';
+}
+
+/*! \fn static void addCell(autopilot * ap, uint32_t * position, int a, int b, int transposed)
+ * \brief Append a cell to the cycle, a and b are the column and row, or the row and column if transposed
+ */
+static void addCell(autopilot * ap, uint32_t * position, int a, int b, int transposed) {
+    int x = transposed ? b : a, y = transposed ? a : b;
+
+    ap->plan[(*position)++] = (uint32_t) y * (uint32_t) ap->width + (uint32_t) x;
+}
+
+size_t autopilotMemorySize(int width, int height) {
+    size_t cells = (size_t) width * (size_t) height;
+
+    return 5 * ARENABLOCK(cells * sizeof(uint32_t)) + ARENABLOCK(cells);
+} // autopilotMemorySize function ends
+
+int autopilotInit(autopilot * ap, int width, int height, memArena * arena) {
+    /*! \var int transposed
+     *  \brief True if the cycle is built column by column, the number of rows is odd
+     */
+    int transposed = height % 2 != 0;
+    /*! \var int across, along
+     *  \brief Length of the lines of the zigzag and the number of lines, an even number
+     */
+    int across = transposed ? height : width, along = transposed ? width : height;
+    /*! \var int a, b
+     *  \brief Position in the line and number of the line
+     */
+    int a, b;
+    /*! \var uint32_t position
+     *  \brief Number of cells added to the cycle
+     */
+    uint32_t position = 0;
+
+    if ((width % 2 != 0) && (height % 2 != 0)) {
+        return -1;                                                      // no Hamiltonian cycle
+    }
+    ap->width = width;
+    ap->height = height;
+    ap->cells = (uint32_t) width * (uint32_t) height;
+    ap->order = arenaAlloc(arena, ap->cells * sizeof(uint32_t));
+    ap->next = arenaAlloc(arena, ap->cells);
+    ap->plan = arenaAlloc(arena, ap->cells * sizeof(uint32_t));
+    ap->seen = arenaAlloc(arena, ap->cells * sizeof(uint32_t));
+    ap->parent = arenaAlloc(arena, ap->cells * sizeof(uint32_t));
+    ap->queue = arenaAlloc(arena, ap->cells * sizeof(uint32_t));
+    if ((ap->order == NULL) || (ap->next == NULL) || (ap->plan == NULL) || (ap->seen == NULL) || (ap->parent == NULL) || (ap->queue == NULL)) {
+        return -1;
+    }
+
+    for (a = 0; a < across; a++) {                                      // first line to the end
+        addCell(ap, &position, a, 0, transposed);
+    }
+    for (b = 1; b < along; b++) {                                       // zigzag back over the other lines, leaving the first cell free
+        if (b % 2 != 0) {
+            for (a = across - 1; a >= 1; a--) {
+                addCell(ap, &position, a, b, transposed);
+            }
+        } else {
+            for (a = 1; a < across; a++) {
+                addCell(ap, &position, a, b, transposed);
+            }
+        }
+    }
+    for (b = along - 1; b >= 1; b--) {                                  // the last line ends at a = 1, return on the first cells
+        addCell(ap, &position, 0, b, transposed);
+    }
+    for (position = 0; position < ap->cells; position++) {              // plan holds the cycle until the first search
+        ap->order[ap->plan[position]] = position;
+        ap->next[ap->plan[position]] = stepDirection(ap->plan[position], ap->plan[(position + 1) % ap->cells]);
+    }
+    memset(ap->seen, 0, ap->cells * sizeof(uint32_t));
+    ap->generation = 0;
+    ap->replanEveryTick = 0;
+    ap->searches = 0;
+    ap->searchedCells = 0;
+    ap->planMoves = 0;
+    ap->cycleMoves = 0;
+    autopilotReset(ap);
+    return 0;
+} // autopilotInit function ends
+
+void autopilotReset(autopilot * ap) {
+    ap->planLength = 0;
+    ap->planStep = 0;
+} // autopilotReset function ends
+
+/*! \fn static int search(autopilot * ap, const gameState * game, uint32_t head)
+ * \brief Find the shortest path to the apple that moves forward on the cycle and keeps its distance from the tail
+ *
+ * The cells between the head and the tail on the cycle are free, any path through
+ * them in cycle order keeps the body in cycle order. The tail is taken as standing
+ * still, it only makes room, and the path stays far enough from it for the growth
+ * still to come, so the snake can follow the cycle afterwards.
+ * The cells skipped by a path stay free inside the body until the tail passes them.
+ * Apples that keep landing right in front of the head could use up the cells ahead
+ * before that, so no path is taken once the snake covers half the board, or if it
+ * leaves fewer than half of the free cells ahead of the head
+ */
+static int search(autopilot * ap, const gameState * game, uint32_t head) {
+    static const int dx[4] = { 0, 0, -1, 1 }, dy[4] = { -1, 1, 0, 0 };
+    const snake * sn = &game->player;
+    uint32_t tail = cellNumber(ap, &sn->position[sn->tail]), apple = cellNumber(ap, &game->apple);
+    uint32_t room, growth, goal, first = 0, last = 0, cell, neighbour, distance, length;
+    uint32_t spare = ap->cells - (uint32_t) sn->snakeSupposedLength - 1;   // free cells once the apple is eaten
+    int x, y, k;
+
+    room = tail == head ? ap->cells : ahead(ap, head, tail);            // steps to the tail on the cycle
+    growth = (uint32_t) (sn->snakeSupposedLength - sn->snakeCurrentLength) + 1;   // the apple adds one more
+    goal = ahead(ap, head, apple);
+    if ((room < growth + 2) || (goal > room - growth - 2)) {
+        return 0;                                                       // too close to the tail, the cycle leads there
+    }
+    if ((2 * (sn->snakeSupposedLength + 1) > ap->cells) || (2 * (room - goal - growth - 1) < spare)) {
+        return 0;                                                       // too few free cells left to skip any
+    }
+    if (++ap->generation == 0) {                                        // wrapped, forget every old search
+        memset(ap->seen, 0, ap->cells * sizeof(uint32_t));
+        ap->generation = 1;
+    }
+    ap->searches++;
+    ap->seen[head] = ap->generation;
+    ap->queue[last++] = head;
+    while ((first < last) && (ap->seen[apple] != ap->generation)) {
+        cell = ap->queue[first++];
+        distance = ahead(ap, head, cell);
+        x = (int) (cell % (uint32_t) ap->width);
+        y = (int) (cell / (uint32_t) ap->width);
+        for (k = 0; k < 4; k++) {
+            if (((unsigned) (x + dx[k]) >= (unsigned) ap->width) || ((unsigned) (y + dy[k]) >= (unsigned) ap->height)) {
+                continue;
+            }
+            neighbour = (uint32_t) (y + dy[k]) * (uint32_t) ap->width + (uint32_t) (x + dx[k]);
+            if ((ap->seen[neighbour] == ap->generation) || (ahead(ap, head, neighbour) <= distance) || (ahead(ap, head, neighbour) > goal)
+                || bitTest(&game->occupied, x + dx[k], y + dy[k])
+                || ((cell == head) && reverseDirection(stepDirection(cell, neighbour), sn->runningDirection))) {
+                continue;                                               // only forward, not past the apple, the first step not backwards
+            }
+            ap->seen[neighbour] = ap->generation;
+            ap->parent[neighbour] = cell;
+            ap->queue[last++] = neighbour;
+        }
+    }
+    ap->searchedCells += first;
+    if (ap->seen[apple] != ap->generation) {
+        return 0;
+    }
+    for (length = 0, cell = apple; cell != head; cell = ap->parent[cell]) {
+        length++;
+    }
+    ap->planLength = length;
+    for (cell = apple; cell != head; cell = ap->parent[cell]) {         // written from the apple back
+        ap->plan[--length] = cell;
+    }
+    ap->planStep = 0;
+    ap->planApple = game->apple;
+    return 1;
+}
+
+/*! \fn static unsigned char cycleInput(autopilot * ap, const gameState * game, uint32_t head)
+ * \brief Next direction on the cycle, at the start of a game the closest forward cell that is not backwards
+ */
+static unsigned char cycleInput(autopilot * ap, const gameState * game, uint32_t head) {
+    static const char directions[] = "udlr";
+    static const int dx[4] = { 0, 0, -1, 1 }, dy[4] = { -1, 1, 0, 0 };
+    const snake * sn = &game->player;
+    int x = (int) (head % (uint32_t) ap->width), y = (int) (head / (uint32_t) ap->width), k;
+    uint32_t neighbour, best = ap->cells;
+    unsigned char choice = ap->next[head];
+
+    ap->cycleMoves++;
+    if (!reverseDirection(choice, sn->runningDirection)) {
+        return choice;
+    }
+    for (k = 0; k < 4; k++) {                                           // only a 1 segment snake can turn back
+        if (((unsigned) (x + dx[k]) < (unsigned) ap->width) && ((unsigned) (y + dy[k]) < (unsigned) ap->height)
+            && !reverseDirection((unsigned char) directions[k], sn->runningDirection)) {
+            neighbour = (uint32_t) (y + dy[k]) * (uint32_t) ap->width + (uint32_t) (x + dx[k]);
+            if (ahead(ap, head, neighbour) < best) {
+                best = ahead(ap, head, neighbour);
+                choice = (unsigned char) directions[k];
+            }
+        }
+    }
+    return choice;
+}
+
+unsigned char autopilotInput(autopilot * ap, const gameState * game) {
+    /*! \var uint32_t head
+     *  \brief Cell of the snake head
+     */
+    uint32_t head = cellNumber(ap, &game->player.position[game->player.head]);
+
+    if (!ap->replanEveryTick && (ap->planStep > 0) && (ap->planStep < ap->planLength) && (ap->plan[ap->planStep - 1] == head)
+        && (game->appleCount != 0) && (game->apple.x == ap->planApple.x) && (game->apple.y == ap->planApple.y)) {
+        ap->planMoves++;                                                // still on the path to the same apple
+        return stepDirection(head, ap->plan[ap->planStep++]);
+    }
+    ap->planLength = 0;
+    if ((game->appleCount != 0) && search(ap, game, head)) {
+        ap->planMoves++;
+        return stepDirection(head, ap->plan[ap->planStep++]);
+    }
+    return cycleInput(ap, game, head);
+} // autopilotInput function ends
+
+// End of autopilot.c
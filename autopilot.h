@@ -0,0 +1,113 @@
+/*! \file autopilot.h
+ * \brief Autopilot header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Chooses the input of a game instead of the keyboard. The board is
+ * covered by a Hamiltonian cycle and the snake body is always kept in
+ * cycle order from the tail to the head, so following the cycle never
+ * hits the body. To be faster it takes shortcuts: once per apple a
+ * breadth first search finds the shortest path to the apple that only
+ * moves forward on the cycle and stays far enough in front of the tail.
+ * Shortcuts are only taken while the snake covers at most half of the
+ * board and most free cells stay in front of the head, so the cells they
+ * skip are freed by the tail long before the board fills up; only on
+ * boards of a few cells can a run of apples right in front of the head
+ * still trap it. The path is kept and followed tick by tick while the
+ * apple is the same and the head is where the path expects it, so a tick
+ * normally costs a few lookups instead of a search of the board. Boards
+ * with an odd number of columns and rows have no Hamiltonian cycle and
+ * are not supported.
+ */
+
+#ifndef SNAKEGAME_AUTOPILOT_H
+#define SNAKEGAME_AUTOPILOT_H
+
+#include <stdint.h>
+#include "engine.h"
+
+/*! \typedef struct autopilot
+ *  \brief Contains the cycle, the cached path and the search memory of the autopilot
+ *
+ * Cells are numbered row by row, the cell of x, y is y * width + x
+ *
+ * \var int width, height Board size
+ * \var uint32_t cells Number of cells
+ * \var uint32_t * order Position of each cell on the cycle
+ * \var unsigned char * next Direction u, d, l, r from each cell to the next one on the cycle
+ * \var uint32_t * plan Cells of the path to the apple, planLength of them, the head not included
+ * \var uint32_t planLength, planStep Length of the path, index of the next cell to move to
+ * \var coord planApple Apple the path leads to
+ * \var int replanEveryTick True to search again every tick, the slow reference
+ * \var uint32_t * seen Search generation that reached each cell
+ * \var uint32_t * parent Cell the search came from
+ * \var uint32_t * queue Search queue
+ * \var uint32_t generation Current search generation, seen is cleared only when it wraps
+ * \var unsigned long searches Number of searches made
+ * \var unsigned long long searchedCells Cells taken from the queue by all searches
+ * \var unsigned long planMoves, cycleMoves Moves along a cached path, moves along the cycle
+ */
+typedef struct autopilot_t {
+    int width;
+    int height;
+    uint32_t cells;
+    uint32_t * order;
+    unsigned char * next;
+    uint32_t * plan;
+    uint32_t planLength;
+    uint32_t planStep;
+    coord planApple;
+    int replanEveryTick;
+    uint32_t * seen;
+    uint32_t * parent;
+    uint32_t * queue;
+    uint32_t generation;
+    unsigned long searches;
+    unsigned long long searchedCells;
+    unsigned long planMoves;
+    unsigned long cycleMoves;
+} autopilot;
+
+/*! \fn size_t autopilotMemorySize(int width, int height)
+ * \brief Arena space needed by the autopilot of a board
+ *
+ * \param width Number of columns
+ * \param height Number of rows
+ * \return size_t Number of bytes
+ */
+size_t autopilotMemorySize(int width, int height);
+
+/*! \fn int autopilotInit(autopilot * ap, int width, int height, memArena * arena)
+ * \brief Build the Hamiltonian cycle of the board
+ *
+ * \param ap Pointer to autopilot
+ * \param width Number of columns
+ * \param height Number of rows
+ * \param arena Memory arena
+ * \return int 0 on success, -1 if both sides are odd or the arena is exhausted
+ */
+int autopilotInit(autopilot * ap, int width, int height, memArena * arena);
+
+/*! \fn void autopilotReset(autopilot * ap)
+ * \brief Forget the cached path, for a new game
+ *
+ * \param ap Pointer to autopilot
+ * \return void No values returned
+ */
+void autopilotReset(autopilot * ap);
+
+/*! \fn unsigned char autopilotInput(autopilot * ap, const gameState * game)
+ * \brief Choose the input of the next step, for updateSnakeDirection or gameStep
+ *
+ * The game must have been played by the autopilot from its start
+ *
+ * \param ap Pointer to autopilot
+ * \param game The game before the step
+ * \return unsigned char Direction u, d, l, r
+ */
+unsigned char autopilotInput(autopilot * ap, const gameState * game);
+
+#endif //SNAKEGAME_AUTOPILOT_H
+
+// End of autopilot.h
@@ -0,0 +1,216 @@
+/*! \file batch.c
+ * \brief Batched game engine
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#include "batch.h"
+#include "engine.h"
+
+/*! \def HOTARRAYS
+ *  \brief Number of int32_t arrays in the batch
+ */
+#define HOTARRAYS 16
+
+/*! \fn static int32_t * takeArray(memArena * arena, size_t count)
+ * \brief Take one int32_t array from the arena
+ */
+static int32_t * takeArray(memArena * arena, size_t count) {
+    return arenaAlloc(arena, count * sizeof(int32_t));
+}
+
+size_t batchMemorySize(size_t count, int width, int height) {
+    return HOTARRAYS * ARENABLOCK(count * sizeof(int32_t)) + ARENABLOCK(count * sizeof(rngState))
+           + ARENABLOCK(count * sizeof(snake)) + ARENABLOCK(count * sizeof(bitboard)) + ARENABLOCK(count * sizeof(freeCells))
+           + count * (bitboardMemorySize(width, height) + snakeMemorySize(width, height) + freeCellsMemorySize(width, height));
+} // batchMemorySize function ends
+
+int batchInit(gameBatch * batch, size_t count, int width, int height, uint64_t seed, memArena * arena) {
+    /*! \var size_t i
+     *  \brief Loop index variable
+     */
+    size_t i;
+
+    batch->count = count;
+    batch->width = width;
+    batch->height = height;
+    batch->headX = takeArray(arena, count);
+    batch->headY = takeArray(arena, count);
+    batch->direction = takeArray(arena, count);
+    batch->currentLength = takeArray(arena, count);
+    batch->supposedLength = takeArray(arena, count);
+    batch->appleX = takeArray(arena, count);
+    batch->appleY = takeArray(arena, count);
+    batch->appleCount = takeArray(arena, count);
+    batch->score = takeArray(arena, count);
+    batch->running = takeArray(arena, count);
+    batch->ticks = takeArray(arena, count);
+    batch->moved = takeArray(arena, count);
+    batch->tailMoved = takeArray(arena, count);
+    batch->ate = takeArray(arena, count);
+    batch->input = takeArray(arena, count);
+    batch->rng = arenaAlloc(arena, count * sizeof(rngState));
+    batch->bodies = arenaAlloc(arena, count * sizeof(snake));
+    batch->boards = arenaAlloc(arena, count * sizeof(bitboard));
+    batch->freeIndex = arenaAlloc(arena, count * sizeof(freeCells));
+    if ((batch->input == NULL) || (batch->freeIndex == NULL)) {           // taken in order, so the last ones tell
+        return -1;
+    }
+
+    for (i = 0; i < count; i++) {
+        if ((initBitboard(&batch->boards[i], width, height, arena) != 0)
+            || (initSnake(&batch->bodies[i], width, height, arena) != 0)
+            || (initFreeCells(&batch->freeIndex[i], &batch->bodies[i], width, height, arena) != 0)) {
+            return -1;
+        }
+        batchReset(batch, i, seed + i);
+    }
+    return 0;
+} // batchInit function ends
+
+void batchReset(gameBatch * batch, size_t game, uint64_t seed) {
+    /*! \var snake * sn
+     *  \brief Body of the game
+     */
+    snake * sn = &batch->bodies[game];
+
+    initSnake(sn, batch->width, batch->height, NULL);                  // same start as gameReset
+    initFreeCells(&batch->freeIndex[game], sn, batch->width, batch->height, NULL);
+    updateBitboard(&batch->boards[game], sn);
+
+    batch->headX[game] = sn->position[sn->head].x;
+    batch->headY[game] = sn->position[sn->head].y;
+    batch->direction[game] = DIRLEFT;
+    batch->currentLength[game] = (int32_t) sn->snakeCurrentLength;
+    batch->supposedLength[game] = (int32_t) sn->snakeSupposedLength;
+    batch->appleX[game] = 0;
+    batch->appleY[game] = 0;
+    batch->appleCount[game] = 0;
+    batch->score[game] = 0;
+    batch->running[game] = 1;
+    batch->ticks[game] = 0;
+    rngSeed(&batch->rng[game], seed);
+} // batchReset function ends
+
+/*! \fn static void moveHeads(gameBatch * batch, const unsigned char * inputs)
+ * \brief Vectorized part of the step: turn, move head, check walls and apple, update length
+ *
+ * Branch free on contiguous arrays, so the compiler turns it into SIMD code
+ */
+static void moveHeads(gameBatch * batch, const unsigned char * restrict inputs) {
+    int32_t * restrict headX = batch->headX;
+    int32_t * restrict headY = batch->headY;
+    int32_t * restrict direction = batch->direction;
+    int32_t * restrict currentLength = batch->currentLength;
+    const int32_t * restrict supposedLength = batch->supposedLength;
+    const int32_t * restrict appleX = batch->appleX;
+    const int32_t * restrict appleY = batch->appleY;
+    const int32_t * restrict appleCount = batch->appleCount;
+    int32_t * restrict running = batch->running;
+    int32_t * restrict ticks = batch->ticks;
+    int32_t * restrict moved = batch->moved;
+    int32_t * restrict tailMoved = batch->tailMoved;
+    int32_t * restrict ate = batch->ate;
+    int32_t * restrict input = batch->input;
+    const int32_t width = batch->width, height = batch->height;
+    const size_t count = batch->count;
+    size_t i;
+
+    for (i = 0; i < count; i++) {                                       // widen inputs first, mixed
+        input[i] = inputs[i];                                           // element sizes stop vectorization
+    }
+
+#pragma GCC ivdep
+    for (i = 0; i < count; i++) {                                       // arrays never overlap
+        int32_t c = input[i];                                           // comparisons give all ones / zero masks
+        int32_t isUp = (c == 'u') ? -1 : 0;
+        int32_t isDown = (c == 'd') ? -1 : 0;
+        int32_t isLeft = (c == 'l') ? -1 : 0;
+        int32_t isRight = (c == 'r') ? -1 : 0;
+        int32_t code = (isDown & DIRDOWN) | (isLeft & DIRLEFT) | (isRight & DIRRIGHT);
+        int32_t live = (running[i] != 0) ? -1 : 0;                      // masks the update of finished games
+        int32_t turn = (isUp | isDown | isLeft | isRight)
+                       & (((code >> 1) != (direction[i] >> 1)) ? -1 : 0);   // only turns across the running axis
+        int32_t dir = (code & turn) | (direction[i] & ~turn);
+        int32_t x = headX[i] + ((dir == DIRRIGHT) ? 1 : 0) - ((dir == DIRLEFT) ? 1 : 0);
+        int32_t y = headY[i] + ((dir == DIRDOWN) ? 1 : 0) - ((dir == DIRUP) ? 1 : 0);
+        int32_t inside = (((uint32_t) x < (uint32_t) width) ? -1 : 0) & (((uint32_t) y < (uint32_t) height) ? -1 : 0);
+        int32_t grow = (currentLength[i] < supposedLength[i]) ? -1 : 0;  // snake still flows in
+        int32_t hit = ((appleCount[i] != 0) ? -1 : 0) & ((x == appleX[i]) ? -1 : 0) & ((y == appleY[i]) ? -1 : 0);
+
+        direction[i] = (dir & live) | (direction[i] & ~live);
+        headX[i] = (x & live) | (headX[i] & ~live);
+        headY[i] = (y & live) | (headY[i] & ~live);
+        currentLength[i] += grow & live & 1;
+        tailMoved[i] = ~grow & live & 1;
+        ticks[i] += live & 1;
+        moved[i] = inside & live & 1;
+        ate[i] = hit & inside & live & 1;
+        running[i] = inside & live & 1;                                 // wall hit ends the game
+    }
+}
+
+size_t batchStep(gameBatch * batch, const unsigned char * inputs) {
+    /*! \var size_t i
+     *  \brief Loop index variable
+     */
+    size_t i;
+    /*! \var size_t runningGames
+     *  \brief Number of games still running after the step
+     */
+    size_t runningGames = 0;
+    snake * sn;
+    bitboard * field;
+    freeCells * fc;
+    coord head, oldTail, apple;
+
+    moveHeads(batch, inputs);
+
+    for (i = 0; i < batch->count; i++) {                                // body, board and apple of the moved games
+        if (!batch->moved[i]) {
+            continue;
+        }
+        sn = &batch->bodies[i];
+        field = &batch->boards[i];
+        fc = &batch->freeIndex[i];
+        head.x = batch->headX[i];
+        head.y = batch->headY[i];
+
+        sn->head = (sn->head + 1 == sn->capacity) ? 0 : sn->head + 1;  // push head into the ring
+        sn->position[sn->head] = head;
+        oldTail = sn->position[sn->tail];
+        if (batch->tailMoved[i]) {                                      // pop tail from the ring
+            sn->tail = (sn->tail + 1 == sn->capacity) ? 0 : sn->tail + 1;
+        }
+
+        batch->running[i] &= !bitTest(field, head.x, head.y);           // Snake hits itself
+        if (batch->ate[i]) {                                            // Snake eats apple
+            batch->score[i] += APPLESCORE;
+            batch->appleCount[i] = 0;
+            batch->supposedLength[i]++;
+        }
+
+        if (batch->tailMoved[i]) {                                      // same order as updateFreeCells
+            releaseFreeCell(fc, &oldTail);
+            bitAssign(field, oldTail.x, oldTail.y, 0);
+        }
+        takeFreeCell(fc, &head);
+        bitAssign(field, head.x, head.y, 1);
+
+        if (batch->appleCount[i] == 0) {                                // if no apple, find position for apple
+            sn->snakeSupposedLength = (size_t) batch->supposedLength[i];
+            if (placeAppleFree(&apple, sn, fc, &batch->rng[i]) == 0) {
+                batch->running[i] = 0;                                  // no more apple possible
+            } else {
+                batch->appleX[i] = apple.x;
+                batch->appleY[i] = apple.y;
+                batch->appleCount[i] = 1;
+            }
+        }
+        runningGames += (size_t) batch->running[i];
+    }
+    return runningGames;
+} // batchStep function ends
+
+// End of batch.c
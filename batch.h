@@ -0,0 +1,123 @@
+/*! \file batch.h
+ * \brief Batched game engine header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Many independent games stored as structure of arrays.
+ * One step advances every game: head movement, wall and apple checks run
+ * over contiguous arrays in one vectorizable loop, the snake body, occupancy grid
+ * and free cell index of each game are updated after that.
+ * The result of every game is exactly the same as with gameStep.
+ */
+
+#ifndef SNAKEGAME_BATCH_H
+#define SNAKEGAME_BATCH_H
+
+#include <stdint.h>
+#include "snake.h"
+#include "freecells.h"
+#include "bitboard.h"
+#include "memarena.h"
+
+/*! \def DIRUP, DIRDOWN, DIRLEFT, DIRRIGHT
+ *  \brief Direction codes stored in the batch, the upper bit is the axis
+ */
+#define DIRUP 0
+#define DIRDOWN 1
+#define DIRLEFT 2
+#define DIRRIGHT 3
+
+/*! \typedef struct gameBatch
+ *  \brief Contains a batch of games, every array has count elements
+ *
+ * \var size_t count Number of games
+ * \var int width, height Board size, the same for every game
+ * \var int32_t * headX, * headY Position of the snake heads
+ * \var int32_t * direction Running directions, DIRUP .. DIRRIGHT
+ * \var int32_t * currentLength, * supposedLength Snake lengths
+ * \var int32_t * appleX, * appleY, * appleCount Apples
+ * \var int32_t * score Scores
+ * \var int32_t * running True while the game runs
+ * \var int32_t * ticks Number of steps made by each game
+ * \var int32_t * moved, * tailMoved, * ate Results of the vectorized part of the last step
+ * \var int32_t * input Inputs of the last step widened to 32 bit
+ * \var rngState * rng Random number generator of each game
+ * \var snake * bodies Snake segment ring buffers, only position, capacity, head and tail are used
+ * \var bitboard * boards Occupancy grids of the games
+ * \var freeCells * freeIndex Free cell indexes
+ */
+typedef struct gameBatch_t {
+    size_t count;
+    int width;
+    int height;
+    int32_t * headX;
+    int32_t * headY;
+    int32_t * direction;
+    int32_t * currentLength;
+    int32_t * supposedLength;
+    int32_t * appleX;
+    int32_t * appleY;
+    int32_t * appleCount;
+    int32_t * score;
+    int32_t * running;
+    int32_t * ticks;
+    int32_t * moved;
+    int32_t * tailMoved;
+    int32_t * ate;
+    int32_t * input;
+    rngState * rng;
+    snake * bodies;
+    bitboard * boards;
+    freeCells * freeIndex;
+} gameBatch;
+
+/*! \fn size_t batchMemorySize(size_t count, int width, int height)
+ * \brief Arena space needed by a batch of games
+ *
+ * \param count Number of games
+ * \param width Number of columns
+ * \param height Number of rows
+ * \return size_t Number of bytes
+ */
+size_t batchMemorySize(size_t count, int width, int height);
+
+/*! \fn int batchInit(gameBatch * batch, size_t count, int width, int height, uint64_t seed, memArena * arena)
+ * \brief Set up a batch of new games
+ *
+ * Game i gets the seed seed + i, the same as a gameState started with gameInit with that seed
+ *
+ * \param batch Pointer to batch
+ * \param count Number of games
+ * \param width Number of columns
+ * \param height Number of rows
+ * \param seed Random number seed of the first game
+ * \param arena Memory arena
+ * \return int 0 on success, -1 if the arena is exhausted
+ */
+int batchInit(gameBatch * batch, size_t count, int width, int height, uint64_t seed, memArena * arena);
+
+/*! \fn void batchReset(gameBatch * batch, size_t game, uint64_t seed)
+ * \brief Start a new game in one slot of the batch
+ *
+ * \param batch Pointer to batch
+ * \param game Index of the game
+ * \param seed Random number seed
+ * \return void No values returned
+ */
+void batchReset(gameBatch * batch, size_t game, uint64_t seed);
+
+/*! \fn size_t batchStep(gameBatch * batch, const unsigned char * inputs)
+ * \brief Advance every running game by one tick
+ *
+ * Finished games are left unchanged
+ *
+ * \param batch Pointer to batch
+ * \param inputs New direction of each game: u, d, l, r or any other value for no change
+ * \return size_t Number of games still running
+ */
+size_t batchStep(gameBatch * batch, const unsigned char * inputs);
+
+#endif //SNAKEGAME_BATCH_H
+
+// End of batch.h
@@ -0,0 +1,70 @@
+/*! \file apple_bench.c
+ * \brief Apple placement benchmark
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Places apples on a board where the snake covers 99% of the cells,
+ * with the retrying placeApple and with the free cell index
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "snake.h"
+#include "freecells.h"
+#include "benchutil.h"
+
+/*! \def ROUNDS
+ *  \brief Number of apples placed by each method
+ */
+#define ROUNDS 100000
+
+int main(int argc, char **argv) {
+    memArena arena;
+    board gameBoard;
+    snake sn;
+    freeCells fc;
+    coord apple;
+    int width = argc > 1 ? atoi(argv[1]) : BOARDSIZEX;
+    int height = argc > 2 ? atoi(argv[2]) : BOARDSIZEY;
+    int rounds = argc > 3 ? atoi(argv[3]) : ROUNDS;
+    size_t length = (size_t) width * (size_t) height * 99 / 100;
+    double start, scanTime, indexTime;
+    long placed = 0;
+    rngState rng;
+    int i;
+
+    if ((width < MINBOARDSIZE) || (height < MINBOARDSIZE) || (rounds < 1)
+        || (arenaInit(&arena, boardMemorySize(width, height) + snakeMemorySize(width, height) + freeCellsMemorySize(width, height)) != 0)) {
+        fprintf(stderr, "Usage: %s [columns] [rows] [rounds]\n", argv[0]);
+        return 1;
+    }
+    initBoard(&gameBoard, width, height, &arena);
+    initSnake(&sn, width, height, &arena);
+    benchFillSnake(&sn, length, width);
+    initFreeCells(&fc, &sn, width, height, &arena);
+    rngSeed(&rng, 1);
+
+    start = benchSeconds();
+    for (i = 0; i < rounds; i++) {                                      // before: random retry + snake scan
+        placed += placeApple(&apple, &sn, &gameBoard, &rng);
+    }
+    scanTime = benchSeconds() - start;
+
+    start = benchSeconds();
+    initFreeCells(&fc, &sn, width, height, NULL);
+    for (i = 0; i < rounds; i++) {                                      // after: draw from free cell index
+        placed += placeAppleFree(&apple, &sn, &fc, &rng);
+    }
+    indexTime = benchSeconds() - start;
+
+    printf("Board %dx%d, snake length %zu (%zu free cells), %d placements each\n",
+           width, height, length, (size_t) width * (size_t) height - length, rounds);
+    printf("placeApple      %10.1f ns/apple\n", scanTime / rounds * 1e9);
+    printf("placeAppleFree  %10.1f ns/apple (index build included)\n", indexTime / rounds * 1e9);
+    printf("speedup         %10.1fx\n", scanTime / indexTime);
+    arenaFree(&arena);
+    return placed == 2L * rounds ? 0 : 1;
+}
+
+// End of apple_bench.c
@@ -0,0 +1,95 @@
+/*! \file benchutil.h
+ * \brief Setup shared by the benchmarks header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Timing, a laid out snake and a scripted player for the benchmark programs.
+ * Header only, every benchmark is one source file.
+ */
+
+#ifndef SNAKEGAME_BENCHUTIL_H
+#define SNAKEGAME_BENCHUTIL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "engine.h"
+#include "rng.h"
+#include "stats.h"
+
+/*! \fn static inline double benchSeconds(void)
+ * \brief Monotonic time in seconds, statsNow as a double
+ */
+static inline double benchSeconds(void) {
+    return (double) statsNow() / 1e9;
+}
+
+/*! \fn static inline void benchFillSnake(snake * sn, size_t length, int width)
+ * \brief Lay a snake of the given length on the board row by row, turning at the ends
+ *
+ * \param sn Pointer to snake, its ring holds at least length cells
+ * \param length Length of the snake, at most the board
+ * \param width Board width
+ * \return void No values returned
+ */
+static inline void benchFillSnake(snake * sn, size_t length, int width) {
+    size_t i;
+    int x, y;
+
+    for (i = 0; i < length; i++) {
+        y = (int) (i / (size_t) width);
+        x = (int) (i % (size_t) width);
+        if (y % 2 == 1) {                                               // every second row runs backwards
+            x = width - 1 - x;
+        }
+        sn->position[i].x = x;
+        sn->position[i].y = y;
+    }
+    sn->tail = 0;
+    sn->head = length - 1;
+    sn->snakeCurrentLength = length;
+    sn->snakeSupposedLength = length;
+    sn->runningDirection = 'r';
+}
+
+/*! \fn static inline unsigned char benchInput(gameState * game, rngState * player, int chase, uint32_t turnOdds)
+ * \brief Input of a scripted player: a turn before running into a wall, toward the apple if chase is set, and a random turn now and then
+ *
+ * \param game Pointer to game
+ * \param player Random number generator of the player
+ * \param chase True to turn toward the apple when it is straight to the side, so the snake grows
+ * \param turnOdds A random turn is made once in turnOdds ticks on average
+ * \return unsigned char Key 'u', 'd', 'l' or 'r', '\0' to keep the direction
+ */
+static inline unsigned char benchInput(gameState * game, rngState * player, int chase, uint32_t turnOdds) {
+    static const char turns[] = "udlr";
+    coord * head = &game->player.position[game->player.head];
+    unsigned char direction = game->player.runningDirection;
+
+    if ((direction == 'l') && (head->x == 0)) {
+        return head->y > 0 ? 'u' : 'd';
+    }
+    if ((direction == 'r') && (head->x == game->occupied.width - 1)) {
+        return head->y > 0 ? 'u' : 'd';
+    }
+    if ((direction == 'u') && (head->y == 0)) {
+        return head->x > 0 ? 'l' : 'r';
+    }
+    if ((direction == 'd') && (head->y == game->occupied.height - 1)) {
+        return head->x > 0 ? 'l' : 'r';
+    }
+    if (chase && (game->appleCount != 0) && ((direction == 'l') || (direction == 'r')) && (head->x == game->apple.x)) {
+        return head->y > game->apple.y ? 'u' : 'd';
+    }
+    if (chase && (game->appleCount != 0) && ((direction == 'u') || (direction == 'd')) && (head->y == game->apple.y)) {
+        return head->x > game->apple.x ? 'l' : 'r';
+    }
+    if (rngBounded(player, turnOdds) == 0) {
+        return (unsigned char) turns[rngBounded(player, 4)];
+    }
+    return '\0';
+}
+
+#endif //SNAKEGAME_BENCHUTIL_H
+
+// End of benchutil.h
@@ -0,0 +1,195 @@
+/*! \file body_bench.c
+ * \brief Snake body representation benchmark
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Plays games with the engine and moves a packed snake in step with the
+ * engine's snake, checking that heads, tails and lengths stay the same.
+ * Reports the body memory of a game with the coordinate ring and with the
+ * packed ring, then the time to walk long bodies in both representations.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "engine.h"
+#include "packedsnake.h"
+#include "benchutil.h"
+
+/*! \def WALKROUNDS
+ *  \brief Number of walks over a body per measurement
+ */
+#define WALKROUNDS 200
+
+/*! \fn static int sameBody(gameState * game, packedSnake * ps)
+ * \brief True if the packed snake has the head, tail and length of the engine's snake
+ */
+static int sameBody(gameState * game, packedSnake * ps) {
+    snake * sn = &game->player;
+
+    return (sn->position[sn->head].x == ps->headCell.x) && (sn->position[sn->head].y == ps->headCell.y)
+           && (sn->position[sn->tail].x == ps->tailCell.x) && (sn->position[sn->tail].y == ps->tailCell.y)
+           && (sn->snakeCurrentLength == ps->snakeCurrentLength);
+}
+
+/*! \fn static void layBodies(snake * sn, packedSnake * ps, size_t length, int width)
+ * \brief Lay the same snake in both representations, row by row, turning at the ends
+ */
+static void layBodies(snake * sn, packedSnake * ps, size_t length, int width) {
+    size_t i;
+    int x, y;
+
+    ps->tailCell.x = ps->headCell.x = 0;
+    ps->tailCell.y = ps->headCell.y = 0;
+    ps->first = 0;
+    ps->snakeCurrentLength = 1;
+    ps->snakeSupposedLength = length;
+    for (i = 0; i < length; i++) {
+        y = (int) (i / (size_t) width);
+        x = (int) (i % (size_t) width);
+        if (y % 2 == 1) {                                               // every second row runs backwards
+            x = width - 1 - x;
+        }
+        sn->position[i].x = x;
+        sn->position[i].y = y;
+        if (i > 0) {                                                    // the packed snake crawls there
+            ps->runningDirection = y != ps->headCell.y ? 'd' : (x > ps->headCell.x ? 'r' : 'l');
+            (void) updatePackedSnake(ps);
+        }
+    }
+    sn->tail = 0;
+    sn->head = length - 1;
+    sn->snakeCurrentLength = length;
+    sn->snakeSupposedLength = length;
+}
+
+/*! \fn static long long walkRing(snake * sn)
+ * \brief Visit every segment of the coordinate ring from tail to head
+ */
+static long long walkRing(snake * sn) {
+    long long sum = 0;
+    size_t i = sn->tail;
+
+    for (;;) {
+        sum += sn->position[i].x * 65536LL + sn->position[i].y;
+        if (i == sn->head) {
+            return sum;
+        }
+        i = (i + 1 == sn->capacity) ? 0 : i + 1;
+    }
+}
+
+/*! \fn static long long walkPacked(packedSnake * ps)
+ * \brief Visit every segment of the packed ring from tail to head
+ */
+static long long walkPacked(packedSnake * ps) {
+    long long sum = 0;
+    packedCursor cursor;
+
+    packedFirst(ps, &cursor);
+    do {
+        sum += cursor.cell.x * 65536LL + cursor.cell.y;
+    } while (packedNext(ps, &cursor));
+    return sum;
+}
+
+int main(int argc, char **argv) {
+    int width = argc > 1 ? atoi(argv[1]) : BOARDSIZEX;
+    int height = argc > 2 ? atoi(argv[2]) : BOARDSIZEY;
+    long games = argc > 3 ? atol(argv[3]) : 10000;
+    static const int fills[] = { 10, 50, 99 };
+    memArena arena;
+    gameState game;
+    packedSnake ps;
+    bitboard grid;
+    rngState player;
+    size_t supposed, ringBytes, packedBytes = 0, packedMax = 0, longest = 0, length, f;
+    unsigned long long ticks = 0;
+    long long ringSum = 0, packedSum = 0;
+    double start, ringTime, packedTime, ringMark, packedMark;
+    long g, mismatches = 0;
+    int r;
+
+    if ((games < 1) || (width < MINBOARDSIZE) || (width > MAXBOARDSIZE) || (height < MINBOARDSIZE) || (height > MAXBOARDSIZE)) {
+        fprintf(stderr, "Usage: %s [columns] [rows] [games]\n", argv[0]);
+        return 1;
+    }
+    if ((arenaInit(&arena, gameMemorySize(width, height) + bitboardMemorySize(width, height)) != 0)
+        || (gameInit(&game, width, height, 1, &arena) != 0)
+        || (initBitboard(&grid, width, height, &arena) != 0)) {
+        fprintf(stderr, "Not enough memory for %dx%d board\n", width, height);
+        return 1;
+    }
+    memset(&ps, 0, sizeof(ps));
+    rngSeed(&player, 12345);
+
+    for (g = 0; g < games; g++) {                                       // both bodies move in step
+        gameReset(&game, (uint64_t) g);
+        freePackedSnake(&ps);                                           // every game starts with the smallest ring
+        if (initPackedSnake(&ps, width, height) != 0) {
+            return 1;
+        }
+        do {
+            updateSnakeDirection(&game.player, benchInput(&game, &player, 1, 16));
+            supposed = game.player.snakeSupposedLength;                 // the move uses the length before eating
+            gameStep(&game, '\0');
+            ps.runningDirection = game.player.runningDirection;
+            ps.snakeSupposedLength = supposed;
+            if ((updatePackedSnake(&ps) != 0) || !sameBody(&game, &ps)) {
+                mismatches++;
+                break;
+            }
+            ticks++;
+        } while (game.running);
+        packedBytes += packedSnakeBytes(&ps);
+        packedMax = packedSnakeBytes(&ps) > packedMax ? packedSnakeBytes(&ps) : packedMax;
+        longest = ps.snakeCurrentLength > longest ? ps.snakeCurrentLength : longest;
+    }
+    ringBytes = sizeof(snake) + snakeMemorySize(width, height);
+
+    printf("Board %dx%d, %ld games, %.1f ticks per game, longest snake %zu\n", width, height, games, (double) ticks / games, longest);
+    printf("coordinate ring %8zu bytes per game, any length\n", ringBytes);
+    printf("packed ring     %8.1f bytes per game on average, %zu at most, %zu for a full board\n", (double) packedBytes / games, packedMax,
+           sizeof(packedSnake) + (size_t) width * (size_t) height / 4 + 8);
+    printf("memory          %8.1fx less\n", ringBytes / ((double) packedBytes / games));
+    printf("verify          %ld of %ld games differ\n\n", mismatches, games);
+
+    for (f = 0; f < sizeof(fills) / sizeof(fills[0]); f++) {            // walking long bodies
+        length = (size_t) width * (size_t) height * (size_t) fills[f] / 100;
+        layBodies(&game.player, &ps, length, width);
+        start = benchSeconds();
+        for (r = 0; r < WALKROUNDS; r++) {
+            ringSum += walkRing(&game.player);
+        }
+        ringTime = benchSeconds() - start;
+        start = benchSeconds();
+        for (r = 0; r < WALKROUNDS; r++) {
+            packedSum += walkPacked(&ps);
+        }
+        packedTime = benchSeconds() - start;
+        start = benchSeconds();
+        for (r = 0; r < WALKROUNDS; r++) {
+            updateBitboard(&grid, &game.player);
+        }
+        ringMark = benchSeconds() - start;
+        start = benchSeconds();
+        for (r = 0; r < WALKROUNDS; r++) {
+            markPackedSnake(&grid, &ps);
+        }
+        packedMark = benchSeconds() - start;
+        printf("length %7zu   walk ring %5.2f ns packed %5.2f ns   grid from ring %5.2f ns packed %5.2f ns per segment   %zu vs %zu bytes\n",
+               length, ringTime / WALKROUNDS / length * 1e9, packedTime / WALKROUNDS / length * 1e9,
+               ringMark / WALKROUNDS / length * 1e9, packedMark / WALKROUNDS / length * 1e9, length * sizeof(coord), packedSnakeBytes(&ps));
+    }
+    if (ringSum != packedSum) {
+        printf("walks differ\n");
+        mismatches++;
+    }
+
+    freePackedSnake(&ps);
+    arenaFree(&arena);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// End of body_bench.c
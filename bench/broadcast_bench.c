@@ -0,0 +1,436 @@
+/*! \file broadcast_bench.c
+ * \brief Spectator broadcast fan-out benchmark
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Plays a game with a bot and broadcasts it, while more and more loopback
+ * viewers connect in the middle of the game. Every viewer keeps a copy of
+ * the screen built from the bytes it receives, like a terminal would. For
+ * every step it reports the time the game thread spends per tick encoding
+ * and handing off, which should not grow with the viewers, the time the
+ * sender thread spends per tick, the frames each viewer received and the
+ * viewers sent back to wait for a keyframe. At the end every viewer that
+ * reads must show the same board as the game.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include "broadcast.h"
+#include "benchutil.h"
+
+/*! \def MAXTHREADS
+ *  \brief Largest number of viewer threads
+ */
+#define MAXTHREADS 64
+
+/*! \def BOARDTOP, BOARDLEFT, PARKROW
+ *  \brief Screen layout of render.c: first board row and column, row of the parked cursor (1 based)
+ */
+#define BOARDTOP 4
+#define BOARDLEFT 2
+#define PARKROW(height) (BOARDTOP + (height) + 4)
+
+/*! \def SCREENCOLUMNS
+ *  \brief Columns of the screen copy of a viewer, enough for the instructions
+ */
+#define SCREENCOLUMNS(width) ((width) + 2 > 100 ? (width) + 2 : 100)
+
+/*! \typedef struct viewer
+ *  \brief One simulated spectator and its copy of the screen
+ */
+typedef struct viewer_t {
+    int fd;
+    int slow;
+    int state;
+    int parameters[2];
+    int parameterCount;
+    int row;
+    int column;
+    char * screen;
+    long long lastFrame;
+    unsigned long frames;
+} viewer;
+
+/*! \typedef struct worker
+ *  \brief One viewer thread, its viewers and its measurements
+ */
+typedef struct worker_t {
+    pthread_t thread;
+    int epollFd;
+    viewer * viewers;
+    int count;
+    pthread_mutex_t lock;
+    histogram gaps;
+    unsigned long long frames;
+    unsigned long long bytes;
+    unsigned long closed;
+} __attribute__((aligned(64))) worker;
+
+/*! \var static volatile int stopping
+ *  \brief Set when the viewer threads should end
+ */
+static volatile int stopping = 0;
+
+/*! \var static int boardWidth, boardHeight
+ *  \brief Board size of the game
+ */
+static int boardWidth = BOARDSIZEX, boardHeight = BOARDSIZEY;
+
+/*! \fn static void endFrame(worker * wk, viewer * vw)
+ * \brief Count a frame and the time since the previous one
+ */
+static void endFrame(worker * wk, viewer * vw) {
+    long long now = statsNow();
+
+    pthread_mutex_lock(&wk->lock);
+    if (vw->lastFrame != 0) {
+        histogramRecord(&wk->gaps, (unsigned long long) (now - vw->lastFrame));
+    }
+    wk->frames++;
+    pthread_mutex_unlock(&wk->lock);
+    vw->lastFrame = now;
+    vw->frames++;
+}
+
+/*! \fn static void putByte(worker * wk, viewer * vw, unsigned char byte)
+ * \brief Apply one byte to the screen copy: text, cursor position, clear screen and clear to end of row
+ */
+static void putByte(worker * wk, viewer * vw, unsigned char byte) {
+    int rows = PARKROW(boardHeight), columns = SCREENCOLUMNS(boardWidth), c;
+
+    if (vw->state == 0) {
+        if (byte == '\033') {
+            vw->state = 1;
+        } else {
+            if ((vw->row >= 1) && (vw->row <= rows) && (vw->column >= 1) && (vw->column <= columns)) {
+                vw->screen[(vw->row - 1) * columns + vw->column - 1] = (char) byte;
+            }
+            vw->column++;
+        }
+    } else if (vw->state == 1) {
+        vw->state = byte == '[' ? 2 : 0;
+        vw->parameters[0] = vw->parameters[1] = 0;
+        vw->parameterCount = 0;
+    } else if ((byte >= '0') && (byte <= '9')) {
+        vw->parameters[vw->parameterCount] = vw->parameters[vw->parameterCount] * 10 + byte - '0';
+    } else if (byte == ';') {
+        vw->parameterCount = 1;
+    } else {
+        if (byte == 'H') {
+            vw->row = vw->parameters[0] > 0 ? vw->parameters[0] : 1;
+            vw->column = vw->parameters[1] > 0 ? vw->parameters[1] : 1;
+            if (vw->row == rows) {                                      // every frame ends with the parked cursor
+                endFrame(wk, vw);
+            }
+        } else if ((byte == 'J') && (vw->parameters[0] == 2)) {
+            memset(vw->screen, ' ', (size_t) rows * (size_t) columns);
+        } else if ((byte == 'K') && (vw->row >= 1) && (vw->row <= rows)) {
+            for (c = vw->column; c <= columns; c++) {
+                vw->screen[(vw->row - 1) * columns + c - 1] = ' ';
+            }
+        }
+        vw->state = 0;
+    }
+}
+
+/*! \fn static void * runWorker(void * argument)
+ * \brief Read the frames of the viewers of one worker
+ */
+static void * runWorker(void * argument) {
+    worker * wk = argument;
+    struct epoll_event events[256];
+    unsigned char bytes[16384];
+    viewer * vw;
+    ssize_t result, i;
+    int count, e;
+
+    while (!stopping) {
+        count = epoll_wait(wk->epollFd, events, 256, 50);
+        for (e = 0; e < count; e++) {
+            vw = events[e].data.ptr;
+            for (;;) {
+                result = recv(vw->fd, bytes, sizeof(bytes), MSG_DONTWAIT);
+                if (result <= 0) {
+                    break;
+                }
+                pthread_mutex_lock(&wk->lock);
+                wk->bytes += (unsigned long long) result;
+                pthread_mutex_unlock(&wk->lock);
+                for (i = 0; i < result; i++) {
+                    putByte(wk, vw, bytes[i]);
+                }
+            }
+            if ((result == 0) || ((result < 0) && (errno != EAGAIN) && (errno != EINTR))) {
+                (void) epoll_ctl(wk->epollFd, EPOLL_CTL_DEL, vw->fd, NULL);
+                pthread_mutex_lock(&wk->lock);
+                wk->closed++;
+                pthread_mutex_unlock(&wk->lock);
+            }
+        }
+    }
+    return NULL;
+}
+
+/*! \fn static int connectViewer(worker * wk, const struct sockaddr_in * address, int slow)
+ * \brief Open one more connection and give it to a worker
+ */
+static int connectViewer(worker * wk, const struct sockaddr_in * address, int slow) {
+    struct epoll_event event;
+    viewer * vw;
+    int fd, small = 4096;
+
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (slow) {                                                         // fills up after a few frames
+        (void) setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+    }
+    if (connect(fd, (const struct sockaddr *) address, sizeof(*address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    pthread_mutex_lock(&wk->lock);
+    vw = &wk->viewers[wk->count];
+    memset(vw, 0, sizeof(*vw));
+    vw->fd = fd;
+    vw->slow = slow;
+    vw->screen = calloc((size_t) PARKROW(boardHeight) * (size_t) SCREENCOLUMNS(boardWidth), 1);
+    wk->count++;
+    pthread_mutex_unlock(&wk->lock);
+    if (vw->screen == NULL) {
+        return -1;
+    }
+    if (!slow) {                                                        // a slow viewer never reads
+        event.events = EPOLLIN;
+        event.data.ptr = vw;
+        if (epoll_ctl(wk->epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*! \fn static void playTicks(broadcaster * bc, gameState * game, rngState * player, long long periodNs, double seconds)
+ * \brief Play and broadcast the game at the tick rate for a while, a lost game is followed by a new one
+ */
+static void playTicks(broadcaster * bc, gameState * game, rngState * player, long long periodNs, double seconds) {
+    long long next = statsNow(), end = next + (long long) (seconds * 1e9);
+    struct timespec wake;
+
+    while (next < end) {
+        next += periodNs;
+        wake.tv_sec = (time_t) (next / 1000000000LL);
+        wake.tv_nsec = (long) (next % 1000000000LL);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) == EINTR) {
+        }
+        if (!game->running) {
+            gameReset(game, game->ticks + 1);
+            bcastRepaint(bc);                                           // the old snake is not in the changed cells
+        }
+        updateSnakeDirection(&game->player, benchInput(game, player, 1, 16));
+        gameStep(game, '\0');
+        (void) bcastPublish(bc, &game->occupied, game->appleCount ? &game->apple : NULL, &game->dirty, game->score);
+    }
+}
+
+/*! \fn static int sameBoard(const viewer * vw, const gameState * game)
+ * \brief True if the screen copy of a viewer shows the board of the game
+ */
+static int sameBoard(const viewer * vw, const gameState * game) {
+    int columns = SCREENCOLUMNS(boardWidth), x, y;
+    char expected;
+
+    for (y = 0; y < boardHeight; y++) {
+        for (x = 0; x < boardWidth; x++) {                              // characters of render.c
+            expected = bitTest(&game->occupied, x, y) ? 'o' : ((game->appleCount != 0) && (game->apple.x == x) && (game->apple.y == y) ? 'b' : ' ');
+            if (vw->screen[(BOARDTOP + y - 1) * columns + BOARDLEFT + x - 1] != expected) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    static worker workers[MAXTHREADS];
+    static broadcaster bc;
+    struct sockaddr_in address;
+    struct rlimit files;
+    memArena arena;
+    gameState game;
+    rngState player;
+    int port = 7071, viewers = 4096, seconds = 3, rate = 30, threads = 2, slowPercent = 0, keyInterval = 6;
+    int option, connected = 0, slowCount = 0, target, slow, i, t, failed = 0, matching = 0;
+    unsigned long long frames, bytes, firstP99 = 0, lastP99 = 0;
+    unsigned long closed = 0;
+    double perViewer;
+    histogram gaps;
+    long long start, elapsed;
+
+    while ((option = getopt(argc, argv, "p:c:d:r:j:s:k:x:y:")) != -1) {
+        switch (option) {
+            case 'p':
+                port = atoi(optarg);
+                break;
+            case 'c':
+                viewers = atoi(optarg);
+                break;
+            case 'd':
+                seconds = atoi(optarg);
+                break;
+            case 'r':
+                rate = atoi(optarg);
+                break;
+            case 'j':
+                threads = atoi(optarg);
+                break;
+            case 's':
+                slowPercent = atoi(optarg);
+                break;
+            case 'k':
+                keyInterval = atoi(optarg);
+                break;
+            case 'x':
+                boardWidth = atoi(optarg);
+                break;
+            case 'y':
+                boardHeight = atoi(optarg);
+                break;
+            default:
+                viewers = 0;
+                break;
+        }
+    }
+    if ((viewers < 1) || (seconds < 1) || (rate < 1) || (threads < 1) || (threads > MAXTHREADS) || (slowPercent < 0) || (slowPercent > 100)
+        || (keyInterval < 1) || (keyInterval > BCASTMAXKEYINTERVAL) || (boardWidth < MINBOARDSIZE) || (boardWidth > MAXBOARDSIZE)
+        || (boardHeight < MINBOARDSIZE) || (boardHeight > MAXBOARDSIZE)) {
+        fprintf(stderr, "Usage: %s [-p port] [-c viewers] [-d seconds per step] [-r ticks per second] [-j threads] [-s percent slow] [-k keyframe interval] [-x columns] [-y rows]\n", argv[0]);
+        return 1;
+    }
+    if (getrlimit(RLIMIT_NOFILE, &files) == 0) {
+        files.rlim_cur = files.rlim_max;
+        (void) setrlimit(RLIMIT_NOFILE, &files);
+    }
+    if ((arenaInit(&arena, gameMemorySize(boardWidth, boardHeight)) != 0) || (gameInit(&game, boardWidth, boardHeight, 1, &arena) != 0)) {
+        fprintf(stderr, "Not enough memory for %dx%d board\n", boardWidth, boardHeight);
+        return 1;
+    }
+    rngSeed(&player, 12345);
+    if (bcastStart(&bc, port, boardWidth, boardHeight, keyInterval) != 0) {
+        perror("broadcast");
+        return 1;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t) port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (t = 0; t < threads; t++) {
+        workers[t].viewers = calloc((size_t) viewers / (size_t) threads + 1, sizeof(viewer));
+        workers[t].epollFd = epoll_create1(EPOLL_CLOEXEC);
+        pthread_mutex_init(&workers[t].lock, NULL);
+        if ((workers[t].viewers == NULL) || (workers[t].epollFd < 0) || (pthread_create(&workers[t].thread, NULL, runWorker, &workers[t]) != 0)) {
+            fprintf(stderr, "Could not start viewer thread\n");
+            return 1;
+        }
+    }
+
+    printf("Board %dx%d, %d ticks per second, keyframe every %d ticks\n", boardWidth, boardHeight, rate, keyInterval);
+    printf("%8s %14s %14s %14s %14s %12s %12s %12s %10s %8s %8s\n", "viewers", "publish p50 us", "publish p99 us", "fan-out p50 us",
+           "fan-out p99 us", "ns/viewer", "frames/s", "gap p99 ms", "KB/s", "resyncs", "dropped");
+    for (target = 1; connected < viewers; target = target * 4 < viewers ? target * 4 : viewers) {
+        while (connected < target) {                                    // they join in the middle of the game
+            slow = connected % 100 < slowPercent;
+            if (connectViewer(&workers[connected % threads], &address, slow) != 0) {
+                failed = 1;
+                break;
+            }
+            connected++;
+            slowCount += slow;
+        }
+        if (failed) {
+            fprintf(stderr, "Connection %d failed: %s\n", connected + 1, strerror(errno));
+            break;
+        }
+        playTicks(&bc, &game, &player, 1000000000LL / rate, 0.5);       // the new viewers sync up
+        histogramReset(&bc.publishNs);
+        pthread_mutex_lock(&bc.lock);
+        histogramReset(&bc.fanoutNs);
+        bc.resyncs = bc.dropped = 0;
+        pthread_mutex_unlock(&bc.lock);
+        for (t = 0; t < threads; t++) {
+            pthread_mutex_lock(&workers[t].lock);
+            histogramReset(&workers[t].gaps);
+            workers[t].frames = workers[t].bytes = 0;
+            pthread_mutex_unlock(&workers[t].lock);
+        }
+        start = statsNow();
+        playTicks(&bc, &game, &player, 1000000000LL / rate, seconds);
+        elapsed = statsNow() - start;
+
+        histogramReset(&gaps);
+        frames = bytes = 0;
+        closed = 0;
+        for (t = 0; t < threads; t++) {
+            pthread_mutex_lock(&workers[t].lock);
+            for (i = 0; i < HISTBUCKETS; i++) {
+                gaps.buckets[i] += workers[t].gaps.buckets[i];
+            }
+            gaps.count += workers[t].gaps.count;
+            gaps.max = workers[t].gaps.max > gaps.max ? workers[t].gaps.max : gaps.max;
+            frames += workers[t].frames;
+            bytes += workers[t].bytes;
+            closed += workers[t].closed;
+            pthread_mutex_unlock(&workers[t].lock);
+        }
+        lastP99 = histogramPercentile(&bc.publishNs, 99.0);
+        firstP99 = firstP99 == 0 ? lastP99 : firstP99;
+        pthread_mutex_lock(&bc.lock);
+        perViewer = (double) histogramPercentile(&bc.fanoutNs, 50.0) / connected;
+        printf("%8d %14.1f %14.1f %14.1f %14.1f %12.0f %12.2f %12.1f %10.0f %8lu %8lu\n", connected,
+               histogramPercentile(&bc.publishNs, 50.0) / 1e3, lastP99 / 1e3, histogramPercentile(&bc.fanoutNs, 50.0) / 1e3,
+               histogramPercentile(&bc.fanoutNs, 99.0) / 1e3, perViewer,
+               connected > slowCount ? (double) frames / (elapsed / 1e9) / (connected - slowCount) : 0,
+               histogramPercentile(&gaps, 99.0) / 1e6, bytes / (elapsed / 1e9) / 1024, bc.resyncs, bc.dropped);
+        pthread_mutex_unlock(&bc.lock);
+    }
+
+    usleep(1000000);                                                    // the last frames reach the viewers
+    for (t = 0; t < threads; t++) {
+        pthread_mutex_lock(&workers[t].lock);
+        for (i = 0; i < workers[t].count; i++) {
+            matching += !workers[t].viewers[i].slow && sameBoard(&workers[t].viewers[i], &game);
+        }
+        pthread_mutex_unlock(&workers[t].lock);
+    }
+    printf("\npublish p99 %.1f us with 1 viewer, %.1f us with %d viewers\n", firstP99 / 1e3, lastP99 / 1e3, connected);
+    printf("handed off %lu frames, lost %lu, %lu viewers closed by the server\n", bc.ticks, bc.handoffLost, closed);
+    printf("screens match the game: %d of %d reading viewers\n", matching, connected - slowCount);
+
+    stopping = 1;
+    for (t = 0; t < threads; t++) {
+        pthread_join(workers[t].thread, NULL);
+        for (i = 0; i < workers[t].count; i++) {
+            close(workers[t].viewers[i].fd);
+            free(workers[t].viewers[i].screen);
+        }
+        free(workers[t].viewers);
+        close(workers[t].epollFd);
+    }
+    bcastStop(&bc);
+    arenaFree(&arena);
+    return matching == connected - slowCount ? 0 : 1;
+}
+
+// End of broadcast_bench.c
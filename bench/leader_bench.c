@@ -0,0 +1,114 @@
+/*! \file leader_bench.c
+ * \brief Leaderboard store benchmark
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Fills a new store with random scores, then measures reopening it,
+ * top list and rank queries, and adding scores to the large store.
+ * The store files are basename.log and basename.idx, existing ones are removed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "leaderboard.h"
+#include "rng.h"
+#include "benchutil.h"
+
+/*! \def QUERIES
+ *  \brief Number of rank queries measured
+ */
+#define QUERIES 1000000
+
+/*! \def ADDS
+ *  \brief Number of scores added to the full store
+ */
+#define ADDS 10000
+
+/*! \fn static int randomScore(rngState * rng)
+ * \brief Score of a random game, most games end early
+ */
+static int randomScore(rngState * rng) {
+    return (int) (rngBounded(rng, 100) * rngBounded(rng, 100) / 10) * 10;
+}
+
+int main(int argc, char **argv) {
+    const char * baseName = argc > 1 ? argv[1] : "leader_bench";
+    long rows = argc > 2 ? atol(argv[2]) : 200000;
+    char fileName[LEADERPATHSIZE + 8];
+    leaderboard lb;
+    leaderEntry top[10];
+    rngState rng;
+    double start, fillTime, openTime, topTime, rankTime, addTime;
+    size_t checksum = 0, shown;
+    unsigned long compactions;
+    long i;
+
+    if (rows < 1) {
+        fprintf(stderr, "Usage: %s [basename] [rows]\n", argv[0]);
+        return 1;
+    }
+    snprintf(fileName, sizeof(fileName), "%s.log", baseName);
+    unlink(fileName);
+    snprintf(fileName, sizeof(fileName), "%s.idx", baseName);
+    unlink(fileName);
+    rngSeed(&rng, 1);
+
+    if (leaderOpen(&lb, baseName) != 0) {
+        perror(baseName);
+        return 1;
+    }
+    start = benchSeconds();
+    for (i = 0; i < rows; i++) {
+        if (leaderAdd(&lb, "bench", randomScore(&rng), i) != 0) {
+            perror(baseName);
+            return 1;
+        }
+    }
+    fillTime = benchSeconds() - start;
+    compactions = lb.compactions;
+    leaderClose(&lb);
+
+    start = benchSeconds();
+    if (leaderOpen(&lb, baseName) != 0) {
+        perror(baseName);
+        return 1;
+    }
+    openTime = benchSeconds() - start;
+
+    start = benchSeconds();
+    for (i = 0; i < 1000; i++) {
+        shown = leaderTop(&lb, top, 10);
+        checksum += shown + (size_t) top[0].score;
+    }
+    topTime = (benchSeconds() - start) / 1000;
+
+    start = benchSeconds();
+    for (i = 0; i < QUERIES; i++) {
+        checksum += leaderRank(&lb, randomScore(&rng));
+    }
+    rankTime = (benchSeconds() - start) / QUERIES;
+
+    start = benchSeconds();
+    for (i = 0; i < ADDS; i++) {
+        if (leaderAdd(&lb, "bench", randomScore(&rng), i) != 0) {
+            perror(baseName);
+            return 1;
+        }
+    }
+    addTime = (benchSeconds() - start) / ADDS;
+
+    printf("%ld rows, %lu index rewrites while filling\n", rows, compactions);
+    printf("fill            %.2f s, %.2f us per score\n", fillTime, fillTime / rows * 1e6);
+    printf("open            %.2f ms (index mapped, %zu scores in memory)\n", openTime * 1e3, lb.deltaCount);
+    printf("top 10          %.2f us\n", topTime * 1e6);
+    printf("rank            %.1f ns\n", rankTime * 1e9);
+    printf("add to full     %.2f us per score (index rewrites included)\n", addTime * 1e6);
+    printf("checksum %zu\n", checksum);
+    leaderClose(&lb);
+    return 0;
+}
+
+// End of leader_bench.c
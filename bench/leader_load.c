@@ -0,0 +1,250 @@
+/*! \file leader_load.c
+ * \brief Leaderboard service load generator
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Opens thousands of connections to a running snake_leaderd, every connection
+ * behaves like a game at its end: submits a score and waits for the answer,
+ * several times, then asks the rank of a score once.
+ * Reports throughput and the p50 / p99 latency of submissions and queries.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include "leaderclient.h"
+
+/*! \typedef struct connection
+ *  \brief One simulated game
+ */
+typedef struct connection_t {
+    int fd;
+    int sent;
+    size_t received;
+    long long started;
+    leaderResponse response;
+} connection;
+
+/*! \typedef struct worker
+ *  \brief One load thread and its connections
+ */
+typedef struct worker_t {
+    pthread_t thread;
+    int id;
+    const char * socketName;
+    int connections;
+    int submits;
+    connection * games;
+    long long * submitLatency;
+    long long * queryLatency;
+    size_t submitCount;
+    size_t queryCount;
+    int failed;
+} worker;
+
+/*! \fn static long long nowNs(void)
+ * \brief Monotonic time in nanoseconds
+ */
+static long long nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/*! \fn static int sendRequest(worker * wk, connection * game)
+ * \brief Send the next request of a game: submits first, then one query
+ */
+static int sendRequest(worker * wk, connection * game) {
+    leaderRequest request;
+
+    memset(&request, 0, sizeof(request));
+    request.type = game->sent < wk->submits ? LEADERSUBMIT : LEADERQUERY;
+    request.score = (int) ((game - wk->games) * 37 + game->sent * 101 + wk->id * 13) % 5000;
+    request.time = time(NULL);
+    snprintf(request.name, sizeof(request.name), "load%d-%d", wk->id, (int) (game - wk->games));
+    game->started = nowNs();
+    game->received = 0;
+    game->sent++;
+    return send(game->fd, &request, sizeof(request), MSG_NOSIGNAL) == (ssize_t) sizeof(request) ? 0 : -1;
+}
+
+/*! \fn static void * runWorker(void * argument)
+ * \brief Drive the connections of one worker until every game made all its requests
+ */
+static void * runWorker(void * argument) {
+    worker * wk = argument;
+    struct epoll_event event, events[256];
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    int active = 0, count, i;
+    connection * game;
+    ssize_t result;
+
+    for (i = 0; i < wk->connections; i++) {
+        game = &wk->games[i];
+        game->fd = leaderConnect(wk->socketName);
+        if (game->fd < 0) {
+            wk->failed++;
+            continue;
+        }
+        event.events = EPOLLIN;
+        event.data.ptr = game;
+        if ((epoll_ctl(epollFd, EPOLL_CTL_ADD, game->fd, &event) != 0) || (sendRequest(wk, game) != 0)) {
+            wk->failed++;
+            close(game->fd);
+            game->fd = -1;
+            continue;
+        }
+        active++;
+    }
+
+    while (active > 0) {
+        count = epoll_wait(epollFd, events, 256, 10000);
+        if (count <= 0) {
+            if ((count < 0) && (errno == EINTR)) {
+                continue;
+            }
+            wk->failed += active;                                       // no answer in 10 seconds
+            break;
+        }
+        for (i = 0; i < count; i++) {
+            game = events[i].data.ptr;
+            result = recv(game->fd, (unsigned char *) &game->response + game->received, sizeof(game->response) - game->received, MSG_DONTWAIT);
+            if ((result < 0) && ((errno == EAGAIN) || (errno == EINTR))) {
+                continue;
+            }
+            if (result > 0) {
+                game->received += (size_t) result;
+                if (game->received < sizeof(game->response)) {
+                    continue;
+                }
+            }
+            if ((result <= 0) || (game->response.status != 0)) {
+                wk->failed++;
+            } else if (game->sent <= wk->submits) {
+                wk->submitLatency[wk->submitCount++] = nowNs() - game->started;
+            } else {
+                wk->queryLatency[wk->queryCount++] = nowNs() - game->started;
+            }
+            if ((result > 0) && (game->sent <= wk->submits) && (sendRequest(wk, game) == 0)) {
+                continue;
+            }
+            close(game->fd);
+            game->fd = -1;
+            active--;
+        }
+    }
+    close(epollFd);
+    return NULL;
+}
+
+/*! \fn static int compareLatency(const void * a, const void * b)
+ * \brief qsort order of latencies
+ */
+static int compareLatency(const void * a, const void * b) {
+    long long x = *(const long long *) a, y = *(const long long *) b;
+    return (x > y) - (x < y);
+}
+
+/*! \fn static void report(const char * what, long long * latency, size_t count, double elapsed)
+ * \brief Print throughput and percentiles of sorted latencies
+ */
+static void report(const char * what, long long * latency, size_t count, double elapsed) {
+    if (count == 0) {
+        printf("%-8s no answers\n", what);
+        return;
+    }
+    qsort(latency, count, sizeof(long long), compareLatency);
+    printf("%-8s %8zu in %.2f s, %8.0f/s   p50 %8.1f us   p99 %8.1f us   max %8.1f us\n", what, count, elapsed, count / elapsed,
+           latency[count / 2] / 1e3, latency[count * 99 / 100] / 1e3, latency[count - 1] / 1e3);
+}
+
+int main(int argc, char **argv) {
+    const char * socketName = LEADERSOCKET;
+    int clients = 2000, submits = 5, threads = 4, option, t, perThread;
+    worker * workers;
+    long long * submitLatency, * queryLatency, start;
+    size_t submitCount = 0, queryCount = 0, offset;
+    struct rlimit files;
+    double elapsed;
+    int failed = 0;
+
+    while ((option = getopt(argc, argv, "s:c:n:j:")) != -1) {
+        switch (option) {
+            case 's':
+                socketName = optarg;
+                break;
+            case 'c':
+                clients = atoi(optarg);
+                break;
+            case 'n':
+                submits = atoi(optarg);
+                break;
+            case 'j':
+                threads = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-s socket] [-c clients] [-n submits per client] [-j threads]\n", argv[0]);
+                return 1;
+        }
+    }
+    if ((clients < 1) || (submits < 1) || (threads < 1) || (threads > clients)) {
+        fprintf(stderr, "Invalid load settings\n");
+        return 1;
+    }
+    if (getrlimit(RLIMIT_NOFILE, &files) == 0) {
+        files.rlim_cur = files.rlim_max;
+        (void) setrlimit(RLIMIT_NOFILE, &files);
+    }
+
+    workers = calloc((size_t) threads, sizeof(worker));
+    submitLatency = malloc((size_t) clients * (size_t) submits * sizeof(long long));
+    queryLatency = malloc((size_t) clients * sizeof(long long));
+    if ((workers == NULL) || (submitLatency == NULL) || (queryLatency == NULL)) {
+        return 1;
+    }
+    perThread = (clients + threads - 1) / threads;
+    start = nowNs();
+    for (t = 0; t < threads; t++) {
+        workers[t].id = t;
+        workers[t].socketName = socketName;
+        workers[t].connections = (t + 1) * perThread <= clients ? perThread : clients - t * perThread;
+        workers[t].submits = submits;
+        workers[t].games = calloc((size_t) perThread, sizeof(connection));
+        offset = (size_t) t * (size_t) perThread;
+        workers[t].submitLatency = submitLatency + offset * (size_t) submits;
+        workers[t].queryLatency = queryLatency + offset;
+        if ((workers[t].connections < 0) || (workers[t].games == NULL)) {
+            workers[t].connections = 0;
+        }
+        pthread_create(&workers[t].thread, NULL, runWorker, &workers[t]);
+    }
+    for (t = 0; t < threads; t++) {                                     // results are packed to the front
+        pthread_join(workers[t].thread, NULL);
+        memmove(submitLatency + submitCount, workers[t].submitLatency, workers[t].submitCount * sizeof(long long));
+        memmove(queryLatency + queryCount, workers[t].queryLatency, workers[t].queryCount * sizeof(long long));
+        submitCount += workers[t].submitCount;
+        queryCount += workers[t].queryCount;
+        failed += workers[t].failed;
+        free(workers[t].games);
+    }
+    elapsed = (nowNs() - start) / 1e9;
+
+    printf("%d clients x %d submits + 1 query on %s, %d threads\n", clients, submits, socketName, threads);
+    report("submit", submitLatency, submitCount, elapsed);
+    report("query", queryLatency, queryCount, elapsed);
+    printf("failed   %d\n", failed);
+    free(workers);
+    free(submitLatency);
+    free(queryLatency);
+    return failed == 0 ? 0 : 1;
+}
+
+// End of leader_load.c
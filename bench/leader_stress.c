@@ -0,0 +1,219 @@
+/*! \file leader_stress.c
+ * \brief Leaderboard concurrency and crash stress test
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Starts many writer processes at the same moment, each adding scores to one store,
+ * while a reader process keeps showing the top list. Then checks that every score
+ * is in the store exactly once, and that a torn record left by a crashed writer
+ * neither hides nor loses scores. Reports the commit throughput.
+ */
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "leaderboard.h"
+#include "benchutil.h"
+
+/*! \fn static void waitStart(int startFd)
+ * \brief Block until the parent closes the start pipe
+ */
+static void waitStart(int startFd) {
+    char c;
+    while (read(startFd, &c, 1) > 0) {
+    }
+}
+
+/*! \fn static void writer(const char * baseName, int startFd, int id, int scores)
+ * \brief Writer process: adds scores named w<id>-<n>
+ */
+static void writer(const char * baseName, int startFd, int id, int scores) {
+    leaderboard lb;
+    char name[LEADERNAMESIZE];
+    int n;
+
+    waitStart(startFd);
+    if (leaderOpen(&lb, baseName) != 0) {
+        _exit(2);
+    }
+    for (n = 0; n < scores; n++) {
+        snprintf(name, sizeof(name), "w%d-%d", id, n);
+        if (leaderAdd(&lb, name, (id * 7919 + n * 104729) % 5000, time(NULL)) != 0) {
+            _exit(3);
+        }
+    }
+    leaderClose(&lb);
+    _exit(0);
+}
+
+/*! \fn static void reader(const char * baseName, int startFd, size_t total, int reportFd)
+ * \brief Reader process: refreshes and reads the top list until every score is visible
+ */
+static void reader(const char * baseName, int startFd, size_t total, int reportFd) {
+    leaderboard lb;
+    leaderEntry top[10];
+    double start, took, worst = 0, sum = 0, deadline;
+    unsigned long reads = 0;
+    char report[128];
+
+    waitStart(startFd);
+    if (leaderOpen(&lb, baseName) != 0) {
+        _exit(2);
+    }
+    deadline = benchSeconds() + 120;
+    while ((leaderCount(&lb) < total) && (benchSeconds() < deadline)) {
+        start = benchSeconds();
+        (void) leaderRefresh(&lb);
+        (void) leaderTop(&lb, top, 10);
+        took = benchSeconds() - start;
+        sum += took;
+        worst = took > worst ? took : worst;
+        reads++;
+    }
+    snprintf(report, sizeof(report), "%lu %.3f %.3f %zu\n", reads, reads > 0 ? sum / reads * 1e6 : 0.0, worst * 1e6, leaderCount(&lb));
+    (void) write(reportFd, report, strlen(report));
+    leaderClose(&lb);
+    _exit(0);
+}
+
+/*! \fn static long verify(const char * baseName, int writers, int scores, size_t expected)
+ * \brief Check that every score w<id>-<n> is stored exactly once, returns the number of errors
+ */
+static long verify(const char * baseName, int writers, int scores, size_t expected) {
+    leaderboard lb;
+    leaderEntry * all = malloc((expected + 16) * sizeof(leaderEntry));
+    unsigned char * seen = calloc((size_t) writers * (size_t) scores, 1);
+    size_t count, i;
+    long errors = 0;
+    int id, n;
+
+    if ((all == NULL) || (seen == NULL) || (leaderOpen(&lb, baseName) != 0)) {
+        return -1;
+    }
+    count = leaderTop(&lb, all, expected + 16);
+    if ((count != expected) || (leaderCount(&lb) != expected)) {
+        printf("expected %zu scores, found %zu\n", expected, count);
+        errors++;
+    }
+    for (i = 0; i < count; i++) {
+        if (sscanf(all[i].name, "w%d-%d", &id, &n) != 2) {
+            continue;                                                   // added by the crash test
+        }
+        if ((id < 0) || (id >= writers) || (n < 0) || (n >= scores) || seen[id * scores + n]++) {
+            printf("unexpected or duplicate score %s\n", all[i].name);
+            errors++;
+        }
+        if ((i > 0) && (all[i].score > all[i-1].score)) {
+            errors++;
+        }
+    }
+    for (i = 0; i < (size_t) writers * (size_t) scores; i++) {
+        if (!seen[i]) {
+            printf("lost score w%zu-%zu\n", i / (size_t) scores, i % (size_t) scores);
+            errors++;
+        }
+    }
+    leaderClose(&lb);
+    free(all);
+    free(seen);
+    return errors;
+}
+
+int main(int argc, char **argv) {
+    const char * baseName = argc > 1 ? argv[1] : "leader_stress";
+    int writers = argc > 2 ? atoi(argv[2]) : 128;
+    int scores = argc > 3 ? atoi(argv[3]) : 64;
+    size_t total = (size_t) writers * (size_t) scores;
+    char fileName[LEADERPATHSIZE + 8], report[128];
+    unsigned char garbage[sizeof(leaderEntry)];
+    int startPipe[2], reportPipe[2], status, logFd, id;
+    unsigned long reads = 0;
+    double start, elapsed, readAvg = 0, readMax = 0;
+    size_t readerSaw = 0;
+    long errors;
+    ssize_t length;
+    leaderboard lb;
+    pid_t pid;
+
+    if ((writers < 1) || (scores < 1)) {
+        fprintf(stderr, "Usage: %s [basename] [writers] [scores per writer]\n", argv[0]);
+        return 1;
+    }
+    snprintf(fileName, sizeof(fileName), "%s.log", baseName);
+    unlink(fileName);
+    snprintf(fileName, sizeof(fileName), "%s.idx", baseName);
+    unlink(fileName);
+    if ((pipe(startPipe) != 0) || (pipe(reportPipe) != 0)) {
+        perror("pipe");
+        return 1;
+    }
+
+    for (id = 0; id <= writers; id++) {                                 // writers and one reader
+        pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pid == 0) {
+            close(startPipe[1]);
+            if (id == writers) {
+                reader(baseName, startPipe[0], total, reportPipe[1]);
+            }
+            writer(baseName, startPipe[0], id, scores);
+        }
+    }
+    close(startPipe[0]);
+    close(reportPipe[1]);
+    start = benchSeconds();
+    close(startPipe[1]);                                                // all start at once
+    errors = 0;
+    while (wait(&status) > 0) {
+        if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0)) {
+            errors++;
+        }
+    }
+    elapsed = benchSeconds() - start;
+    length = read(reportPipe[0], report, sizeof(report) - 1);
+    if (length > 0) {
+        report[length] = '\0';
+        sscanf(report, "%lu %lf %lf %zu", &reads, &readAvg, &readMax, &readerSaw);
+    }
+
+    printf("%d writers x %d scores, %zu commits in %.2f s: %.0f commits/s\n", writers, scores, total, elapsed, total / elapsed);
+    printf("reader: %lu top list reads while writing, %.1f us average, %.1f us worst, saw %zu scores\n", reads, readAvg, readMax, readerSaw);
+    if (errors > 0) {
+        printf("%ld processes failed\n", errors);
+    }
+    errors += verify(baseName, writers, scores, total);
+
+    snprintf(fileName, sizeof(fileName), "%s.log", baseName);          // a writer crashed in the middle of a record
+    logFd = open(fileName, O_WRONLY | O_APPEND);
+    memset(garbage, 0x5A, sizeof(garbage));
+    if ((logFd < 0) || (write(logFd, garbage, sizeof(garbage)) != (ssize_t) sizeof(garbage))
+        || (write(logFd, garbage, 20) != 20)) {
+        perror(fileName);
+        return 1;
+    }
+    close(logFd);
+    if ((leaderOpen(&lb, baseName) != 0) || (leaderCount(&lb) != total)) { // reader skips the torn records
+        printf("torn records changed the store\n");
+        errors++;
+    }
+    if ((leaderAdd(&lb, "after crash", 1, 0) != 0) || (leaderCount(&lb) != total + 1)) {
+        printf("add after crash failed\n");
+        errors++;
+    }
+    leaderClose(&lb);
+    errors += verify(baseName, writers, scores, total + 1);
+
+    printf("verify: %ld errors\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+// End of leader_stress.c
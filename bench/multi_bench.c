@@ -0,0 +1,191 @@
+/*! \file multi_bench.c
+ * \brief Multi-snake arena benchmark
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Runs arenas of growing snake counts with bots, on one thread and on all
+ * cores (or the given number of threads), and reports the tick time and its phases. The arenas played with
+ * different thread counts must end in the same state. From the slowest 99th
+ * percentile tick it estimates how many snakes fit in a 6 Hz tick.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "multisnake.h"
+
+/*! \def TICKNS
+ *  \brief Length of a 6 Hz tick in nanoseconds
+ */
+#define TICKNS (1000000000LL / 6)
+
+/*! \def MAXLENGTH
+ *  \brief Longest snake of the arenas
+ */
+#define MAXLENGTH 256
+
+/*! \typedef struct botState
+ *  \brief Random number generator of one bot, padded to a cache line
+ */
+typedef struct botState_t {
+    rngState rng;
+} __attribute__((aligned(ARENAALIGN))) botState;
+
+/*! \fn static void stepCell(coord * cell, unsigned char direction)
+ * \brief Move a cell one step in a direction
+ */
+static void stepCell(coord * cell, unsigned char direction) {
+    cell->x += (direction == 'r') - (direction == 'l');
+    cell->y += (direction == 'd') - (direction == 'u');
+}
+
+/*! \fn static unsigned char botPolicy(void * context, const multiGame * game, int index)
+ * \brief Go for an apple next to the head, otherwise straight on with a random turn now and then, around bodies and walls
+ */
+static unsigned char botPolicy(void * context, const multiGame * game, int index) {
+    static const char * turns[] = { "lr", "lr", "ud", "ud" };          // for u, d, l, r
+    botState * bot = &((botState *) context)[index];
+    const snake * sn = &game->snakes[index].body;
+    unsigned char direction = sn->runningDirection, choice[3];
+    const char * side = turns[(direction == 'd') + 2 * (direction == 'l') + 3 * (direction == 'r')];
+    coord cell;
+    int i, first;
+
+    first = (int) rngBounded(&bot->rng, 2);                             // which side to try first
+    choice[0] = direction;
+    choice[1] = (unsigned char) side[first];
+    choice[2] = (unsigned char) side[1 - first];
+    if (rngBounded(&bot->rng, 8) == 0) {
+        choice[0] = choice[1];
+        choice[1] = direction;
+    }
+    for (i = 0; i < 3; i++) {
+        cell = sn->position[sn->head];
+        stepCell(&cell, choice[i]);
+        if (bitTest(&game->fruit, cell.x, cell.y) && !bitTest(&game->occupied, cell.x, cell.y)) {
+            return choice[i];
+        }
+    }
+    for (i = 0; i < 3; i++) {
+        cell = sn->position[sn->head];
+        stepCell(&cell, choice[i]);
+        if (!bitTest(&game->occupied, cell.x, cell.y)) {
+            return choice[i];
+        }
+    }
+    return 0;
+}
+
+/*! \fn static int runArena(multiConfig * config, long ticks, tickStats * stats, double * length, unsigned long * deaths, unsigned long * headOns, uint64_t * checksum)
+ * \brief Play one arena with bots, return -1 if it could not be set up
+ *
+ * length is the average length of the live snakes at the end
+ */
+static int runArena(multiConfig * config, long ticks, tickStats * stats, double * length, unsigned long * deaths, unsigned long * headOns, uint64_t * checksum) {
+    multiGame game;
+    botState * bots;
+    long t;
+    int i;
+
+    if (posix_memalign((void **) &bots, ARENAALIGN, (size_t) config->snakes * sizeof(botState)) != 0) {
+        return -1;
+    }
+    for (i = 0; i < config->snakes; i++) {
+        rngSeed(&bots[i].rng, config->seed * 1000003u + (uint64_t) i);
+    }
+    config->policy = botPolicy;
+    config->policyContext = bots;
+    if (multiInit(&game, config) != 0) {
+        free(bots);
+        return -1;
+    }
+    statsInit(stats, 1);
+    game.stats = stats;
+    for (t = 0; t < ticks; t++) {
+        statsBegin(stats);
+        multiStep(&game);
+        statsEnd(stats);
+    }
+    *length = 0;
+    *deaths = 0;
+    for (i = 0; i < config->snakes; i++) {
+        *length += (double) game.snakes[i].body.snakeCurrentLength * game.snakes[i].alive;
+        *deaths += (unsigned long) game.snakes[i].deaths;
+    }
+    *length /= game.alive > 0 ? game.alive : 1;
+    *headOns = game.headOns;
+    *checksum = multiChecksum(&game);
+    multiFree(&game);
+    free(bots);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int width = argc > 1 ? atoi(argv[1]) : 512;
+    int height = argc > 2 ? atoi(argv[2]) : 512;
+    long ticks = argc > 3 ? atol(argv[3]) : 500;
+    int cores = argc > 4 ? atoi(argv[4]) : (int) sysconf(_SC_NPROCESSORS_ONLN);
+    static const int counts[] = { 16, 64, 256, 1024, 4096, 16384, 65536 };
+    int threadCounts[2], c, k, mismatches = 0;
+    static tickStats stats;
+    multiConfig config;
+    double length;
+    unsigned long deaths, headOns;
+    uint64_t checksum, reference = 0;
+    unsigned long long p99, worst = 0;
+    int worstSnakes = 0;
+
+    if ((ticks < 1) || (cores < 1) || (width < MINBOARDSIZE) || (width > MAXBOARDSIZE) || (height < MINBOARDSIZE) || (height > MAXBOARDSIZE)) {
+        fprintf(stderr, "Usage: %s [columns] [rows] [ticks] [threads]\n", argv[0]);
+        return 1;
+    }
+    threadCounts[0] = 1;
+    threadCounts[1] = cores < MULTIMAXTHREADS ? cores : MULTIMAXTHREADS;
+
+    printf("Board %dx%d, %ld ticks, bots, respawn, snakes up to %d long, apples = snakes / 4\n", width, height, ticks, MAXLENGTH);
+    printf("%7s %7s %9s %12s %12s %12s %12s %12s %12s %16s\n", "snakes", "threads", "length", "tick p50 us", "tick p99 us",
+           "move p50 us", "merge p50 us", "deaths", "head-on", "checksum");
+    for (c = 0; c < (int) (sizeof(counts) / sizeof(counts[0])); c++) {
+        if ((size_t) counts[c] * 8 > (size_t) width * (size_t) height) {
+            break;                                                      // keep the board at most 1/8 heads
+        }
+        for (k = 0; k < (threadCounts[1] > 1 ? 2 : 1); k++) {
+            config.width = width;
+            config.height = height;
+            config.snakes = counts[c];
+            config.apples = counts[c] / 4 + 1;
+            config.maxLength = MAXLENGTH;
+            config.threads = threadCounts[k];
+            config.respawn = 1;
+            config.seed = 42;
+            if (runArena(&config, ticks, &stats, &length, &deaths, &headOns, &checksum) != 0) {
+                fprintf(stderr, "Could not set up %d snakes on %d threads\n", counts[c], threadCounts[k]);
+                return 1;
+            }
+            if (k == 0) {
+                reference = checksum;
+            } else if (checksum != reference) {
+                mismatches++;
+            }
+            p99 = histogramPercentile(&stats.phase[STATTICK], 99.0);
+            if (p99 > worst) {
+                worst = p99;
+                worstSnakes = counts[c];
+            }
+            printf("%7d %7d %9.1f %12.1f %12.1f %12.1f %12.1f %12lu %12lu %016llx%s\n", counts[c], threadCounts[k], length,
+                   histogramPercentile(&stats.phase[STATTICK], 50.0) / 1e3, p99 / 1e3,
+                   histogramPercentile(&stats.phase[STATSNAKE], 50.0) / 1e3,
+                   histogramPercentile(&stats.phase[STATCOLLISION], 50.0) / 1e3, deaths, headOns,
+                   (unsigned long long) checksum, (k > 0) && (checksum != reference) ? " differs" : "");
+        }
+    }
+    if (worst > 0) {
+        printf("\n%d snakes take %.1f us per tick at p99, a 6 Hz tick of %.1f ms fits about %.0f snakes at that rate\n",
+               worstSnakes, worst / 1e3, TICKNS / 1e6, (double) worstSnakes * (double) TICKNS / (double) worst);
+    }
+    printf("threads agree: %s\n", mismatches == 0 ? "yes" : "no");
+    return mismatches == 0 ? 0 : 1;
+}
+
+// End of multi_bench.c
@@ -0,0 +1,89 @@
+/*! \file replay_bench.c
+ * \brief Replay recording and playback benchmark
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Plays games with a wall avoiding random player, records each one to a replay file,
+ * then plays the file back and checks that the result is the same.
+ * Reports the size of the replays and the time of one playback.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "engine.h"
+#include "replay.h"
+#include "benchutil.h"
+
+int main(int argc, char **argv) {
+    const char * fileName = argc > 1 ? argv[1] : "replay_bench.rpl";
+    long games = argc > 2 ? atol(argv[2]) : 1000;
+    int width = argc > 3 ? atoi(argv[3]) : BOARDSIZEX;
+    int height = argc > 4 ? atoi(argv[4]) : BOARDSIZEY;
+    memArena arena;
+    gameState game, check;
+    replayWriter recorder;
+    replayData replay;
+    replayResult result;
+    rngState player;
+    unsigned char direction;
+    unsigned long long bytes = 0, eventBytes = 0, events = 0, ticks = 0;
+    double playTime = 0, start;
+    long g, mismatches = 0;
+
+    if ((games < 1) || (width < MINBOARDSIZE) || (width > MAXBOARDSIZE) || (height < MINBOARDSIZE) || (height > MAXBOARDSIZE)) {
+        fprintf(stderr, "Usage: %s [replayfile] [games] [columns] [rows]\n", argv[0]);
+        return 1;
+    }
+    if ((arenaInit(&arena, 2 * gameMemorySize(width, height) + replayMemorySize()) != 0)
+        || (gameInit(&game, width, height, 1, &arena) != 0)
+        || (gameInit(&check, width, height, 1, &arena) != 0)) {
+        fprintf(stderr, "Not enough memory for %dx%d board\n", width, height);
+        return 1;
+    }
+    rngSeed(&player, 12345);
+
+    for (g = 0; g < games; g++) {
+        if (replayOpen(&recorder, fileName, 0, width, height, (uint64_t) g, &arena) != 0) {
+            perror(fileName);
+            return 1;
+        }
+        arena.used -= replayMemorySize();                               // the next game reuses the buffer
+        gameReset(&game, (uint64_t) g);
+        do {
+            direction = game.player.runningDirection;
+            updateSnakeDirection(&game.player, benchInput(&game, &player, 0, 8));
+            if (game.player.runningDirection != direction) {
+                replayRecord(&recorder, game.ticks, game.player.runningDirection);
+            }
+        } while (gameStep(&game, '\0'));
+        eventBytes += recorder.bytes - REPLAYHEADERSIZE;
+        if (replayClose(&recorder, game.ticks, game.score, game.player.snakeCurrentLength) != 0) {
+            perror(fileName);
+            return 1;
+        }
+
+        if (replayLoad(&replay, fileName) != 0) {
+            perror(fileName);
+            return 1;
+        }
+        start = benchSeconds();
+        if (replayPlay(&replay, &check, &result) != 0) {
+            mismatches++;
+        }
+        playTime += benchSeconds() - start;
+        bytes += replay.size;
+        events += result.events;
+        ticks += result.ticks;
+        replayUnload(&replay);
+    }
+
+    printf("Board %dx%d, %ld games, %.1f ticks and %.1f direction changes per game\n", width, height, games, (double) ticks / games, (double) events / games);
+    printf("replay size     %.1f bytes per game, %.2f bytes per direction change\n", (double) bytes / games, events > 0 ? (double) eventBytes / events : 0.0);
+    printf("playback        %.2f us per game, %.1f ns per tick\n", playTime / games * 1e6, playTime / ticks * 1e9);
+    printf("verify          %ld of %ld games differ\n", mismatches, games);
+    arenaFree(&arena);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// End of replay_bench.c
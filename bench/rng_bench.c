@@ -0,0 +1,63 @@
+/*! \file rng_bench.c
+ * \brief Random number generator benchmark
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Compares the per game generator with libc rand() and rand_r(),
+ * drawing apple positions (bounded numbers) as placeApple does
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "rng.h"
+#include "benchutil.h"
+
+/*! \def DRAWS
+ *  \brief Default number of random numbers drawn by each generator
+ */
+#define DRAWS 100000000L
+
+int main(int argc, char **argv) {
+    long draws = argc > 1 ? atol(argv[1]) : DRAWS;
+    uint32_t bound = argc > 2 ? (uint32_t) strtoul(argv[2], NULL, 10) : 280;
+    unsigned int seed = 1;
+    uint64_t sum = 0;
+    rngState rng;
+    double start, randTime, randRTime, rngTime;
+    long i;
+
+    if ((draws < 1) || (bound < 1)) {
+        fprintf(stderr, "Usage: %s [draws] [bound]\n", argv[0]);
+        return 1;
+    }
+
+    srand(1);
+    start = benchSeconds();
+    for (i = 0; i < draws; i++) {                                       // global state, modulo bias
+        sum += (uint32_t) (rand() % (int) bound);
+    }
+    randTime = benchSeconds() - start;
+
+    start = benchSeconds();
+    for (i = 0; i < draws; i++) {                                       // caller owned state, modulo bias
+        sum += (uint32_t) (rand_r(&seed) % (int) bound);
+    }
+    randRTime = benchSeconds() - start;
+
+    rngSeed(&rng, 1);
+    start = benchSeconds();
+    for (i = 0; i < draws; i++) {                                       // per game state, no bias
+        sum += rngBounded(&rng, bound);
+    }
+    rngTime = benchSeconds() - start;
+
+    printf("%ld draws below %u\n", draws, bound);
+    printf("rand() %%        %6.2f ns/draw\n", randTime / draws * 1e9);
+    printf("rand_r() %%      %6.2f ns/draw\n", randRTime / draws * 1e9);
+    printf("rngBounded()    %6.2f ns/draw (%.1fx faster than rand)\n", rngTime / draws * 1e9, randTime / rngTime);
+    printf("checksum %llu\n", (unsigned long long) sum);
+    return 0;
+}
+
+// End of rng_bench.c
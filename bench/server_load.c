@@ -0,0 +1,315 @@
+/*! \file server_load.c
+ * \brief Game server load generator
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Opens more and more loopback connections to a running snake_server and
+ * plays them like players: an arrow key and a space (new game after a game
+ * over) about once a second, reading every frame. For every step it reports
+ * the frames per second each session received and the gaps between frames.
+ * A step is sustained when the sessions get 6 frames a second without gaps
+ * over one and a half ticks. Some sessions may be set to never read, they
+ * must not slow the others down.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include "stats.h"
+
+/*! \def TICKNS
+ *  \brief Length of a server tick in nanoseconds
+ */
+#define TICKNS (1000000000LL / 6)
+
+/*! \def MAXTHREADS
+ *  \brief Largest number of load threads
+ */
+#define MAXTHREADS 64
+
+/*! \typedef struct connection
+ *  \brief One simulated player
+ */
+typedef struct connection_t {
+    int fd;
+    int slow;
+    int match;
+    long long lastFrame;
+    long long nextKey;
+    unsigned long frames;
+} connection;
+
+/*! \typedef struct worker
+ *  \brief One load thread, its connections and its measurements
+ */
+typedef struct worker_t {
+    pthread_t thread;
+    int epollFd;
+    connection * players;
+    int count;
+    pthread_mutex_t lock;
+    histogram gaps;
+    unsigned long long frames;
+    unsigned long long bytes;
+    unsigned long closed;
+} __attribute__((aligned(64))) worker;
+
+/*! \var static volatile int stopping
+ *  \brief Set when the load threads should end
+ */
+static volatile int stopping = 0;
+
+/*! \var static char parkSequence[32]
+ *  \brief Cursor movement ending every frame of the server
+ */
+static char parkSequence[32];
+
+/*! \fn static void countFrames(worker * wk, connection * player, const unsigned char * bytes, ssize_t length)
+ * \brief Find the frame ends in received bytes, a sequence may be split between reads
+ */
+static void countFrames(worker * wk, connection * player, const unsigned char * bytes, ssize_t length) {
+    long long now = statsNow();
+    ssize_t i;
+
+    for (i = 0; i < length; i++) {
+        if (bytes[i] == (unsigned char) parkSequence[player->match]) {
+            player->match++;
+        } else {
+            player->match = bytes[i] == '\033' ? 1 : 0;                 // ESC appears only at the start
+        }
+        if (parkSequence[player->match] == '\0') {
+            player->match = 0;
+            pthread_mutex_lock(&wk->lock);
+            if (player->lastFrame != 0) {
+                histogramRecord(&wk->gaps, (unsigned long long) (now - player->lastFrame));
+            }
+            wk->frames++;
+            pthread_mutex_unlock(&wk->lock);
+            player->lastFrame = now;
+            player->frames++;
+        }
+    }
+}
+
+/*! \fn static void * runWorker(void * argument)
+ * \brief Read the frames of the connections of one worker and press keys
+ */
+static void * runWorker(void * argument) {
+    static const char * keys[] = { "\033[A ", "\033[B ", "\033[C ", "\033[D " };
+    worker * wk = argument;
+    struct epoll_event events[256];
+    unsigned char bytes[16384];
+    connection * player;
+    long long now;
+    ssize_t result;
+    int count, i;
+
+    while (!stopping) {
+        count = epoll_wait(wk->epollFd, events, 256, 50);
+        for (i = 0; i < count; i++) {
+            player = events[i].data.ptr;
+            for (;;) {
+                result = recv(player->fd, bytes, sizeof(bytes), MSG_DONTWAIT);
+                if (result <= 0) {
+                    break;
+                }
+                pthread_mutex_lock(&wk->lock);
+                wk->bytes += (unsigned long long) result;
+                pthread_mutex_unlock(&wk->lock);
+                countFrames(wk, player, bytes, result);
+            }
+            if ((result == 0) || ((result < 0) && (errno != EAGAIN) && (errno != EINTR))) {
+                (void) epoll_ctl(wk->epollFd, EPOLL_CTL_DEL, player->fd, NULL);
+                wk->closed++;
+            }
+        }
+        now = statsNow();
+        pthread_mutex_lock(&wk->lock);                                  // the main thread adds players
+        for (i = 0; i < wk->count; i++) {
+            player = &wk->players[i];
+            if (!player->slow && (now >= player->nextKey)) {
+                (void) send(player->fd, keys[(now / 1000) & 3], 4, MSG_NOSIGNAL | MSG_DONTWAIT);
+                player->nextKey = now + 800000000LL + (now / 1000) % 400000000LL;
+            }
+        }
+        pthread_mutex_unlock(&wk->lock);
+    }
+    return NULL;
+}
+
+/*! \fn static int connectPlayer(worker * wk, const struct sockaddr_in * address, int slow)
+ * \brief Open one more connection and give it to a worker
+ */
+static int connectPlayer(worker * wk, const struct sockaddr_in * address, int slow) {
+    struct epoll_event event;
+    connection * player;
+    int fd, small = 4096;
+
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (slow) {                                                         // fills up after a few frames
+        (void) setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+    }
+    if (connect(fd, (const struct sockaddr *) address, sizeof(*address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    pthread_mutex_lock(&wk->lock);
+    player = &wk->players[wk->count];
+    memset(player, 0, sizeof(*player));
+    player->fd = fd;
+    player->slow = slow;
+    player->nextKey = statsNow() + (long long) (rand() % 1000) * 1000000LL;
+    wk->count++;
+    pthread_mutex_unlock(&wk->lock);
+    if (!slow) {                                                        // a slow player never reads
+        event.events = EPOLLIN;
+        event.data.ptr = player;
+        if (epoll_ctl(wk->epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    static worker workers[MAXTHREADS];
+    struct sockaddr_in address;
+    struct rlimit files;
+    int port = 7070, sessions = 4000, seconds = 3, threads = 2, slowPercent = 0, reactors = 1, rows = 14;
+    int option, connected = 0, slowCount = 0, target, slow, ok, i, t, sustained = 0, failed = 0;
+    unsigned long long frames, bytes;
+    unsigned long closed;
+    double rate;
+    histogram gaps;
+    long long start, elapsed;
+
+    while ((option = getopt(argc, argv, "p:c:d:j:s:r:y:")) != -1) {
+        switch (option) {
+            case 'p':
+                port = atoi(optarg);
+                break;
+            case 'c':
+                sessions = atoi(optarg);
+                break;
+            case 'd':
+                seconds = atoi(optarg);
+                break;
+            case 'j':
+                threads = atoi(optarg);
+                break;
+            case 's':
+                slowPercent = atoi(optarg);
+                break;
+            case 'r':
+                reactors = atoi(optarg);
+                break;
+            case 'y':
+                rows = atoi(optarg);
+                break;
+            default:
+                sessions = 0;
+                break;
+        }
+    }
+    if ((sessions < 1) || (seconds < 1) || (threads < 1) || (threads > MAXTHREADS) || (slowPercent < 0) || (slowPercent > 100)
+        || (reactors < 1) || (rows < 1)) {
+        fprintf(stderr, "Usage: %s [-p port] [-c sessions] [-d seconds per step] [-j threads] [-s percent slow] [-r server reactors] [-y rows]\n", argv[0]);
+        return 1;
+    }
+    snprintf(parkSequence, sizeof(parkSequence), "\033[%d;1H", 4 + rows + 4);   // PARKROW of render.c
+    if (getrlimit(RLIMIT_NOFILE, &files) == 0) {
+        files.rlim_cur = files.rlim_max;
+        (void) setrlimit(RLIMIT_NOFILE, &files);
+    }
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t) port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (t = 0; t < threads; t++) {
+        workers[t].players = calloc((size_t) sessions / (size_t) threads + 1, sizeof(connection));
+        workers[t].epollFd = epoll_create1(EPOLL_CLOEXEC);
+        pthread_mutex_init(&workers[t].lock, NULL);
+        if ((workers[t].players == NULL) || (workers[t].epollFd < 0) || (pthread_create(&workers[t].thread, NULL, runWorker, &workers[t]) != 0)) {
+            fprintf(stderr, "Could not start load thread\n");
+            return 1;
+        }
+    }
+
+    printf("%8s %12s %12s %12s %12s %12s %10s %8s\n", "sessions", "frames/s", "gap p50 ms", "gap p99 ms", "gap max ms", "KB/s", "closed", "6 Hz");
+    for (target = sessions < 50 ? sessions : 50; connected < sessions; target = target * 2 < sessions ? target * 2 : sessions) {
+        while (connected < target) {                                    // every n-th player is slow
+            slow = connected % 100 < slowPercent;
+            if (connectPlayer(&workers[connected % threads], &address, slow) != 0) {
+                failed = 1;
+                break;
+            }
+            connected++;
+            slowCount += slow;
+        }
+        if (failed) {
+            fprintf(stderr, "Connection %d failed: %s\n", connected + 1, strerror(errno));
+            break;
+        }
+        usleep(500000);                                                 // let the new sessions start
+        for (t = 0; t < threads; t++) {
+            pthread_mutex_lock(&workers[t].lock);
+            histogramReset(&workers[t].gaps);
+            workers[t].frames = workers[t].bytes = 0;
+            pthread_mutex_unlock(&workers[t].lock);
+        }
+        start = statsNow();
+        sleep((unsigned) seconds);
+        elapsed = statsNow() - start;
+
+        histogramReset(&gaps);
+        frames = bytes = 0;
+        closed = 0;
+        for (t = 0; t < threads; t++) {
+            pthread_mutex_lock(&workers[t].lock);
+            for (i = 0; i < HISTBUCKETS; i++) {
+                gaps.buckets[i] += workers[t].gaps.buckets[i];
+            }
+            gaps.count += workers[t].gaps.count;
+            gaps.max = workers[t].gaps.max > gaps.max ? workers[t].gaps.max : gaps.max;
+            frames += workers[t].frames;
+            bytes += workers[t].bytes;
+            closed += workers[t].closed;
+            pthread_mutex_unlock(&workers[t].lock);
+        }
+        rate = connected > slowCount ? (double) frames / (elapsed / 1e9) / (connected - slowCount) : 0;
+        ok = (rate >= 5.7) && (histogramPercentile(&gaps, 99.0) <= (unsigned long long) (TICKNS * 3 / 2));
+        sustained = ok ? connected : sustained;
+        printf("%8d %12.2f %12.1f %12.1f %12.1f %12.0f %10lu %8s\n", connected, rate, histogramPercentile(&gaps, 50.0) / 1e6,
+               histogramPercentile(&gaps, 99.0) / 1e6, gaps.max / 1e6, bytes / (elapsed / 1e9) / 1024, closed, ok ? "yes" : "no");
+        if (!ok) {
+            break;
+        }
+    }
+    printf("\nsustained %d sessions at 6 Hz, %d per server reactor\n", sustained, sustained / reactors);
+
+    stopping = 1;
+    for (t = 0; t < threads; t++) {
+        pthread_join(workers[t].thread, NULL);
+        for (i = 0; i < workers[t].count; i++) {
+            close(workers[t].players[i].fd);
+        }
+        free(workers[t].players);
+        close(workers[t].epollFd);
+    }
+    return 0;
+}
+
+// End of server_load.c
@@ -0,0 +1,347 @@
+/*! \file snake_bench.c
+ * \brief Headless engine benchmark
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Plays games with random or scripted input through gameStep,
+ * without rendering, and reports the number of ticks per second.
+ * With -b the same games are played by the batched engine,
+ * with -v both are run and the results compared game by game.
+ * With -j the batches run on 1, 2, 4 .. N worker threads.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "engine.h"
+#include "batch.h"
+#include "runner.h"
+#include "benchutil.h"
+
+/*! \def MAXSCRIPT
+ *  \brief Longest input script read from file
+ */
+#define MAXSCRIPT 65536
+
+/*! \typedef struct benchConfig
+ *  \brief Benchmark settings
+ */
+typedef struct benchConfig_t {
+    int width;
+    int height;
+    long games;
+    unsigned int seed;
+    unsigned long maxTicks;
+    size_t batchSize;
+    int threads;
+    int verify;
+    unsigned char * script;
+    size_t scriptLength;
+} benchConfig;
+
+/*! \typedef struct gameResult
+ *  \brief Result of one game
+ */
+typedef struct gameResult_t {
+    int score;
+    unsigned long ticks;
+} gameResult;
+
+/*! \fn static unsigned char nextInput(benchConfig * config, policyState * source)
+ * \brief Next input of a game: script character, or random: mostly no change, sometimes a turn
+ */
+static unsigned char nextInput(benchConfig * config, policyState * source) {
+    static const unsigned char turns[8] = { 'u', 'd', 'l', 'r', 0, 0, 0, 0 };
+
+    if (config->scriptLength > 0) {
+        return config->script[source->position++ % config->scriptLength];
+    }
+    source->state = source->state * 1103515245u + 12345u;               // cheap generator, input only
+    return turns[(source->state >> 16) & 7];
+}
+
+/*! \fn static void startInput(benchConfig * config, policyState * source, long game)
+ * \brief Input generator of game number game, the same in every mode
+ */
+static void startInput(benchConfig * config, policyState * source, long game) {
+    source->state = config->seed + (unsigned int) game;
+    source->position = 0;
+}
+
+/*! \fn static unsigned char benchPolicy(void * context, gameBatch * batch, size_t slot, policyState * ps)
+ * \brief Input policy of the parallel runner, same inputs as the other modes
+ */
+static unsigned char benchPolicy(void * context, gameBatch * batch, size_t slot, policyState * ps) {
+    (void) batch;
+    (void) slot;
+    return nextInput(context, ps);
+}
+
+/*! \fn static size_t readScript(const char * fileName, unsigned char * script)
+ * \brief Read input script, one character per tick: u d l r, anything else is no input
+ */
+static size_t readScript(const char * fileName, unsigned char * script) {
+    FILE * scriptFile = fopen(fileName, "r");
+    size_t length;
+
+    if (scriptFile == NULL) {
+        perror(fileName);
+        return 0;
+    }
+    length = fread(script, 1, MAXSCRIPT, scriptFile);
+    fclose(scriptFile);
+    return length;
+}
+
+/*! \fn static int runScalar(benchConfig * config, gameResult * results)
+ * \brief Play every game one after the other with gameStep
+ */
+static int runScalar(benchConfig * config, gameResult * results) {
+    memArena arena;
+    gameState game;
+    policyState source;
+    long g;
+
+    if ((arenaInit(&arena, gameMemorySize(config->width, config->height)) != 0)
+        || (gameInit(&game, config->width, config->height, config->seed, &arena) != 0)) {
+        return -1;
+    }
+    for (g = 0; g < config->games; g++) {
+        gameReset(&game, config->seed + (unsigned int) g);              // game g always plays the same way
+        startInput(config, &source, g);
+        while (gameStep(&game, nextInput(config, &source)) && (game.ticks < config->maxTicks)) {
+            // scripts may loop forever, so the length of a game is limited
+        }
+        results[g].score = game.score;
+        results[g].ticks = game.ticks;
+    }
+    arenaFree(&arena);
+    return 0;
+}
+
+/*! \fn static int runBatch(benchConfig * config, gameResult * results)
+ * \brief Play the games in a batch, a finished slot gets the next game
+ */
+static int runBatch(benchConfig * config, gameResult * results) {
+    memArena arena;
+    gameBatch batch;
+    size_t slots = config->batchSize, i;
+    long * slotGame = malloc(slots * sizeof(long));
+    policyState * sources = malloc(slots * sizeof(policyState));
+    unsigned char * inputs = malloc(slots);
+    long nextGame = 0, active = 0;
+    int result = 0;
+
+    if ((slotGame == NULL) || (sources == NULL) || (inputs == NULL)
+        || (arenaInit(&arena, batchMemorySize(slots, config->width, config->height)) != 0)) {
+        free(slotGame);
+        free(sources);
+        free(inputs);
+        return -1;
+    }
+    if (batchInit(&batch, slots, config->width, config->height, config->seed, &arena) != 0) {
+        result = -1;
+    } else {
+        for (i = 0; i < slots; i++) {                                   // first games: 0 .. slots - 1
+            if (nextGame < config->games) {
+                slotGame[i] = nextGame;
+                startInput(config, &sources[i], nextGame);
+                nextGame++;
+                active++;
+            } else {
+                slotGame[i] = -1;
+                batch.running[i] = 0;
+            }
+        }
+        while (active > 0) {
+            for (i = 0; i < slots; i++) {
+                inputs[i] = (slotGame[i] >= 0) ? nextInput(config, &sources[i]) : 0;
+            }
+            batchStep(&batch, inputs);
+            for (i = 0; i < slots; i++) {                               // collect finished games, refill slots
+                if ((slotGame[i] < 0) || (batch.running[i] && ((unsigned long) batch.ticks[i] < config->maxTicks))) {
+                    continue;
+                }
+                results[slotGame[i]].score = batch.score[i];
+                results[slotGame[i]].ticks = (unsigned long) batch.ticks[i];
+                if (nextGame < config->games) {
+                    batchReset(&batch, i, config->seed + (unsigned int) nextGame);
+                    slotGame[i] = nextGame;
+                    startInput(config, &sources[i], nextGame);
+                    nextGame++;
+                } else {
+                    slotGame[i] = -1;
+                    batch.running[i] = 0;
+                    active--;
+                }
+            }
+        }
+    }
+    arenaFree(&arena);
+    free(slotGame);
+    free(sources);
+    free(inputs);
+    return result;
+}
+
+/*! \fn static int runParallel(benchConfig * config, gameResult * results)
+ * \brief Play the games with the parallel runner on 1, 2, 4 .. config->threads threads
+ *
+ * The results of the last run are returned
+ */
+static int runParallel(benchConfig * config, gameResult * results) {
+    runnerConfig run;
+    runnerStats stats;
+    runnerResult * runResults;
+    unsigned long long checksum;
+    double singleThread = 0;
+    long g, least, most;
+    int threads, i;
+
+    if (posix_memalign((void **) &runResults, 64, (size_t) config->games * sizeof(runnerResult)) != 0) {
+        return -1;
+    }
+    for (threads = 1; threads > 0; threads = (threads == config->threads) ? 0 : (threads * 2 < config->threads ? threads * 2 : config->threads)) {
+        run.width = config->width;
+        run.height = config->height;
+        run.games = config->games;
+        run.seed = config->seed;
+        run.threads = threads;
+        run.slots = config->batchSize > 0 ? config->batchSize : 64;
+        run.shardSize = (long) run.slots * 16;
+        run.maxTicks = config->maxTicks;
+        run.policy = benchPolicy;
+        run.policyContext = config;
+        if (runGames(&run, runResults, &stats) != 0) {
+            free(runResults);
+            return -1;
+        }
+        checksum = 0;
+        for (g = 0; g < config->games; g++) {
+            checksum = checksum * 31 + (unsigned long long) runResults[g].score * 1000003u + (unsigned long long) runResults[g].ticks;
+        }
+        least = most = stats.gamesPerThread[0];
+        for (i = 1; i < threads; i++) {
+            least = stats.gamesPerThread[i] < least ? stats.gamesPerThread[i] : least;
+            most = stats.gamesPerThread[i] > most ? stats.gamesPerThread[i] : most;
+        }
+        if (threads == 1) {
+            singleThread = stats.elapsed;
+        }
+        printf("parallel: %3d threads %.3f s, %.0f ticks/s, %.0f ticks/s per thread, speedup %.2f, games/thread %ld..%ld, steals %ld, checksum %016llx\n",
+               threads, stats.elapsed, stats.ticks / stats.elapsed, stats.ticks / stats.elapsed / threads,
+               singleThread / stats.elapsed, least, most, stats.steals, checksum);
+    }
+    for (g = 0; g < config->games; g++) {
+        results[g].score = runResults[g].score;
+        results[g].ticks = (unsigned long) runResults[g].ticks;
+    }
+    free(runResults);
+    return 0;
+}
+
+/*! \fn static void report(const char * mode, benchConfig * config, gameResult * results, double elapsed)
+ * \brief Print throughput, average score and the regression checksum
+ */
+static void report(const char * mode, benchConfig * config, gameResult * results, double elapsed) {
+    unsigned long long ticks = 0, scoreSum = 0, checksum = 0;
+    long g;
+
+    for (g = 0; g < config->games; g++) {
+        ticks += results[g].ticks;
+        scoreSum += (unsigned long long) results[g].score;
+        checksum = checksum * 31 + (unsigned long long) results[g].score * 1000003u + results[g].ticks;     // regression fingerprint
+    }
+    printf("%s: board %dx%d games %ld ticks %llu\n", mode, config->width, config->height, config->games, ticks);
+    printf("%s: time %.3f s, %.0f ticks/s (1 core), %.0f games/s\n", mode, elapsed, ticks / elapsed, config->games / elapsed);
+    printf("%s: average score %.2f, average ticks %.1f, checksum %016llx\n",
+           mode, (double) scoreSum / config->games, (double) ticks / config->games, checksum);
+}
+
+int main(int argc, char **argv) {
+    static unsigned char script[MAXSCRIPT];
+    benchConfig config;
+    gameResult * scalarResults = NULL, * batchResults = NULL;
+    double start;
+    long g, mismatches = 0;
+    int option;
+
+    config.width = BOARDSIZEX;
+    config.height = BOARDSIZEY;
+    config.games = 100000;
+    config.seed = 1;
+    config.maxTicks = 100000;
+    config.batchSize = 0;
+    config.threads = 0;
+    config.verify = 0;
+    config.script = script;
+    config.scriptLength = 0;
+
+    while ((option = getopt(argc, argv, "x:y:g:s:f:t:b:j:v")) != -1) {
+        switch (option) {
+            case 'x': config.width = atoi(optarg); break;
+            case 'y': config.height = atoi(optarg); break;
+            case 'g': config.games = atol(optarg); break;
+            case 's': config.seed = (unsigned int) strtoul(optarg, NULL, 10); break;
+            case 't': config.maxTicks = strtoul(optarg, NULL, 10); break;
+            case 'b': config.batchSize = strtoul(optarg, NULL, 10); break;
+            case 'j': config.threads = atoi(optarg); break;
+            case 'v': config.verify = 1; break;
+            case 'f':
+                config.scriptLength = readScript(optarg, script);
+                if (config.scriptLength == 0) {
+                    return 1;
+                }
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-x columns] [-y rows] [-g games] [-s seed] [-t maxticks] [-f scriptfile] [-b batchsize] [-j threads] [-v]\n", argv[0]);
+                return 1;
+        }
+    }
+    if ((config.width < MINBOARDSIZE) || (config.height < MINBOARDSIZE) || (config.width > MAXBOARDSIZE)
+        || (config.height > MAXBOARDSIZE) || (config.games < 1) || (config.maxTicks > 0x7fffffffUL)
+        || (config.threads < 0) || (config.threads > RUNNERMAXTHREADS)) {
+        fprintf(stderr, "Invalid board size, game count or tick limit\n");
+        return 1;
+    }
+
+    if (((config.batchSize == 0) && (config.threads == 0)) || config.verify) {
+        scalarResults = malloc((size_t) config.games * sizeof(gameResult));
+        start = benchSeconds();
+        if ((scalarResults == NULL) || (runScalar(&config, scalarResults) != 0)) {
+            fprintf(stderr, "Not enough memory\n");
+            return 1;
+        }
+        report("scalar", &config, scalarResults, benchSeconds() - start);
+    }
+    if (config.threads > 0) {
+        batchResults = malloc((size_t) config.games * sizeof(gameResult));
+        if ((batchResults == NULL) || (runParallel(&config, batchResults) != 0)) {
+            fprintf(stderr, "Not enough memory or threads\n");
+            return 1;
+        }
+    } else if (config.batchSize > 0) {
+        batchResults = malloc((size_t) config.games * sizeof(gameResult));
+        start = benchSeconds();
+        if ((batchResults == NULL) || (runBatch(&config, batchResults) != 0)) {
+            fprintf(stderr, "Not enough memory\n");
+            return 1;
+        }
+        report("batch", &config, batchResults, benchSeconds() - start);
+    }
+    if ((scalarResults != NULL) && (batchResults != NULL)) {
+        for (g = 0; g < config.games; g++) {                            // every game must end the same way
+            if ((scalarResults[g].score != batchResults[g].score) || (scalarResults[g].ticks != batchResults[g].ticks)) {
+                mismatches++;
+            }
+        }
+        printf("verify: %ld of %ld games differ\n", mismatches, config.games);
+    }
+    free(scalarResults);
+    free(batchResults);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// End of snake_bench.c
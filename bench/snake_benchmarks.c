@@ -0,0 +1,521 @@
+/*! \file snake_benchmarks.c
+ * \brief Microbenchmarks of the board, snake and screen functions
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Times clearBoard, updateBoard, updateBitboard, updateSnake, placeApple, placeAppleFree,
+ * readInput (fed from a pipe), drawScreen, renderFrame and renderDirty
+ * (written to /dev/null) over a sweep of board sizes and snake lengths.
+ * renderView and renderScroll draw the board through an 80x24 terminal,
+ * their cost should not grow with the board.
+ * Every case is calibrated to run at least the minimum time, measured
+ * REPEATS times, and written as one CSV line: the median and the best
+ * nanoseconds per call. With -c the results are compared to an earlier
+ * CSV file and the cases slower by more than the threshold are reported.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "snake.h"
+#include "freecells.h"
+#include "bitboard.h"
+#include "terminal.h"
+#include "render.h"
+#include "benchutil.h"
+
+/*! \def REPEATS
+ *  \brief Number of measurements of a case, the median is reported
+ */
+#define REPEATS 5
+
+/*! \def MAXBASELINE
+ *  \brief Most cases read from a baseline file
+ */
+#define MAXBASELINE 1024
+
+/*! \def PIPEKEYS
+ *  \brief Key sequences put in the pipe at once, 3 bytes each, less than the pipe holds
+ */
+#define PIPEKEYS 16384
+
+/*! \typedef struct fixture
+ *  \brief Board, snake and renderer of one case
+ */
+typedef struct fixture_t {
+    memArena arena;
+    board gameBoard;
+    bitboard occupied;
+    snake sn;
+    freeCells fc;
+    renderer rd;
+    dirtyList dirty;
+    coord apple;
+    rngState rng;
+    int width;
+    int height;
+    size_t length;
+    int devNull;
+    int keyPipe[2];
+} fixture;
+
+/*! \typedef struct benchmark
+ *  \brief One benchmarked function
+ *
+ * The run function makes the given number of calls and returns the time they took,
+ * so preparation that is not part of the function can be left out
+ */
+typedef struct benchmark_t {
+    const char * name;
+    int sweepLength;
+    double (*run)(fixture * fx, long iterations);
+} benchmark;
+
+/*! \typedef struct baselineCase
+ *  \brief One line of an earlier result file
+ */
+typedef struct baselineCase_t {
+    char name[32];
+    int width;
+    int height;
+    size_t length;
+    double medianNs;
+} baselineCase;
+
+/*! \fn static int prepare(fixture * fx, int width, int height, size_t length)
+ * \brief Set up the board, snake, free cell index and renderer of a case
+ */
+static int prepare(fixture * fx, int width, int height, size_t length) {
+    if (arenaInit(&fx->arena, boardMemorySize(width, height) + bitboardMemorySize(width, height) + snakeMemorySize(width, height)
+                  + freeCellsMemorySize(width, height) + renderMemorySize(width, height)) != 0) {
+        return -1;
+    }
+    fx->width = width;
+    fx->height = height;
+    fx->length = length;
+    initBoard(&fx->gameBoard, width, height, &fx->arena);
+    initBitboard(&fx->occupied, width, height, &fx->arena);
+    initSnake(&fx->sn, width, height, &fx->arena);
+    benchFillSnake(&fx->sn, length, width);
+    initFreeCells(&fx->fc, &fx->sn, width, height, &fx->arena);
+    renderInit(&fx->rd, fx->devNull, width, height, &fx->arena);
+    rngSeed(&fx->rng, 1);
+    fx->apple.x = width - 1;                                            // last cell, never under the laid out snake
+    fx->apple.y = height - 1;
+    updateBoard(&fx->gameBoard, &fx->apple, &fx->sn, 1);
+    updateBitboard(&fx->occupied, &fx->sn);
+    return 0;
+}
+
+/*! \fn static double benchClearBoard(fixture * fx, long iterations)
+ * \brief clearBoard of the whole board
+ */
+static double benchClearBoard(fixture * fx, long iterations) {
+    double start = benchSeconds();
+    long i;
+
+    for (i = 0; i < iterations; i++) {
+        clearBoard(&fx->gameBoard);
+        __asm__ __volatile__("" : : "r"(fx->gameBoard.cells) : "memory");  // the stores are not dead
+    }
+    return benchSeconds() - start;
+}
+
+/*! \fn static double benchUpdateBoard(fixture * fx, long iterations)
+ * \brief updateBoard: clear and draw the apple and every snake segment
+ */
+static double benchUpdateBoard(fixture * fx, long iterations) {
+    double start = benchSeconds();
+    long i;
+
+    for (i = 0; i < iterations; i++) {
+        updateBoard(&fx->gameBoard, &fx->apple, &fx->sn, 1);
+        __asm__ __volatile__("" : : "r"(fx->gameBoard.cells) : "memory");
+    }
+    return benchSeconds() - start;
+}
+
+/*! \fn static double benchUpdateBitboard(fixture * fx, long iterations)
+ * \brief updateBitboard: clear the grid, set the walls and every snake segment
+ */
+static double benchUpdateBitboard(fixture * fx, long iterations) {
+    double start = benchSeconds();
+    long i;
+
+    for (i = 0; i < iterations; i++) {
+        updateBitboard(&fx->occupied, &fx->sn);
+        __asm__ __volatile__("" : : "r"(fx->occupied.words) : "memory");
+    }
+    return benchSeconds() - start;
+}
+
+/*! \fn static double benchUpdateSnake(fixture * fx, long iterations)
+ * \brief updateSnake: the snake runs in a small square, so the head stays on the board
+ */
+static double benchUpdateSnake(fixture * fx, long iterations) {
+    static const unsigned char square[4] = { 'd', 'l', 'u', 'r' };
+    double start = benchSeconds();
+    long i;
+
+    for (i = 0; i < iterations; i++) {
+        fx->sn.runningDirection = square[i & 3];
+        updateSnake(&fx->sn);
+    }
+    return benchSeconds() - start;
+}
+
+/*! \fn static double benchPlaceApple(fixture * fx, long iterations)
+ * \brief placeApple: random cells retried until one is not under the snake, the snake scanned each time
+ */
+static double benchPlaceApple(fixture * fx, long iterations) {
+    double start = benchSeconds();
+    long i;
+
+    for (i = 0; i < iterations; i++) {
+        (void) placeApple(&fx->apple, &fx->sn, &fx->gameBoard, &fx->rng);
+    }
+    return benchSeconds() - start;
+}
+
+/*! \fn static double benchPlaceAppleFree(fixture * fx, long iterations)
+ * \brief placeAppleFree: one draw from the free cell index, the method the game uses
+ */
+static double benchPlaceAppleFree(fixture * fx, long iterations) {
+    double start = benchSeconds();
+    long i;
+
+    for (i = 0; i < iterations; i++) {
+        (void) placeAppleFree(&fx->apple, &fx->sn, &fx->fc, &fx->rng);
+    }
+    return benchSeconds() - start;
+}
+
+/*! \fn static double benchReadInput(fixture * fx, long iterations)
+ * \brief readInput of arrow keys from a pipe on standard input, only the reads are timed
+ */
+static double benchReadInput(fixture * fx, long iterations) {
+    static const char arrows[4] = { 'A', 'B', 'C', 'D' };
+    unsigned char keys[PIPEKEYS * 3];
+    double elapsed = 0, start;
+    long done = 0, chunk, i;
+    int savedInput = dup(STDIN_FILENO);
+
+    for (i = 0; i < PIPEKEYS; i++) {
+        keys[i * 3] = 27;
+        keys[i * 3 + 1] = '[';
+        keys[i * 3 + 2] = (unsigned char) arrows[i & 3];
+    }
+    dup2(fx->keyPipe[0], STDIN_FILENO);
+    while (done < iterations) {
+        chunk = iterations - done < PIPEKEYS ? iterations - done : PIPEKEYS;
+        if (write(fx->keyPipe[1], keys, (size_t) chunk * 3) != chunk * 3) {
+            break;
+        }
+        start = benchSeconds();
+        for (i = 0; i < chunk; i++) {
+            (void) readInput();
+        }
+        elapsed += benchSeconds() - start;
+        done += chunk;
+    }
+    dup2(savedInput, STDIN_FILENO);
+    close(savedInput);
+    return elapsed;
+}
+
+/*! \fn static double benchDrawScreen(fixture * fx, long iterations)
+ * \brief drawScreen of the whole board with standard output on /dev/null
+ */
+static double benchDrawScreen(fixture * fx, long iterations) {
+    double start;
+    long i;
+    int savedOutput;
+
+    fflush(stdout);
+    savedOutput = dup(STDOUT_FILENO);
+    dup2(fx->devNull, STDOUT_FILENO);
+    start = benchSeconds();
+    for (i = 0; i < iterations; i++) {
+        drawScreen(&fx->gameBoard, 0, fx->height + 8);
+    }
+    fflush(stdout);                                                     // buffered output belongs to the calls
+    start = benchSeconds() - start;
+    dup2(savedOutput, STDOUT_FILENO);
+    close(savedOutput);
+    return start;
+}
+
+/*! \fn static double benchRenderFrame(fixture * fx, long iterations)
+ * \brief renderFrame as a full repaint, what the game sends for its first frame
+ */
+static double benchRenderFrame(fixture * fx, long iterations) {
+    double start = benchSeconds();
+    long i;
+
+    for (i = 0; i < iterations; i++) {
+        fx->rd.fullRepaint = 1;
+        (void) renderFrame(&fx->rd, &fx->occupied, &fx->apple, 0);
+    }
+    return benchSeconds() - start;
+}
+
+/*! \fn static double benchRenderDirty(fixture * fx, long iterations)
+ * \brief renderDirty of a tick: one cell freed, one taken, the apple moved
+ */
+static double benchRenderDirty(fixture * fx, long iterations) {
+    double start;
+    long i;
+    int phase;
+
+    (void) renderFrame(&fx->rd, &fx->occupied, &fx->apple, 0);          // later frames are differential
+    start = benchSeconds();
+    for (i = 0; i < iterations; i++) {
+        phase = (int) (i & 1);                                          // cells change back and forth, so never skipped
+        fx->dirty.count = 3;
+        fx->dirty.cells[0].cell = fx->sn.position[fx->sn.tail];
+        fx->dirty.cells[0].value = phase ? 'o' : ' ';
+        fx->dirty.cells[1].cell = fx->apple;
+        fx->dirty.cells[1].value = phase ? 'b' : 'o';
+        fx->dirty.cells[2].cell.x = 0;
+        fx->dirty.cells[2].cell.y = fx->height - 1;
+        fx->dirty.cells[2].value = phase ? ' ' : 'o';
+        applyDirtyBits(&fx->occupied, &fx->dirty);
+        (void) renderDirty(&fx->rd, &fx->occupied, &fx->apple, &fx->dirty, phase);
+    }
+    return benchSeconds() - start;
+}
+
+/*! \fn static double benchRenderView(fixture * fx, long iterations)
+ * \brief renderFrame as a full repaint of an 80x24 terminal, what the game sends after SIGWINCH
+ */
+static double benchRenderView(fixture * fx, long iterations) {
+    double start;
+    long i;
+
+    renderResize(&fx->rd, 80, 24);
+    renderFollow(&fx->rd, fx->width / 2, fx->height / 2);
+    start = benchSeconds();
+    for (i = 0; i < iterations; i++) {
+        fx->rd.fullRepaint = 1;
+        (void) renderFrame(&fx->rd, &fx->occupied, &fx->apple, 0);
+    }
+    return benchSeconds() - start;
+}
+
+/*! \fn static double benchRenderScroll(fixture * fx, long iterations)
+ * \brief renderDirty of an 80x24 terminal after the camera jumped, the whole view is compared
+ */
+static double benchRenderScroll(fixture * fx, long iterations) {
+    double start;
+    long i;
+    int phase;
+
+    renderResize(&fx->rd, 80, 24);
+    renderFollow(&fx->rd, 0, 0);
+    (void) renderFrame(&fx->rd, &fx->occupied, &fx->apple, 0);          // later frames are differential
+    fx->dirty.count = 0;
+    start = benchSeconds();
+    for (i = 0; i < iterations; i++) {
+        phase = (int) (i & 1);                                          // camera to the far corner and back
+        renderFollow(&fx->rd, phase ? fx->width - 1 : 0, phase ? fx->height - 1 : 0);
+        (void) renderDirty(&fx->rd, &fx->occupied, &fx->apple, &fx->dirty, 0);
+    }
+    return benchSeconds() - start;
+}
+
+/*! \var static const benchmark benchmarks[]
+ *  \brief The benchmarked functions, sweepLength is false where the snake length does not matter
+ */
+static const benchmark benchmarks[] = {
+    { "clearBoard", 0, benchClearBoard },
+    { "updateBoard", 1, benchUpdateBoard },
+    { "updateBitboard", 1, benchUpdateBitboard },
+    { "updateSnake", 1, benchUpdateSnake },
+    { "placeApple", 1, benchPlaceApple },
+    { "placeAppleFree", 1, benchPlaceAppleFree },
+    { "readInput", 0, benchReadInput },
+    { "drawScreen", 1, benchDrawScreen },
+    { "renderFrame", 1, benchRenderFrame },
+    { "renderDirty", 1, benchRenderDirty },
+    { "renderView", 1, benchRenderView },
+    { "renderScroll", 1, benchRenderScroll },
+};
+
+/*! \var static const int boardSizes[][2]
+ *  \brief Swept board sizes: the default board, a full terminal, and large boards
+ */
+static const int boardSizes[][2] = { { BOARDSIZEX, BOARDSIZEY }, { 80, 40 }, { 256, 192 }, { 1024, 768 } };
+
+/*! \var static const int fillPercents[]
+ *  \brief Swept snake lengths as percent of the board cells
+ */
+static const int fillPercents[] = { 1, 25, 50, 90, 99 };
+
+/*! \fn static int compareDouble(const void * a, const void * b)
+ * \brief qsort order of measurements
+ */
+static int compareDouble(const void * a, const void * b) {
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+/*! \fn static void measure(const benchmark * bm, fixture * fx, double minTime, long * iterations, double * medianNs, double * bestNs)
+ * \brief Calibrate the number of calls to the minimum time, then take REPEATS measurements
+ */
+static void measure(const benchmark * bm, fixture * fx, double minTime, long * iterations, double * medianNs, double * bestNs) {
+    double times[REPEATS];
+    long count = 1;
+    int r;
+
+    while ((bm->run(fx, count) < minTime) && (count < (1L << 40))) {  // warms up the caches as well
+        count *= 2;
+    }
+    for (r = 0; r < REPEATS; r++) {
+        times[r] = bm->run(fx, count) / (double) count * 1e9;
+    }
+    qsort(times, REPEATS, sizeof(double), compareDouble);
+    *iterations = count;
+    *medianNs = times[REPEATS / 2];
+    *bestNs = times[0];
+}
+
+/*! \fn static size_t readBaseline(const char * fileName, baselineCase * cases)
+ * \brief Read the cases of an earlier result file
+ */
+static size_t readBaseline(const char * fileName, baselineCase * cases) {
+    FILE * in = fopen(fileName, "r");
+    char line[256];
+    size_t count = 0;
+
+    if (in == NULL) {
+        perror(fileName);
+        return 0;
+    }
+    while ((count < MAXBASELINE) && (fgets(line, sizeof(line), in) != NULL)) {
+        if (sscanf(line, "%31[^,],%d,%d,%zu,%*d,%*d,%lf", cases[count].name, &cases[count].width,
+                   &cases[count].height, &cases[count].length, &cases[count].medianNs) == 5) {
+            count++;                                                    // the header line does not match
+        }
+    }
+    fclose(in);
+    return count;
+}
+
+/*! \fn static int compareBaseline(baselineCase * cases, size_t count, const char * name, fixture * fx, double medianNs, double threshold)
+ * \brief Report the change of a case against the baseline, true if it is a regression
+ */
+static int compareBaseline(baselineCase * cases, size_t count, const char * name, fixture * fx, double medianNs, double threshold) {
+    double change;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        if ((strcmp(cases[i].name, name) == 0) && (cases[i].width == fx->width)
+            && (cases[i].height == fx->height) && (cases[i].length == fx->length)) {
+            change = (medianNs / cases[i].medianNs - 1) * 100;
+            if ((change > threshold) || (change < -threshold)) {
+                fprintf(stderr, "%-14s %4dx%-4d length %7zu: %10.1f -> %10.1f ns %+6.1f%%%s\n", name, fx->width, fx->height,
+                        fx->length, cases[i].medianNs, medianNs, change, change > threshold ? "  REGRESSION" : "");
+            }
+            return change > threshold;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    fixture fx;
+    baselineCase * baseline = NULL;
+    size_t baselineCount = 0, length, cells;
+    const char * outputName = NULL, * baselineName = NULL, * only = NULL;
+    double minTime = 0.02, threshold = 10, medianNs, bestNs;
+    int maxCells = 1024 * 768, option, regressions = 0;
+    size_t b, s, f;
+    long iterations;
+    FILE * out = stdout;
+
+    while ((option = getopt(argc, argv, "o:c:t:m:b:s:")) != -1) {
+        switch (option) {
+            case 'o':
+                outputName = optarg;
+                break;
+            case 'c':
+                baselineName = optarg;
+                break;
+            case 't':
+                threshold = atof(optarg);
+                break;
+            case 'm':
+                minTime = atof(optarg) / 1000;
+                break;
+            case 'b':
+                only = optarg;
+                break;
+            case 's':
+                maxCells = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-o results.csv] [-c baseline.csv] [-t percent] [-m ms per measurement] [-b benchmark] [-s max cells]\n", argv[0]);
+                return 1;
+        }
+    }
+    fx.devNull = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if ((fx.devNull < 0) || (pipe(fx.keyPipe) != 0)) {
+        perror("benchmark setup");
+        return 1;
+    }
+    if (baselineName != NULL) {
+        baseline = malloc(MAXBASELINE * sizeof(baselineCase));
+        baselineCount = baseline == NULL ? 0 : readBaseline(baselineName, baseline);
+        if (baselineCount == 0) {
+            fprintf(stderr, "%s: no results to compare with\n", baselineName);
+            return 1;
+        }
+    }
+    if ((outputName != NULL) && ((out = fopen(outputName, "w")) == NULL)) {
+        perror(outputName);
+        return 1;
+    }
+
+    fprintf(out, "benchmark,width,height,length,fill,iterations,median_ns,best_ns\n");
+    for (b = 0; b < sizeof(benchmarks) / sizeof(benchmarks[0]); b++) {
+        if ((only != NULL) && (strcmp(only, benchmarks[b].name) != 0)) {
+            continue;
+        }
+        for (s = 0; s < sizeof(boardSizes) / sizeof(boardSizes[0]); s++) {
+            cells = (size_t) boardSizes[s][0] * (size_t) boardSizes[s][1];
+            if ((cells > (size_t) maxCells) || ((benchmarks[b].run == benchReadInput) && (s > 0))) {
+                continue;                                               // input does not depend on the board
+            }
+            for (f = 0; f < (benchmarks[b].sweepLength ? sizeof(fillPercents) / sizeof(fillPercents[0]) : 1); f++) {
+                length = benchmarks[b].sweepLength ? cells * (size_t) fillPercents[f] / 100 : 4;
+                if (length < 2) {
+                    length = 2;
+                }
+                if (prepare(&fx, boardSizes[s][0], boardSizes[s][1], length) != 0) {
+                    fprintf(stderr, "Not enough memory for %dx%d board\n", boardSizes[s][0], boardSizes[s][1]);
+                    return 1;
+                }
+                measure(&benchmarks[b], &fx, minTime / REPEATS, &iterations, &medianNs, &bestNs);
+                fprintf(out, "%s,%d,%d,%zu,%d,%ld,%.1f,%.1f\n", benchmarks[b].name, fx.width, fx.height, fx.length,
+                        benchmarks[b].sweepLength ? fillPercents[f] : 0, iterations, medianNs, bestNs);
+                fflush(out);
+                regressions += compareBaseline(baseline, baselineCount, benchmarks[b].name, &fx, medianNs, threshold);
+                arenaFree(&fx.arena);
+            }
+        }
+    }
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    if (baseline != NULL) {
+        fprintf(stderr, "%d regressions over %.0f%% against %s\n", regressions, threshold, baselineName);
+        free(baseline);
+    }
+    return regressions == 0 ? 0 : 1;
+}
+
+// End of snake_benchmarks.c
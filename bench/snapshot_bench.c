@@ -0,0 +1,151 @@
+/*! \file snapshot_bench.c
+ * \brief Game snapshot benchmark
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Lets the autopilot play a game on boards of growing size and saves it
+ * regularly. Reports the time the game thread spends on a snapshot, the
+ * time of the background write and the time of loading and restoring the
+ * last snapshot into a second game. Then plays both games on with the
+ * same random turns and checks that they stay the same tick by tick.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "engine.h"
+#include "autopilot.h"
+#include "snapshot.h"
+#include "benchutil.h"
+
+/*! \def SAVES
+ *  \brief Snapshots taken during one game
+ */
+#define SAVES 64
+
+/*! \def RESTORES
+ *  \brief Loads and restores of the last snapshot timed
+ */
+#define RESTORES 32
+
+/*! \fn static int sameGame(const gameState * a, const gameState * b)
+ * \brief True if the two games show the same board, apple and score
+ */
+static int sameGame(const gameState * a, const gameState * b) {
+    const coord * headA = &a->player.position[a->player.head];
+    const coord * headB = &b->player.position[b->player.head];
+
+    return (a->running == b->running) && (a->ticks == b->ticks) && (a->score == b->score)
+           && (a->appleCount == b->appleCount) && (!a->appleCount || ((a->apple.x == b->apple.x) && (a->apple.y == b->apple.y)))
+           && (a->player.snakeCurrentLength == b->player.snakeCurrentLength) && (headA->x == headB->x) && (headA->y == headB->y)
+           && (a->freeIndex.count == b->freeIndex.count)
+           && (memcmp(a->occupied.words, b->occupied.words, BITBOARDWORDS(a->occupied.width, a->occupied.height) * sizeof(uint64_t)) == 0);
+}
+
+/*! \fn static int benchBoard(const char * fileName, int width, int height)
+ * \brief Measure one board size, 0 if the restored game went on the same
+ */
+static int benchBoard(const char * fileName, int width, int height) {
+    memArena arena;
+    gameState game, check;
+    autopilot pilot;
+    snapshotWriter saver;
+    snapshotData snapshot;
+    rngState player, checkPlayer;
+    unsigned long steps, every, t;
+    double start, saveTime = 0, saveMax = 0, loadTime = 0, restoreTime = 0, elapsed;
+    int i, failed = 0;
+
+    if ((arenaInit(&arena, 2 * gameMemorySize(width, height) + autopilotMemorySize(width, height)) != 0)
+        || (gameInit(&game, width, height, 7, &arena) != 0) || (gameInit(&check, width, height, 1, &arena) != 0)
+        || (autopilotInit(&pilot, width, height, &arena) != 0)) {
+        fprintf(stderr, "Not enough memory for %dx%d board\n", width, height);
+        return -1;
+    }
+    if (snapshotStart(&saver, fileName, width, height) != 0) {
+        perror("snapshot writer");
+        arenaFree(&arena);
+        return -1;
+    }
+
+    steps = (unsigned long) width * (unsigned long) height;            // a long snake, or a long walk on a big board
+    steps = steps < 200000 ? steps : 200000;
+    every = steps / SAVES > 0 ? steps / SAVES : 1;
+    for (t = 1; (t <= steps) && game.running; t++) {
+        if (!gameStep(&game, autopilotInput(&pilot, &game))) {
+            break;
+        }
+        if (t % every == 0) {
+            start = benchSeconds();
+            (void) snapshotSave(&saver, &game);
+            elapsed = benchSeconds() - start;
+            saveTime += elapsed;
+            saveMax = elapsed > saveMax ? elapsed : saveMax;
+        }
+    }
+    if (!game.running) {                                                // filled the board, save the last running state
+        fprintf(stderr, "%dx%d: the game ended after %lu ticks, use a bigger board\n", width, height, game.ticks);
+        snapshotStop(&saver, 1);
+        arenaFree(&arena);
+        return -1;
+    }
+    (void) snapshotSave(&saver, &game);
+    snapshotStop(&saver, 0);                                            // the last one is on disk now
+
+    for (i = 0; i < RESTORES; i++) {
+        start = benchSeconds();
+        if (snapshotLoad(&snapshot, fileName) != 0) {
+            perror(fileName);
+            arenaFree(&arena);
+            return -1;
+        }
+        loadTime += benchSeconds() - start;
+        start = benchSeconds();
+        failed |= snapshotRestore(&snapshot, &check) != 0;
+        restoreTime += benchSeconds() - start;
+        snapshotUnload(&snapshot);
+    }
+
+    failed |= !sameGame(&game, &check);
+    rngSeed(&player, 12345);
+    rngSeed(&checkPlayer, 12345);
+    for (t = 0; !failed && game.running && (t < 100000); t++) {         // on with the same turns until the end
+        (void) gameStep(&game, benchInput(&game, &player, 0, 8));
+        (void) gameStep(&check, benchInput(&check, &checkPlayer, 0, 8));
+        failed = !sameGame(&game, &check);
+    }
+
+    printf("%5dx%-5d %10zu %6lu %8lu %10.2f %10.2f %10.1f %10.2f %10.2f %8lu  %s\n", width, height, snapshotSize(width, height),
+           saver.saved, saver.replaced, saveTime / (double) saver.saved * 1e6, saveMax * 1e6,
+           (double) histogramPercentile(&saver.writeNs, 50.0) / 1000.0, loadTime / RESTORES * 1e6, restoreTime / RESTORES * 1e6,
+           t, failed ? "DIFFERENT" : "same");
+    (void) remove(fileName);
+    arenaFree(&arena);
+    return failed ? 1 : 0;
+}
+
+int main(int argc, char **argv) {
+    static const int sizes[][2] = { { 20, 14 }, { 64, 64 }, { 256, 256 }, { 1024, 1024 } };
+    const char * fileName = argc > 1 ? argv[1] : "snapshot_bench.snp";
+    int width = argc > 3 ? atoi(argv[2]) : 0;
+    int height = argc > 3 ? atoi(argv[3]) : 0;
+    int i, result = 0;
+
+    if ((argc > 3) && ((width < MINBOARDSIZE) || (width > MAXBOARDSIZE) || (height < MINBOARDSIZE) || (height > MAXBOARDSIZE))) {
+        fprintf(stderr, "Usage: %s [snapshotfile] [columns rows]\n", argv[0]);
+        return 1;
+    }
+    printf("%-11s %10s %6s %8s %10s %10s %10s %10s %10s %8s  %s\n", "board", "bytes", "saves", "replaced", "save us", "max us",
+           "write us", "load us", "restore us", "ticks on", "restored game");
+    if (argc > 3) {
+        result = benchBoard(fileName, width, height) != 0;
+    } else {
+        for (i = 0; i < (int) (sizeof(sizes) / sizeof(sizes[0])); i++) {
+            result |= benchBoard(fileName, sizes[i][0], sizes[i][1]) != 0;
+        }
+    }
+    return result;
+}
+
+// End of snapshot_bench.c
@@ -0,0 +1,122 @@
+/*! \file solver_bench.c
+ * \brief Autopilot benchmark
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Plays seeded games with the autopilot on growing boards until the
+ * snake fills the board or dies, and reports how many games filled the
+ * board, the ticks they took and the time the autopilot spent per tick.
+ * The same games are played with the cached path and with a search every
+ * tick, the naive way, on the boards where that finishes in reasonable time.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "autopilot.h"
+
+/*! \def NAIVEMAXCELLS
+ *  \brief Largest board played with a search every tick
+ */
+#define NAIVEMAXCELLS 1024
+
+/*! \typedef struct solverResult
+ *  \brief Totals of the games of one board and mode
+ */
+typedef struct solverResult_t {
+    long games;
+    long filled;
+    unsigned long long ticks;
+    unsigned long long solverNs;
+    unsigned long long searches;
+    unsigned long long searchedCells;
+    histogram tickNs;
+} solverResult;
+
+/*! \fn static int playGames(int width, int height, long games, int naive, solverResult * result)
+ * \brief Play the games of one board, return -1 if the board can not be set up
+ */
+static int playGames(int width, int height, long games, int naive, solverResult * result) {
+    unsigned long long limit = (unsigned long long) width * (unsigned long long) height;
+    memArena arena;
+    gameState game;
+    autopilot pilot;
+    long long start, spent;
+    long g;
+
+    if ((arenaInit(&arena, gameMemorySize(width, height) + autopilotMemorySize(width, height)) != 0)
+        || (gameInit(&game, width, height, 1, &arena) != 0) || (autopilotInit(&pilot, width, height, &arena) != 0)) {
+        return -1;
+    }
+    pilot.replanEveryTick = naive;
+    memset(result, 0, sizeof(*result));
+    histogramReset(&result->tickNs);
+    limit = limit * (limit + 1);                                        // the cycle reaches every apple within a lap
+    for (g = 0; g < games; g++) {
+        gameReset(&game, (uint64_t) g + 1);
+        autopilotReset(&pilot);
+        do {
+            start = statsNow();
+            updateSnakeDirection(&game.player, autopilotInput(&pilot, &game));
+            spent = statsNow() - start;
+            result->solverNs += (unsigned long long) spent;
+            histogramRecord(&result->tickNs, (unsigned long long) spent);
+            gameStep(&game, '\0');
+        } while (game.running && (game.ticks < limit));
+        result->ticks += game.ticks;
+        result->filled += game.player.snakeSupposedLength == game.player.capacity;   // no cell left for an apple
+    }
+    result->games = games;
+    result->searches = pilot.searches;
+    result->searchedCells = pilot.searchedCells;
+    arenaFree(&arena);
+    return 0;
+}
+
+/*! \fn static void printResult(int width, int height, const char * mode, const solverResult * result)
+ * \brief Print one line of results
+ */
+static void printResult(int width, int height, const char * mode, const solverResult * result) {
+    printf("%5dx%-5d %6s %6ld %8.1f %12.0f %10.3f %10.0f %10.1f %12.1f %12.1f\n", width, height, mode, result->games,
+           100.0 * (double) result->filled / (double) result->games, (double) result->ticks / (double) result->games,
+           (double) result->solverNs / (double) result->ticks / 1e3, (double) histogramPercentile(&result->tickNs, 50.0),
+           histogramPercentile(&result->tickNs, 99.0) / 1e3, (double) result->searches / (double) result->games,
+           (double) result->searchedCells / (double) result->ticks);
+}
+
+int main(int argc, char **argv) {
+    long games = argc > 1 ? atol(argv[1]) : 10;
+    int largest = argc > 2 ? atoi(argv[2]) : 64;
+    static const int sides[][2] = { { 8, 8 }, { 20, 14 }, { 16, 16 }, { 32, 32 }, { 64, 64 }, { 128, 128 }, { 256, 256 } };
+    solverResult cached, naive;
+    int s, failed = 0;
+
+    if ((games < 1) || (largest < 8)) {
+        fprintf(stderr, "Usage: %s [games] [largest side]\n", argv[0]);
+        return 1;
+    }
+    printf("%11s %6s %6s %8s %12s %10s %10s %10s %12s %12s\n", "board", "mode", "games", "filled %", "ticks/game",
+           "us/tick", "p50 ns", "p99 us", "search/game", "cells/tick");
+    for (s = 0; s < (int) (sizeof(sides) / sizeof(sides[0])); s++) {
+        if ((sides[s][0] > largest) || (sides[s][1] > largest)) {
+            break;
+        }
+        if (playGames(sides[s][0], sides[s][1], games, 0, &cached) != 0) {
+            fprintf(stderr, "Could not set up %dx%d board\n", sides[s][0], sides[s][1]);
+            return 1;
+        }
+        printResult(sides[s][0], sides[s][1], "cached", &cached);
+        failed += cached.filled != cached.games;
+        if (sides[s][0] * sides[s][1] <= NAIVEMAXCELLS) {
+            (void) playGames(sides[s][0], sides[s][1], games, 1, &naive);
+            printResult(sides[s][0], sides[s][1], "naive", &naive);
+            printf("%18s naive takes %.2fx the ticks and %.1fx the solver time per tick\n", "", (double) naive.ticks / (double) cached.ticks,
+                   ((double) naive.solverNs / (double) naive.ticks) / ((double) cached.solverNs / (double) cached.ticks));
+        }
+    }
+    printf("\nevery game filled the board: %s\n", failed == 0 ? "yes" : "no");
+    return failed == 0 ? 0 : 1;
+}
+
+// End of solver_bench.c
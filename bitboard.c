@@ -0,0 +1,87 @@
+/*! \file bitboard.c
+ * \brief Bit-packed occupancy grid
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#include <string.h>
+#include "bitboard.h"
+
+#define SNAKECHAR 'o'
+
+size_t bitboardMemorySize(int width, int height) {
+    return ARENABLOCK(BITBOARDWORDS(width, height) * sizeof(uint64_t));
+} // bitboardMemorySize function ends
+
+int initBitboard(bitboard * bb, int width, int height, memArena * arena) {
+    if (arena != NULL) {
+        bb->words = arenaAlloc(arena, BITBOARDWORDS(width, height) * sizeof(uint64_t));
+        if (bb->words == NULL) {
+            return -1;
+        }
+    }
+    bb->width = width;
+    bb->height = height;
+    bb->stride = (size_t) width + 2;
+    clearBitboard(bb);
+    return 0;
+} // initBitboard function ends
+
+void clearBitboard(bitboard * bb) {
+    /*! \var size_t bit, last
+     *  \brief Bit of the top wall row, first bit of the bottom wall row
+     */
+    size_t bit, last = (size_t) (bb->height + 1) * bb->stride;
+    /*! \var int y
+     *  \brief Row index variable
+     */
+    int y;
+
+    memset(bb->words, 0, BITBOARDWORDS(bb->width, bb->height) * sizeof(uint64_t));
+    for (bit = 0; bit < bb->stride; bit++) {                            // top and bottom wall
+        bb->words[bit >> 6] |= (uint64_t) 1 << (bit & 63);
+        bb->words[(last + bit) >> 6] |= (uint64_t) 1 << ((last + bit) & 63);
+    }
+    for (y = 0; y < bb->height; y++) {                                  // left and right wall
+        bitAssign(bb, -1, y, 1);
+        bitAssign(bb, bb->width, y, 1);
+    }
+} // clearBitboard function ends
+
+void updateBitboard(bitboard * bb, snake * sn) {
+    /*! \var size_t i, bit
+     *  \brief Loop index variable, bit of a segment
+     */
+    size_t i, bit;
+    /*! \var size_t first, last
+     *  \brief Segment ranges of the ring: first .. capacity - 1 and 0 .. last
+     */
+    size_t first = sn->tail, last = sn->head;
+
+    clearBitboard(bb);
+    if (sn->head < sn->tail) {                                          // ..>>..head......tail..>>..
+        for (i = sn->tail; i < sn->capacity; i++) {
+            bit = bitIndex(bb, sn->position[i].x, sn->position[i].y);
+            bb->words[bit >> 6] |= (uint64_t) 1 << (bit & 63);
+        }
+        first = 0;
+    }
+    for (i = first; i <= last; i++) {                                   // ......tail..>>..head......
+        bit = bitIndex(bb, sn->position[i].x, sn->position[i].y);
+        bb->words[bit >> 6] |= (uint64_t) 1 << (bit & 63);
+    }
+} // updateBitboard function ends
+
+void applyDirtyBits(bitboard * bb, dirtyList * dirty) {
+    /*! \var size_t i
+     *  \brief Loop index variable
+     */
+    size_t i;
+
+    for (i = 0; i < dirty->count; i++) {                                // an apple cell is free for the snake
+        bitAssign(bb, dirty->cells[i].cell.x, dirty->cells[i].cell.y, dirty->cells[i].value == SNAKECHAR);
+    }
+} // applyDirtyBits function ends
+
+// End of bitboard.c
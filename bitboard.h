@@ -0,0 +1,127 @@
+/*! \file bitboard.h
+ * \brief Bit-packed occupancy grid header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * One bit per cell, set where the snake body is. The grid has a border of
+ * one cell on every side whose bits are always set, so a head that just left
+ * the board lands on a wall bit: a single bit test covers walls and body,
+ * without a branch and without reading outside the grid.
+ * A cell takes 1 bit instead of the 1 byte of the character board.
+ */
+
+#ifndef SNAKEGAME_BITBOARD_H
+#define SNAKEGAME_BITBOARD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "snake.h"
+#include "memarena.h"
+
+/*! \def BITBOARDWORDS
+ *  \brief Number of 64 bit words of the grid of a board, border included
+ */
+#define BITBOARDWORDS(width, height) ((((size_t) (width) + 2) * ((size_t) (height) + 2) + 63) / 64)
+
+/*! \typedef struct bitboard
+ *  \brief Contains the occupancy grid of a board
+ *
+ * Bit of cell x, y is bit (y + 1) * stride + x + 1, x and y may be -1 .. width or height
+ *
+ * \var int width Number of columns of the board, border not included
+ * \var int height Number of rows of the board, border not included
+ * \var size_t stride Number of bits in a row of the grid, width + 2
+ * \var uint64_t * words The grid, BITBOARDWORDS elements
+ */
+typedef struct bitboard_t {
+    int width;
+    int height;
+    size_t stride;
+    uint64_t * words;
+} bitboard;
+
+/*! \fn static inline size_t bitIndex(const bitboard * bb, int x, int y)
+ * \brief Number of the bit of a cell, x and y may be on the border
+ */
+static inline size_t bitIndex(const bitboard * bb, int x, int y) {
+    return (size_t) (y + 1) * bb->stride + (size_t) (x + 1);
+}
+
+/*! \fn static inline int bitTest(const bitboard * bb, int x, int y)
+ * \brief 1 if the cell is a wall or snake body, 0 if it is free
+ *
+ * \param bb Pointer to grid
+ * \param x Column, -1 .. width
+ * \param y Row, -1 .. height
+ * \return int 0 or 1
+ */
+static inline int bitTest(const bitboard * bb, int x, int y) {
+    size_t bit = bitIndex(bb, x, y);
+
+    return (int) ((bb->words[bit >> 6] >> (bit & 63)) & 1);
+}
+
+/*! \fn static inline void bitAssign(bitboard * bb, int x, int y, int value)
+ * \brief Set (value 1) or clear (value 0) the bit of a cell of the board, without a branch
+ */
+static inline void bitAssign(bitboard * bb, int x, int y, int value) {
+    size_t bit = bitIndex(bb, x, y);
+    uint64_t mask = (uint64_t) 1 << (bit & 63);
+
+    bb->words[bit >> 6] = (bb->words[bit >> 6] & ~mask) | (mask & (uint64_t) -(int64_t) value);
+}
+
+/*! \fn size_t bitboardMemorySize(int width, int height)
+ * \brief Arena space needed by the grid of a board
+ *
+ * \param width Number of columns
+ * \param height Number of rows
+ * \return size_t Number of bytes
+ */
+size_t bitboardMemorySize(int width, int height);
+
+/*! \fn int initBitboard(bitboard * bb, int width, int height, memArena * arena)
+ * \brief Set up an empty grid with walls around, words taken from the arena
+ *
+ * If arena is NULL, the words already taken are reused (the board size must be the same)
+ *
+ * \param bb Pointer to grid
+ * \param width Number of columns
+ * \param height Number of rows
+ * \param arena Memory arena or NULL
+ * \return int 0 on success, -1 if the arena is exhausted
+ */
+int initBitboard(bitboard * bb, int width, int height, memArena * arena);
+
+/*! \fn void clearBitboard(bitboard * bb)
+ * \brief Clear every cell of the board, set every cell of the border
+ *
+ * \param bb Pointer to grid
+ * \return void No values returned
+ */
+void clearBitboard(bitboard * bb);
+
+/*! \fn void updateBitboard(bitboard * bb, snake * sn)
+ * \brief Rebuild the grid from the snake: clear it and set every body segment
+ *
+ * \param bb Pointer to grid
+ * \param sn Pointer to snake
+ * \return void No values returned
+ */
+void updateBitboard(bitboard * bb, snake * sn);
+
+/*! \fn void applyDirtyBits(bitboard * bb, dirtyList * dirty)
+ * \brief Apply the changed cells of a tick: snake cells are set, every other value clears the bit
+ *
+ * The cells are applied in order of change, like applyDirtyCells
+ *
+ * \param bb Pointer to grid
+ * \param dirty Cells changed in this tick, all on the board
+ * \return void No values returned
+ */
+void applyDirtyBits(bitboard * bb, dirtyList * dirty);
+
+#endif //SNAKEGAME_BITBOARD_H
+
+// End of bitboard.h
@@ -0,0 +1,479 @@
+/*! \file broadcast.c
+ * \brief Spectator broadcast
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include "broadcast.h"
+
+/*! \def MAXEVENTS
+ *  \brief Events handled per epoll_wait
+ */
+#define MAXEVENTS 256
+
+/*! \def SENDIOV
+ *  \brief Queued frames given to the socket in one sendmsg() call
+ */
+#define SENDIOV 16
+
+/*! \fn static bcastFrame * newFrame(const renderer * rd, unsigned long tick, int keyframe, int delta)
+ * \brief Copy the frame left in the buffer of a renderer into a new shared frame, held by the ring
+ */
+static bcastFrame * newFrame(const renderer * rd, unsigned long tick, int keyframe, int delta) {
+    bcastFrame * frame = malloc(sizeof(bcastFrame) + rd->length);
+
+    if (frame != NULL) {
+        frame->refs = 1;
+        frame->keyframe = keyframe;
+        frame->delta = delta;
+        frame->gap = 0;
+        frame->tick = tick;
+        frame->length = rd->length;
+        memcpy(frame->data, rd->buffer, rd->length);
+    }
+    return frame;
+}
+
+/*! \fn static void releaseFrame(bcastFrame * frame)
+ * \brief Drop one reference, the last one frees the frame
+ */
+static void releaseFrame(bcastFrame * frame) {
+    if (--frame->refs == 0) {
+        free(frame);
+    }
+}
+
+/*! \fn static void releaseGroup(broadcaster * bc)
+ * \brief Forget the frames kept for new viewers
+ */
+static void releaseGroup(broadcaster * bc) {
+    while (bc->groupCount > 0) {
+        releaseFrame(bc->group[--bc->groupCount]);
+    }
+}
+
+/*! \fn static void notify(int fd)
+ * \brief Wake up the sender thread
+ */
+static void notify(int fd) {
+    uint64_t one = 1;
+    (void) write(fd, &one, sizeof(one));
+}
+
+/*! \fn static void sendViewer(broadcaster * bc, bcastViewer * vw, long long now)
+ * \brief Give the socket as much of the queued frames as it takes, straight from the shared buffers, never blocks
+ */
+static void sendViewer(broadcaster * bc, bcastViewer * vw, long long now) {
+    struct iovec parts[SENDIOV];
+    struct msghdr message;
+    bcastFrame * frame;
+    size_t taken, rest;
+    ssize_t result;
+    unsigned k, count;
+
+    while (vw->count > 0) {
+        count = vw->count < SENDIOV ? vw->count : SENDIOV;
+        for (k = 0; k < count; k++) {
+            frame = vw->queue[(vw->first + k) % BCASTQUEUE];
+            parts[k].iov_base = frame->data + (k == 0 ? vw->offset : 0);
+            parts[k].iov_len = frame->length - (k == 0 ? vw->offset : 0);
+        }
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = parts;
+        message.msg_iovlen = count;
+        result = sendmsg(vw->peer.fd, &message, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                netCloseLater(bc->epollFd, &vw->peer);
+                return;
+            }
+            netWatchWrite(bc->epollFd, &vw->peer, vw, 1);              // socket buffer full
+            return;
+        }
+        vw->lastSent = now;
+        bc->bytesSent += (unsigned long long) result;
+        for (taken = (size_t) result; taken > 0; ) {                    // drop the frames sent completely
+            frame = vw->queue[vw->first];
+            rest = frame->length - vw->offset;
+            if (taken < rest) {
+                vw->offset += taken;
+                break;
+            }
+            taken -= rest;
+            releaseFrame(frame);
+            vw->first = (vw->first + 1) % BCASTQUEUE;
+            vw->count--;
+            vw->offset = 0;
+        }
+    }
+    netWatchWrite(bc->epollFd, &vw->peer, vw, 0);
+}
+
+/*! \fn static void queueFrame(broadcaster * bc, bcastViewer * vw, bcastFrame * frame, long long now)
+ * \brief Queue a frame for a viewer, a full queue sends the viewer back to wait for a keyframe
+ */
+static void queueFrame(broadcaster * bc, bcastViewer * vw, bcastFrame * frame, long long now) {
+    if (vw->count == BCASTQUEUE) {                                      // too slow: keep only the frame being sent
+        while (vw->count > (vw->offset > 0 ? 1u : 0u)) {
+            releaseFrame(vw->queue[(vw->first + vw->count - 1) % BCASTQUEUE]);
+            vw->count--;
+        }
+        vw->waitKey = 1;
+        bc->resyncs++;
+        return;
+    }
+    if ((vw->count == 0) && !vw->peer.writeWatched) {
+        vw->lastSent = now;                                             // the stall is measured from here, a full socket keeps its time
+    }
+    vw->queue[(vw->first + vw->count) % BCASTQUEUE] = frame;
+    vw->count++;
+    frame->refs++;
+    bc->framesQueued++;
+}
+
+/*! \fn static void removeViewer(broadcaster * bc, bcastViewer * vw)
+ * \brief Close a viewer and release its queued frames
+ */
+static void removeViewer(broadcaster * bc, bcastViewer * vw) {
+    bc->viewers[vw->index] = bc->viewers[--bc->viewerCount];
+    bc->viewers[vw->index]->index = vw->index;
+    close(vw->peer.fd);                                                 // also removes it from epoll
+    while (vw->count > 0) {
+        releaseFrame(vw->queue[vw->first]);
+        vw->first = (vw->first + 1) % BCASTQUEUE;
+        vw->count--;
+    }
+    free(vw);
+    bc->closed++;
+}
+
+/*! \fn static int addViewer(broadcaster * bc, int fd, long long now)
+ * \brief Start sending to a new connection: the last keyframe and the deltas since
+ */
+static int addViewer(broadcaster * bc, int fd, long long now) {
+    bcastViewer ** grown;
+    bcastViewer * vw;
+    int i;
+
+    if (bc->viewerCount == bc->viewerSlots) {
+        grown = realloc(bc->viewers, (bc->viewerSlots ? bc->viewerSlots * 2 : 64) * sizeof(*grown));
+        if (grown == NULL) {
+            return -1;
+        }
+        bc->viewers = grown;
+        bc->viewerSlots = bc->viewerSlots ? bc->viewerSlots * 2 : 64;
+    }
+    vw = calloc(1, sizeof(*vw));
+    if (vw == NULL) {
+        return -1;
+    }
+    if (netAttach(bc->epollFd, &vw->peer, fd, vw, (int) (2 * bc->delta.bufferSize)) != 0) {
+        free(vw);
+        return -1;
+    }
+    vw->waitKey = 1;
+    vw->index = bc->viewerCount;
+    bc->viewers[bc->viewerCount++] = vw;
+    for (i = 0; i < bc->groupCount; i++) {                              // none before the first keyframe
+        queueFrame(bc, vw, bc->group[i], now);
+        vw->waitKey = 0;
+    }
+    bc->joined++;
+    sendViewer(bc, vw, now);
+    return 0;
+}
+
+/*! \fn static void acceptViewers(broadcaster * bc)
+ * \brief Accept every waiting connection
+ */
+static void acceptViewers(broadcaster * bc) {
+    long long now = statsNow();
+    int fd;
+
+    for (;;) {
+        fd = netAccept(bc->epollFd, bc->listenFd, &bc->listenPaused);
+        if (fd < 0) {
+            return;                                                     // EAGAIN, or out of descriptors until a viewer closes
+        }
+        if (addViewer(bc, fd, now) != 0) {
+            close(fd);
+        }
+    }
+}
+
+/*! \fn static void readViewer(broadcaster * bc, bcastViewer * vw)
+ * \brief Throw away what a viewer types, close it at end of stream
+ */
+static void readViewer(broadcaster * bc, bcastViewer * vw) {
+    unsigned char bytes[512];
+    ssize_t length;
+
+    for (;;) {
+        length = recv(vw->peer.fd, bytes, sizeof(bytes), MSG_DONTWAIT);
+        if (length > 0) {
+            continue;
+        }
+        if ((length == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))) {
+            netCloseLater(bc->epollFd, &vw->peer);
+        }
+        return;
+    }
+}
+
+/*! \fn static void shareFrame(broadcaster * bc, bcastFrame * frame, long long now)
+ * \brief Queue a frame taken from the ring for every viewer it is meant for
+ *
+ * A delta goes to the viewers in step and to the group of new viewers,
+ * a keyframe starts a new group and brings the waiting viewers in step
+ */
+static void shareFrame(broadcaster * bc, bcastFrame * frame, long long now) {
+    bcastViewer * vw;
+    size_t i;
+
+    if (frame->gap) {                                                   // the deltas before it were lost
+        releaseGroup(bc);
+        for (i = 0; i < bc->viewerCount; i++) {
+            bc->viewers[i]->waitKey = 1;
+        }
+    }
+    if (frame->keyframe || (bc->groupCount == BCASTQUEUE)) {           // a full group would not fit in a new queue
+        releaseGroup(bc);
+    }
+    if (frame->keyframe || (bc->groupCount > 0)) {
+        bc->group[bc->groupCount++] = frame;
+        frame->refs++;
+    }
+    for (i = 0; i < bc->viewerCount; i++) {
+        vw = bc->viewers[i];
+        if (vw->peer.closing) {
+            continue;
+        }
+        if (vw->waitKey ? frame->keyframe : frame->delta) {
+            vw->waitKey = 0;
+            queueFrame(bc, vw, frame, now);
+        }
+    }
+    releaseFrame(frame);                                                // reference of the ring
+}
+
+/*! \fn static void fanOut(broadcaster * bc)
+ * \brief Take the handed off frames, queue them and send to every viewer, drop the closed and stalled viewers
+ */
+static void fanOut(broadcaster * bc) {
+    long long now = statsNow();
+    bcastViewer * vw;
+    size_t tail = bc->tail, head = __atomic_load_n(&bc->head, __ATOMIC_ACQUIRE), i;
+
+    while (tail != head) {
+        shareFrame(bc, bc->ring[tail & (BCASTRING - 1)], now);
+        tail++;
+    }
+    __atomic_store_n(&bc->tail, tail, __ATOMIC_RELEASE);                // slots free after the frames were taken
+
+    for (i = 0; i < bc->viewerCount; ) {
+        vw = bc->viewers[i];
+        if (!vw->peer.closing && (vw->count > 0) && (now - vw->lastSent > BCASTSTALLNS)) {
+            netCloseLater(bc->epollFd, &vw->peer);
+            bc->dropped++;
+        }
+        if (vw->peer.closing) {
+            removeViewer(bc, vw);                                       // the last viewer moved to i
+            continue;
+        }
+        if (!vw->peer.writeWatched && (vw->count > 0)) {
+            sendViewer(bc, vw, now);                                    // the others wait for EPOLLOUT
+        }
+        i++;
+    }
+    netResume(bc->epollFd, &bc->listenFd, &bc->listenPaused);         // a closed viewer, or another process, may have freed one
+    histogramRecord(&bc->fanoutNs, (unsigned long long) (statsNow() - now));
+}
+
+/*! \fn static void * senderMain(void * argument)
+ * \brief Sender thread: accept viewers, share and send the frames until stopped
+ */
+static void * senderMain(void * argument) {
+    broadcaster * bc = argument;
+    struct epoll_event events[MAXEVENTS];
+    bcastViewer * vw;
+    uint64_t wakeups;
+    int count, i, woken;
+
+    while (!__atomic_load_n(&bc->stopping, __ATOMIC_ACQUIRE)) {
+        count = epoll_wait(bc->epollFd, events, MAXEVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        woken = 0;
+        pthread_mutex_lock(&bc->lock);                                  // held while working, not while waiting
+        for (i = 0; i < count; i++) {
+            if (events[i].data.ptr == &bc->listenFd) {
+                acceptViewers(bc);
+            } else if (events[i].data.ptr == &bc->wakeFd) {
+                woken = read(bc->wakeFd, &wakeups, sizeof(wakeups)) > 0;
+            } else {
+                vw = events[i].data.ptr;
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    readViewer(bc, vw);
+                }
+                if ((events[i].events & EPOLLOUT) && !vw->peer.closing) {
+                    sendViewer(bc, vw, statsNow());                     // closed viewers are removed with the next frame
+                }
+            }
+        }
+        if (woken) {                                                    // after the batch, its events may name removed viewers
+            fanOut(bc);
+        }
+        pthread_mutex_unlock(&bc->lock);
+    }
+    return NULL;
+}
+
+/*! \fn static void closeDescriptors(broadcaster * bc)
+ * \brief Close the sockets and event descriptors that were opened
+ */
+static void closeDescriptors(broadcaster * bc) {
+    if (bc->listenFd >= 0) {
+        close(bc->listenFd);
+    }
+    if (bc->epollFd >= 0) {
+        close(bc->epollFd);
+    }
+    if (bc->wakeFd >= 0) {
+        close(bc->wakeFd);
+    }
+}
+
+int bcastStart(broadcaster * bc, int port, int width, int height, int keyInterval) {
+    /*! \var struct epoll_event event
+     *  \brief Registration of the listening socket and the wake up counter
+     */
+    struct epoll_event event;
+
+    memset(bc, 0, sizeof(*bc));
+    bc->listenFd = bc->epollFd = bc->wakeFd = -1;
+    if ((keyInterval < 1) || (keyInterval > BCASTMAXKEYINTERVAL)
+        || (arenaInit(&bc->memory, 2 * renderMemorySize(width, height)) != 0)) {
+        return -1;
+    }
+    (void) renderInit(&bc->delta, -1, width, height, &bc->memory);     // the arena is sized for both
+    (void) renderInit(&bc->key, -1, width, height, &bc->memory);
+    bc->keyInterval = keyInterval;
+    histogramReset(&bc->publishNs);
+    histogramReset(&bc->fanoutNs);
+    bc->wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    bc->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if ((bc->wakeFd < 0) || (bc->epollFd < 0) || ((bc->listenFd = netListen(port, 0)) < 0)) {
+        closeDescriptors(bc);
+        arenaFree(&bc->memory);
+        return -1;
+    }
+    event.events = EPOLLIN;
+    event.data.ptr = &bc->listenFd;
+    if (epoll_ctl(bc->epollFd, EPOLL_CTL_ADD, bc->listenFd, &event) == 0) {
+        event.data.ptr = &bc->wakeFd;
+        if ((epoll_ctl(bc->epollFd, EPOLL_CTL_ADD, bc->wakeFd, &event) == 0)
+            && (pthread_mutex_init(&bc->lock, NULL) == 0)) {
+            if (pthread_create(&bc->thread, NULL, senderMain, bc) == 0) {
+                return 0;
+            }
+            pthread_mutex_destroy(&bc->lock);
+        }
+    }
+    closeDescriptors(bc);
+    arenaFree(&bc->memory);
+    return -1;
+} // bcastStart function ends
+
+int bcastPublish(broadcaster * bc, const bitboard * occupied, const coord * apple, dirtyList * dirty, int score) {
+    /*! \var long long start
+     *  \brief Time the encoding started
+     */
+    long long start = statsNow();
+    /*! \var bcastFrame * frames[2]
+     *  \brief Delta and keyframe of this tick
+     */
+    bcastFrame * frames[2];
+    /*! \var int count, keyframe, i
+     *  \brief Number of frames, true if the delta draws the complete screen, loop index
+     */
+    int count = 0, keyframe, i;
+    /*! \var size_t head
+     *  \brief Own position in the ring
+     */
+    size_t head = bc->head;
+
+    keyframe = bc->delta.fullRepaint;                                   // the first frame draws everything anyway
+    (void) renderDirty(&bc->delta, occupied, apple, dirty, score);      // capture mode, can not fail
+    frames[count++] = newFrame(&bc->delta, bc->ticks, keyframe, 1);
+    if (!keyframe && (bc->lost || (bc->ticks % (unsigned long) bc->keyInterval == 0))) {
+        bc->key.fullRepaint = 1;
+        (void) renderFrame(&bc->key, occupied, apple, score);
+        frames[count++] = newFrame(&bc->key, bc->ticks, 1, 0);     // only for the viewers waiting for it
+    }
+    bc->ticks++;
+
+    if ((frames[0] == NULL) || (frames[count - 1] == NULL)
+        || (head + (size_t) count - __atomic_load_n(&bc->tail, __ATOMIC_ACQUIRE) > BCASTRING)) {
+        for (i = 0; i < count; i++) {
+            free(frames[i]);
+        }
+        bc->lost = 1;                                                   // the viewers catch up with the next keyframe
+        bc->handoffLost++;
+        histogramRecord(&bc->publishNs, (unsigned long long) (statsNow() - start));
+        return -1;
+    }
+    frames[0]->gap = bc->lost;
+    bc->lost = 0;
+    for (i = 0; i < count; i++) {
+        bc->ring[(head + (size_t) i) & (BCASTRING - 1)] = frames[i];
+    }
+    __atomic_store_n(&bc->head, head + (size_t) count, __ATOMIC_RELEASE);  // frames visible before the new head
+    notify(bc->wakeFd);
+    histogramRecord(&bc->publishNs, (unsigned long long) (statsNow() - start));
+    return 0;
+} // bcastPublish function ends
+
+void bcastRepaint(broadcaster * bc) {
+    bc->delta.fullRepaint = 1;
+} // bcastRepaint function ends
+
+void bcastStop(broadcaster * bc) {
+    /*! \var size_t tail
+     *  \brief Frames not taken by the sender thread start here
+     */
+    size_t tail;
+
+    __atomic_store_n(&bc->stopping, 1, __ATOMIC_RELEASE);
+    notify(bc->wakeFd);
+    pthread_join(bc->thread, NULL);
+    while (bc->viewerCount > 0) {
+        removeViewer(bc, bc->viewers[bc->viewerCount - 1]);
+    }
+    releaseGroup(bc);
+    for (tail = bc->tail; tail != bc->head; tail++) {
+        releaseFrame(bc->ring[tail & (BCASTRING - 1)]);
+    }
+    free(bc->viewers);
+    pthread_mutex_destroy(&bc->lock);
+    closeDescriptors(bc);
+    arenaFree(&bc->memory);
+} // bcastStop function ends
+
+// End of broadcast.c
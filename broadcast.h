@@ -0,0 +1,201 @@
+/*! \file broadcast.h
+ * \brief Spectator broadcast header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Streams one live game to many viewers connecting over TCP. The game
+ * thread encodes every tick once: a renderer in capture mode turns the
+ * changed cells of the tick into a delta frame, and every keyInterval
+ * ticks a second renderer draws a keyframe, the complete screen. Each
+ * frame is one reference counted buffer handed to the sender thread
+ * through a single producer, single consumer ring, so the tick costs the
+ * same for one viewer or thousands. The sender thread queues pointers to
+ * the shared buffers for every viewer and gives them to the sockets with
+ * sendmsg(), the bytes are never copied per viewer. A new viewer gets the
+ * last keyframe and the deltas since then. A viewer whose queue is full
+ * loses its queued frames and waits for the next keyframe; one that takes
+ * no bytes for BCASTSTALLNS is disconnected.
+ */
+
+#ifndef SNAKEGAME_BROADCAST_H
+#define SNAKEGAME_BROADCAST_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include "engine.h"
+#include "memarena.h"
+#include "netpeer.h"
+#include "render.h"
+#include "stats.h"
+
+/*! \def BCASTRING
+ *  \brief Frames in flight from the game thread to the sender thread, a power of 2
+ */
+#define BCASTRING 64
+
+/*! \def BCASTQUEUE
+ *  \brief Frames queued for one viewer before it has to wait for a keyframe
+ */
+#define BCASTQUEUE 32
+
+/*! \def BCASTMAXKEYINTERVAL
+ *  \brief Longest keyframe interval, a new viewer's first frames must fit in its queue
+ */
+#define BCASTMAXKEYINTERVAL (BCASTQUEUE / 2)
+
+/*! \def BCASTSTALLNS
+ *  \brief A viewer that takes no bytes for this long while frames wait is disconnected
+ */
+#define BCASTSTALLNS (10 * 1000000000LL)
+
+/*! \typedef struct bcastFrame
+ *  \brief One encoded frame shared by all viewers
+ *
+ * \var int refs Number of viewer queues and keyframe group slots holding the frame, only the sender thread changes it
+ * \var int keyframe True if the frame draws the complete screen, a viewer may start with it
+ * \var int delta True if the frame follows the previous one, for the viewers in step; a keyframe drawn only for the waiting viewers is not
+ * \var int gap True if frames were lost before this one, every viewer has to wait for a keyframe
+ * \var unsigned long tick Tick of the game the frame shows
+ * \var size_t length Number of bytes in data
+ * \var char data[] Terminal output of the frame
+ */
+typedef struct bcastFrame_t {
+    int refs;
+    int keyframe;
+    int delta;
+    int gap;
+    unsigned long tick;
+    size_t length;
+    char data[];
+} bcastFrame;
+
+/*! \typedef struct bcastViewer
+ *  \brief Contains one connected viewer
+ *
+ * \var netPeer peer Socket and its epoll registration
+ * \var bcastFrame * queue[BCASTQUEUE] Frames waiting for the socket, a ring
+ * \var unsigned first, count First waiting frame in queue and the number of waiting frames
+ * \var size_t offset Bytes of the first waiting frame already sent
+ * \var int waitKey True while the viewer is out of step and waits for the next keyframe
+ * \var long long lastSent Time the socket last took bytes or had nothing to take
+ * \var size_t index Position in the viewer list
+ */
+typedef struct bcastViewer_t {
+    netPeer peer;
+    bcastFrame * queue[BCASTQUEUE];
+    unsigned first;
+    unsigned count;
+    size_t offset;
+    int waitKey;
+    long long lastSent;
+    size_t index;
+} bcastViewer;
+
+/*! \typedef struct broadcaster
+ *  \brief Contains the encoders, the hand-off ring, the sender thread and its viewers
+ *
+ * \var memArena memory Memory of the renderers
+ * \var renderer delta Renderer of the delta frames, game thread only
+ * \var renderer key Renderer of the keyframes, game thread only
+ * \var int keyInterval Ticks between keyframes
+ * \var unsigned long ticks Frames published
+ * \var int lost True if a frame could not be handed off, the next one is a keyframe with the gap flag
+ * \var bcastFrame * ring[BCASTRING] Frames handed off to the sender thread
+ * \var size_t head, tail Written by the game thread and by the sender thread
+ * \var int listenFd Listening socket
+ * \var int listenPaused True while listenFd is out of epoll because the descriptors ran out
+ * \var int epollFd Epoll instance of the sender thread
+ * \var int wakeFd Event counter the game thread bumps after a hand-off
+ * \var int stopping Set to end the sender thread
+ * \var pthread_t thread The sender thread
+ * \var bcastFrame * group[BCASTQUEUE] Last keyframe and the deltas since, sent to new viewers
+ * \var int groupCount Number of frames in group, 0 until the first keyframe
+ * \var bcastViewer ** viewers Connected viewers
+ * \var size_t viewerCount, viewerSlots Number of viewers, size of the viewers array
+ * \var histogram publishNs Time the game thread spends per tick encoding and handing off, game thread only
+ * \var unsigned long handoffLost Ticks lost because of a full ring or no memory, game thread only
+ * \var pthread_mutex_t lock Guards the viewers, the counters and fanoutNs, the sender thread holds it while it works, not while it waits
+ * \var histogram fanoutNs Time the sender thread spends per tick queueing and sending to all viewers
+ * \var unsigned long long framesQueued Frames queued for viewers, counted once per viewer
+ * \var unsigned long long bytesSent Bytes taken by the viewer sockets
+ * \var unsigned long joined, closed, resyncs, dropped Viewers connected, disconnected, sent back to wait for a keyframe, disconnected as stalled
+ */
+typedef struct broadcaster_t {
+    memArena memory;
+    renderer delta;
+    renderer key;
+    int keyInterval;
+    unsigned long ticks;
+    int lost;
+    bcastFrame * ring[BCASTRING];
+    size_t head;
+    size_t tail;
+    int listenFd;
+    int listenPaused;
+    int epollFd;
+    int wakeFd;
+    int stopping;
+    pthread_t thread;
+    bcastFrame * group[BCASTQUEUE];
+    int groupCount;
+    bcastViewer ** viewers;
+    size_t viewerCount;
+    size_t viewerSlots;
+    histogram publishNs;
+    unsigned long handoffLost;
+    pthread_mutex_t lock;
+    histogram fanoutNs;
+    unsigned long long framesQueued;
+    unsigned long long bytesSent;
+    unsigned long joined;
+    unsigned long closed;
+    unsigned long resyncs;
+    unsigned long dropped;
+} broadcaster;
+
+/*! \fn int bcastStart(broadcaster * bc, int port, int width, int height, int keyInterval)
+ * \brief Open the listening socket and start the sender thread
+ *
+ * \param bc Pointer to broadcaster
+ * \param port TCP port of the viewers
+ * \param width Number of columns of the board
+ * \param height Number of rows of the board
+ * \param keyInterval Ticks between keyframes, 1..BCASTMAXKEYINTERVAL
+ * \return int 0 on success, -1 on bad settings, memory, socket or thread creation error
+ */
+int bcastStart(broadcaster * bc, int port, int width, int height, int keyInterval);
+
+/*! \fn int bcastPublish(broadcaster * bc, const bitboard * occupied, const coord * apple, dirtyList * dirty, int score)
+ * \brief Encode one tick of the game and hand it to the sender thread, never waits for the viewers
+ *
+ * Called by the game thread after the step, with the same arguments as renderDirty
+ *
+ * \param bc Pointer to broadcaster
+ * \param occupied Occupancy grid of the game
+ * \param apple Position of the apple, NULL if there is none
+ * \param dirty Cells changed in this tick
+ * \param score Players current score
+ * \return int 0 on success, -1 if the frame was lost (no memory or ring full), the viewers catch up with the next keyframe
+ */
+int bcastPublish(broadcaster * bc, const bitboard * occupied, const coord * apple, dirtyList * dirty, int score);
+
+/*! \fn void bcastRepaint(broadcaster * bc)
+ * \brief Make the next published frame a keyframe, for a new game on the same broadcaster
+ *
+ * \param bc Pointer to broadcaster
+ * \return void No values returned
+ */
+void bcastRepaint(broadcaster * bc);
+
+/*! \fn void bcastStop(broadcaster * bc)
+ * \brief Stop the sender thread, disconnect the viewers and release everything
+ *
+ * \param bc Pointer to broadcaster
+ * \return void No values returned
+ */
+void bcastStop(broadcaster * bc);
+
+#endif //SNAKEGAME_BROADCAST_H
+
+// End of broadcast.h
@@ -0,0 +1,92 @@
+/*! \file engine.c
+ * \brief Headless game engine
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#include "engine.h"
+
+size_t gameMemorySize(int width, int height) {
+    return bitboardMemorySize(width, height) + snakeMemorySize(width, height) + freeCellsMemorySize(width, height);
+} // gameMemorySize function ends
+
+int gameInit(gameState * game, int width, int height, uint64_t seed, memArena * arena) {
+    if ((initBitboard(&game->occupied, width, height, arena) != 0)
+        || (initSnake(&game->player, width, height, arena) != 0)
+        || (initFreeCells(&game->freeIndex, &game->player, width, height, arena) != 0)) {
+        return -1;
+    }
+    game->stats = NULL;                                                 // kept over gameReset
+    gameReset(game, seed);
+    return 0;
+} // gameInit function ends
+
+void gameReset(gameState * game, uint64_t seed) {
+    initSnake(&game->player, game->occupied.width, game->occupied.height, NULL);   // memory is reused
+    initFreeCells(&game->freeIndex, &game->player, game->occupied.width, game->occupied.height, NULL);
+    game->appleCount = 0;
+    game->score = 0;
+    game->running = 1;
+    rngSeed(&game->rng, seed);
+    game->ticks = 0;
+    game->dirty.count = 0;
+    updateBitboard(&game->occupied, &game->player);                     // built once, later only changes are applied
+} // gameReset function ends
+
+int gameStep(gameState * game, unsigned char input) {
+    /*! \var coord * head
+     *  \brief Position of the snake head after the move
+     */
+    coord * head;
+    /*! \var int blocked
+     *  \brief 1 if the new head is on a wall or on the body before the move is applied
+     */
+    int blocked;
+    /*! \var int ate
+     *  \brief 1 if the new head is on the apple
+     */
+    int ate;
+
+    if (!game->running) {
+        return 0;
+    }
+    game->dirty.count = 0;
+    game->ticks++;
+
+    updateSnakeDirection(&game->player, input);                         // update snake direction according to input
+    updateSnakeTracked(&game->player, &game->dirty);                    // update snake position and length, collect changed cells
+    statsLap(game->stats, STATSNAKE);
+    head = &game->player.position[game->player.head];
+
+    // check snake collision: the head is at most one cell outside the board, on the wall border of the grid
+    blocked = bitTest(&game->occupied, head->x, head->y);              // Snake hits wall or itself
+    ate = (head->x == game->apple.x) & (head->y == game->apple.y) & (game->appleCount != 0);
+    game->running = !blocked;
+    game->score += APPLESCORE * ate;                                    // Snake eats apple
+    game->appleCount -= ate;
+    game->player.snakeSupposedLength += (size_t) ate;
+    statsLap(game->stats, STATCOLLISION);
+    if (((unsigned) head->x >= (unsigned) game->occupied.width) | ((unsigned) head->y >= (unsigned) game->occupied.height)) {
+        game->dirty.count = 0;                                          // nothing to apply outside the board
+        return 0;
+    }
+
+    updateFreeCells(&game->freeIndex, &game->dirty);                    // head cell taken, tail cell released
+
+    if (game->appleCount == 0) {                                        // if no apple, find position for apple
+        game->appleCount = placeAppleFree(&game->apple, &game->player, &game->freeIndex, &game->rng);
+        if (game->appleCount == 0) {                                    // no more apple possible...
+            game->running = 0;                                          // ..so the game ends
+        } else {
+            markApple(&game->apple, &game->dirty);
+        }
+    }
+    statsLap(game->stats, STATAPPLE);
+
+    applyDirtyBits(&game->occupied, &game->dirty);                      // update changed cells of the grid
+    statsLap(game->stats, STATBOARD);
+    return game->running;
+} // gameStep function ends
+
+// End of engine.c
@@ -0,0 +1,104 @@
+/*! \file engine.h
+ * \brief Headless game engine header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * The complete rules of one game behind a single step function,
+ * without any terminal input or output, for bots, benchmarks and regression runs
+ */
+
+#ifndef SNAKEGAME_ENGINE_H
+#define SNAKEGAME_ENGINE_H
+
+#include <stdint.h>
+#include "snake.h"
+#include "freecells.h"
+#include "bitboard.h"
+#include "memarena.h"
+#include "stats.h"
+
+/*! \def APPLESCORE
+ *  \brief Points given for one apple
+ */
+#define APPLESCORE 10
+
+/*! \typedef struct gameState
+ *  \brief Contains the complete state of one game
+ *
+ * \var bitboard occupied Cells of the snake body and the walls around the board, always up to date
+ * \var snake player The players snake
+ * \var freeCells freeIndex Cells not covered by the snake
+ * \var dirtyList dirty Board cells changed in the last step
+ * \var coord apple Coordinate of the apple
+ * \var int appleCount Number of apples currently on board
+ * \var int score Score achieved by player
+ * \var int running True while the game runs, set to false when the game is over
+ * \var rngState rng Random number generator of the game
+ * \var unsigned long ticks Number of steps made
+ * \var tickStats * stats Instrumentation timing the phases of a step, NULL when not used
+ */
+typedef struct gameState_t {
+    bitboard occupied;
+    snake player;
+    freeCells freeIndex;
+    dirtyList dirty;
+    coord apple;
+    int appleCount;
+    int score;
+    int running;
+    rngState rng;
+    unsigned long ticks;
+    tickStats * stats;
+} gameState;
+
+/*! \fn size_t gameMemorySize(int width, int height)
+ * \brief Arena space needed by one game
+ *
+ * \param width Number of columns
+ * \param height Number of rows
+ * \return size_t Number of bytes
+ */
+size_t gameMemorySize(int width, int height);
+
+/*! \fn int gameInit(gameState * game, int width, int height, uint64_t seed, memArena * arena)
+ * \brief Set up a new game
+ *
+ * Memory is taken from the arena, the snake is placed at the center of the board
+ * The first apple is placed by the first step
+ *
+ * \param game Pointer to game
+ * \param width Number of columns
+ * \param height Number of rows
+ * \param seed Random number seed, the same seed and inputs give the same game
+ * \param arena Memory arena
+ * \return int 0 on success, -1 if the arena is exhausted
+ */
+int gameInit(gameState * game, int width, int height, uint64_t seed, memArena * arena);
+
+/*! \fn void gameReset(gameState * game, uint64_t seed)
+ * \brief Start a new game in the memory of a finished one
+ *
+ * \param game Pointer to game
+ * \param seed Random number seed
+ * \return void No values returned
+ */
+void gameReset(gameState * game, uint64_t seed);
+
+/*! \fn int gameStep(gameState * game, unsigned char input)
+ * \brief Advance the game by one tick
+ *
+ * Turns the snake according to input, moves it, checks collision with walls and itself
+ * in one bit test, eats and places apples, and updates the occupancy grid
+ * The changed cells are left in game->dirty for rendering
+ * With game->stats set each phase is timed from the previous probe (see statsBegin)
+ *
+ * \param game Pointer to game
+ * \param input New direction u, d, l, r or any other value for no change
+ * \return int 1 while the game runs, 0 when the game is over
+ */
+int gameStep(gameState * game, unsigned char input);
+
+#endif //SNAKEGAME_ENGINE_H
+
+// End of engine.h
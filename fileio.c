@@ -0,0 +1,147 @@
+/*! \file fileio.c
+ * \brief File helpers of the stores
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "fileio.h"
+
+/*! \var static uint32_t crcTable[8][256]
+ *  \brief CRC32 tables for 8 bytes per step, built on first use
+ */
+static uint32_t crcTable[8][256];
+
+/*! \var static pthread_once_t crcOnce
+ *  \brief Builds crcTable once
+ */
+static pthread_once_t crcOnce = PTHREAD_ONCE_INIT;
+
+/*! \fn static void crcInit(void)
+ * \brief Fill the CRC tables
+ */
+static void crcInit(void) {
+    uint32_t crc;
+    int i, bit, k;
+
+    for (i = 0; i < 256; i++) {
+        crc = (uint32_t) i;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (uint32_t) -(int32_t) (crc & 1));
+        }
+        crcTable[0][i] = crc;
+    }
+    for (i = 0; i < 256; i++) {
+        for (k = 1; k < 8; k++) {
+            crcTable[k][i] = (crcTable[k - 1][i] >> 8) ^ crcTable[0][crcTable[k - 1][i] & 255];
+        }
+    }
+}
+
+uint32_t fileCrc32(uint32_t crc, const void * data, size_t size) {
+    /*! \var const unsigned char * bytes
+     *  \brief Next byte to add
+     */
+    const unsigned char * bytes = data;
+    /*! \var uint32_t high
+     *  \brief Upper 4 bytes of a step, little endian
+     */
+    uint32_t high;
+
+    pthread_once(&crcOnce, crcInit);
+    crc = ~crc;
+    while (size >= 8) {                                                 // a large snapshot is checked in microseconds
+        crc ^= (uint32_t) bytes[0] | ((uint32_t) bytes[1] << 8) | ((uint32_t) bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+        high = (uint32_t) bytes[4] | ((uint32_t) bytes[5] << 8) | ((uint32_t) bytes[6] << 16) | ((uint32_t) bytes[7] << 24);
+        crc = crcTable[7][crc & 255] ^ crcTable[6][(crc >> 8) & 255] ^ crcTable[5][(crc >> 16) & 255] ^ crcTable[4][crc >> 24]
+              ^ crcTable[3][high & 255] ^ crcTable[2][(high >> 8) & 255] ^ crcTable[1][(high >> 16) & 255] ^ crcTable[0][high >> 24];
+        bytes += 8;
+        size -= 8;
+    }
+    while (size-- > 0) {
+        crc = (crc >> 8) ^ crcTable[0][(crc ^ *bytes++) & 255];
+    }
+    return ~crc;
+} // fileCrc32 function ends
+
+int fileWriteAll(int fd, const void * data, size_t size) {
+    /*! \var const unsigned char * bytes
+     *  \brief Next byte to write
+     */
+    const unsigned char * bytes = data;
+    /*! \var ssize_t result
+     *  \brief Bytes written by one call
+     */
+    ssize_t result;
+
+    while (size > 0) {
+        result = write(fd, bytes, size);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        bytes += result;
+        size -= (size_t) result;
+    }
+    return 0;
+} // fileWriteAll function ends
+
+int fileWriteAt(int fd, const void * data, size_t size, off_t offset) {
+    /*! \var const unsigned char * bytes
+     *  \brief Next byte to write
+     */
+    const unsigned char * bytes = data;
+    /*! \var ssize_t result
+     *  \brief Bytes written by one call
+     */
+    ssize_t result;
+
+    while (size > 0) {
+        result = pwrite(fd, bytes, size, offset);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        bytes += result;
+        offset += result;
+        size -= (size_t) result;
+    }
+    return 0;
+} // fileWriteAt function ends
+
+int fileReadAt(int fd, void * data, size_t size, off_t offset) {
+    /*! \var unsigned char * bytes
+     *  \brief Next byte to read
+     */
+    unsigned char * bytes = data;
+    /*! \var ssize_t result
+     *  \brief Bytes read by one call
+     */
+    ssize_t result;
+
+    while (size > 0) {
+        result = pread(fd, bytes, size, offset);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (result == 0) {
+            return -1;                                                  // the file ends before
+        }
+        bytes += result;
+        offset += result;
+        size -= (size_t) result;
+    }
+    return 0;
+} // fileReadAt function ends
+
+// End of fileio.c
@@ -0,0 +1,63 @@
+/*! \file fileio.h
+ * \brief File helpers of the stores header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * The leaderboard, the tournament results and the snapshots checksum
+ * their records with the same CRC32 and write them with the same loops,
+ * which retry interrupted and short reads and writes.
+ */
+
+#ifndef SNAKEGAME_FILEIO_H
+#define SNAKEGAME_FILEIO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*! \fn uint32_t fileCrc32(uint32_t crc, const void * data, size_t size)
+ * \brief CRC32 (IEEE polynomial, the one of zlib), 8 bytes per step
+ *
+ * \param crc CRC of the bytes before, 0 to start
+ * \param data Bytes to add
+ * \param size Number of bytes
+ * \return uint32_t CRC of the bytes before and data
+ */
+uint32_t fileCrc32(uint32_t crc, const void * data, size_t size);
+
+/*! \fn int fileWriteAll(int fd, const void * data, size_t size)
+ * \brief Write the whole buffer at the file position, retrying short writes
+ *
+ * \param fd File descriptor
+ * \param data Bytes to write
+ * \param size Number of bytes
+ * \return int 0 on success, -1 on error (errno set)
+ */
+int fileWriteAll(int fd, const void * data, size_t size);
+
+/*! \fn int fileWriteAt(int fd, const void * data, size_t size, off_t offset)
+ * \brief Write the whole buffer at an offset, retrying short writes
+ *
+ * \param fd File descriptor
+ * \param data Bytes to write
+ * \param size Number of bytes
+ * \param offset Position in the file
+ * \return int 0 on success, -1 on error (errno set)
+ */
+int fileWriteAt(int fd, const void * data, size_t size, off_t offset);
+
+/*! \fn int fileReadAt(int fd, void * data, size_t size, off_t offset)
+ * \brief Read size bytes at an offset, retrying short reads
+ *
+ * \param fd File descriptor
+ * \param data Buffer
+ * \param size Number of bytes
+ * \param offset Position in the file
+ * \return int 0 on success, -1 on error or if the file ends before
+ */
+int fileReadAt(int fd, void * data, size_t size, off_t offset);
+
+#endif //SNAKEGAME_FILEIO_H
+
+// End of fileio.h
@@ -0,0 +1,129 @@
+/*! \file freecells.c
+ * \brief Free cell index
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#include "freecells.h"
+
+#define EMPTYCHAR ' '
+#define SNAKECHAR 'o'
+
+/*! \fn static int cellNumber(freeCells * fc, coord * cell)
+ * \brief Number of the cell in the index, -1 if outside the board
+ */
+static int cellNumber(freeCells * fc, coord * cell) {
+    if ((cell->x < 0) || (cell->x >= fc->width) || (cell->y < 0) || (cell->y >= fc->height)) {
+        return -1;
+    }
+    return cell->y * fc->width + cell->x;
+}
+
+size_t freeCellsMemorySize(int width, int height) {
+    return 2 * ARENABLOCK((size_t) width * (size_t) height * sizeof(int));
+} // freeCellsMemorySize function ends
+
+int initFreeCells(freeCells * fc, snake * sn, int width, int height, memArena * arena) {
+    /*! \var size_t i
+     *  \brief Loop index variable
+     */
+    size_t i;
+    /*! \var size_t cellCount
+     *  \brief Number of cells on board
+     */
+    size_t cellCount = (size_t) width * (size_t) height;
+
+    if (arena != NULL) {
+        fc->cells = arenaAlloc(arena, cellCount * sizeof(int));
+        fc->slot = arenaAlloc(arena, cellCount * sizeof(int));
+        if ((fc->cells == NULL) || (fc->slot == NULL)) {
+            return -1;
+        }
+    }
+    fc->width = width;
+    fc->height = height;
+
+    for (i = 0; i < cellCount; i++) {                                   // every cell is free...
+        fc->cells[i] = (int) i;
+        fc->slot[i] = (int) i;
+    }
+    fc->count = cellCount;
+
+    i = sn->tail;                                                       // ...except the snake
+    while (1) {
+        takeFreeCell(fc, &sn->position[i]);
+        if (i == sn->head) {
+            break;
+        }
+        i++;
+        if (i == sn->capacity) {                                        // ring buffer wraps around
+            i = 0;
+        }
+    }
+    return 0;
+} // initFreeCells function ends
+
+void takeFreeCell(freeCells * fc, coord * cell) {
+    /*! \var int number, position, last
+     *  \brief Cell number, its place in the dense array, and the cell moved into its place
+     */
+    int number = cellNumber(fc, cell);
+    int position, last;
+
+    if ((number < 0) || (fc->slot[number] < 0)) {                      // outside or already occupied
+        return;
+    }
+    position = fc->slot[number];
+    last = fc->cells[fc->count - 1];
+    fc->cells[position] = last;                                         // last free cell fills the hole
+    fc->slot[last] = position;
+    fc->slot[number] = -1;
+    fc->count--;
+} // takeFreeCell function ends
+
+void releaseFreeCell(freeCells * fc, coord * cell) {
+    /*! \var int number
+     *  \brief Cell number
+     */
+    int number = cellNumber(fc, cell);
+
+    if ((number < 0) || (fc->slot[number] >= 0)) {                      // outside or already free
+        return;
+    }
+    fc->cells[fc->count] = number;                                      // append to the end
+    fc->slot[number] = (int) fc->count;
+    fc->count++;
+} // releaseFreeCell function ends
+
+void updateFreeCells(freeCells * fc, dirtyList * dirty) {
+    /*! \var size_t i
+     *  \brief Loop index variable
+     */
+    size_t i;
+
+    for (i = 0; i < dirty->count; i++) {                                // in order of change, so a head entering
+        if (dirty->cells[i].value == EMPTYCHAR) {                       // the vacated tail cell stays occupied
+            releaseFreeCell(fc, &dirty->cells[i].cell);
+        } else if (dirty->cells[i].value == SNAKECHAR) {
+            takeFreeCell(fc, &dirty->cells[i].cell);
+        }
+    }
+} // updateFreeCells function ends
+
+int placeAppleFree(coord * apple, snake * sn, freeCells * fc, rngState * rng) {
+    /*! \var int number
+     *  \brief Number of the chosen cell
+     */
+    int number;
+
+    if ((sn->snakeSupposedLength == sn->capacity) || (fc->count == 0)) {  // snake covering the whole board
+        return 0;
+    }
+    number = fc->cells[rngBounded(rng, (uint32_t) fc->count)];          // any free cell, equal chance
+    apple->x = number % fc->width;
+    apple->y = number / fc->width;
+    return 1;
+} // placeAppleFree function ends
+
+// End of freecells.c
@@ -0,0 +1,113 @@
+/*! \file freecells.h
+ * \brief Free cell index header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Keeps the list of board cells not covered by the snake,
+ * so an apple position can be drawn in constant time
+ */
+
+#include <stddef.h>
+#include "snake.h"
+#include "rng.h"
+
+#ifndef SNAKEGAME_FREECELLS_H
+#define SNAKEGAME_FREECELLS_H
+
+/*! \typedef struct freeCells
+ *  \brief Contains the free cells of the board
+ *
+ * Cells are numbered row by row: y * width + x
+ * Removal swaps the last free cell into the place of the removed one
+ *
+ * \var int width Number of columns of the board
+ * \var int height Number of rows of the board
+ * \var int * cells Dense array of free cell numbers, first count elements are valid
+ * \var int * slot Position of each cell in cells array, -1 if the cell is occupied
+ * \var size_t count Number of free cells
+ */
+typedef struct freeCells_t {
+    int width;
+    int height;
+    int * cells;
+    int * slot;
+    size_t count;
+} freeCells;
+
+/*! \fn size_t freeCellsMemorySize(int width, int height)
+ * \brief Arena space needed by the free cell index of a board
+ *
+ * \param width Number of columns
+ * \param height Number of rows
+ * \return size_t Number of bytes
+ */
+size_t freeCellsMemorySize(int width, int height);
+
+/*! \fn int initFreeCells(freeCells * fc, snake * sn, int width, int height, memArena * arena)
+ * \brief Build the free cell index
+ *
+ * All cells are free except the ones covered by the snake
+ * If arena is NULL, the arrays already taken are reused (the board size must be the same)
+ *
+ * \param fc Pointer to free cell index
+ * \param sn Pointer to snake
+ * \param width Number of columns
+ * \param height Number of rows
+ * \param arena Memory arena or NULL
+ * \return int 0 on success, -1 if the arena is exhausted
+ */
+int initFreeCells(freeCells * fc, snake * sn, int width, int height, memArena * arena);
+
+/*! \fn void takeFreeCell(freeCells * fc, coord * cell)
+ * \brief Mark a cell occupied
+ *
+ * Nothing happens if the cell is already occupied or outside the board
+ *
+ * \param fc Pointer to free cell index
+ * \param cell Position of the cell
+ * \return void No values returned
+ */
+void takeFreeCell(freeCells * fc, coord * cell);
+
+/*! \fn void releaseFreeCell(freeCells * fc, coord * cell)
+ * \brief Mark a cell free
+ *
+ * Nothing happens if the cell is already free or outside the board
+ *
+ * \param fc Pointer to free cell index
+ * \param cell Position of the cell
+ * \return void No values returned
+ */
+void releaseFreeCell(freeCells * fc, coord * cell);
+
+/*! \fn void updateFreeCells(freeCells * fc, dirtyList * dirty)
+ * \brief Follow the snake move in the free cell index
+ *
+ * Vacated tail cells are released, new head cells are taken
+ * Apple cells do not change the index, the apple is not an obstacle
+ *
+ * \param fc Pointer to free cell index
+ * \param dirty Cells changed by updateSnakeTracked
+ * \return void No values returned
+ */
+void updateFreeCells(freeCells * fc, dirtyList * dirty);
+
+/*! \fn int placeAppleFree(coord * apple, snake * sn, freeCells * fc, rngState * rng)
+ * \brief Place an apple on a random free cell
+ *
+ * Same as placeApple, but the position is drawn from the free cell index
+ * in constant time instead of retrying random positions
+ * The random number state is owned by the caller, so each game is reproducible
+ *
+ * \param apple Pointer to apple
+ * \param sn Pointer to snake
+ * \param fc Pointer to free cell index
+ * \param rng Random number generator of the game
+ * \return int No. of placed apples returned
+ */
+int placeAppleFree(coord * apple, snake * sn, freeCells * fc, rngState * rng);
+
+#endif //SNAKEGAME_FREECELLS_H
+
+// End of freecells.h
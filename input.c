@@ -0,0 +1,226 @@
+/*! \file input.c
+ * \brief Keyboard input thread
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include "input.h"
+
+#define NSEC_PER_MSEC 1000000LL
+#define READSIZE 64
+
+long long inputNow(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long) now.tv_sec * 1000000000LL + now.tv_nsec;
+} // inputNow function ends
+
+int keyRingPush(keyRing * ring, const keyEvent * event) {
+    /*! \var size_t head, tail
+     *  \brief Own position and the position published by the consumer
+     */
+    size_t head = ring->head, tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    if (head - tail == KEYRINGSIZE) {
+        ring->dropped++;
+        return -1;
+    }
+    ring->events[head & (KEYRINGSIZE - 1)] = *event;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);          // event visible before the new head
+    return 0;
+} // keyRingPush function ends
+
+int keyRingPop(keyRing * ring, keyEvent * event) {
+    /*! \var size_t tail, head
+     *  \brief Own position and the position published by the producer
+     */
+    size_t tail = ring->tail, head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+    if (tail == head) {
+        return 0;
+    }
+    *event = ring->events[tail & (KEYRINGSIZE - 1)];
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);          // slot free after it was copied
+    return 1;
+} // keyRingPop function ends
+
+int keyParse(keyParser * parser, unsigned char byte, long long timeNs, keyEvent * keys) {
+    /*! \var int count
+     *  \brief Number of keys completed
+     */
+    int count = 0;
+
+    if (parser->state == 1) {                                           // after ESC
+        if ((byte == '[') || (byte == 'O')) {
+            parser->state = 2;
+            return 0;
+        }
+        keys[count].key = KEYESCAPE;                                    // ESC on its own, byte is a new key
+        keys[count++].timeNs = parser->escapeNs;
+        parser->state = 0;
+    } else if (parser->state == 2) {                                    // after ESC [ or ESC O
+        if ((byte >= 0x40) && (byte <= 0x7E)) {                         // final byte ends the sequence
+            parser->state = 0;
+            if ((byte >= 'A') && (byte <= 'D')) {
+                keys[count].key = (unsigned char) "udrl"[byte - 'A'];
+                keys[count++].timeNs = timeNs;
+            }
+        }
+        return count;                                                   // parameters of other sequences are skipped
+    }
+
+    if (byte == KEYESCAPE) {
+        parser->state = 1;
+        parser->escapeNs = timeNs;
+    } else if (byte == ' ') {
+        keys[count].key = ' ';
+        keys[count++].timeNs = timeNs;
+    } else if ((byte == 'h') || (byte == 'H')) {
+        keys[count].key = KEYHUD;
+        keys[count++].timeNs = timeNs;
+    }
+    return count;
+} // keyParse function ends
+
+int keyParseTimeout(keyParser * parser, long long nowNs, keyEvent * key) {
+    if ((parser->state != 1) || (nowNs - parser->escapeNs < ESCTIMEOUTMS * NSEC_PER_MSEC)) {
+        return 0;
+    }
+    parser->state = 0;
+    key->key = KEYESCAPE;
+    key->timeNs = parser->escapeNs;
+    return 1;
+} // keyParseTimeout function ends
+
+/*! \fn static void notify(int fd)
+ * \brief Wake up the game loop
+ */
+static void notify(int fd) {
+    uint64_t one = 1;
+    (void) write(fd, &one, sizeof(one));
+}
+
+/*! \fn static void pushKeys(inputReader * in, const keyEvent * keys, int count)
+ * \brief Queue parsed keys, an ESC also wakes up the game loop
+ */
+static void pushKeys(inputReader * in, const keyEvent * keys, int count) {
+    int i;
+
+    for (i = 0; i < count; i++) {
+        (void) keyRingPush(&in->ring, &keys[i]);
+        if (keys[i].key == KEYESCAPE) {
+            __atomic_store_n(&in->escape, 1, __ATOMIC_RELEASE);
+            notify(in->notifyFd);
+        }
+    }
+}
+
+/*! \fn static void * readerThread(void * argument)
+ * \brief Input thread: wait for bytes, timestamp and parse them as soon as they arrive
+ */
+static void * readerThread(void * argument) {
+    inputReader * in = argument;
+    struct pollfd fds[2];
+    unsigned char bytes[READSIZE];
+    keyEvent keys[2];
+    long long now;
+    ssize_t length, i;
+    int timeout;
+
+    fds[0].fd = in->fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = in->stopFd;
+    fds[1].events = POLLIN;
+    for (;;) {
+        timeout = in->parser.state == 1 ? ESCTIMEOUTMS : -1;            // a lone ESC waits for the rest of a sequence
+        if (poll(fds, 2, timeout) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        now = inputNow();
+        if (fds[1].revents & POLLIN) {
+            break;                                                      // game ends
+        }
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            length = read(in->fd, bytes, sizeof(bytes));
+            if ((length < 0) && ((errno == EINTR) || (errno == EAGAIN))) {
+                continue;
+            }
+            if (length <= 0) {                                          // end of input
+                break;
+            }
+            for (i = 0; i < length; i++) {
+                pushKeys(in, keys, keyParse(&in->parser, bytes[i], now, keys));
+            }
+        }
+        if (keyParseTimeout(&in->parser, inputNow(), keys)) {
+            pushKeys(in, keys, 1);
+        }
+    }
+    if (keyParseTimeout(&in->parser, inputNow() + ESCTIMEOUTMS * NSEC_PER_MSEC, keys)) {
+        pushKeys(in, keys, 1);                                          // ESC as the last byte
+    }
+    __atomic_store_n(&in->closed, 1, __ATOMIC_RELEASE);
+    notify(in->notifyFd);
+    return NULL;
+}
+
+int inputStart(inputReader * in, int fd) {
+    memset(in, 0, sizeof(*in));
+    in->fd = fd;
+    in->stopFd = eventfd(0, EFD_CLOEXEC);
+    in->notifyFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if ((in->stopFd < 0) || (in->notifyFd < 0) || (pthread_create(&in->thread, NULL, readerThread, in) != 0)) {
+        if (in->stopFd >= 0) {
+            close(in->stopFd);
+        }
+        if (in->notifyFd >= 0) {
+            close(in->notifyFd);
+        }
+        return -1;
+    }
+    return 0;
+} // inputStart function ends
+
+void inputStop(inputReader * in) {
+    notify(in->stopFd);
+    pthread_join(in->thread, NULL);
+    close(in->stopFd);
+    close(in->notifyFd);
+} // inputStop function ends
+
+int inputNextKey(inputReader * in, keyEvent * key) {
+    return keyRingPop(&in->ring, key);
+} // inputNextKey function ends
+
+int inputEscape(inputReader * in) {
+    return __atomic_load_n(&in->escape, __ATOMIC_ACQUIRE);
+} // inputEscape function ends
+
+int inputClosed(inputReader * in) {
+    return __atomic_load_n(&in->closed, __ATOMIC_ACQUIRE);
+} // inputClosed function ends
+
+void inputLatencyAdd(inputLatency * stats, long long latencyNs) {
+    if ((stats->count == 0) || (latencyNs < stats->minNs)) {
+        stats->minNs = latencyNs;
+    }
+    if (latencyNs > stats->maxNs) {
+        stats->maxNs = latencyNs;
+    }
+    stats->lastNs = latencyNs;
+    stats->sumNs += latencyNs;
+    stats->count++;
+} // inputLatencyAdd function ends
+
+// End of input.c
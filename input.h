@@ -0,0 +1,218 @@
+/*! \file input.h
+ * \brief Keyboard input thread header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * A dedicated thread reads the terminal as soon as bytes arrive, parses escape
+ * sequences from a streaming buffer (a sequence may be split between reads, several
+ * keys may come in one read) and pushes timestamped key events into a lock-free
+ * single producer / single consumer ring. The game loop takes the keys at its ticks.
+ */
+
+#ifndef SNAKEGAME_INPUT_H
+#define SNAKEGAME_INPUT_H
+
+#include <pthread.h>
+#include <stddef.h>
+
+/*! \def KEYRINGSIZE
+ *  \brief Number of key events the ring holds, a power of two
+ */
+#define KEYRINGSIZE 64
+
+/*! \def ESCTIMEOUTMS
+ *  \brief An ESC not followed by the rest of a sequence within this time is the ESC key
+ */
+#define ESCTIMEOUTMS 30
+
+/*! \def KEYESCAPE
+ *  \brief Key code of the ESC key
+ */
+#define KEYESCAPE 27
+
+/*! \def KEYHUD
+ *  \brief Key code of the key showing and hiding the timings, H in either case
+ */
+#define KEYHUD 'h'
+
+/*! \typedef struct keyEvent
+ *  \brief Contains one key press
+ *
+ * \var unsigned char key u, d, l, r for the arrow keys, KEYESCAPE, KEYHUD or ' '
+ * \var long long timeNs Monotonic time the bytes of the key were read
+ */
+typedef struct keyEvent_t {
+    unsigned char key;
+    long long timeNs;
+} keyEvent;
+
+/*! \typedef struct keyRing
+ *  \brief Lock-free single producer / single consumer queue of key events
+ *
+ * Only the producer writes head, only the consumer writes tail;
+ * they are on separate cache lines
+ *
+ * \var keyEvent events[KEYRINGSIZE] Queued events
+ * \var size_t head Number of events pushed
+ * \var size_t tail Number of events popped
+ * \var unsigned long dropped Number of events lost because the ring was full
+ */
+typedef struct keyRing_t {
+    keyEvent events[KEYRINGSIZE];
+    size_t head __attribute__((aligned(64)));
+    unsigned long dropped;
+    size_t tail __attribute__((aligned(64)));
+} keyRing;
+
+/*! \typedef struct keyParser
+ *  \brief State of the streaming escape sequence parser
+ *
+ * \var int state Bytes of an escape sequence seen: 0 none, 1 ESC, 2 ESC [ or ESC O
+ * \var long long escapeNs Time the ESC byte was read
+ */
+typedef struct keyParser_t {
+    int state;
+    long long escapeNs;
+} keyParser;
+
+/*! \typedef struct inputReader
+ *  \brief Contains the input thread and its queue
+ *
+ * \var pthread_t thread The reader thread
+ * \var int fd Terminal file descriptor read by the thread
+ * \var int stopFd Event file descriptor that stops the thread
+ * \var int notifyFd Event file descriptor signalled on ESC and on end of input, polled by the game loop
+ * \var int escape Set when ESC was pressed
+ * \var int closed Set when the input ended
+ * \var keyParser parser Escape sequence parser
+ * \var keyRing ring Parsed keys, ESC included
+ */
+typedef struct inputReader_t {
+    pthread_t thread;
+    int fd;
+    int stopFd;
+    int notifyFd;
+    int escape;
+    int closed;
+    keyParser parser;
+    keyRing ring;
+} inputReader;
+
+/*! \typedef struct inputLatency
+ *  \brief Time from key press to the frame showing its effect
+ *
+ * \var unsigned long count Number of keys measured
+ * \var long long lastNs, minNs, maxNs, sumNs Latency of the last key, smallest, largest and sum
+ */
+typedef struct inputLatency_t {
+    unsigned long count;
+    long long lastNs;
+    long long minNs;
+    long long maxNs;
+    long long sumNs;
+} inputLatency;
+
+/*! \fn long long inputNow(void)
+ * \brief Current time of the monotonic clock in nanoseconds, the clock of the key events
+ *
+ * \return long long Time in nanoseconds
+ */
+long long inputNow(void);
+
+/*! \fn int keyRingPush(keyRing * ring, const keyEvent * event)
+ * \brief Queue an event, producer side
+ *
+ * \param ring Pointer to ring
+ * \param event The event
+ * \return int 0 on success, -1 if the ring is full (the event is counted as dropped)
+ */
+int keyRingPush(keyRing * ring, const keyEvent * event);
+
+/*! \fn int keyRingPop(keyRing * ring, keyEvent * event)
+ * \brief Take the oldest event, consumer side
+ *
+ * \param ring Pointer to ring
+ * \param event Receives the event
+ * \return int 1 if an event was taken, 0 if the ring is empty
+ */
+int keyRingPop(keyRing * ring, keyEvent * event);
+
+/*! \fn int keyParse(keyParser * parser, unsigned char byte, long long timeNs, keyEvent * keys)
+ * \brief Feed one input byte to the parser
+ *
+ * Arrow keys are ESC [ A..D or ESC O A..D. Other sequences are skipped.
+ * An ESC followed by anything else is an ESC key and the byte is parsed again.
+ *
+ * \param parser Pointer to parser
+ * \param byte The byte
+ * \param timeNs Time the byte was read
+ * \param keys Receives the completed keys, room for 2
+ * \return int Number of keys completed
+ */
+int keyParse(keyParser * parser, unsigned char byte, long long timeNs, keyEvent * keys);
+
+/*! \fn int keyParseTimeout(keyParser * parser, long long nowNs, keyEvent * key)
+ * \brief Complete a lone ESC when no more bytes came for ESCTIMEOUTMS
+ *
+ * \param parser Pointer to parser
+ * \param nowNs Current time
+ * \param key Receives the ESC key
+ * \return int 1 if the ESC key was completed, 0 otherwise
+ */
+int keyParseTimeout(keyParser * parser, long long nowNs, keyEvent * key);
+
+/*! \fn int inputStart(inputReader * in, int fd)
+ * \brief Start the input thread
+ *
+ * \param in Pointer to input reader
+ * \param fd Terminal file descriptor
+ * \return int 0 on success, -1 on error
+ */
+int inputStart(inputReader * in, int fd);
+
+/*! \fn void inputStop(inputReader * in)
+ * \brief Stop the input thread and release its resources
+ *
+ * \param in Pointer to input reader
+ * \return void No values returned
+ */
+void inputStop(inputReader * in);
+
+/*! \fn int inputNextKey(inputReader * in, keyEvent * key)
+ * \brief Take the next key press, game loop side
+ *
+ * \param in Pointer to input reader
+ * \param key Receives the key
+ * \return int 1 if a key was taken, 0 if there is none
+ */
+int inputNextKey(inputReader * in, keyEvent * key);
+
+/*! \fn int inputEscape(inputReader * in)
+ * \brief True when ESC was pressed
+ *
+ * \param in Pointer to input reader
+ * \return int True after ESC
+ */
+int inputEscape(inputReader * in);
+
+/*! \fn int inputClosed(inputReader * in)
+ * \brief True when the input ended, the thread has finished
+ *
+ * \param in Pointer to input reader
+ * \return int True after end of input
+ */
+int inputClosed(inputReader * in);
+
+/*! \fn void inputLatencyAdd(inputLatency * stats, long long latencyNs)
+ * \brief Count the latency of one key press
+ *
+ * \param stats Pointer to latency statistics
+ * \param latencyNs Time from reading the key to the frame written
+ * \return void No values returned
+ */
+void inputLatencyAdd(inputLatency * stats, long long latencyNs);
+
+#endif //SNAKEGAME_INPUT_H
+
+// End of input.h
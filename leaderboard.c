@@ -0,0 +1,569 @@
+/*! \file leaderboard.c
+ * \brief Leaderboard store
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "leaderboard.h"
+#include "fileio.h"
+
+#define INDEXHEADERSIZE 24
+#define LEGACYENTRIES 10
+#define WRITEBATCH 4096
+#define READBATCH 256
+
+/*! \typedef struct legacyEntry
+ *  \brief One entry of the old top list file, written raw by earlier versions
+ */
+typedef struct legacyEntry_t {
+    char name[LEADERNAMESIZE];
+    int score;
+} legacyEntry;
+
+static int readTail(leaderboard * lb, size_t end, int locked);
+
+/*! \fn static uint32_t entryChecksum(const leaderEntry * entry)
+ * \brief Checksum of a log record, the checksum field counts as zero
+ */
+static uint32_t entryChecksum(const leaderEntry * entry) {
+    leaderEntry copy = *entry;
+
+    copy.checksum = 0;
+    return fileCrc32(0, &copy, sizeof(copy));
+}
+
+/*! \fn static int slotBefore(const leaderSlot * a, const leaderSlot * b)
+ * \brief True if a comes before b: higher score first, equal scores in log order
+ */
+static int slotBefore(const leaderSlot * a, const leaderSlot * b) {
+    return (a->score > b->score) || ((a->score == b->score) && (a->record < b->record));
+}
+
+/*! \fn static size_t countAbove(const leaderSlot * slots, size_t count, int score, int equal)
+ * \brief Number of slots with higher score (or higher or equal if equal is true), binary search
+ */
+static size_t countAbove(const leaderSlot * slots, size_t count, int score, int equal) {
+    size_t low = 0, high = count, middle;
+
+    while (low < high) {
+        middle = low + (high - low) / 2;
+        if ((slots[middle].score > score) || (equal && (slots[middle].score == score))) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/*! \fn static int lockLog(leaderboard * lb, int operation)
+ * \brief Take (LOCK_EX) or release (LOCK_UN) the writer lock of the store
+ */
+static int lockLog(leaderboard * lb, int operation) {
+    while (flock(lb->logFd, operation) != 0) {
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*! \fn static size_t logRecords(leaderboard * lb)
+ * \brief Number of complete records in the log file
+ */
+static size_t logRecords(leaderboard * lb) {
+    struct stat info;
+
+    if (fstat(lb->logFd, &info) != 0) {
+        return lb->records;
+    }
+    return (size_t) info.st_size / sizeof(leaderEntry);
+}
+
+/*! \fn static int compareSlots(const void * a, const void * b)
+ * \brief qsort order of slots: higher score first, equal scores in log order
+ */
+static int compareSlots(const void * a, const void * b) {
+    return slotBefore(a, b) ? -1 : (slotBefore(b, a) ? 1 : 0);
+}
+
+/*! \fn static int appendSlot(leaderboard * lb, int score, size_t record)
+ * \brief Put a slot at the end of delta, out of order until mergeSlots, delta grows if it is full
+ */
+static int appendSlot(leaderboard * lb, int score, size_t record) {
+    leaderSlot * grown;
+
+    if (lb->deltaCount == lb->deltaCapacity) {
+        grown = realloc(lb->delta, 2 * lb->deltaCapacity * sizeof(leaderSlot));
+        if (grown == NULL) {
+            return -1;
+        }
+        lb->delta = grown;
+        lb->deltaCapacity *= 2;
+    }
+    lb->delta[lb->deltaCount].score = score;
+    lb->delta[lb->deltaCount].record = (uint32_t) record;
+    lb->deltaCount++;
+    return 0;
+}
+
+/*! \fn static void mergeSlots(leaderboard * lb, size_t sorted)
+ * \brief Sort the slots appended after the first sorted ones and merge them in, one pass instead of a move per record
+ */
+static void mergeSlots(leaderboard * lb, size_t sorted) {
+    size_t count = lb->deltaCount - sorted, i = sorted, j = count, k = lb->deltaCount;
+    leaderSlot * fresh;
+
+    if (count == 0) {
+        return;
+    }
+    qsort(&lb->delta[sorted], count, sizeof(leaderSlot), compareSlots);    // records are unique, so the order is stable
+    if ((sorted == 0) || slotBefore(&lb->delta[sorted - 1], &lb->delta[sorted])) {
+        return;                                                         // the new slots all come after the old ones
+    }
+    fresh = malloc(count * sizeof(leaderSlot));
+    if (fresh == NULL) {
+        qsort(lb->delta, lb->deltaCount, sizeof(leaderSlot), compareSlots);
+        return;
+    }
+    memcpy(fresh, &lb->delta[sorted], count * sizeof(leaderSlot));
+    while (j > 0) {                                                     // from the back, the last slot in order first
+        if ((i > 0) && slotBefore(&fresh[j - 1], &lb->delta[i - 1])) {
+            lb->delta[--k] = lb->delta[--i];
+        } else {
+            lb->delta[--k] = fresh[--j];
+        }
+    }
+    free(fresh);
+}
+
+/*! \fn static void unmapIndex(leaderboard * lb)
+ * \brief Drop the mapping of the index file
+ */
+static void unmapIndex(leaderboard * lb) {
+    if (lb->indexMap != NULL) {
+        munmap(lb->indexMap, lb->indexMapSize);
+    }
+    lb->indexMap = NULL;
+    lb->indexMapSize = 0;
+    lb->index = NULL;
+    lb->indexCount = 0;
+    lb->indexCovered = 0;
+}
+
+/*! \fn static int mapIndex(leaderboard * lb)
+ * \brief Map the index file, fails if it is missing or does not match the log
+ */
+static int mapIndex(leaderboard * lb) {
+    struct stat info;
+    const unsigned char * header;
+    uint64_t covered, count;
+    uint32_t version;
+    void * map;
+    int fd;
+
+    unmapIndex(lb);
+    fd = open(lb->indexName, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return -1;
+    }
+    lb->indexInode = (unsigned long long) info.st_ino;                  // a damaged index is not tried again
+    if (info.st_size < INDEXHEADERSIZE) {
+        close(fd);
+        return -1;
+    }
+    map = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+    header = map;
+    memcpy(&version, header + 4, sizeof(version));
+    memcpy(&covered, header + 8, sizeof(covered));
+    memcpy(&count, header + 16, sizeof(count));
+    if ((memcmp(header, "SNKI", 4) != 0) || (version != LEADERINDEXVERSION) || (count > covered)
+        || (covered > logRecords(lb)) || ((size_t) info.st_size != INDEXHEADERSIZE + count * sizeof(leaderSlot))) {
+        munmap(map, (size_t) info.st_size);
+        return -1;
+    }
+    lb->indexMap = map;
+    lb->indexMapSize = (size_t) info.st_size;
+    lb->index = (const leaderSlot *) (header + INDEXHEADERSIZE);
+    lb->indexCount = (size_t) count;
+    lb->indexCovered = (size_t) covered;
+    return 0;
+}
+
+/*! \fn static int writeIndex(leaderboard * lb)
+ * \brief Write a new index: the mapped index merged with delta, the caller holds the lock
+ */
+static int writeIndex(leaderboard * lb) {
+    char tempName[LEADERPATHSIZE + 8];
+    unsigned char header[INDEXHEADERSIZE];
+    leaderSlot * buffer;
+    uint64_t covered = lb->records, count = lb->indexCount + lb->deltaCount;
+    uint32_t version = LEADERINDEXVERSION;
+    size_t i = 0, j = 0, used = 0;
+    int fd, result = 0;
+
+    buffer = malloc(WRITEBATCH * sizeof(leaderSlot));
+    if (buffer == NULL) {
+        return -1;
+    }
+    snprintf(tempName, sizeof(tempName), "%s.tmp", lb->indexName);
+    fd = open(tempName, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        free(buffer);
+        return -1;
+    }
+    memcpy(header, "SNKI", 4);
+    memcpy(header + 4, &version, sizeof(version));
+    memcpy(header + 8, &covered, sizeof(covered));
+    memcpy(header + 16, &count, sizeof(count));
+    result = fileWriteAll(fd, header, sizeof(header));
+
+    while ((result == 0) && ((i < lb->indexCount) || (j < lb->deltaCount))) {  // merge the two sorted runs
+        if ((j == lb->deltaCount) || ((i < lb->indexCount) && slotBefore(&lb->index[i], &lb->delta[j]))) {
+            buffer[used++] = lb->index[i++];
+        } else {
+            buffer[used++] = lb->delta[j++];
+        }
+        if (used == WRITEBATCH) {
+            result = fileWriteAll(fd, buffer, used * sizeof(leaderSlot));
+            used = 0;
+        }
+    }
+    if ((result == 0) && (used > 0)) {
+        result = fileWriteAll(fd, buffer, used * sizeof(leaderSlot));
+    }
+    free(buffer);
+    if ((result == 0) && (fsync(fd) != 0)) {                            // content on disk before the name
+        result = -1;
+    }
+    if ((close(fd) != 0) || (result != 0) || (rename(tempName, lb->indexName) != 0)) {
+        unlink(tempName);
+        return -1;
+    }
+    lb->compactions++;
+    if (mapIndex(lb) != 0) {                                            // read everything again from the log
+        lb->records = lb->indexCovered;
+        lb->deltaCount = 0;
+        (void) readTail(lb, logRecords(lb), 1);
+        return -1;
+    }
+    lb->deltaCount = 0;                                                 // everything is in the index now
+    return 0;
+}
+
+/*! \fn static int readRecords(leaderboard * lb, size_t end, int locked)
+ * \brief Append the slots of the log records from lb->records up to end to delta, unsorted
+ *
+ * Without the lock a damaged record may be one still being written, reading stops there.
+ * With the lock nobody writes, so a damaged record is left by a crash and is replaced by a tombstone.
+ */
+static int readRecords(leaderboard * lb, size_t end, int locked) {
+    leaderEntry batch[READBATCH];
+    size_t n, k;
+    ssize_t result;
+
+    while (lb->records < end) {
+        n = end - lb->records < READBATCH ? end - lb->records : READBATCH;
+        result = pread(lb->logFd, batch, n * sizeof(leaderEntry), (off_t) (lb->records * sizeof(leaderEntry)));
+        if (result < 0) {
+            return -1;
+        }
+        n = (size_t) result / sizeof(leaderEntry);
+        if (n == 0) {
+            return 0;                                                   // log is shorter than it was
+        }
+        for (k = 0; k < n; k++, lb->records++) {
+            if (batch[k].checksum != entryChecksum(&batch[k])) {
+                if (!locked) {
+                    return 0;                                           // try again at the next refresh
+                }
+                memset(&batch[k], 0, sizeof(leaderEntry));
+                batch[k].score = LEADERTOMBSTONE;
+                batch[k].checksum = entryChecksum(&batch[k]);
+                if ((pwrite(lb->logFd, &batch[k], sizeof(leaderEntry), (off_t) (lb->records * sizeof(leaderEntry))) != (ssize_t) sizeof(leaderEntry))
+                    || (fdatasync(lb->logFd) != 0)) {
+                    return -1;
+                }
+                lb->skipped++;
+            } else if (batch[k].score == LEADERTOMBSTONE) {
+                lb->skipped++;
+            } else if (appendSlot(lb, batch[k].score, lb->records) != 0) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+/*! \fn static int readTail(leaderboard * lb, size_t end, int locked)
+ * \brief Read the log records from lb->records up to end into delta, sorted once at the end
+ */
+static int readTail(leaderboard * lb, size_t end, int locked) {
+    size_t sorted = lb->deltaCount;
+    int result;
+
+    result = readRecords(lb, end, locked);
+    mergeSlots(lb, sorted);                                             // also the slots read before an error
+    return result;
+}
+
+/*! \fn static int refresh(leaderboard * lb, int locked)
+ * \brief Remap the index if another process replaced it, then read the new log records
+ */
+static int refresh(leaderboard * lb, int locked) {
+    struct stat info;
+
+    if ((stat(lb->indexName, &info) == 0) && ((unsigned long long) info.st_ino != lb->indexInode)) {
+        (void) mapIndex(lb);                                            // a damaged index counts as empty
+        lb->records = lb->indexCovered;
+        lb->deltaCount = 0;
+        lb->skipped = 0;
+    }
+    return readTail(lb, logRecords(lb), locked);
+}
+
+/*! \fn static void fillEntry(leaderEntry * entry, const char * name, int score, int64_t time)
+ * \brief Build a log record
+ */
+static void fillEntry(leaderEntry * entry, const char * name, int score, int64_t time) {
+    memset(entry, 0, sizeof(*entry));
+    memcpy(entry->name, name, strnlen(name, LEADERNAMESIZE - 1));       // the zeroed entry ends the name
+    entry->score = score;
+    entry->time = time;
+}
+
+/*! \fn static int appendLocked(leaderboard * lb, leaderEntry * entries, size_t count)
+ * \brief Bring the store up to date and append records with one write and one sync, the caller holds the lock
+ */
+static int appendLocked(leaderboard * lb, leaderEntry * entries, size_t count) {
+    struct stat info;
+    size_t i, sorted;
+
+    if (fstat(lb->logFd, &info) != 0) {
+        return -1;
+    }
+    if ((size_t) info.st_size % sizeof(leaderEntry) != 0) {            // cut the record of a crashed writer
+        if (ftruncate(lb->logFd, info.st_size / (off_t) sizeof(leaderEntry) * (off_t) sizeof(leaderEntry)) != 0) {
+            return -1;
+        }
+    }
+    if (refresh(lb, 1) != 0) {
+        return -1;
+    }
+    if (lb->records + count >= UINT32_MAX) {
+        errno = EFBIG;
+        return -1;
+    }
+    if (lb->deltaCount >= LEADERMAXDELTA) {
+        (void) writeIndex(lb);                                          // the scores are not lost if this fails
+    }
+
+    for (i = 0; i < count; i++) {
+        entries[i].name[LEADERNAMESIZE - 1] = '\0';
+        entries[i].checksum = entryChecksum(&entries[i]);
+    }
+    if (fileWriteAt(lb->logFd, entries, count * sizeof(leaderEntry), (off_t) (lb->records * sizeof(leaderEntry))) != 0) {
+        return -1;                                                      // the next writer cuts the partial record
+    }
+    if (fdatasync(lb->logFd) != 0) {                                    // committed when on disk
+        return -1;
+    }
+    sorted = lb->deltaCount;
+    for (i = 0; (i < count) && (appendSlot(lb, entries[i].score, lb->records) == 0); i++) {
+        lb->records++;
+    }
+    mergeSlots(lb, sorted);
+    return i == count ? 0 : -1;
+}
+
+/*! \fn static void migrateLegacy(leaderboard * lb, const char * legacyName)
+ * \brief Copy the scores of the old 10 entry top list file into the empty log
+ */
+static void migrateLegacy(leaderboard * lb, const char * legacyName) {
+    legacyEntry legacy[LEGACYENTRIES];
+    leaderEntry entries[LEGACYENTRIES];
+    size_t count, used = 0, i;
+    FILE * legacyFile = fopen(legacyName, "rb");
+
+    if (legacyFile == NULL) {
+        return;
+    }
+    count = fread(legacy, sizeof(legacy[0]), LEGACYENTRIES, legacyFile);
+    fclose(legacyFile);
+    if ((count == 0) || (lockLog(lb, LOCK_EX) != 0)) {
+        return;
+    }
+    for (i = 0; i < count; i++) {                                       // the file is sorted, so is the log
+        if (legacy[i].score > 0) {
+            legacy[i].name[LEADERNAMESIZE - 1] = '\0';
+            fillEntry(&entries[used++], legacy[i].name, legacy[i].score, 0);
+        }
+    }
+    if ((used > 0) && (logRecords(lb) == 0)) {                          // no other process migrated meanwhile
+        (void) appendLocked(lb, entries, used);
+    }
+    (void) lockLog(lb, LOCK_UN);
+}
+
+int leaderOpen(leaderboard * lb, const char * baseName) {
+    /*! \var char legacyName[LEADERPATHSIZE]
+     *  \brief Name of the old top list file
+     */
+    char legacyName[LEADERPATHSIZE];
+
+    memset(lb, 0, sizeof(*lb));
+    lb->logFd = -1;
+    if (((size_t) snprintf(lb->logName, LEADERPATHSIZE, "%s.log", baseName) >= LEADERPATHSIZE)
+        || ((size_t) snprintf(lb->indexName, LEADERPATHSIZE, "%s.idx", baseName) >= LEADERPATHSIZE)
+        || ((size_t) snprintf(legacyName, LEADERPATHSIZE, "%s.dat", baseName) >= LEADERPATHSIZE)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    lb->deltaCapacity = LEADERMAXDELTA;
+    lb->delta = malloc(lb->deltaCapacity * sizeof(leaderSlot));
+    if (lb->delta == NULL) {
+        return -1;
+    }
+    lb->logFd = open(lb->logName, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (lb->logFd < 0) {
+        leaderClose(lb);
+        return -1;
+    }
+
+    if (logRecords(lb) == 0) {                                          // new store
+        migrateLegacy(lb, legacyName);
+    }
+    if (refresh(lb, 0) != 0) {
+        leaderClose(lb);
+        return -1;
+    }
+    if (lb->records - lb->indexCovered > LEADERMAXDELTA) {             // no index or an old one, spare the next readers
+        (void) leaderCompact(lb);                                       // the store is read without it if this fails
+    }
+    return 0;
+} // leaderOpen function ends
+
+void leaderClose(leaderboard * lb) {
+    unmapIndex(lb);
+    if (lb->logFd >= 0) {
+        close(lb->logFd);
+    }
+    lb->logFd = -1;
+    free(lb->delta);
+    lb->delta = NULL;
+    lb->deltaCount = 0;
+    lb->deltaCapacity = 0;
+} // leaderClose function ends
+
+int leaderRefresh(leaderboard * lb) {
+    return refresh(lb, 0);
+} // leaderRefresh function ends
+
+int leaderAdd(leaderboard * lb, const char * name, int score, int64_t time) {
+    /*! \var leaderEntry entry
+     *  \brief The new log record
+     */
+    leaderEntry entry;
+
+    fillEntry(&entry, name, score, time);
+    return leaderAddBatch(lb, &entry, 1);
+} // leaderAdd function ends
+
+int leaderAddBatch(leaderboard * lb, leaderEntry * entries, size_t count) {
+    /*! \var int result
+     *  \brief Result of the append
+     */
+    int result;
+    /*! \var size_t i
+     *  \brief Loop index variable
+     */
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        if (entries[i].score == LEADERTOMBSTONE) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    if (count == 0) {
+        return 0;
+    }
+    if (lockLog(lb, LOCK_EX) != 0) {
+        return -1;
+    }
+    result = appendLocked(lb, entries, count);
+    (void) lockLog(lb, LOCK_UN);
+    return result;
+} // leaderAddBatch function ends
+
+size_t leaderRank(const leaderboard * lb, int score) {
+    return 1 + countAbove(lb->index, lb->indexCount, score, 0) + countAbove(lb->delta, lb->deltaCount, score, 0);
+} // leaderRank function ends
+
+size_t leaderPlace(const leaderboard * lb, int score) {
+    return 1 + countAbove(lb->index, lb->indexCount, score, 1) + countAbove(lb->delta, lb->deltaCount, score, 1);
+} // leaderPlace function ends
+
+size_t leaderTop(const leaderboard * lb, leaderEntry * top, size_t count) {
+    /*! \var size_t i, j, n
+     *  \brief Positions in the index, in delta and in top
+     */
+    size_t i = 0, j = 0, n;
+    /*! \var const leaderSlot * slot
+     *  \brief Next slot in order
+     */
+    const leaderSlot * slot;
+
+    for (n = 0; (n < count) && ((i < lb->indexCount) || (j < lb->deltaCount)); n++) {
+        if ((j == lb->deltaCount) || ((i < lb->indexCount) && slotBefore(&lb->index[i], &lb->delta[j]))) {
+            slot = &lb->index[i++];
+        } else {
+            slot = &lb->delta[j++];
+        }
+        if (pread(lb->logFd, &top[n], sizeof(leaderEntry), (off_t) slot->record * (off_t) sizeof(leaderEntry)) != (ssize_t) sizeof(leaderEntry)) {
+            break;
+        }
+        top[n].name[LEADERNAMESIZE - 1] = '\0';
+    }
+    return n;
+} // leaderTop function ends
+
+size_t leaderCount(const leaderboard * lb) {
+    return lb->indexCount + lb->deltaCount;
+} // leaderCount function ends
+
+int leaderCompact(leaderboard * lb) {
+    /*! \var int result
+     *  \brief Result of the rewrite
+     */
+    int result = -1;
+
+    if (lockLog(lb, LOCK_EX) != 0) {
+        return -1;
+    }
+    if (refresh(lb, 1) == 0) {
+        result = writeIndex(lb);
+    }
+    (void) lockLog(lb, LOCK_UN);
+    return result;
+} // leaderCompact function ends
+
+// End of leaderboard.c
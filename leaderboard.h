@@ -0,0 +1,228 @@
+/*! \file leaderboard.h
+ * \brief Leaderboard store header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Every score ever made is kept in an append-only log (name.log).
+ * A sorted index of the log (name.idx) is mapped into memory, the records
+ * appended after the index was written are kept sorted in memory.
+ * Top list and rank queries are binary searches in these two sorted arrays,
+ * a new score is one append to the log; the index is rewritten only when
+ * LEADERMAXDELTA scores have been added since it was built.
+ *
+ * Many game processes may use the store at the same time. Writers append under an
+ * exclusive flock of the log and pick up the records other processes appended first.
+ * Readers never lock: every record carries a CRC32, a record being written or torn
+ * by a crash fails the check and is skipped. The index is replaced with rename,
+ * so a reader keeps its old mapping until it refreshes.
+ *
+ * Index file layout: "SNKI", version (4 bytes), number of log records covered (8 bytes),
+ * number of slots (8 bytes), then the slots, highest score first, equal scores in log order
+ */
+
+#ifndef SNAKEGAME_LEADERBOARD_H
+#define SNAKEGAME_LEADERBOARD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*! \def LEADERNAMESIZE
+ *  \brief Size of a player name including the terminating zero, the same as in the old top list
+ */
+#define LEADERNAMESIZE 40
+
+/*! \def LEADERMAXDELTA
+ *  \brief Number of scores kept outside the index before the index is rewritten
+ */
+#define LEADERMAXDELTA 4096
+
+/*! \def LEADERPATHSIZE
+ *  \brief Longest file name of the store
+ */
+#define LEADERPATHSIZE 256
+
+/*! \def LEADERTOMBSTONE
+ *  \brief Score of a record that replaces a damaged one
+ */
+#define LEADERTOMBSTONE INT32_MIN
+
+/*! \def LEADERINDEXVERSION
+ *  \brief Format version of the index file
+ */
+#define LEADERINDEXVERSION 2
+
+/*! \typedef struct leaderEntry
+ *  \brief One record of the score log
+ *
+ * \var char name[LEADERNAMESIZE] Name of the player, zero terminated
+ * \var int32_t score The score the player has achieved
+ * \var uint32_t checksum CRC32 of the record, computed with this field zero
+ *
+ * A damaged record is overwritten with a valid record of score LEADERTOMBSTONE, which is never listed
+ * \var int64_t time Time of the game in seconds since the epoch, 0 if unknown
+ */
+typedef struct leaderEntry_t {
+    char name[LEADERNAMESIZE];
+    int32_t score;
+    uint32_t checksum;
+    int64_t time;
+} leaderEntry;
+
+/*! \typedef struct leaderSlot
+ *  \brief One element of the sorted index
+ *
+ * \var int32_t score Score of the record
+ * \var uint32_t record Position of the record in the log
+ */
+typedef struct leaderSlot_t {
+    int32_t score;
+    uint32_t record;
+} leaderSlot;
+
+/*! \typedef struct leaderboard
+ *  \brief Contains an open leaderboard store
+ *
+ * \var int logFd File descriptor of the score log
+ * \var size_t records Number of log records read, including damaged ones
+ * \var size_t skipped Number of damaged records found in the log tail
+ * \var const leaderSlot * index Sorted slots of the index file, mapped into memory
+ * \var size_t indexCount Number of slots in the index
+ * \var size_t indexCovered Number of log records covered by the index
+ * \var unsigned long long indexInode Inode of the mapped index file, changes when another process rewrites it
+ * \var void * indexMap Mapping of the index file, NULL if there is no index
+ * \var size_t indexMapSize Size of the mapping
+ * \var leaderSlot * delta Sorted slots of the records not in the index
+ * \var size_t deltaCount Number of slots in delta
+ * \var size_t deltaCapacity Number of slots delta has room for
+ * \var unsigned long compactions Number of times this process rewrote the index
+ * \var char logName[LEADERPATHSIZE] Name of the log file
+ * \var char indexName[LEADERPATHSIZE] Name of the index file
+ */
+typedef struct leaderboard_t {
+    int logFd;
+    size_t records;
+    size_t skipped;
+    const leaderSlot * index;
+    size_t indexCount;
+    size_t indexCovered;
+    unsigned long long indexInode;
+    void * indexMap;
+    size_t indexMapSize;
+    leaderSlot * delta;
+    size_t deltaCount;
+    size_t deltaCapacity;
+    unsigned long compactions;
+    char logName[LEADERPATHSIZE];
+    char indexName[LEADERPATHSIZE];
+} leaderboard;
+
+/*! \fn int leaderOpen(leaderboard * lb, const char * baseName)
+ * \brief Open or create the store baseName.log and baseName.idx
+ *
+ * If the log is empty, the entries of the old 10 entry top list
+ * baseName.dat are copied into it. A missing, damaged or old index that
+ * leaves more than LEADERMAXDELTA records outside is rewritten, the store is
+ * read without it if that fails. Never waits for other processes unless the
+ * log has to be migrated or the index rewritten.
+ *
+ * \param lb Pointer to leaderboard
+ * \param baseName File name without extension
+ * \return int 0 on success, -1 on error
+ */
+int leaderOpen(leaderboard * lb, const char * baseName);
+
+/*! \fn void leaderClose(leaderboard * lb)
+ * \brief Close the store
+ *
+ * \param lb Pointer to leaderboard
+ * \return void No values returned
+ */
+void leaderClose(leaderboard * lb);
+
+/*! \fn int leaderRefresh(leaderboard * lb)
+ * \brief Pick up the scores other processes added since the store was opened or refreshed
+ *
+ * Does not lock, records still being written are picked up by a later refresh
+ *
+ * \param lb Pointer to leaderboard
+ * \return int 0 on success, -1 on error
+ */
+int leaderRefresh(leaderboard * lb);
+
+/*! \fn int leaderAdd(leaderboard * lb, const char * name, int score, int64_t time)
+ * \brief Append a score to the log
+ *
+ * Takes the log lock, refreshes, writes the record and waits until it is on disk.
+ * A partial record left by a crashed writer is cut off first.
+ *
+ * \param lb Pointer to leaderboard
+ * \param name Name of the player, truncated to LEADERNAMESIZE - 1 characters
+ * \param score The score
+ * \param time Time of the game
+ * \return int 0 on success, -1 on error
+ */
+int leaderAdd(leaderboard * lb, const char * name, int score, int64_t time);
+
+/*! \fn int leaderAddBatch(leaderboard * lb, leaderEntry * entries, size_t count)
+ * \brief Append many scores with one write and one wait for the disk (group commit)
+ *
+ * Name, score and time of the entries are used, the checksums are filled in
+ *
+ * \param lb Pointer to leaderboard
+ * \param entries Array of new records
+ * \param count Number of records
+ * \return int 0 on success, -1 on error
+ */
+int leaderAddBatch(leaderboard * lb, leaderEntry * entries, size_t count);
+
+/*! \fn size_t leaderRank(const leaderboard * lb, int score)
+ * \brief Rank of a score: 1 + number of higher scores, equal scores share the rank
+ *
+ * \param lb Pointer to leaderboard
+ * \param score The score
+ * \return size_t Rank, 1 is the best
+ */
+size_t leaderRank(const leaderboard * lb, int score);
+
+/*! \fn size_t leaderPlace(const leaderboard * lb, int score)
+ * \brief Position a new score would take in the list, after the equal scores made earlier
+ *
+ * \param lb Pointer to leaderboard
+ * \param score The score
+ * \return size_t Position, 1 is the first
+ */
+size_t leaderPlace(const leaderboard * lb, int score);
+
+/*! \fn size_t leaderTop(const leaderboard * lb, leaderEntry * top, size_t count)
+ * \brief Read the best entries
+ *
+ * \param lb Pointer to leaderboard
+ * \param top Array receiving the entries, highest score first
+ * \param count Number of entries wanted
+ * \return size_t Number of entries read, less than count if the store is smaller
+ */
+size_t leaderTop(const leaderboard * lb, leaderEntry * top, size_t count);
+
+/*! \fn size_t leaderCount(const leaderboard * lb)
+ * \brief Number of scores in the store
+ *
+ * \param lb Pointer to leaderboard
+ * \return size_t Number of scores
+ */
+size_t leaderCount(const leaderboard * lb);
+
+/*! \fn int leaderCompact(leaderboard * lb)
+ * \brief Merge the in-memory scores into a new index file
+ *
+ * Takes the log lock. The new index is written to a temporary file,
+ * flushed to disk and renamed over the old one
+ *
+ * \param lb Pointer to leaderboard
+ * \return int 0 on success, -1 on error
+ */
+int leaderCompact(leaderboard * lb);
+
+#endif //SNAKEGAME_LEADERBOARD_H
+
+// End of leaderboard.h
@@ -0,0 +1,110 @@
+/*! \file leaderclient.c
+ * \brief Leaderboard service client
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "leaderclient.h"
+
+int leaderConnect(const char * socketName) {
+    /*! \var struct sockaddr_un address
+     *  \brief Address of the service
+     */
+    struct sockaddr_un address;
+    /*! \var int fd
+     *  \brief The socket
+     */
+    int fd;
+
+    if (strlen(socketName) >= sizeof(address.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socketName);
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *) &address, sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+} // leaderConnect function ends
+
+int leaderCall(int fd, const leaderRequest * request, leaderResponse * response) {
+    /*! \var size_t done
+     *  \brief Bytes sent or received so far
+     */
+    size_t done = 0;
+    /*! \var ssize_t result
+     *  \brief Return value of send and recv
+     */
+    ssize_t result;
+
+    while (done < sizeof(*request)) {
+        result = send(fd, (const unsigned char *) request + done, sizeof(*request) - done, MSG_NOSIGNAL);
+        if (result <= 0) {
+            if ((result < 0) && (errno == EINTR)) {
+                continue;
+            }
+            return -1;
+        }
+        done += (size_t) result;
+    }
+    done = 0;
+    while (done < sizeof(*response)) {
+        result = recv(fd, (unsigned char *) response + done, sizeof(*response) - done, 0);
+        if (result <= 0) {
+            if ((result < 0) && (errno == EINTR)) {
+                continue;
+            }
+            if (result == 0) {
+                errno = ECONNRESET;
+            }
+            return -2;                                                  // the service may have done it
+        }
+        done += (size_t) result;
+    }
+    if (response->status != 0) {
+        errno = response->status;
+        return -1;
+    }
+    return 0;
+} // leaderCall function ends
+
+int leaderSubmit(int fd, const char * name, int score, int64_t time, leaderResponse * response) {
+    /*! \var leaderRequest request
+     *  \brief The request
+     */
+    leaderRequest request;
+
+    memset(&request, 0, sizeof(request));
+    request.type = LEADERSUBMIT;
+    request.score = score;
+    request.time = time;
+    strncpy(request.name, name, LEADERNAMESIZE - 1);
+    return leaderCall(fd, &request, response);
+} // leaderSubmit function ends
+
+int leaderQuery(int fd, int type, int score, leaderResponse * response) {
+    /*! \var leaderRequest request
+     *  \brief The request
+     */
+    leaderRequest request;
+
+    memset(&request, 0, sizeof(request));
+    request.type = (uint32_t) type;
+    request.score = score;
+    return leaderCall(fd, &request, response);
+} // leaderQuery function ends
+
+// End of leaderclient.c
@@ -0,0 +1,117 @@
+/*! \file leaderclient.h
+ * \brief Leaderboard service protocol and client header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * The leaderboard service (snake_leaderd) owns the score store and answers
+ * requests over a UNIX domain stream socket. Every request is one fixed size
+ * leaderRequest, every answer one fixed size leaderResponse, in host byte order.
+ * A submitted score is answered after it is on disk; the service writes all
+ * scores arrived meanwhile with one write and one sync.
+ */
+
+#ifndef SNAKEGAME_LEADERCLIENT_H
+#define SNAKEGAME_LEADERCLIENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "leaderboard.h"
+
+/*! \def LEADERSOCKET
+ *  \brief Default socket of the service
+ */
+#define LEADERSOCKET "snakegame.sock"
+
+/*! \def LEADERTOPSIZE
+ *  \brief Number of best entries the service keeps in memory and sends
+ */
+#define LEADERTOPSIZE 10
+
+/*! \def LEADERSUBMIT, LEADERQUERY, LEADERTOPLIST
+ *  \brief Request types: add a score, rank of a score, best entries
+ */
+#define LEADERSUBMIT 1
+#define LEADERQUERY 2
+#define LEADERTOPLIST 3
+
+/*! \typedef struct leaderRequest
+ *  \brief Request sent to the service
+ *
+ * \var uint32_t type LEADERSUBMIT, LEADERQUERY or LEADERTOPLIST
+ * \var int32_t score Score to add or to rank
+ * \var int64_t time Time of the game, LEADERSUBMIT only
+ * \var char name[LEADERNAMESIZE] Name of the player, LEADERSUBMIT only
+ */
+typedef struct leaderRequest_t {
+    uint32_t type;
+    int32_t score;
+    int64_t time;
+    char name[LEADERNAMESIZE];
+} leaderRequest;
+
+/*! \typedef struct leaderResponse
+ *  \brief Answer of the service
+ *
+ * \var int32_t status 0 on success, an errno value on error
+ * \var uint32_t count Number of valid entries in top
+ * \var uint64_t rank Rank of the score, see leaderRank
+ * \var uint64_t place Position a new score would take, see leaderPlace (LEADERQUERY only)
+ * \var uint64_t total Number of scores in the store
+ * \var leaderEntry top[LEADERTOPSIZE] Best entries, highest first (LEADERTOPLIST only)
+ */
+typedef struct leaderResponse_t {
+    int32_t status;
+    uint32_t count;
+    uint64_t rank;
+    uint64_t place;
+    uint64_t total;
+    leaderEntry top[LEADERTOPSIZE];
+} leaderResponse;
+
+/*! \fn int leaderConnect(const char * socketName)
+ * \brief Connect to the service
+ *
+ * \param socketName Path of the socket
+ * \return int Socket file descriptor, -1 if the service is not running
+ */
+int leaderConnect(const char * socketName);
+
+/*! \fn int leaderCall(int fd, const leaderRequest * request, leaderResponse * response)
+ * \brief Send a request and wait for the answer
+ *
+ * \param fd Socket returned by leaderConnect
+ * \param request The request
+ * \param response The answer
+ * \return int 0 on success, -1 if the request was not sent or the service returned an error,
+ *             -2 if the request was sent but the answer did not come
+ */
+int leaderCall(int fd, const leaderRequest * request, leaderResponse * response);
+
+/*! \fn int leaderSubmit(int fd, const char * name, int score, int64_t time, leaderResponse * response)
+ * \brief Add a score, returns when it is on disk
+ *
+ * \param fd Socket returned by leaderConnect
+ * \param name Name of the player
+ * \param score The score
+ * \param time Time of the game
+ * \param response Rank of the score and number of scores
+ * \return int 0 on success, -1 if the score was not stored, -2 if the connection failed after
+ *             the score was sent, it may be stored and must not be added again
+ */
+int leaderSubmit(int fd, const char * name, int score, int64_t time, leaderResponse * response);
+
+/*! \fn int leaderQuery(int fd, int type, int score, leaderResponse * response)
+ * \brief Ask the rank of a score (LEADERQUERY) or the best entries (LEADERTOPLIST)
+ *
+ * \param fd Socket returned by leaderConnect
+ * \param type LEADERQUERY or LEADERTOPLIST
+ * \param score Score to rank, not used by LEADERTOPLIST
+ * \param response The answer
+ * \return int 0 on success, -1 or -2 on error, see leaderCall
+ */
+int leaderQuery(int fd, int type, int score, leaderResponse * response);
+
+#endif //SNAKEGAME_LEADERCLIENT_H
+
+// End of leaderclient.h
@@ -0,0 +1,423 @@
+/*! \file leaderd.c
+ * \brief Leaderboard service
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Keeps the score store open and the top list in memory, and serves
+ * game processes over a UNIX domain socket (see leaderclient.h).
+ * Submitted scores are collected while the previous batch is written,
+ * then written together with one write and one sync (group commit);
+ * each submitter gets its answer when its score is on disk.
+ * Scores added by games that found the service down are picked up from the store.
+ */
+
+#define _GNU_SOURCE                                                     // accept4
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "leaderboard.h"
+#include "leaderclient.h"
+
+/*! \def MAXEVENTS
+ *  \brief Events handled per epoll_wait
+ */
+#define MAXEVENTS 256
+
+/*! \def MAXBATCH
+ *  \brief Most scores written in one commit
+ */
+#define MAXBATCH 4096
+
+/*! \def REFRESHMS
+ *  \brief Milliseconds between looking for scores written without the service
+ */
+#define REFRESHMS 100
+
+/*! \typedef struct client
+ *  \brief Contains one connected game
+ *
+ * \var int active True while the connection is open
+ * \var int pending True while a submitted score waits for the commit
+ * \var int closing True after the game closed the connection or broke the protocol
+ * \var size_t received Bytes of the request received so far
+ * \var leaderRequest request The request being received
+ */
+typedef struct client_t {
+    int active;
+    int pending;
+    int closing;
+    size_t received;
+    leaderRequest request;
+} client;
+
+/*! \typedef struct service
+ *  \brief Contains the state of the service
+ *
+ * \var leaderboard store The score store
+ * \var int listenFd Listening socket
+ * \var int epollFd Epoll instance watching all sockets
+ * \var client * clients Connections indexed by file descriptor
+ * \var size_t clientSlots Size of the clients array
+ * \var leaderEntry batch[MAXBATCH] Scores waiting for the next commit
+ * \var int batchFd[MAXBATCH] Connection of each waiting score
+ * \var size_t batchCount Number of waiting scores
+ * \var leaderEntry top[LEADERTOPSIZE] Best entries of the store
+ * \var size_t topCount Number of valid entries in top
+ * \var unsigned long long submissions, commits, queries Counters printed at exit
+ */
+typedef struct service_t {
+    leaderboard store;
+    int listenFd;
+    int epollFd;
+    client * clients;
+    size_t clientSlots;
+    leaderEntry batch[MAXBATCH];
+    int batchFd[MAXBATCH];
+    size_t batchCount;
+    leaderEntry top[LEADERTOPSIZE];
+    size_t topCount;
+    unsigned long long submissions;
+    unsigned long long commits;
+    unsigned long long queries;
+} service;
+
+/*! \var static volatile sig_atomic_t stopRequested
+ *  \brief Set by SIGINT and SIGTERM
+ */
+static volatile sig_atomic_t stopRequested = 0;
+
+/*! \fn static void onStop(int signalNumber)
+ * \brief Signal handler, ends the main loop
+ */
+static void onStop(int signalNumber) {
+    (void) signalNumber;
+    stopRequested = 1;
+}
+
+/*! \fn static long long nowMs(void)
+ * \brief Monotonic time in milliseconds
+ */
+static long long nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*! \fn static void reply(service * sv, int fd, leaderResponse * response)
+ * \brief Send an answer, a game that does not read its answers is disconnected
+ */
+static void reply(service * sv, int fd, leaderResponse * response) {
+    if (send(fd, response, sizeof(*response), MSG_NOSIGNAL | MSG_DONTWAIT) != (ssize_t) sizeof(*response)) {
+        sv->clients[fd].closing = 1;                                    // one request at a time, so the buffer is empty
+    }
+}
+
+/*! \fn static void updateTop(service * sv)
+ * \brief Read the best entries of the store into memory
+ */
+static void updateTop(service * sv) {
+    sv->topCount = leaderTop(&sv->store, sv->top, LEADERTOPSIZE);
+}
+
+/*! \fn static void commit(service * sv)
+ * \brief Write the waiting scores with one sync and answer their games
+ */
+static void commit(service * sv) {
+    leaderResponse response;
+    int status = 0;
+    size_t i;
+
+    if (sv->batchCount == 0) {
+        return;
+    }
+    if (leaderAddBatch(&sv->store, sv->batch, sv->batchCount) != 0) {
+        status = errno != 0 ? errno : EIO;
+    }
+    sv->commits++;
+    memset(&response, 0, sizeof(response));
+    response.status = status;
+    response.total = leaderCount(&sv->store);
+    for (i = 0; i < sv->batchCount; i++) {
+        response.rank = leaderRank(&sv->store, sv->batch[i].score);
+        sv->clients[sv->batchFd[i]].pending = 0;
+        reply(sv, sv->batchFd[i], &response);
+    }
+    sv->batchCount = 0;
+    updateTop(sv);
+}
+
+/*! \fn static void handleRequest(service * sv, int fd)
+ * \brief Answer a query at once, queue a submitted score for the next commit
+ */
+static void handleRequest(service * sv, int fd) {
+    leaderRequest * request = &sv->clients[fd].request;
+    leaderResponse response;
+
+    memset(&response, 0, sizeof(response));
+    switch (request->type) {
+        case LEADERSUBMIT:
+            if (request->score == LEADERTOMBSTONE) {
+                response.status = EINVAL;
+                break;
+            }
+            if (sv->batchCount == MAXBATCH) {
+                commit(sv);
+            }
+            memset(&sv->batch[sv->batchCount], 0, sizeof(leaderEntry));
+            memcpy(sv->batch[sv->batchCount].name, request->name, LEADERNAMESIZE);
+            sv->batch[sv->batchCount].score = request->score;
+            sv->batch[sv->batchCount].time = request->time;
+            sv->batchFd[sv->batchCount++] = fd;
+            sv->clients[fd].pending = 1;
+            sv->submissions++;
+            return;                                                     // answered by commit
+        case LEADERQUERY:
+            response.rank = leaderRank(&sv->store, request->score);
+            response.place = leaderPlace(&sv->store, request->score);
+            break;
+        case LEADERTOPLIST:
+            response.count = (uint32_t) sv->topCount;
+            memcpy(response.top, sv->top, sv->topCount * sizeof(leaderEntry));
+            break;
+        default:
+            response.status = EINVAL;
+            break;
+    }
+    response.total = leaderCount(&sv->store);
+    sv->queries++;
+    reply(sv, fd, &response);
+}
+
+/*! \fn static void readClient(service * sv, int fd)
+ * \brief Receive request bytes, handle the request when it is complete
+ */
+static void readClient(service * sv, int fd) {
+    client * cl = &sv->clients[fd];
+    ssize_t result;
+
+    while (!cl->pending && !cl->closing) {                              // a waiting game sends nothing new
+        result = recv(fd, (unsigned char *) &cl->request + cl->received, sizeof(cl->request) - cl->received, MSG_DONTWAIT);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                cl->closing = 1;
+            }
+            return;
+        }
+        if (result == 0) {
+            cl->closing = 1;
+            return;
+        }
+        cl->received += (size_t) result;
+        if (cl->received == sizeof(cl->request)) {
+            cl->received = 0;
+            handleRequest(sv, fd);
+        }
+    }
+}
+
+/*! \fn static void acceptClients(service * sv)
+ * \brief Accept every waiting connection
+ */
+static void acceptClients(service * sv) {
+    struct epoll_event event;
+    client * grown;
+    size_t slots;
+    int fd;
+
+    for (;;) {
+        fd = accept4(sv->listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;                                                     // EAGAIN, or out of descriptors for now
+        }
+        if ((size_t) fd >= sv->clientSlots) {
+            slots = sv->clientSlots * 2 > (size_t) fd ? sv->clientSlots * 2 : (size_t) fd + 1;
+            grown = realloc(sv->clients, slots * sizeof(client));
+            if (grown == NULL) {
+                close(fd);
+                continue;
+            }
+            memset(grown + sv->clientSlots, 0, (slots - sv->clientSlots) * sizeof(client));
+            sv->clients = grown;
+            sv->clientSlots = slots;
+        }
+        memset(&sv->clients[fd], 0, sizeof(client));
+        sv->clients[fd].active = 1;
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(sv->epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            sv->clients[fd].active = 0;
+            close(fd);
+        }
+    }
+}
+
+/*! \fn static void closeClients(service * sv, const struct epoll_event * events, int count)
+ * \brief Close the connections marked closing that have no score waiting
+ */
+static void closeClients(service * sv, const struct epoll_event * events, int count) {
+    int i, fd;
+
+    for (i = 0; i < count; i++) {
+        fd = events[i].data.fd;
+        if ((fd != sv->listenFd) && sv->clients[fd].active && sv->clients[fd].closing && !sv->clients[fd].pending) {
+            sv->clients[fd].active = 0;
+            close(fd);                                                  // also removes it from epoll
+        }
+    }
+}
+
+/*! \fn static int openSocket(service * sv, const char * socketName)
+ * \brief Create the listening socket, a stale socket file of a dead service is replaced
+ */
+static int openSocket(service * sv, const char * socketName) {
+    struct sockaddr_un address;
+    int fd;
+
+    fd = leaderConnect(socketName);
+    if (fd >= 0) {
+        close(fd);
+        fprintf(stderr, "%s: service already running\n", socketName);
+        return -1;
+    }
+    if (strlen(socketName) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "%s: name too long\n", socketName);
+        return -1;
+    }
+    unlink(socketName);
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socketName);
+    sv->listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if ((sv->listenFd < 0) || (bind(sv->listenFd, (struct sockaddr *) &address, sizeof(address)) != 0)
+        || (listen(sv->listenFd, SOMAXCONN) != 0)) {
+        perror(socketName);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    /*! \var static service sv
+     *  \brief The service, static because of the batch arrays
+     */
+    static service sv;
+    /*! \var struct epoll_event events[MAXEVENTS]
+     *  \brief Ready sockets
+     */
+    struct epoll_event events[MAXEVENTS];
+    /*! \var struct epoll_event event
+     *  \brief Registration of the listening socket
+     */
+    struct epoll_event event;
+    /*! \var struct sigaction action
+     *  \brief Stop signal handler, without restart so epoll_wait returns
+     */
+    struct sigaction action;
+    /*! \var struct rlimit files
+     *  \brief Open file limit, raised for thousands of games
+     */
+    struct rlimit files;
+    /*! \var const char * storeName, * socketName
+     *  \brief Base name of the store and path of the socket
+     */
+    const char * storeName = "snakegame", * socketName = LEADERSOCKET;
+    /*! \var long long lastRefresh
+     *  \brief Time the store was last refreshed
+     */
+    long long lastRefresh;
+    /*! \var int option, count, i
+     *  \brief Command line option, number of events, loop index
+     */
+    int option, count, i;
+
+    while ((option = getopt(argc, argv, "f:s:")) != -1) {
+        switch (option) {
+            case 'f':
+                storeName = optarg;
+                break;
+            case 's':
+                socketName = optarg;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-f storename] [-s socket]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (getrlimit(RLIMIT_NOFILE, &files) == 0) {
+        files.rlim_cur = files.rlim_max;
+        (void) setrlimit(RLIMIT_NOFILE, &files);
+    }
+    if (leaderOpen(&sv.store, storeName) != 0) {
+        perror(storeName);
+        return 1;
+    }
+    if (openSocket(&sv, socketName) != 0) {
+        leaderClose(&sv.store);
+        return 1;
+    }
+    sv.epollFd = epoll_create1(EPOLL_CLOEXEC);
+    event.events = EPOLLIN;
+    event.data.fd = sv.listenFd;
+    if ((sv.epollFd < 0) || (epoll_ctl(sv.epollFd, EPOLL_CTL_ADD, sv.listenFd, &event) != 0)) {
+        perror("epoll");
+        return 1;
+    }
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onStop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    updateTop(&sv);
+    lastRefresh = nowMs();
+    fprintf(stderr, "Serving %zu scores of %s on %s\n", leaderCount(&sv.store), storeName, socketName);
+
+    while (!stopRequested) {
+        count = epoll_wait(sv.epollFd, events, MAXEVENTS, REFRESHMS);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait");
+            break;
+        }
+        for (i = 0; i < count; i++) {
+            if (events[i].data.fd == sv.listenFd) {
+                acceptClients(&sv);
+            } else {
+                readClient(&sv, events[i].data.fd);
+            }
+        }
+        commit(&sv);                                                    // everything submitted while the last commit ran
+        closeClients(&sv, events, count);
+        if (nowMs() - lastRefresh >= REFRESHMS) {                       // scores of games that wrote the store directly
+            if ((leaderRefresh(&sv.store) == 0) && (sv.batchCount == 0)) {
+                updateTop(&sv);
+            }
+            lastRefresh = nowMs();
+        }
+    }
+
+    commit(&sv);
+    fprintf(stderr, "%llu scores in %llu commits (%.1f per commit), %llu queries\n", sv.submissions, sv.commits,
+            sv.commits > 0 ? (double) sv.submissions / sv.commits : 0.0, sv.queries);
+    close(sv.listenFd);
+    unlink(socketName);
+    leaderClose(&sv.store);
+    free(sv.clients);
+    return 0;
+} // main function ends
+
+// End of leaderd.c
@@ -11,86 +11,410 @@
 
 //#define DEBUG
 
+#include <errno.h>
+#include <signal.h> // for the window size change signal
 #include <stdio.h>
-#include <stdlib.h> // for random number
+#include <stdlib.h>
 #include <string.h> // memory operations
 #include <sys/ioctl.h> // for ioctl
 #include <unistd.h> // for ioctl and read
 #include <termios.h> // for reading and writing terminal parameters
 #include <time.h> // for timing functions
 #include "snake.h"
+#include "engine.h"
+#include "render.h"
+#include "terminal.h"
+#include "ticker.h"
+#include "replay.h"
+#include "leaderboard.h"
+#include "leaderclient.h"
+#include "input.h"
+#include "stats.h"
+#include "broadcast.h"
+#include "autopilot.h"
+#include "snapshot.h"
+
+/*! \def REPLAYPREFIX
+ *  \brief Start of the replay file names, every game gets its own file: snakegame-date-time-pid.rpl
+ */
+#define REPLAYPREFIX "snakegame"
+
+/*! \def REPLAYNAMESIZE
+ *  \brief Size of a generated replay file name
+ */
+#define REPLAYNAMESIZE 96
+
+/*! \def LEADERFILE
+ *  \brief Name of the leaderboard store without extension, snakegame.log and snakegame.idx
+ */
+#define LEADERFILE "snakegame"
+
+/*! \def HALLOFFAME
+ *  \brief Number of entries shown in the hall of fame
+ */
+#define HALLOFFAME 10
 
-/*! \struct entry
- *  \brief Contains 1 entry for top list
+/*! \def KEYINTERVAL
+ *  \brief Ticks between two complete frames sent to the spectators, a late viewer waits at most this long
+ */
+#define KEYINTERVAL 6
+
+/*! \def SNAPSHOTTICKS
+ *  \brief Ticks between two snapshots of the game, one a second
+ */
+#define SNAPSHOTTICKS 6
+
+/*! \var static volatile sig_atomic_t resized
+ *  \brief Set by SIGWINCH, the main loop reads the new window size
+ */
+static volatile sig_atomic_t resized = 0;
+
+/*! \fn static void onResize(int signal)
+ * \brief Window size change signal handler
+ */
+static void onResize(int signal) {
+    (void) signal;
+    resized = 1;
+}
+
+/*! \fn int readBoardSize(const char * text, int * size)
+ * \brief Convert a board width or height given as text
  *
- * \var char name[40] Name of the player
- * \var int score The score the player has achieved
+ * \param text Number as text
+ * \param size Pointer to result
+ * \return int 0 on success, -1 if the text is not a number between MINBOARDSIZE and MAXBOARDSIZE
  */
-struct entry {
-    char name[40];
-    int score;
-};
+int readBoardSize(const char * text, int * size);
 
-/*! \fn void sortToplist(struct entry *toplist, size_t num)
- * \brief Sort the top list entries on scores descending order
+int readBoardSize(const char * text, int * size) {
+    /*! \var char * end
+     *  \brief First character after the number
+     */
+    char * end;
+    /*! \var long value
+     *  \brief Converted number
+     */
+    long value;
+
+    errno = 0;
+    value = strtol(text, &end, 10);
+    while ((*end == ' ') || (*end == '\t') || (*end == '\r') || (*end == '\n')) {   // trailing white space allowed
+        end++;
+    }
+    if ((errno != 0) || (end == text) || (*end != '\0') || (value < MINBOARDSIZE) || (value > MAXBOARDSIZE)) {
+        fprintf(stderr, "Invalid board size: %s (allowed %d..%d)\n", text, MINBOARDSIZE, MAXBOARDSIZE);
+        return -1;
+    }
+    *size = (int) value;
+    return 0;
+}
+
+/*! \fn int readConfigFile(const char * fileName, int * width, int * height)
+ * \brief Read game settings from configuration file
  *
- * Receive a pointer to the top list array and the number of elements.
- * Sort the array by score values descending order, highest score is first entry
+ * The file contains key = value lines, empty lines and lines starting with # are skipped
+ * Known keys: width, height
  *
- * \param toplist Pointer to array with entries
- * \param num Number of entries in array
- * \return void No values returned
+ * \param fileName Name of configuration file
+ * \param width Pointer to board width
+ * \param height Pointer to board height
+ * \return int 0 on success, -1 on error
  */
-void sortToplist(struct entry *toplist, size_t num);
+int readConfigFile(const char * fileName, int * width, int * height);
 
-void sortToplist(struct entry *toplist, size_t num) {
-    /*! \var size_t i, j
-     *  \brief Loop index variables
+int readConfigFile(const char * fileName, int * width, int * height) {
+    /*! \var FILE * configFile
+     *  \brief Pointer to the configuration file
+     */
+    FILE * configFile;
+    /*! \var char line[128]
+     *  \brief One line of the file
      */
-    size_t i, j;
-    /*! \var size_t largest
-     *  \brief Index of the largest entry
+    char line[128];
+    /*! \var char key[32], value[64]
+     *  \brief Key and value parts of the line
      */
-    size_t largest;
-    /*! \var struct entry temp
-     *  \brief Helper for swapping 2 entries
+    char key[32], value[64];
+    /*! \var int result
+     *  \brief Return value, -1 after the first error
      */
-    struct entry temp;
+    int result = 0;
 
-    for (i = 0; i < num-1; i++) {               // Loop through sorted section
-        largest = i;                            // Suppose sorted section member is in position
-        for (j = i+1; j < num; j++) {           // Loop through unsorted section
-            if ((toplist+j)->score > (toplist+largest)->score) { // If member in unsorted section larger
-                largest = j;                    // Remember its index
-            }
+    configFile = fopen(fileName, "r");
+    if (configFile == NULL) {
+        perror(fileName);
+        return -1;
+    }
+    while ((result == 0) && (fgets(line, sizeof(line), configFile) != NULL)) {
+        if ((line[0] == '#') || (sscanf(line, " %31[a-z] = %63s", key, value) != 2)) {
+            continue;                                                   // comment or empty line
         }
-        if (largest != i) {                     // If largest entry is not in sorted section...
-            memcpy(temp.name, (toplist+i)->name, sizeof((toplist+i)->name));    // ...swap it with the entry...
-            temp.score = (toplist+i)->score;                                    // ...in unsorted section.
-            memcpy((toplist+i)->name, (toplist+largest)->name, sizeof((toplist+largest)->name)); // Both the name and the score...
-            (toplist+i)->score = (toplist+largest)->score;                      // ...must be swapped.
-            memcpy((toplist+largest)->name, temp.name, sizeof(temp.name));
-            (toplist+largest)->score = temp.score;
+        if (strcmp(key, "width") == 0) {
+            result = readBoardSize(value, width);
+        } else if (strcmp(key, "height") == 0) {
+            result = readBoardSize(value, height);
+        } else {
+            fprintf(stderr, "%s: unknown setting %s\n", fileName, key);
+            result = -1;
         }
     }
-    /*
-    printf("    Toplist after sort\n");                                         // DEBUG: Print the toplist
-        for (i = 0; i < 10; i++) {
-            printf("%4ld %30s %6d\n", i+1, (toplist+i)->name, (toplist+i)->score);
-        }
-        */
+    fclose(configFile);
+    return result;
 }
 
+/*! \fn int openRecording(replayWriter * recorder, char * fileName, int width, int height, uint64_t seed, memArena * arena)
+ * \brief Create a new replay file named after the start time and the process, never overwriting one
+ *
+ * Games started in the same second by the same process id get a counter after the name
+ *
+ * \param recorder Pointer to recorder
+ * \param fileName REPLAYNAMESIZE bytes, receives the name of the file
+ * \param width Number of columns
+ * \param height Number of rows
+ * \param seed Random number seed of the game
+ * \param arena Memory arena
+ * \return int 0 on success, -1 on error
+ */
+int openRecording(replayWriter * recorder, char * fileName, int width, int height, uint64_t seed, memArena * arena);
+
+int openRecording(replayWriter * recorder, char * fileName, int width, int height, uint64_t seed, memArena * arena) {
+    /*! \var time_t now
+     *  \brief Start time of the game
+     */
+    time_t now = time(NULL);
+    /*! \var struct tm local
+     *  \brief Start time as date and time of day
+     */
+    struct tm local;
+    /*! \var char stamp[32]
+     *  \brief Date and time part of the name
+     */
+    char stamp[32];
+    /*! \var int attempt
+     *  \brief Counter after the name, 0 for none
+     */
+    int attempt;
+
+    (void) localtime_r(&now, &local);
+    (void) strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &local);
+    for (attempt = 0; attempt < 100; attempt++) {
+        if (attempt == 0) {
+            snprintf(fileName, REPLAYNAMESIZE, "%s-%s-%d.rpl", REPLAYPREFIX, stamp, (int) getpid());
+        } else {
+            snprintf(fileName, REPLAYNAMESIZE, "%s-%s-%d-%d.rpl", REPLAYPREFIX, stamp, (int) getpid(), attempt);
+        }
+        if (replayOpen(recorder, fileName, 1, width, height, seed, arena) == 0) {
+            return 0;
+        }
+        if (errno != EEXIST) {
+            return -1;
+        }
+    }
+    return -1;
+} // openRecording function ends
+
+/*! \fn int playReplay(const char * fileName)
+ * \brief Play back a recorded game without timer and verify its result
+ *
+ * \param fileName Name of the replay file
+ * \return int Exit code, 0 if the played back game ends the same as the recorded one
+ */
+int playReplay(const char * fileName);
+
+int playReplay(const char * fileName) {
+    /*! \var replayData replay
+     *  \brief The mapped replay file
+     */
+    replayData replay;
+    /*! \var replayResult result
+     *  \brief Recorded and played back results
+     */
+    replayResult result;
+    /*! \var gameState game
+     *  \brief The game played back
+     */
+    gameState game;
+    /*! \var memArena arena
+     *  \brief Memory of the game
+     */
+    memArena arena;
+    /*! \var struct timespec start, end
+     *  \brief Time of the playback
+     */
+    struct timespec start, end;
+    /*! \var int status
+     *  \brief Result of the playback
+     */
+    int status;
+
+    if (replayLoad(&replay, fileName) != 0) {
+        perror(fileName);
+        return 1;
+    }
+    if ((replayHeader(&replay, &result) != 0)
+        || (arenaInit(&arena, gameMemorySize(result.width, result.height)) != 0)) {
+        fprintf(stderr, "%s: not a replay file\n", fileName);
+        replayUnload(&replay);
+        return 1;
+    }
+    gameInit(&game, result.width, result.height, result.seed, &arena);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    status = replayPlay(&replay, &game, &result);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (status < 0) {
+        fprintf(stderr, "%s: damaged replay file\n", fileName);
+    } else {
+        printf("Board %dx%d seed %016llx, %lu direction changes, %zu bytes\n", result.width, result.height, (unsigned long long) result.seed, result.events, replay.size);
+        printf("Recorded:    ticks %lu score %d length %zu\n", result.recordedTicks, result.recordedScore, result.recordedLength);
+        printf("Played back: ticks %lu score %d length %zu in %.1f us\n", result.ticks, result.score, result.length, ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / 1000.0);
+        printf("%s\n", status == 0 ? "Replay verified" : "REPLAY MISMATCH");
+    }
+    arenaFree(&arena);
+    replayUnload(&replay);
+    return status == 0 ? 0 : 1;
+} // playReplay function ends
+
+/*! \fn void printHallOfFame(const leaderEntry * toplist, size_t shown)
+ * \brief Print the best entries, empty lines up to HALLOFFAME
+ *
+ * \param toplist Best entries, highest score first
+ * \param shown Number of entries
+ * \return void No values returned
+ */
+void printHallOfFame(const leaderEntry * toplist, size_t shown);
+
+void printHallOfFame(const leaderEntry * toplist, size_t shown) {
+    /*! \var size_t i
+     *  \brief Loop index variable
+     */
+    size_t i;
+
+    printf("    Hall of fame\n");                                       // print top list
+    for (i = 0; i < HALLOFFAME; i++) {
+        printf("%4ld %30s %6d\n", i+1, i < shown ? toplist[i].name : "", i < shown ? toplist[i].score : 0);
+    }
+    printf("\n");
+} // printHallOfFame function ends
+
+/*! \fn void recordScore(int score)
+ * \brief Add the score to the leaderboard and show the hall of fame
+ *
+ * The leaderboard service is used when it runs, otherwise the store files are opened directly
+ * The player name is asked if the score earned a place in the Top 10
+ *
+ * \param score Final score of the game
+ * \return void No values returned
+ */
+void recordScore(int score);
+
+void recordScore(int score) {
+    /*! \var int service
+     *  \brief Connection to the leaderboard service, -1 if it is not used
+     */
+    int service;
+    /*! \var leaderResponse answer
+     *  \brief Answer of the service
+     */
+    leaderResponse answer;
+    /*! \var leaderboard scores
+     *  \brief Every score ever made, when there is no service
+     */
+    leaderboard scores;
+    /*! \var int local
+     *  \brief True when the store is open
+     */
+    int local = 0;
+    /*! \var int submitted
+     *  \brief True when the score is stored or handed to the service, or when there is nothing to store
+     */
+    int submitted;
+    /*! \var int result
+     *  \brief Return value of the submit
+     */
+    int result;
+    /*! \var size_t place
+     *  \brief Position the score takes in the list
+     */
+    size_t place;
+    /*! \var char name[LEADERNAMESIZE]
+     *  \brief Players name input
+     */
+    char name[LEADERNAMESIZE];
+    /*! \var leaderEntry toplist[HALLOFFAME]
+     *  \brief Best entries of the leaderboard
+     */
+    leaderEntry toplist[HALLOFFAME];
+
+    service = leaderConnect(LEADERSOCKET);
+    if ((service >= 0) && (leaderQuery(service, LEADERQUERY, score, &answer) == 0)) {
+        place = (size_t) answer.place;
+    } else {
+        if (service >= 0) {
+            close(service);
+            service = -1;
+        }
+        if (leaderOpen(&scores, LEADERFILE) != 0) {                  // created and migrated on first use
+            perror(LEADERFILE ".log");
+            return;
+        }
+        local = 1;
+        place = leaderPlace(&scores, score);
+    }
+
+    memset(name, 0, sizeof(name));
+    if ((score > 0) && (place <= HALLOFFAME)) {                         // Player earned a place on top list
+        printf("You earned a place on the top list! Enter your name: ");
+        if (fgets(name, sizeof(name), stdin) != NULL) {                 // Ask for players name
+            name[strcspn(name, "\n")] = '\0';
+        }
+        printf("\n");
+    }
+
+    submitted = (score <= 0);                                           // only real scores are kept
+    if (service >= 0) {
+        result = submitted ? -1 : leaderSubmit(service, name, score, (int64_t) time(NULL), &answer);
+        if (result == 0) {
+            submitted = 1;
+            printf("Your rank: %llu of %llu\n\n", (unsigned long long) answer.rank, (unsigned long long) answer.total);
+        } else if (result == -2) {                                      // it may be on disk, adding it again could count it twice
+            submitted = 1;
+            printf("The leaderboard service did not answer, your score may not be kept\n\n");
+        }
+        if (submitted && (leaderQuery(service, LEADERTOPLIST, 0, &answer) == 0)) {
+            printHallOfFame(answer.top, answer.count);
+            close(service);
+            return;
+        }
+        close(service);                                                 // service stopped meanwhile, use the store
+    }
+
+    if (!local && (leaderOpen(&scores, LEADERFILE) != 0)) {
+        perror(LEADERFILE ".log");
+        return;
+    }
+    if (!submitted && (leaderAdd(&scores, name, score, (int64_t) time(NULL)) == 0)) {   // Every score is kept
+        printf("Your rank: %zu of %zu\n\n", leaderRank(&scores, score), leaderCount(&scores));
+    }
+    printHallOfFame(toplist, leaderTop(&scores, toplist, HALLOFFAME));
+    leaderClose(&scores);
+} // recordScore function ends
+
 /*! \fn main(int argc, char **argv)
  * \brief The main entry point of the program
  *
  * Declares and initialize all used variables
- * Reads terminal window size
+ * Reads board size from configuration file (-c file) and command line (-x columns -y rows)
+ * With -p file plays back a recorded game and exits, otherwise the game is recorded to a new file of its own (-o file overwrites the given file)
+ * With -r file continues the game saved in the snapshot file and keeps saving it there until the game ends
+ * Takes all game memory from one arena sized to the board
+ * Reads terminal window size, and again on every SIGWINCH, the board is shown through a view of that size
  * Configures terminal environment for interactive use, disables waiting for keyboard entry
  * Starts the main event loop
  * Runs the snake game
- * When main loop ended, processses the top list file
- * Add player name and score if player earned sufficient point to enter Top 10
+ * When main loop ended, adds the score to the leaderboard store
+ * Asks the player name if the score earned a place in the Top 10
  * Finally present the toplist
  *
  * \param argc Number of parameters
@@ -99,67 +423,150 @@ void sortToplist(struct entry *toplist, size_t num) {
  */
 int main(int argc, char **argv) {
 
-    /*! \var clock_t previousTime
-     *  \brief Time of the beginning of interval
+    /*! \var ticker tick
+     *  \brief Game tick scheduler, wakes up the main loop 6 times / second
      */
-    clock_t previousTime = clock();
-    /*! \var clock_t currentTime
-     *  \brief Time of the end of interval
+    ticker tick;
+    /*! \var renderer screen
+     *  \brief Differential renderer, keeps the last drawn frame
      */
-    clock_t currentTime;
-    /*! \var size_t i
-     *  \brief Loop index variable
+    renderer screen;
+    /*! \var gameState game
+     *  \brief The game: board, players snake, apple and score
      */
-    size_t i;
-    /*! \var unsigned char input
-     *  \brief Input character after processing
+    gameState game;
+    /*! \var replayWriter recorder
+     *  \brief Records the direction changes of the game
      */
-    unsigned char input;
-    /*! \var int gameRun
-     *  \brief True while the game runs, when player lose it is set to false
+    replayWriter recorder;
+    /*! \var memArena arena
+     *  \brief Memory of the game, the renderer and the recorder
      */
-    int gameRun = 1;
-    /*! \var int score
-     *  \brief Score achieved by player
+    memArena arena;
+    /*! \var uint64_t seed
+     *  \brief Random number seed of the game, stored in the replay
      */
-    int score = 0;
-
-#ifdef DEBUG
-    score = 0;
-#endif
-
-    /*! \var unsigned char board
-     *  \brief The game board
-     *
-     *  Snake is rendered into the board
+    uint64_t seed;
+    /*! \var const char * replayFile
+     *  \brief Name of the file given with -o, NULL to record to a new file
      */
-    unsigned char board[BOARDSIZEX][BOARDSIZEY];
-    /*! \var snake player
-     *  \brief The players snake
+    const char * replayFile = NULL;
+    /*! \var char replayName[REPLAYNAMESIZE]
+     *  \brief Name of the file the game is recorded to
      */
-    snake player;
-    /*! \var int appleCount
-     *  \brief Number of apples currently on board
-     *
-     *  Count is always keept at 1
+    char replayName[REPLAYNAMESIZE] = "replay file";
+    /*! \var int recorded
+     *  \brief True if the replay file was written completely
      */
-    int appleCount = 0;
-    /*! \var coord apple
-     *  \brief Coordinate of the apple
+    int recorded = 0;
+    /*! \var const char * statsFile
+     *  \brief Name of the file the timing histograms are dumped to, NULL for none
      */
-    coord apple;
-    /*! \var FILE * datafile
-     *  \brief Pointer to file containing the Top 10 list
+    const char * statsFile = NULL;
+    /*! \var tickStats stats
+     *  \brief Timing histograms of the game phases, frame sizes and tick lateness
      */
-    FILE * datafile;
-    /*! \var char name[40]
-     *  \brief Players name input
+    tickStats stats;
+    /*! \var broadcaster spectators
+     *  \brief Streams the game to the viewers, used if spectatorPort is set
+     */
+    broadcaster spectators;
+    /*! \var int spectatorPort
+     *  \brief TCP port of the viewers, 0 if the game is not broadcast
+     */
+    int spectatorPort = 0;
+    /*! \var autopilot pilot
+     *  \brief Plays the game instead of the keyboard, used if piloted is set
+     */
+    autopilot pilot;
+    /*! \var int piloted
+     *  \brief True if the autopilot plays, the arrow keys are ignored
+     */
+    int piloted = 0;
+    /*! \var snapshotWriter saver
+     *  \brief Saves the game in the background, used if saving is set
+     */
+    snapshotWriter saver;
+    /*! \var snapshotData snapshot
+     *  \brief The snapshot file the game continues from
+     */
+    snapshotData snapshot = { NULL, 0 };
+    /*! \var snapshotInfo resumeInfo
+     *  \brief Board size and summary of the snapshot
+     */
+    snapshotInfo resumeInfo;
+    /*! \var const char * snapshotFile
+     *  \brief Name of the snapshot file, NULL if the game is not saved
+     */
+    const char * snapshotFile = NULL;
+    /*! \var int saving
+     *  \brief True while the writer thread runs
+     */
+    int saving = 0;
+    /*! \var long long resumeNs
+     *  \brief Time of mapping, checking and restoring the snapshot, -1 for a new game
      */
-    char name[40];
-    /*! \var struct entry toplist[10]
-     *  \brief Top 10 list read from file / written to file
+    long long resumeNs = -1;
+    /*! \var long long startNs
+     *  \brief Start of the snapshot load
      */
-    struct entry toplist[10];
+    long long startNs = 0;
+    /*! \var int hud
+     *  \brief True while the timings are shown below the board
+     */
+    int hud = 0;
+    /*! \var char hudLine[256]
+     *  \brief Text of the timing line
+     */
+    char hudLine[256];
+    /*! \var unsigned char direction
+     *  \brief Running direction before the input was processed
+     */
+    unsigned char direction;
+    /*! \var int boardWidth, boardHeight
+     *  \brief Size of the game board
+     */
+    int boardWidth = BOARDSIZEX, boardHeight = BOARDSIZEY;
+    /*! \var int option
+     *  \brief Command line option
+     */
+    int option;
+    /*! \var int events
+     *  \brief Events returned by the scheduler
+     */
+    int events;
+    /*! \var int inputFd
+     *  \brief Notification of the input thread polled by the scheduler, -1 when input is closed
+     */
+    int inputFd = -1;
+    /*! \var inputReader keys
+     *  \brief Input thread and its queue of key presses
+     */
+    inputReader keys;
+    /*! \var keyEvent key
+     *  \brief Key press taken from the queue
+     */
+    keyEvent key;
+    /*! \var inputLatency latency
+     *  \brief Time from key press to the frame showing the turn
+     */
+    inputLatency latency = { 0, 0, 0, 0, 0 };
+    /*! \var int turned
+     *  \brief True when a key turned the snake in this tick
+     */
+    int turned;
+    /*! \var uint64_t wakeups
+     *  \brief Counter read from the input notification
+     */
+    uint64_t wakeups;
+    /*! \var unsigned char input
+     *  \brief Input character after processing
+     */
+    unsigned char input = '\0';
+    /*! \var int gameRun
+     *  \brief True while the game runs, when player lose or quit it is set to false
+     */
+    int gameRun = 1;
     /*! \var struct termios cooked, raw
      *  \brief Contains the state of terminal
      *
@@ -173,8 +580,127 @@ int main(int argc, char **argv) {
      *  The actual window size is required for proper rendering
      */
     struct winsize w;
+    /*! \var struct sigaction action
+     *  \brief Window size change signal handler
+     */
+    struct sigaction action;
+
+    while ((option = getopt(argc, argv, "c:x:y:o:p:s:b:ar:")) != -1) {    // Configuration file first, command line overrides it
+        switch (option) {
+            case 'c':
+                if (readConfigFile(optarg, &boardWidth, &boardHeight) != 0) {
+                    return 1;
+                }
+                break;
+            case 'x':
+                if (readBoardSize(optarg, &boardWidth) != 0) {
+                    return 1;
+                }
+                break;
+            case 'y':
+                if (readBoardSize(optarg, &boardHeight) != 0) {
+                    return 1;
+                }
+                break;
+            case 'o':
+                replayFile = optarg;
+                break;
+            case 'p':
+                return playReplay(optarg);
+            case 's':
+                statsFile = optarg;
+                break;
+            case 'b':
+                spectatorPort = atoi(optarg);
+                if ((spectatorPort < 1) || (spectatorPort > 65535)) {
+                    fprintf(stderr, "Invalid spectator port: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'a':
+                piloted = 1;
+                break;
+            case 'r':
+                snapshotFile = optarg;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-c configfile] [-x columns] [-y rows] [-o replayfile] [-p replayfile] [-s statsfile] [-b port] [-a] [-r snapshotfile]\n", argv[0]);
+                return 1;
+        }
+    }
 
-    ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);       // Query the terminal window size
+    if (piloted && (snapshotFile != NULL)) {                           // the body of a saved game need not follow the cycle
+        fprintf(stderr, "The autopilot can not continue a snapshot game, use -a or -r\n");
+        return 1;
+    }
+    if (snapshotFile != NULL) {                                        // the board size of a saved game wins
+        startNs = statsNow();
+        if (snapshotLoad(&snapshot, snapshotFile) == 0) {
+            snapshotHeader(&snapshot, &resumeInfo);
+            boardWidth = resumeInfo.width;
+            boardHeight = resumeInfo.height;
+        } else if (errno != ENOENT) {                                   // no file: nothing to continue
+            perror(snapshotFile);                                       // a new game replaces it
+        }
+    }
+
+    if (arenaInit(&arena, gameMemorySize(boardWidth, boardHeight) + renderMemorySize(boardWidth, boardHeight) + replayMemorySize()
+                  + (piloted ? autopilotMemorySize(boardWidth, boardHeight) : 0)) != 0) {
+        fprintf(stderr, "Not enough memory for %dx%d board\n", boardWidth, boardHeight);
+        snapshotUnload(&snapshot);
+        return 1;
+    }
+    if (piloted && (autopilotInit(&pilot, boardWidth, boardHeight, &arena) != 0)) {
+        fprintf(stderr, "The autopilot needs an even number of columns or rows\n");
+        snapshotUnload(&snapshot);
+        arenaFree(&arena);
+        return 1;
+    }
+    seed = (uint64_t) time(NULL) ^ ((uint64_t) getpid() << 32);
+    gameInit(&game, boardWidth, boardHeight, seed, &arena);                         // The arena is sized for all,
+    renderInit(&screen, STDOUT_FILENO, boardWidth, boardHeight, &arena);            // so these can not fail
+    if (snapshot.data != NULL) {
+        if (snapshotRestore(&snapshot, &game) == 0) {
+            resumeNs = statsNow() - startNs;
+        } else {
+            fprintf(stderr, "%s: damaged snapshot, a new game is started\n", snapshotFile);
+            gameReset(&game, seed);
+        }
+        snapshotUnload(&snapshot);
+    }
+    if (resumeNs >= 0) {                                                            // a replay starts with a new game,
+        memset(&recorder, 0, sizeof(recorder));                                     // a continued one is not recorded
+        recorder.fd = -1;
+    } else if (replayFile != NULL) {                                                // explicit name, overwritten
+        snprintf(replayName, sizeof(replayName), "%s", replayFile);
+        if (replayOpen(&recorder, replayFile, 0, boardWidth, boardHeight, seed, &arena) != 0) {
+            perror(replayFile);                                                     // the game is played unrecorded
+        }
+    } else if (openRecording(&recorder, replayName, boardWidth, boardHeight, seed, &arena) != 0) {
+        perror(replayName);
+    }
+    if (snapshotFile != NULL) {
+        if (snapshotStart(&saver, snapshotFile, boardWidth, boardHeight) == 0) {
+            saving = 1;
+        } else {
+            perror("snapshot writer");                                              // the game is played unsaved
+        }
+    }
+    statsInit(&stats, statsFile != NULL);                                           // off until the HUD is shown, unless dumped
+    game.stats = &stats;
+    if ((spectatorPort != 0) && (bcastStart(&spectators, spectatorPort, boardWidth, boardHeight, KEYINTERVAL) != 0)) {
+        perror("spectator port");                                                   // the game is played without viewers
+        spectatorPort = 0;
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onResize;
+    action.sa_flags = SA_RESTART;               // the input thread keeps reading
+    sigaction(SIGWINCH, &action, NULL);
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) == 0) {    // Query the terminal window size, the view is fitted to it
+        renderResize(&screen, w.ws_col, w.ws_row);
+    }
+    renderFollow(&screen, game.player.position[game.player.head].x, game.player.position[game.player.head].y);
 
 #ifdef DEBUG
     printf ("Lines: %d\n", w.ws_row);
@@ -184,133 +710,166 @@ int main(int argc, char **argv) {
     (void) tcgetattr(0, &cooked);               // Get the state of the terminal
     (void) memcpy(&raw, &cooked, sizeof(struct termios));       // Make a copy of it
     raw.c_lflag &= ~ (ICANON | ECHO);           // Turn off echoing, linebuffering, and special-character processing
-    raw.c_cc[VMIN] = 0;                         // No waiting time for input, so program is not stopped
+    raw.c_cc[VMIN] = 0;                         // No waiting time for input, program waits in poll() instead
     raw.c_cc[VTIME] = 0;                        // If no data availale READ returns 0
     (void) tcsetattr(0, TCSANOW, &raw);         // Write back the changed state
 
 
-    clearBoard(board, BOARDSIZEX, BOARDSIZEY);  // Clear game board
+    if (tickerOpen(&tick, 6) != 0) {                    // Game runs 6 ticks / second
+        (void) tcsetattr(0, TCSANOW, &cooked);
+        perror("timerfd");
+        return 1;
+    }
 
-    for (i = 0; i< BOARDSIZEX * BOARDSIZEY; i++) {      // Clear snake data.
-        player.position[i].x = 0;
-        player.position[i].y = 0;
-    };
-    player.head = 0;
-    player.tail = 0;
-    player.position[player.head].x = BOARDSIZEX / 2;    // Positon snake at the center of the board
-    player.position[player.head].y = BOARDSIZEY / 2;
+    if (inputStart(&keys, STDIN_FILENO) != 0) {        // Keys are read by their own thread
+        tickerClose(&tick);
+        (void) tcsetattr(0, TCSANOW, &cooked);
+        perror("input thread");
+        return 1;
+    }
+    inputFd = keys.notifyFd;
 
-    player.snakeCurrentLength = 1;                      // Initial snake length
-    player.snakeSupposedLength = 4;                     // The snake "flows in"
-    player.runningDirection = 'l';                      // Snake runs to the left
+    while (gameRun) {                                   // main event loop starts here
+        events = tickerWait(&tick, inputFd);            // Sleep until ESC, end of input or next tick
+        if (events < 0) {
+            break;
+        }
 
-    srand (time(NULL));                                 // Init random number generator
+        if (resized) {                                  // full repaint with the next frame
+            resized = 0;
+            if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) == 0) {
+                renderResize(&screen, w.ws_col, w.ws_row);
+            }
+        }
 
-    while (gameRun) {                                   // main event loop starts here
-        input = readInput();                            // Read user input
-        if (input == 27) {                              // Game stops when ESC key pressed
+        if (events & TICKER_INPUT) {
+            (void) read(inputFd, &wakeups, sizeof(wakeups));
+            if (inputEscape(&keys)) {                   // Game stops when ESC key pressed
                 gameRun = 0;
+            }
+            if (inputClosed(&keys)) {                   // Input closed, only the timer is waited for
+                inputFd = -1;
+            }
         }
 
+        if (gameRun && (events & TICKER_TICK)) {        // timed part, runs only n times / second
+            statsBegin(&stats);
+            turned = 0;
+            while (!turned && inputNextKey(&keys, &key)) {  // at most one turn per tick, the rest waits in the queue
+                input = key.key;
 #ifdef DEBUG
-        if (input == ' ') {                             // In debug mode it is possible to pause the game
-            do {
-                input = readInput();
-            } while (input != ' ');
-            input = readInput();
-        }
+                if (input == ' ') {                     // In debug mode it is possible to pause the game
+                    do {
+                        while (!inputNextKey(&keys, &key)) {
+                            usleep(10000);
+                        }
+                    } while (key.key != ' ');
+                    continue;
+                }
 #endif
+                if (input == KEYHUD) {                  // timings on screen on or off
+                    hud = !hud;
+                    stats.enabled = hud || (statsFile != NULL);
+                    statsBegin(&stats);                 // probes switched on in the middle of the tick
+                    (void) statsFormat(&stats, hudLine, sizeof(hudLine));
+                    renderStatus(&screen, hud ? hudLine : NULL);
+                    continue;
+                }
+                if (piloted) {                          // the autopilot steers
+                    continue;
+                }
+                direction = game.player.runningDirection;
+                updateSnakeDirection(&game.player, input);  // update snake direction according to input
+                if (game.player.runningDirection != direction) {
+                    replayRecord(&recorder, game.ticks, game.player.runningDirection);  // only copied to memory
+                    turned = 1;                         // keys with no effect do not use up the tick
+                }
+            }
+            if (piloted) {                              // in place of the keys
+                direction = game.player.runningDirection;
+                updateSnakeDirection(&game.player, autopilotInput(&pilot, &game));
+                if (game.player.runningDirection != direction) {
+                    replayRecord(&recorder, game.ticks, game.player.runningDirection);
+                }
+            }
+            statsLap(&stats, STATINPUT);
 
-        updateSnakeDirection(&player, input);           // update snake direction according to input
-
-        currentTime = clock();
-        if ((currentTime - previousTime) > (CLOCKS_PER_SEC / 6) ) {     // timed part, runs only n times / second
-            previousTime = currentTime;
-
-            updateSnake(&player);                       // update snake position and length
+            gameRun = gameStep(&game, '\0');            // move, check collision, eat and place apple
 
-            // check snake collision
-            if (board[player.position[player.head].x][player.position[player.head].y] == 'o') {     // Snake hits itself
-                // game over
-                gameRun = 0;
+            renderFollow(&screen, game.player.position[game.player.head].x, game.player.position[game.player.head].y);   // camera on the head
+            renderDirty(&screen, &game.occupied, game.appleCount ? &game.apple : NULL, &game.dirty, game.score);   // draw changed cells
+            if (spectatorPort != 0) {                   // encoded once, the viewers are served by another thread
+                (void) bcastPublish(&spectators, &game.occupied, game.appleCount ? &game.apple : NULL, &game.dirty, game.score);
             }
-            if ((player.position[player.head].x < 0) || (player.position[player.head].x == BOARDSIZEX)) {   // Snake hits vetical wall
-                // game over
-                gameRun = 0;
+            statsLap(&stats, STATDRAW);
+            statsEnd(&stats);
+            statsRecord(&stats, STATBYTES, (long long) screen.lastFrameBytes);
+            statsRecord(&stats, STATLATE, tick.lastJitterNs);
+            stats.missedTicks = tick.missedTicks;
+            if (turned) {
+                inputLatencyAdd(&latency, inputNow() - key.timeNs);         // key read .. frame written
             }
-            if ((player.position[player.head].y < 0) || (player.position[player.head].y == BOARDSIZEY)) {   // Snake hits hoizontal wall
-                // game over
-                gameRun = 0;
+
+            if (recorder.length > REPLAYBUFFERSIZE / 2) {                   // frame is out, write the replay
+                (void) replayFlush(&recorder);
             }
-            if (board[player.position[player.head].x][player.position[player.head].y] == 'b') {             // Snake eats apple
-                // ate apple
-                score += 10;
-                appleCount = 0;
-                player.snakeSupposedLength++;
+            if (saving && gameRun && (game.ticks % SNAPSHOTTICKS == 0)) {   // only copied, written by the thread
+                (void) snapshotSave(&saver, &game);
             }
-
-            if (appleCount == 0) {                                  // if no apple, find position for apple
-                appleCount = placeApple(&apple, &player);
-                if (appleCount == 0) {                              // no more apple possible...
-                    gameRun = 0;                                    // ..so the game ends
-                }
+            if (hud) {                                                      // shown with the next frame
+                (void) statsFormat(&stats, hudLine, sizeof(hudLine));
             }
 
-            updateBoard(board, &apple, &player, appleCount);        // update board
-
-            drawScreen(board, score, w.ws_row);                     // draw board
-
 #ifdef DEBUG
             // DEBUG: print some variable values
-            printf ("SnakeCurrentLength: %ld SnakeSupposedLength: %ld Head: %ld Tail: %ld Time: %ld Input %c", player.snakeCurrentLength, player.snakeSupposedLength, player.head, player.tail,  currentTime, input);
+            printf ("SnakeCurrentLength: %ld SnakeSupposedLength: %ld Head: %ld Tail: %ld Tick: %lu Jitter: %ld us Missed: %lu Bytes: %zu Writes: %lu Input %c Key latency: %lld us\033[K", game.player.snakeCurrentLength, game.player.snakeSupposedLength, game.player.head, game.player.tail, tick.ticks, tick.lastJitterNs / 1000, tick.missedTicks, screen.lastFrameBytes, screen.lastFrameSyscalls, input, latency.lastNs / 1000);
+            (void) fflush(stdout);
 #endif
-            printf("\n");
         } // timed part ends
 
     } // main event loop ends
 
+    inputStop(&keys);
+    tickerClose(&tick);
+    if (spectatorPort != 0) {
+        bcastStop(&spectators);
+    }
+    if (saving) {                                                   // lost or quit, nothing left to continue
+        snapshotStop(&saver, 1);
+    }
     (void) tcsetattr(0, TCSANOW, &cooked);                          // Restore the original cooked state of terminal
-
-    printf("\n\nGAME OVER!\n\n");
-    printf("Your final score is: %d\n", score);
-
-    for (i = 0; i < 10; i++) {                                      // Empty Top 10 list
-        memset(toplist[i].name, 0, sizeof(toplist[i].name));
-        toplist[i].score = 0;
+    if (recorder.fd >= 0) {
+        recorded = replayClose(&recorder, game.ticks, game.score, game.player.snakeCurrentLength) == 0;
+        if (!recorded) {
+            perror(replayName);
+        }
+    }
+    if ((statsFile != NULL) && (statsWriteJson(&stats, statsFile) != 0)) {
+        perror(statsFile);
     }
 
-    datafile = fopen("snakegame.dat", "ab+");                       // Open data file, if it is not exist, it is created
-    if (datafile != NULL) {
-        rewind(datafile);                                           // Go to the beginning
-
-        fread(toplist, sizeof(toplist[0]), 10, datafile);           // Read in the top list
-        fclose(datafile);                                           // ...and close
-
-        if (toplist[9].score < score) {                             // Player earned a place on top list
-            printf("You earned a place on the top list! Enter your name: ");
-            fgets(name, sizeof(name)-1, stdin);                     // Ask for players name
-            name[strlen(name)-1] = '\0';
-            printf("\n");
-
-            memcpy(toplist[9].name, name, sizeof(name));            // Put player at the last poition
-            toplist[9].score = score;
-
-            sortToplist(toplist, 10);                               // Sort the list
-
-            datafile = fopen("snakegame.dat", "wb");                // Write the top list back to file
-            if (datafile != NULL) {
-                fwrite(toplist, sizeof(toplist[0]), 10, datafile);
-                fclose(datafile);
-            }
-        }
+#ifdef DEBUG
+    if (tick.ticks > 0) {                                           // DEBUG: scheduling jitter summary
+        printf("Ticks: %lu Missed: %lu Jitter avg: %lld us max: %ld us\n", tick.ticks, tick.missedTicks, tick.sumJitterNs / (long long) tick.ticks / 1000, tick.maxJitterNs / 1000);
+        printf("Frames: %lu Bytes: %llu Writes: %lu\n", screen.frames, screen.totalBytes, screen.totalSyscalls);
+    }
+#endif
 
-        printf("    Hall of fame\n");                               // print top list
-        for (i = 0; i < 10; i++) {
-            printf("%4ld %30s %6d\n", i+1, toplist[i].name, toplist[i].score);
-        }
-        printf("\n");
+    printf("\n\nGAME OVER!\n\n");
+    printf("Your final score is: %d\n", game.score);
+    if (resumeNs >= 0) {
+        printf("Continued from %s at tick %lu, restored in %.1f us\n", snapshotFile, resumeInfo.ticks, resumeNs / 1000.0);
     }
+    if (recorded) {
+        printf("Game recorded to %s\n", replayName);
+    }
+    if (latency.count > 0) {
+        printf("Key to screen latency: %lu turns, average %.1f ms, min %.1f ms, max %.1f ms\n", latency.count, latency.sumNs / (double) latency.count / 1e6, latency.minNs / 1e6, latency.maxNs / 1e6);
+    }
+
+    recordScore(game.score);                                        // Service first, the store files if it is not running
 
+    arenaFree(&arena);
     return 0;
 } // main function ends
 
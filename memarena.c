@@ -0,0 +1,45 @@
+/*! \file memarena.c
+ * \brief Memory arena
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "memarena.h"
+
+int arenaInit(memArena * arena, size_t size) {
+    arena->size = ARENABLOCK(size);
+    arena->used = 0;
+    if (posix_memalign((void **) &arena->base, ARENAALIGN, arena->size) != 0) {
+        arena->base = NULL;
+        arena->size = 0;
+        return -1;
+    }
+    memset(arena->base, 0, arena->size);
+    return 0;
+} // arenaInit function ends
+
+void * arenaAlloc(memArena * arena, size_t size) {
+    /*! \var void * block
+     *  \brief The block handed out
+     */
+    void * block;
+
+    if (ARENABLOCK(size) > arena->size - arena->used) {                 // not enough space left
+        return NULL;
+    }
+    block = arena->base + arena->used;
+    arena->used += ARENABLOCK(size);                                    // next block starts on a cache line
+    return block;
+} // arenaAlloc function ends
+
+void arenaFree(memArena * arena) {
+    free(arena->base);
+    arena->base = NULL;
+    arena->size = 0;
+    arena->used = 0;
+} // arenaFree function ends
+
+// End of memarena.c
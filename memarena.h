@@ -0,0 +1,69 @@
+/*! \file memarena.h
+ * \brief Memory arena header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * All game state is carved out of one allocation made at startup,
+ * nothing is allocated while the game runs
+ */
+
+#include <stddef.h>
+
+#ifndef SNAKEGAME_MEMARENA_H
+#define SNAKEGAME_MEMARENA_H
+
+/*! \def ARENAALIGN
+ *  \brief Alignment of every block taken from the arena, one cache line
+ */
+#define ARENAALIGN 64
+
+/*! \def ARENABLOCK
+ *  \brief Space a block of the given size takes in the arena, including alignment
+ */
+#define ARENABLOCK(size) (((size) + ARENAALIGN - 1) / ARENAALIGN * ARENAALIGN)
+
+/*! \typedef struct memArena
+ *  \brief Contains one memory arena
+ *
+ * \var unsigned char * base Start of the allocation
+ * \var size_t size Size of the allocation
+ * \var size_t used Bytes already handed out
+ */
+typedef struct memArena_t {
+    unsigned char * base;
+    size_t size;
+    size_t used;
+} memArena;
+
+/*! \fn int arenaInit(memArena * arena, size_t size)
+ * \brief Allocate the arena
+ *
+ * The memory is zero filled
+ *
+ * \param arena Pointer to arena
+ * \param size Number of bytes, sum of ARENABLOCK sizes of all blocks
+ * \return int 0 on success, -1 if memory is not available
+ */
+int arenaInit(memArena * arena, size_t size);
+
+/*! \fn void * arenaAlloc(memArena * arena, size_t size)
+ * \brief Take one block from the arena
+ *
+ * \param arena Pointer to arena
+ * \param size Number of bytes
+ * \return void * Cache line aligned block, NULL if the arena is exhausted
+ */
+void * arenaAlloc(memArena * arena, size_t size);
+
+/*! \fn void arenaFree(memArena * arena)
+ * \brief Release the arena with all blocks taken from it
+ *
+ * \param arena Pointer to arena
+ * \return void No values returned
+ */
+void arenaFree(memArena * arena);
+
+#endif //SNAKEGAME_MEMARENA_H
+
+// End of memarena.h
@@ -0,0 +1,370 @@
+/*! \file multisnake.c
+ * \brief Multi-snake arena
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "multisnake.h"
+#include "engine.h"
+
+/*! \def CLAIMFREE, CLAIMCONTESTED
+ *  \brief Claim of a cell no head arrived on, and of a cell several heads arrived on
+ */
+#define CLAIMFREE (-1)
+#define CLAIMCONTESTED (-2)
+
+/*! \def BLOCKEDWALL, BLOCKEDHEADON
+ *  \brief Values of multiSnake.blocked: hit a wall or a body, crashed into another head
+ */
+#define BLOCKEDWALL 1
+#define BLOCKEDHEADON 2
+
+/*! \fn static size_t cellIndex(const multiGame * game, const coord * cell)
+ * \brief Index of a board cell in the claim array
+ */
+static size_t cellIndex(const multiGame * game, const coord * cell) {
+    return (size_t) cell->y * (size_t) game->config.width + (size_t) cell->x;
+}
+
+/*! \fn static int randomFreeCell(multiGame * game, coord * cell)
+ * \brief Pick a random cell without body or apple, 0 if none was found in MULTISPAWNTRIES tries
+ */
+static int randomFreeCell(multiGame * game, coord * cell) {
+    int i;
+
+    for (i = 0; i < MULTISPAWNTRIES; i++) {
+        cell->x = (int) rngBounded(&game->rng, (uint32_t) game->config.width);
+        cell->y = (int) rngBounded(&game->rng, (uint32_t) game->config.height);
+        if (!bitTest(&game->occupied, cell->x, cell->y) && !bitTest(&game->fruit, cell->x, cell->y)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*! \fn static void spawnSnake(multiGame * game, multiSnake * ms)
+ * \brief Start a new life at a random free cell, the same start as initSnake otherwise
+ */
+static void spawnSnake(multiGame * game, multiSnake * ms) {
+    static const char directions[] = "udlr";
+    coord cell;
+
+    if (!randomFreeCell(game, &cell)) {
+        return;                                                         // board too full, try next tick
+    }
+    ms->body.head = 0;
+    ms->body.tail = 0;
+    ms->body.position[0] = cell;
+    ms->body.snakeCurrentLength = 1;
+    ms->body.snakeSupposedLength = 4;
+    ms->body.runningDirection = (unsigned char) directions[rngBounded(&game->rng, 4)];
+    ms->input = 0;
+    ms->score = 0;
+    ms->alive = 1;
+    bitAssign(&game->occupied, cell.x, cell.y, 1);
+    game->alive++;
+}
+
+/*! \fn static void placeApples(multiGame * game)
+ * \brief Fill the board up to the configured number of apples
+ */
+static void placeApples(multiGame * game) {
+    coord cell;
+
+    while ((game->appleCount < game->config.apples) && randomFreeCell(game, &cell)) {
+        game->apples[game->appleCount++] = cell;
+        bitAssign(&game->fruit, cell.x, cell.y, 1);
+    }
+}
+
+/*! \fn static void eatApple(multiGame * game, const coord * cell)
+ * \brief Remove the apple at a cell
+ */
+static void eatApple(multiGame * game, const coord * cell) {
+    int i;
+
+    bitAssign(&game->fruit, cell->x, cell->y, 0);
+    for (i = 0; i < game->appleCount; i++) {
+        if ((game->apples[i].x == cell->x) && (game->apples[i].y == cell->y)) {
+            game->apples[i] = game->apples[--game->appleCount];         // order of apples does not matter
+            return;
+        }
+    }
+}
+
+/*! \fn static void removeBody(multiGame * game, multiSnake * ms)
+ * \brief Clear the cells of a dead snake, the new head was never set
+ */
+static void removeBody(multiGame * game, multiSnake * ms) {
+    snake * sn = &ms->body;
+    size_t i = sn->tail;
+
+    if (ms->tailMoved) {
+        bitAssign(&game->occupied, ms->oldTail.x, ms->oldTail.y, 0);
+    }
+    while (i != sn->head) {
+        bitAssign(&game->occupied, sn->position[i].x, sn->position[i].y, 0);
+        i = (i + 1 == sn->capacity) ? 0 : i + 1;
+    }
+}
+
+/*! \fn static void moveSnakes(multiGame * game, int first, int end)
+ * \brief Move phase of snakes first .. end - 1, reads the grid and writes only these snakes
+ */
+static void moveSnakes(multiGame * game, int first, int end) {
+    multiSnake * ms;
+    coord * head;
+    size_t tailIndex;
+    int i;
+
+    for (i = first; i < end; i++) {
+        ms = &game->snakes[i];
+        if (!ms->alive) {
+            continue;
+        }
+        if (game->config.policy != NULL) {
+            ms->input = game->config.policy(game->config.policyContext, game, i);
+        }
+        updateSnakeDirection(&ms->body, ms->input);
+        ms->input = 0;                                                  // one turn per tick
+        ms->oldTail = ms->body.position[ms->body.tail];
+        tailIndex = ms->body.tail;
+        updateSnake(&ms->body);
+        ms->tailMoved = ms->body.tail != tailIndex;
+        head = &ms->body.position[ms->body.head];
+        ms->blocked = bitTest(&game->occupied, head->x, head->y);       // grid of the previous tick
+    }
+}
+
+/*! \fn static void * workerMain(void * argument)
+ * \brief Thread of the move phase: move its block of snakes once per tick
+ */
+static void * workerMain(void * argument) {
+    multiWorker * wk = argument;
+    multiGame * game = wk->game;
+
+    pthread_mutex_lock(&game->gateLock);                                // until every thread started and the barriers exist
+    while (!game->gateOpen) {
+        pthread_cond_wait(&game->gateOpened, &game->gateLock);
+    }
+    pthread_mutex_unlock(&game->gateLock);
+    if (game->stopping) {
+        return NULL;                                                    // another thread could not start, there are no barriers
+    }
+    for (;;) {
+        pthread_barrier_wait(&game->start);
+        if (game->stopping) {
+            return NULL;
+        }
+        moveSnakes(game, wk->first, wk->end);
+        pthread_barrier_wait(&game->done);
+    }
+}
+
+/*! \fn static void mergeSnakes(multiGame * game)
+ * \brief Merge phase: resolve the crashes in snake order and apply the moves to the grid
+ */
+static void mergeSnakes(multiGame * game) {
+    multiSnake * ms;
+    coord * head;
+    size_t cell;
+    int i;
+
+    for (i = 0; i < game->config.snakes; i++) {                         // heads claim their cells
+        ms = &game->snakes[i];
+        if (ms->alive && !ms->blocked) {
+            cell = cellIndex(game, &ms->body.position[ms->body.head]);
+            game->claimOwner[cell] = game->claimOwner[cell] == CLAIMFREE ? i : CLAIMCONTESTED;
+        }
+    }
+    for (i = 0; i < game->config.snakes; i++) {                         // a shared cell kills every claimant
+        ms = &game->snakes[i];
+        if (ms->alive && !ms->blocked
+            && (game->claimOwner[cellIndex(game, &ms->body.position[ms->body.head])] != i)) {
+            ms->blocked = BLOCKEDHEADON;
+            game->headOns++;
+        }
+    }
+    for (i = 0; i < game->config.snakes; i++) {
+        ms = &game->snakes[i];
+        if (!ms->alive) {
+            continue;
+        }
+        head = &ms->body.position[ms->body.head];
+        if (ms->blocked != BLOCKEDWALL) {
+            game->claimOwner[cellIndex(game, head)] = CLAIMFREE;         // ready for the next tick
+        }
+        if (ms->blocked) {                                              // snake dies
+            removeBody(game, ms);
+            ms->alive = 0;
+            ms->deaths++;
+            ms->best = ms->score > ms->best ? ms->score : ms->best;
+            game->alive--;
+            continue;
+        }
+        if (ms->tailMoved) {                                            // old tail cell is free
+            bitAssign(&game->occupied, ms->oldTail.x, ms->oldTail.y, 0);
+        }
+        bitAssign(&game->occupied, head->x, head->y, 1);
+        if (bitTest(&game->fruit, head->x, head->y)) {                  // snake eats apple
+            ms->score += APPLESCORE;
+            ms->body.snakeSupposedLength += ms->body.snakeSupposedLength < ms->body.capacity;
+            eatApple(game, head);
+        }
+    }
+}
+
+int multiInit(multiGame * game, const multiConfig * config) {
+    /*! \var size_t cells
+     *  \brief Number of cells on the board
+     */
+    size_t cells = (size_t) config->width * (size_t) config->height;
+    /*! \var size_t ringBytes
+     *  \brief Arena space of one snake ring
+     */
+    size_t ringBytes = ARENABLOCK(config->maxLength * sizeof(coord));
+    size_t i;
+    int t, started;
+
+    if ((config->width < MINBOARDSIZE) || (config->width > MAXBOARDSIZE) || (config->height < MINBOARDSIZE) || (config->height > MAXBOARDSIZE)
+        || (config->snakes < 1) || (config->apples < 0) || (config->maxLength < 4)
+        || (config->threads < 1) || (config->threads > MULTIMAXTHREADS)) {
+        return -1;
+    }
+    memset(game, 0, sizeof(*game));
+    game->config = *config;
+    if ((arenaInit(&game->memory, 2 * bitboardMemorySize(config->width, config->height)
+                   + ARENABLOCK((size_t) config->snakes * sizeof(multiSnake)) + (size_t) config->snakes * ringBytes
+                   + ARENABLOCK((size_t) config->apples * sizeof(coord) + 1) + ARENABLOCK(cells * sizeof(int32_t))) != 0)
+        || (initBitboard(&game->occupied, config->width, config->height, &game->memory) != 0)
+        || (initBitboard(&game->fruit, config->width, config->height, &game->memory) != 0)) {
+        arenaFree(&game->memory);
+        return -1;
+    }
+    game->snakes = arenaAlloc(&game->memory, (size_t) config->snakes * sizeof(multiSnake));
+    for (t = 0; t < config->snakes; t++) {
+        game->snakes[t].body.position = arenaAlloc(&game->memory, config->maxLength * sizeof(coord));
+        game->snakes[t].body.capacity = config->maxLength;
+    }
+    game->apples = arenaAlloc(&game->memory, (size_t) config->apples * sizeof(coord) + 1);
+    game->claimOwner = arenaAlloc(&game->memory, cells * sizeof(int32_t));
+    for (i = 0; i < cells; i++) {
+        game->claimOwner[i] = CLAIMFREE;
+    }
+    rngSeed(&game->rng, config->seed);
+    for (t = 0; t < config->snakes; t++) {                              // in index order, so the layout depends on the seed only
+        spawnSnake(game, &game->snakes[t]);
+    }
+    placeApples(game);
+
+    for (t = 0; t < config->threads; t++) {                             // contiguous block of snakes per thread
+        game->workers[t].game = game;
+        game->workers[t].first = (int) ((long) config->snakes * t / config->threads);
+        game->workers[t].end = (int) ((long) config->snakes * (t + 1) / config->threads);
+    }
+    if (config->threads > 1) {
+        pthread_mutex_init(&game->gateLock, NULL);
+        pthread_cond_init(&game->gateOpened, NULL);
+        for (started = 1; started < config->threads; started++) {
+            if (pthread_create(&game->workers[started].thread, NULL, workerMain, &game->workers[started]) != 0) {
+                break;
+            }
+        }
+        pthread_mutex_lock(&game->gateLock);
+        if (started < config->threads) {
+            game->stopping = 1;                                         // the started threads leave at the gate
+        } else {
+            pthread_barrier_init(&game->start, NULL, (unsigned) config->threads);
+            pthread_barrier_init(&game->done, NULL, (unsigned) config->threads);
+        }
+        game->gateOpen = 1;
+        pthread_cond_broadcast(&game->gateOpened);
+        pthread_mutex_unlock(&game->gateLock);
+        if (started < config->threads) {
+            for (t = 1; t < started; t++) {
+                pthread_join(game->workers[t].thread, NULL);
+            }
+            pthread_cond_destroy(&game->gateOpened);
+            pthread_mutex_destroy(&game->gateLock);
+            arenaFree(&game->memory);
+            return -1;
+        }
+    }
+    return 0;
+} // multiInit function ends
+
+void multiStep(multiGame * game) {
+    /*! \var int i
+     *  \brief Loop index variable
+     */
+    int i;
+
+    game->ticks++;
+    if (game->config.threads > 1) {
+        pthread_barrier_wait(&game->start);                             // every thread moves its block
+        moveSnakes(game, game->workers[0].first, game->workers[0].end);
+        pthread_barrier_wait(&game->done);
+    } else {
+        moveSnakes(game, 0, game->config.snakes);
+    }
+    statsLap(game->stats, STATSNAKE);
+
+    mergeSnakes(game);
+    statsLap(game->stats, STATCOLLISION);
+
+    placeApples(game);
+    statsLap(game->stats, STATAPPLE);
+
+    if (game->config.respawn) {
+        for (i = 0; i < game->config.snakes; i++) {
+            if (!game->snakes[i].alive) {
+                spawnSnake(game, &game->snakes[i]);
+            }
+        }
+    }
+    statsLap(game->stats, STATBOARD);
+} // multiStep function ends
+
+void multiFree(multiGame * game) {
+    /*! \var int t
+     *  \brief Loop index variable
+     */
+    int t;
+
+    if (game->config.threads > 1) {
+        game->stopping = 1;
+        pthread_barrier_wait(&game->start);                             // the threads see stopping and end
+        for (t = 1; t < game->config.threads; t++) {
+            pthread_join(game->workers[t].thread, NULL);
+        }
+        pthread_barrier_destroy(&game->start);
+        pthread_barrier_destroy(&game->done);
+        pthread_cond_destroy(&game->gateOpened);
+        pthread_mutex_destroy(&game->gateLock);
+    }
+    arenaFree(&game->memory);
+} // multiFree function ends
+
+uint64_t multiChecksum(const multiGame * game) {
+    /*! \var uint64_t checksum
+     *  \brief Fingerprint of the arena
+     */
+    uint64_t checksum = game->ticks;
+    const multiSnake * ms;
+    int i;
+
+    for (i = 0; i < game->config.snakes; i++) {
+        ms = &game->snakes[i];
+        checksum = checksum * 31 + (uint64_t) ms->alive * 1000003u + (uint64_t) ms->score * 7919u + (uint64_t) ms->deaths;
+        checksum = checksum * 31 + (uint64_t) (ms->body.position[ms->body.head].x * 65536 + ms->body.position[ms->body.head].y);
+    }
+    for (i = 0; i < game->appleCount; i++) {
+        checksum = checksum * 31 + (uint64_t) (game->apples[i].x * 65536 + game->apples[i].y);
+    }
+    return checksum;
+} // multiChecksum function ends
+
+// End of multisnake.c
@@ -0,0 +1,202 @@
+/*! \file multisnake.h
+ * \brief Multi-snake arena header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Many snakes, human or bot, on one large board with several apples.
+ * A tick has two phases. In the move phase the snakes are cut into one
+ * contiguous block per thread: each snake gets its input, moves with
+ * updateSnake and tests its new head against the occupancy grid of the
+ * previous tick, which nobody writes during the phase. In the merge phase
+ * one thread walks the snakes in index order, kills the snakes that hit a
+ * wall or a body and every snake of a head-to-head, updates the grid, eats
+ * and places apples and respawns. The result does not depend on the number
+ * of threads.
+ */
+
+#ifndef SNAKEGAME_MULTISNAKE_H
+#define SNAKEGAME_MULTISNAKE_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include "snake.h"
+#include "bitboard.h"
+#include "memarena.h"
+#include "stats.h"
+
+/*! \def MULTIMAXTHREADS
+ *  \brief Largest number of threads of the move phase
+ */
+#define MULTIMAXTHREADS 64
+
+/*! \def MULTISPAWNTRIES
+ *  \brief Random cells tried for a new snake or apple before giving up for this tick
+ */
+#define MULTISPAWNTRIES 64
+
+/*! \typedef struct multiSnake
+ *  \brief Contains 1 snake of the arena
+ *
+ * Padded to cache lines, so the threads of the move phase do not share lines
+ *
+ * \var snake body The snake, its ring holds at most maxLength segments
+ * \var coord oldTail Tail position before the move of this tick
+ * \var int tailMoved True if the tail left oldTail in this tick
+ * \var int blocked True if the new head is on a wall or on a body of the previous tick
+ * \var int alive True while the snake plays
+ * \var int score Score of the current life
+ * \var int best Best score of all lives
+ * \var int deaths Number of lives lost
+ * \var unsigned char input Next direction u, d, l, r, set by the player or the policy
+ */
+typedef struct multiSnake_t {
+    snake body;
+    coord oldTail;
+    int tailMoved;
+    int blocked;
+    int alive;
+    int score;
+    int best;
+    int deaths;
+    unsigned char input;
+} __attribute__((aligned(ARENAALIGN))) multiSnake;
+
+struct multiGame_t;
+
+/*! \typedef multiPolicy
+ *  \brief Function choosing the next input of one snake
+ *
+ * Called for every live snake at the start of the move phase, from the threads
+ * It may read the grids, the apples and its own snake, the other snakes are moving
+ */
+typedef unsigned char (*multiPolicy)(void * context, const struct multiGame_t * game, int index);
+
+/*! \typedef struct multiConfig
+ *  \brief Settings of an arena
+ *
+ * \var int width, height Board size
+ * \var int snakes Number of snakes
+ * \var int apples Number of apples kept on the board
+ * \var size_t maxLength Longest snake, the size of each ring
+ * \var int threads Number of threads of the move phase, the caller included
+ * \var int respawn True if dead snakes come back at a random free cell
+ * \var uint64_t seed Random number seed, the same seed and inputs give the same game
+ * \var multiPolicy policy Input of the snakes, NULL to keep the input fields set by the caller
+ * \var void * policyContext Passed to the policy
+ */
+typedef struct multiConfig_t {
+    int width;
+    int height;
+    int snakes;
+    int apples;
+    size_t maxLength;
+    int threads;
+    int respawn;
+    uint64_t seed;
+    multiPolicy policy;
+    void * policyContext;
+} multiConfig;
+
+/*! \typedef struct multiWorker
+ *  \brief Contains one thread of the move phase
+ *
+ * \var struct multiGame_t * game The arena
+ * \var int first, end Snakes first .. end - 1 are moved by this thread
+ * \var pthread_t thread The thread
+ */
+typedef struct multiWorker_t {
+    struct multiGame_t * game;
+    int first;
+    int end;
+    pthread_t thread;
+} __attribute__((aligned(ARENAALIGN))) multiWorker;
+
+/*! \typedef struct multiGame
+ *  \brief Contains the complete state of one arena
+ *
+ * \var multiConfig config Settings
+ * \var memArena memory All memory of the arena
+ * \var bitboard occupied Cells of all live bodies and the walls around the board
+ * \var bitboard fruit Cells of the apples
+ * \var multiSnake * snakes The snakes
+ * \var coord * apples Apple positions, appleCount of them
+ * \var int appleCount Number of apples on the board
+ * \var int32_t * claimOwner Per cell, the snake whose head arrived there in this tick, -1 if none, -2 if several
+ * \var rngState rng Random number generator of spawns and apples
+ * \var unsigned long ticks Number of ticks made
+ * \var int alive Number of live snakes
+ * \var unsigned long headOns Number of snakes lost in head-to-head crashes
+ * \var multiWorker workers[MULTIMAXTHREADS] Threads of the move phase, worker 0 is the caller
+ * \var pthread_mutex_t gateLock Protects gateOpen
+ * \var pthread_cond_t gateOpened Signalled when gateOpen is set
+ * \var int gateOpen Set when every thread started, or when starting one failed, the threads wait for it before the first tick
+ * \var pthread_barrier_t start, done Synchronise the threads around the move phase, made once every thread started
+ * \var int stopping Set to end the threads
+ * \var tickStats * stats Times the move (STATSNAKE), merge (STATCOLLISION), apple (STATAPPLE) and respawn (STATBOARD) phases, NULL when not used
+ */
+typedef struct multiGame_t {
+    multiConfig config;
+    memArena memory;
+    bitboard occupied;
+    bitboard fruit;
+    multiSnake * snakes;
+    coord * apples;
+    int appleCount;
+    int32_t * claimOwner;
+    rngState rng;
+    unsigned long ticks;
+    int alive;
+    unsigned long headOns;
+    multiWorker workers[MULTIMAXTHREADS];
+    pthread_mutex_t gateLock;
+    pthread_cond_t gateOpened;
+    int gateOpen;
+    pthread_barrier_t start;
+    pthread_barrier_t done;
+    int stopping;
+    tickStats * stats;
+} multiGame;
+
+/*! \fn int multiInit(multiGame * game, const multiConfig * config)
+ * \brief Set up an arena, spawn the snakes and apples and start the threads
+ *
+ * The snakes are spawned in index order at random free cells, running in a random direction
+ *
+ * \param game Pointer to arena
+ * \param config Settings
+ * \return int 0 on success, -1 on bad settings, memory or thread creation error
+ */
+int multiInit(multiGame * game, const multiConfig * config);
+
+/*! \fn void multiStep(multiGame * game)
+ * \brief Advance the arena by one tick
+ *
+ * A head moving onto a cell that was a body or a wall at the start of the tick kills the snake,
+ * a cell vacated by a tail in the same tick included, like in gameStep
+ * Heads arriving on the same free cell kill all of their snakes
+ *
+ * \param game Pointer to arena
+ * \return void No values returned
+ */
+void multiStep(multiGame * game);
+
+/*! \fn void multiFree(multiGame * game)
+ * \brief Stop the threads and release the memory of the arena
+ *
+ * \param game Pointer to arena
+ * \return void No values returned
+ */
+void multiFree(multiGame * game);
+
+/*! \fn uint64_t multiChecksum(const multiGame * game)
+ * \brief Hash of the scores, lives, heads and apples, to compare runs
+ *
+ * \param game Pointer to arena
+ * \return uint64_t Checksum
+ */
+uint64_t multiChecksum(const multiGame * game);
+
+#endif //SNAKEGAME_MULTISNAKE_H
+
+// End of multisnake.h
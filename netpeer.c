@@ -0,0 +1,122 @@
+/*! \file netpeer.c
+ * \brief Nonblocking TCP peers on epoll
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#define _GNU_SOURCE                                                     // accept4
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include "netpeer.h"
+
+int netListen(int port, int sharePort) {
+    /*! \var struct sockaddr_in address
+     *  \brief Any address, the given port
+     */
+    struct sockaddr_in address;
+    /*! \var int fd, one
+     *  \brief Listening socket, option value
+     */
+    int fd, one = 1;
+
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons((uint16_t) port);
+    if ((setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0)
+        || (sharePort && (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) != 0))
+        || (bind(fd, (struct sockaddr *) &address, sizeof(address)) != 0)
+        || (listen(fd, SOMAXCONN) != 0)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+} // netListen function ends
+
+int netAccept(int epollFd, int listenFd, int * paused) {
+    /*! \var int fd
+     *  \brief Accepted socket
+     */
+    int fd;
+
+    fd = accept4(listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if ((fd < 0) && ((errno == EMFILE) || (errno == ENFILE)) && !*paused) {
+        if (epoll_ctl(epollFd, EPOLL_CTL_DEL, listenFd, NULL) == 0) {  // else epoll reports it again at once
+            *paused = 1;
+        }
+    }
+    return fd;
+} // netAccept function ends
+
+void netResume(int epollFd, int * listenFd, int * paused) {
+    /*! \var struct epoll_event event
+     *  \brief Registration of the listening socket
+     */
+    struct epoll_event event;
+
+    if (!*paused) {
+        return;
+    }
+    event.events = EPOLLIN;
+    event.data.ptr = listenFd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, *listenFd, &event) == 0) {
+        *paused = 0;
+    }
+} // netResume function ends
+
+int netAttach(int epollFd, netPeer * peer, int fd, void * owner, int sendBuffer) {
+    /*! \var struct epoll_event event
+     *  \brief Registration of the socket
+     */
+    struct epoll_event event;
+    /*! \var int one
+     *  \brief Option value
+     */
+    int one = 1;
+
+    peer->fd = fd;
+    peer->writeWatched = 0;
+    peer->closing = 0;
+    (void) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));  // a frame is one segment, send it now
+    (void) setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sendBuffer, sizeof(sendBuffer));   // the owner's queue holds the backlog, not the kernel
+    event.events = EPOLLIN;
+    event.data.ptr = owner;
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) == 0 ? 0 : -1;
+} // netAttach function ends
+
+void netWatchWrite(int epollFd, netPeer * peer, void * owner, int on) {
+    /*! \var struct epoll_event event
+     *  \brief New registration of the socket
+     */
+    struct epoll_event event;
+
+    if ((peer->writeWatched == on) || peer->closing) {
+        return;
+    }
+    event.events = EPOLLIN | (on ? EPOLLOUT : 0);
+    event.data.ptr = owner;
+    if (epoll_ctl(epollFd, EPOLL_CTL_MOD, peer->fd, &event) == 0) {
+        peer->writeWatched = on;
+    }
+} // netWatchWrite function ends
+
+void netCloseLater(int epollFd, netPeer * peer) {
+    if (!peer->closing) {
+        peer->closing = 1;
+        (void) epoll_ctl(epollFd, EPOLL_CTL_DEL, peer->fd, NULL);       // a hung up socket would be reported until then
+    }
+} // netCloseLater function ends
+
+// End of netpeer.c
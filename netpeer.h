@@ -0,0 +1,98 @@
+/*! \file netpeer.h
+ * \brief Nonblocking TCP peers on epoll header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * The game server and the spectator broadcast both serve many sockets
+ * from one epoll loop: a listening socket, peers that are watched for
+ * input and, while their send buffer is full, for output, and peers that
+ * are closed later, after the events of the batch that may still name them.
+ */
+
+#ifndef SNAKEGAME_NETPEER_H
+#define SNAKEGAME_NETPEER_H
+
+/*! \typedef struct netPeer
+ *  \brief Contains the socket of a peer and its epoll registration
+ *
+ * \var int fd Socket
+ * \var int writeWatched True while epoll waits for the socket to take more bytes
+ * \var int closing Set when the peer should be closed, epoll no longer reports it
+ */
+typedef struct netPeer_t {
+    int fd;
+    int writeWatched;
+    int closing;
+} netPeer;
+
+/*! \fn int netListen(int port, int sharePort)
+ * \brief Open a nonblocking listening socket on all addresses
+ *
+ * \param port TCP port
+ * \param sharePort True to let more sockets listen on the port (SO_REUSEPORT), the kernel spreads the connections
+ * \return int Socket, -1 on error (errno set)
+ */
+int netListen(int port, int sharePort);
+
+/*! \fn int netAccept(int epollFd, int listenFd, int * paused)
+ * \brief Accept a waiting connection, nonblocking
+ *
+ * Out of descriptors (EMFILE, ENFILE) the listening socket is taken out of epoll
+ * and paused is set: it stays readable, so epoll would report it again at once.
+ *
+ * \param epollFd Epoll instance watching listenFd
+ * \param listenFd Listening socket
+ * \param paused Set when the listening socket was taken out of epoll
+ * \return int Accepted socket, -1 if none is waiting or on error (errno set)
+ */
+int netAccept(int epollFd, int listenFd, int * paused);
+
+/*! \fn void netResume(int epollFd, int * listenFd, int * paused)
+ * \brief Watch a paused listening socket again, once a descriptor may be free
+ *
+ * \param epollFd Epoll instance
+ * \param listenFd Listening socket, its address is reported in the epoll events
+ * \param paused Cleared when the socket is watched again, nothing is done if it is not set
+ * \return void No values returned
+ */
+void netResume(int epollFd, int * listenFd, int * paused);
+
+/*! \fn int netAttach(int epollFd, netPeer * peer, int fd, void * owner, int sendBuffer)
+ * \brief Set up an accepted socket for frames and watch it for input
+ *
+ * Turns off Nagle, so a frame goes out at once, and limits the kernel send buffer,
+ * so the backlog stays in the queue of the owner
+ *
+ * \param epollFd Epoll instance
+ * \param peer Pointer to peer
+ * \param fd Accepted socket
+ * \param owner Reported in the epoll events of the socket
+ * \param sendBuffer Size of the kernel send buffer
+ * \return int 0 on success, -1 if the socket can not be watched
+ */
+int netAttach(int epollFd, netPeer * peer, int fd, void * owner, int sendBuffer);
+
+/*! \fn void netWatchWrite(int epollFd, netPeer * peer, void * owner, int on)
+ * \brief Ask epoll to report when the socket takes bytes again, or stop asking
+ *
+ * \param epollFd Epoll instance
+ * \param peer Pointer to peer
+ * \param owner Reported in the epoll events of the socket
+ * \param on True to watch for output as well as input
+ * \return void No values returned
+ */
+void netWatchWrite(int epollFd, netPeer * peer, void * owner, int on);
+
+/*! \fn void netCloseLater(int epollFd, netPeer * peer)
+ * \brief Stop watching a peer that the owner closes later
+ *
+ * \param epollFd Epoll instance
+ * \param peer Pointer to peer
+ * \return void No values returned
+ */
+void netCloseLater(int epollFd, netPeer * peer);
+
+#endif //SNAKEGAME_NETPEER_H
+
+// End of netpeer.h
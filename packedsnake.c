@@ -0,0 +1,121 @@
+/*! \file packedsnake.c
+ * \brief Compact snake body
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "packedsnake.h"
+
+/*! \def LINKWORDS
+ *  \brief Number of words of a ring of n links
+ */
+#define LINKWORDS(n) (((n) + 31) / 32)
+
+/*! \fn static int linkCode(unsigned char direction)
+ * \brief 2 bit code of a direction letter
+ */
+static int linkCode(unsigned char direction) {
+    return (direction == 'd') * PACKEDDOWN + (direction == 'l') * PACKEDLEFT + (direction == 'r') * PACKEDRIGHT;
+}
+
+/*! \fn static int growRing(packedSnake * ps)
+ * \brief Double the ring, the links are moved to the start of the new ring
+ */
+static int growRing(packedSnake * ps) {
+    uint64_t * grown;
+    size_t links = ps->snakeCurrentLength - 1, i, position;
+    int link;
+
+    grown = calloc(LINKWORDS(2 * ps->capacity), sizeof(uint64_t));
+    if (grown == NULL) {
+        return -1;
+    }
+    for (i = 0; i < links; i++) {                                       // unwrap the old ring
+        position = (ps->first + i) & (ps->capacity - 1);
+        link = packedLink(ps, position);
+        grown[i >> 5] |= (uint64_t) link << ((i & 31) * 2);
+    }
+    free(ps->links);
+    ps->links = grown;
+    ps->capacity *= 2;
+    ps->first = 0;
+    return 0;
+}
+
+int initPackedSnake(packedSnake * ps, int width, int height) {
+    if (ps->links == NULL) {
+        ps->links = malloc(LINKWORDS(PACKEDINITIAL) * sizeof(uint64_t));
+        if (ps->links == NULL) {
+            return -1;
+        }
+        ps->capacity = PACKEDINITIAL;
+    }
+    ps->first = 0;
+    ps->headCell.x = width / 2;                                         // same start as initSnake
+    ps->headCell.y = height / 2;
+    ps->tailCell = ps->headCell;
+    ps->snakeCurrentLength = 1;
+    ps->snakeSupposedLength = 4;
+    ps->runningDirection = 'l';
+    return 0;
+} // initPackedSnake function ends
+
+void freePackedSnake(packedSnake * ps) {
+    free(ps->links);
+    ps->links = NULL;
+    ps->capacity = 0;
+} // freePackedSnake function ends
+
+int updatePackedSnake(packedSnake * ps) {
+    /*! \var int link
+     *  \brief Link from the old head to the new one
+     */
+    int link = linkCode(ps->runningDirection);
+    /*! \var size_t position, shift
+     *  \brief Ring position of the new link, its bit position in the word
+     */
+    size_t position, shift;
+
+    if ((ps->snakeCurrentLength - 1 == ps->capacity) && (growRing(ps) != 0)) {
+        return -1;
+    }
+    position = (ps->first + ps->snakeCurrentLength - 1) & (ps->capacity - 1);
+    shift = (position & 31) * 2;
+    ps->links[position >> 5] = (ps->links[position >> 5] & ~((uint64_t) 3 << shift)) | ((uint64_t) link << shift);
+    packedStep(&ps->headCell, link);                                    // head moves forward
+    ps->snakeCurrentLength++;
+
+    if (ps->snakeCurrentLength > ps->snakeSupposedLength) {             // tail follows along its link
+        packedStep(&ps->tailCell, packedLink(ps, ps->first));
+        ps->first = (ps->first + 1) & (ps->capacity - 1);
+        ps->snakeCurrentLength--;
+    }
+    return 0;
+} // updatePackedSnake function ends
+
+size_t packedSnakeBytes(const packedSnake * ps) {
+    return sizeof(*ps) + LINKWORDS(ps->capacity) * sizeof(uint64_t);
+} // packedSnakeBytes function ends
+
+void markPackedSnake(bitboard * bb, const packedSnake * ps) {
+    /*! \var packedCursor cursor
+     *  \brief Walks the body from the tail
+     */
+    packedCursor cursor;
+    /*! \var size_t bit
+     *  \brief Bit of a segment
+     */
+    size_t bit;
+
+    clearBitboard(bb);
+    packedFirst(ps, &cursor);
+    do {
+        bit = bitIndex(bb, cursor.cell.x, cursor.cell.y);
+        bb->words[bit >> 6] |= (uint64_t) 1 << (bit & 63);
+    } while (packedNext(ps, &cursor));
+} // markPackedSnake function ends
+
+// End of packedsnake.c
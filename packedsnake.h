@@ -0,0 +1,172 @@
+/*! \file packedsnake.h
+ * \brief Compact snake body header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Alternative to the coordinate ring of struct snake: the head and tail
+ * coordinates plus one 2 bit direction per segment link, tail to head, in a
+ * ring bitstream. The ring starts with PACKEDINITIAL links and doubles when
+ * the snake outgrows it, so a game pays for the length its snake reached,
+ * not for a snake covering the whole board.
+ */
+
+#ifndef SNAKEGAME_PACKEDSNAKE_H
+#define SNAKEGAME_PACKEDSNAKE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "snake.h"
+#include "bitboard.h"
+
+/*! \def PACKEDINITIAL
+ *  \brief Links held by a new ring, one 64 bit word, a power of two
+ */
+#define PACKEDINITIAL 32
+
+/*! \def PACKEDUP, PACKEDDOWN, PACKEDLEFT, PACKEDRIGHT
+ *  \brief 2 bit codes of the links, the upper bit is the axis like the batch directions
+ */
+#define PACKEDUP 0
+#define PACKEDDOWN 1
+#define PACKEDLEFT 2
+#define PACKEDRIGHT 3
+
+/*! \typedef struct packedSnake
+ *  \brief Contains 1 snake as head, tail and the links between them
+ *
+ * Link i leads from segment i to segment i + 1, counted from the tail
+ *
+ * \var coord headCell Position of the head
+ * \var coord tailCell Position of the tail
+ * \var uint64_t * links Ring of 2 bit links, 32 per word
+ * \var size_t capacity Number of links the ring holds, a power of two
+ * \var size_t first Ring position of the link leaving the tail
+ * \var size_t snakeCurrentLength Length of the snake, links + 1
+ * \var size_t snakeSupposedLength Length the snake should be
+ * \var unsigned char runningDirection The direction the snake is facing and sliding, u, d, l, r
+ */
+typedef struct packedSnake_t {
+    coord headCell;
+    coord tailCell;
+    uint64_t * links;
+    size_t capacity;
+    size_t first;
+    size_t snakeCurrentLength;
+    size_t snakeSupposedLength;
+    unsigned char runningDirection;
+} packedSnake;
+
+/*! \typedef struct packedCursor
+ *  \brief Walks the segments of a packed snake from tail to head
+ *
+ * \var coord cell The current segment
+ * \var size_t position Ring position of the next word to load
+ * \var size_t left Links not walked yet
+ * \var uint64_t word Links of the loaded word not walked yet, the next one in the low bits
+ * \var int inWord Number of links left in word
+ */
+typedef struct packedCursor_t {
+    coord cell;
+    size_t position;
+    size_t left;
+    uint64_t word;
+    int inWord;
+} packedCursor;
+
+/*! \fn static inline int packedLink(const packedSnake * ps, size_t position)
+ * \brief Link stored at a ring position
+ */
+static inline int packedLink(const packedSnake * ps, size_t position) {
+    return (int) ((ps->links[position >> 5] >> ((position & 31) * 2)) & 3);
+}
+
+/*! \fn static inline void packedStep(coord * cell, int link)
+ * \brief Move a coordinate along a link, without a branch
+ */
+static inline void packedStep(coord * cell, int link) {
+    cell->x += (link == PACKEDRIGHT) - (link == PACKEDLEFT);
+    cell->y += (link == PACKEDDOWN) - (link == PACKEDUP);
+}
+
+/*! \fn static inline void packedFirst(const packedSnake * ps, packedCursor * cursor)
+ * \brief Put the cursor on the tail
+ */
+static inline void packedFirst(const packedSnake * ps, packedCursor * cursor) {
+    cursor->cell = ps->tailCell;
+    cursor->position = ps->first;
+    cursor->left = ps->snakeCurrentLength - 1;
+    cursor->inWord = 0;
+}
+
+/*! \fn static inline int packedNext(const packedSnake * ps, packedCursor * cursor)
+ * \brief Step the cursor to the next segment towards the head
+ *
+ * \return int 1 if the cursor moved, 0 if it was on the head
+ */
+static inline int packedNext(const packedSnake * ps, packedCursor * cursor) {
+    if (cursor->left == 0) {
+        return 0;
+    }
+    if (cursor->inWord == 0) {                                          // a word holds up to 32 links
+        cursor->word = ps->links[cursor->position >> 5] >> ((cursor->position & 31) * 2);
+        cursor->inWord = 32 - (int) (cursor->position & 31);
+        cursor->position = (cursor->position + (size_t) cursor->inWord) & (ps->capacity - 1);
+    }
+    packedStep(&cursor->cell, (int) (cursor->word & 3));
+    cursor->word >>= 2;
+    cursor->inWord--;
+    cursor->left--;
+    return 1;
+}
+
+/*! \fn int initPackedSnake(packedSnake * ps, int width, int height)
+ * \brief Set up a new snake, the same start as initSnake
+ *
+ * A ring already taken is reused, so the structure must be zeroed before the first call
+ *
+ * \param ps Pointer to snake
+ * \param width Number of columns of the board
+ * \param height Number of rows of the board
+ * \return int 0 on success, -1 if out of memory
+ */
+int initPackedSnake(packedSnake * ps, int width, int height);
+
+/*! \fn void freePackedSnake(packedSnake * ps)
+ * \brief Release the ring of the snake
+ *
+ * \param ps Pointer to snake
+ * \return void No values returned
+ */
+void freePackedSnake(packedSnake * ps);
+
+/*! \fn int updatePackedSnake(packedSnake * ps)
+ * \brief Move the snake one cell in runningDirection, the same head and tail steps as updateSnake
+ *
+ * The head moves, the length grows, and the tail follows when the snake is longer than supposed
+ *
+ * \param ps Pointer to snake
+ * \return int 0 on success, -1 if the ring could not grow (the snake is unchanged)
+ */
+int updatePackedSnake(packedSnake * ps);
+
+/*! \fn size_t packedSnakeBytes(const packedSnake * ps)
+ * \brief Memory used by the snake, structure and ring
+ *
+ * \param ps Pointer to snake
+ * \return size_t Number of bytes
+ */
+size_t packedSnakeBytes(const packedSnake * ps);
+
+/*! \fn void markPackedSnake(bitboard * bb, const packedSnake * ps)
+ * \brief Rebuild an occupancy grid from a packed snake, like updateBitboard
+ *
+ * \param bb Pointer to grid
+ * \param ps Pointer to snake
+ * \return void No values returned
+ */
+void markPackedSnake(bitboard * bb, const packedSnake * ps);
+
+#endif //SNAKEGAME_PACKEDSNAKE_H
+
+// End of packedsnake.h
@@ -0,0 +1,402 @@
+/*! \file render.c
+ * \brief Differential terminal renderer
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "render.h"
+
+#define WALLCHAR 'H'
+#define SNAKECHAR 'o'
+#define APPLECHAR 'b'
+#define EMPTYCHAR ' '
+#define SCROLLCHAR ':'
+
+/*! \def BOARDTOP
+ *  \brief Terminal row of the first board row (1 based), below title, score and top wall
+ */
+#define BOARDTOP 4
+/*! \def BOARDLEFT
+ *  \brief Terminal column of the first board column (1 based), right of the left wall
+ */
+#define BOARDLEFT 2
+/*! \def PARKROW
+ *  \brief Terminal row where the cursor is left after a frame
+ */
+#define PARKROW(rd) (BOARDTOP + (rd)->viewHeight + 4)
+/*! \def STATUSROW
+ *  \brief Terminal row of the status line, between the instructions and the parked cursor
+ */
+#define STATUSROW(rd) (BOARDTOP + (rd)->viewHeight + 3)
+/*! \def FRAMEROWS
+ *  \brief Terminal rows used around the view: title, score, walls, instructions, status and parked cursor
+ */
+#define FRAMEROWS (BOARDTOP + 4)
+/*! \def FRAMECOLUMNS
+ *  \brief Terminal columns used around the view: left and right wall
+ */
+#define FRAMECOLUMNS 2
+/*! \def TOPEDGE, BOTTOMEDGE, LEFTEDGE, RIGHTEDGE
+ *  \brief Character of an edge of the view, the wall if the board ends there
+ */
+#define TOPEDGE(rd) ((rd)->viewY == 0 ? WALLCHAR : SCROLLCHAR)
+#define BOTTOMEDGE(rd) ((rd)->viewY + (rd)->viewHeight == (rd)->height ? WALLCHAR : SCROLLCHAR)
+#define LEFTEDGE(rd) ((rd)->viewX == 0 ? WALLCHAR : SCROLLCHAR)
+#define RIGHTEDGE(rd) ((rd)->viewX + (rd)->viewWidth == (rd)->width ? WALLCHAR : SCROLLCHAR)
+
+/*! \fn static void appendText(renderer * rd, const char * text, size_t length)
+ * \brief Append bytes to the frame buffer
+ */
+static void appendText(renderer * rd, const char * text, size_t length) {
+    if (rd->length + length <= rd->bufferSize) {
+        memcpy(rd->buffer + rd->length, text, length);
+        rd->length += length;
+    }
+}
+
+/*! \fn static void appendLine(renderer * rd, const char * text, size_t length)
+ * \brief Append text cut to the terminal width, so it never wraps into the next row
+ */
+static void appendLine(renderer * rd, const char * text, size_t length) {
+    if ((rd->screenColumns > 0) && (length > (size_t) rd->screenColumns - 1)) {
+        length = (size_t) rd->screenColumns - 1;
+    }
+    appendText(rd, text, length);
+}
+
+/*! \fn static void moveCursor(renderer * rd, int column, int row)
+ * \brief Append ANSI cursor positioning, skipped if the cursor is already there
+ */
+static void moveCursor(renderer * rd, int column, int row) {
+    char sequence[24];
+    int length;
+
+    if ((rd->cursorX != column) || (rd->cursorY != row)) {
+        length = snprintf(sequence, sizeof(sequence), "\033[%d;%dH", row, column);
+        appendText(rd, sequence, (size_t) length);
+        rd->cursorX = column;
+        rd->cursorY = row;
+    }
+}
+
+/*! \fn static void putCell(renderer * rd, char c)
+ * \brief Append one character at the cursor, the cursor steps right
+ */
+static void putCell(renderer * rd, char c) {
+    appendText(rd, &c, 1);
+    rd->cursorX++;
+}
+
+/*! \fn static char cellChar(const bitboard * occupied, const coord * apple, int x, int y)
+ * \brief Character of a board cell: snake body from the grid, otherwise apple or empty
+ */
+static char cellChar(const bitboard * occupied, const coord * apple, int x, int y) {
+    if (bitTest(occupied, x, y)) {
+        return SNAKECHAR;
+    }
+    return ((apple != NULL) && (apple->x == x) && (apple->y == y)) ? APPLECHAR : EMPTYCHAR;
+}
+
+/*! \fn static void appendScore(renderer * rd, int score)
+ * \brief Append the score line
+ */
+static void appendScore(renderer * rd, int score) {
+    char line[80];
+    int length;
+
+    moveCursor(rd, 1, 2);
+    length = snprintf(line, sizeof(line), "                                    Your score: %d", score);
+    appendLine(rd, line, (size_t) length);
+    appendText(rd, "\033[K", 3);
+    rd->cursorX = -1;                                                   // cursor position not tracked after text
+}
+
+/*! \fn static void appendHorizontalEdge(renderer * rd, int row, char c)
+ * \brief Append the top or bottom edge of the view
+ */
+static void appendHorizontalEdge(renderer * rd, int row, char c) {
+    int j;
+
+    moveCursor(rd, 1, row);
+    for (j = 0; j < rd->viewWidth + 2; j++) {
+        putCell(rd, c);
+    }
+}
+
+/*! \fn static void appendFullFrame(renderer * rd, const bitboard * occupied, const coord * apple, int score)
+ * \brief Append clear screen and the complete frame, remember it as the last drawn frame
+ */
+static void appendFullFrame(renderer * rd, const bitboard * occupied, const coord * apple, int score) {
+    static const char title[] = "\033[H\033[2JSnake game";
+    static const char help[] = "    Use arrow keys to turn snake. Press ESC to quit game, H to show timings.";
+    int i, j;
+
+    appendText(rd, title, sizeof(title) - 1);
+    rd->cursorX = -1;
+    appendScore(rd, score);
+
+    appendHorizontalEdge(rd, BOARDTOP - 1, TOPEDGE(rd));               // Top edge of board
+    for (i = 0; i < rd->viewHeight; i++) {                              // Visible part of the board with left and right edge
+        moveCursor(rd, 1, BOARDTOP + i);
+        putCell(rd, LEFTEDGE(rd));
+        for (j = 0; j < rd->viewWidth; j++) {
+            rd->previous[(size_t) i * (size_t) rd->viewWidth + (size_t) j] = (unsigned char) cellChar(occupied, apple, rd->viewX + j, rd->viewY + i);
+            putCell(rd, (char) rd->previous[(size_t) i * (size_t) rd->viewWidth + (size_t) j]);
+        }
+        putCell(rd, RIGHTEDGE(rd));
+    }
+    appendHorizontalEdge(rd, BOARDTOP + rd->viewHeight, BOTTOMEDGE(rd));   // Bottom edge of board
+
+    moveCursor(rd, 1, BOARDTOP + rd->viewHeight + 2);                   // Instructions
+    appendLine(rd, help, sizeof(help) - 1);
+    rd->cursorX = -1;
+}
+
+/*! \fn static int flushFrame(renderer * rd)
+ * \brief Write the frame buffer to the output, normally in a single write() call
+ */
+static int flushFrame(renderer * rd) {
+    size_t written = 0;
+    ssize_t result;
+
+    rd->lastFrameSyscalls = 0;
+    if (rd->fd < 0) {                                                   // frame stays in buffer for the caller
+        rd->lastFrameBytes = rd->length;
+        rd->totalBytes += rd->length;
+        return 0;
+    }
+    while (written < rd->length) {
+        result = write(rd->fd, rd->buffer + written, rd->length - written);
+        rd->lastFrameSyscalls++;
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            rd->length = 0;
+            return -1;
+        }
+        written += (size_t) result;                                     // partial write: send the rest
+    }
+    rd->lastFrameBytes = written;
+    rd->totalBytes += written;
+    rd->totalSyscalls += rd->lastFrameSyscalls;
+    rd->length = 0;
+    return 0;
+}
+
+size_t renderMemorySize(int width, int height) {
+    return ARENABLOCK((size_t) width * (size_t) height) + ARENABLOCK(RENDERBUFFERSIZE(width, height));
+} // renderMemorySize function ends
+
+int renderInit(renderer * rd, int fd, int width, int height, memArena * arena) {
+    rd->width = width;
+    rd->height = height;
+    rd->bufferSize = RENDERBUFFERSIZE(width, height);
+    rd->previous = arenaAlloc(arena, (size_t) width * (size_t) height);
+    rd->buffer = arenaAlloc(arena, rd->bufferSize);
+    if ((rd->previous == NULL) || (rd->buffer == NULL)) {
+        return -1;
+    }
+    rd->screenColumns = 0;
+    rd->screenRows = 0;
+    rd->viewX = 0;
+    rd->viewY = 0;
+    rd->viewWidth = width;
+    rd->viewHeight = height;
+    rd->focusX = width / 2;
+    rd->focusY = height / 2;
+    rd->scrolled = 0;
+    rd->fd = fd;
+    rd->fullRepaint = 1;
+    rd->previousScore = 0;
+    rd->cursorX = -1;
+    rd->cursorY = -1;
+    rd->length = 0;
+    rd->lastFrameBytes = 0;
+    rd->lastFrameSyscalls = 0;
+    rd->totalBytes = 0;
+    rd->totalSyscalls = 0;
+    rd->frames = 0;
+    rd->statusLine = NULL;
+    rd->statusShown = 0;
+    return 0;
+} // renderInit function ends
+
+/*! \fn static void appendRepaint(renderer * rd, const bitboard * occupied, const coord * apple, int score)
+ * \brief Append the complete frame and remember it as the last drawn frame
+ */
+static void appendRepaint(renderer * rd, const bitboard * occupied, const coord * apple, int score) {
+    appendFullFrame(rd, occupied, apple, score);
+    rd->previousScore = score;
+    rd->fullRepaint = 0;
+    rd->scrolled = 0;
+}
+
+/*! \fn static void appendChangedCell(renderer * rd, const bitboard * occupied, const coord * apple, int column, int row)
+ * \brief Append 1 cell of the view if it differs from the last drawn frame
+ */
+static void appendChangedCell(renderer * rd, const bitboard * occupied, const coord * apple, int column, int row) {
+    /*! \var size_t cell
+     *  \brief Index of the cell in the last frame
+     */
+    size_t cell = (size_t) row * (size_t) rd->viewWidth + (size_t) column;
+    /*! \var char c
+     *  \brief Content of the board cell shown there now
+     */
+    char c = cellChar(occupied, apple, rd->viewX + column, rd->viewY + row);
+
+    if ((unsigned char) c != rd->previous[cell]) {
+        moveCursor(rd, BOARDLEFT + column, BOARDTOP + row);
+        putCell(rd, c);
+        rd->previous[cell] = (unsigned char) c;
+    }
+}
+
+/*! \fn static void appendChangedView(renderer * rd, const bitboard * occupied, const coord * apple)
+ * \brief Append every cell of the view that differs from the last drawn frame
+ */
+static void appendChangedView(renderer * rd, const bitboard * occupied, const coord * apple) {
+    int i, j;
+
+    if (rd->scrolled) {                                                 // the edges may show the wall now, or no more
+        appendHorizontalEdge(rd, BOARDTOP - 1, TOPEDGE(rd));
+        for (i = 0; i < rd->viewHeight; i++) {
+            moveCursor(rd, 1, BOARDTOP + i);
+            putCell(rd, LEFTEDGE(rd));
+            moveCursor(rd, BOARDLEFT + rd->viewWidth, BOARDTOP + i);
+            putCell(rd, RIGHTEDGE(rd));
+        }
+        appendHorizontalEdge(rd, BOARDTOP + rd->viewHeight, BOTTOMEDGE(rd));
+        rd->scrolled = 0;
+    }
+    for (i = 0; i < rd->viewHeight; i++) {                              // compare with last frame row by row
+        for (j = 0; j < rd->viewWidth; j++) {
+            appendChangedCell(rd, occupied, apple, j, i);               // only changed cells are sent
+        }
+    }
+}
+
+/*! \fn static int finishFrame(renderer * rd)
+ * \brief Park the cursor and send the frame
+ */
+static int finishFrame(renderer * rd) {
+    rd->cursorX = -1;                                                   // other output may have moved the cursor
+    if ((rd->statusLine != NULL) || rd->statusShown) {
+        moveCursor(rd, 1, STATUSROW(rd));
+        if (rd->statusLine != NULL) {
+            appendLine(rd, rd->statusLine, strlen(rd->statusLine));
+        }
+        appendText(rd, "\033[K", 3);                                    // rest of the row, or all of it when hidden
+        rd->statusShown = (rd->statusLine != NULL);
+        rd->cursorX = -1;
+    }
+    moveCursor(rd, 1, PARKROW(rd));                                         // park cursor below the board
+
+    rd->frames++;
+    return flushFrame(rd);
+}
+
+int renderFrame(renderer * rd, const bitboard * occupied, const coord * apple, int score) {
+    rd->length = 0;
+    if (rd->fullRepaint) {                                              // first frame: draw everything
+        appendRepaint(rd, occupied, apple, score);
+    } else {
+        if (score != rd->previousScore) {                               // score line changed
+            appendScore(rd, score);
+            rd->previousScore = score;
+        }
+        appendChangedView(rd, occupied, apple);
+    }
+    return finishFrame(rd);
+} // renderFrame function ends
+
+int renderDirty(renderer * rd, const bitboard * occupied, const coord * apple, dirtyList * dirty, int score) {
+    /*! \var size_t i
+     *  \brief Loop index variable
+     */
+    size_t i;
+    /*! \var int column, row
+     *  \brief Position of a changed cell in the view
+     */
+    int column, row;
+
+    rd->length = 0;
+    if (rd->fullRepaint) {                                              // first frame: draw everything
+        appendRepaint(rd, occupied, apple, score);
+    } else {
+        if (score != rd->previousScore) {                               // score line changed
+            appendScore(rd, score);
+            rd->previousScore = score;
+        }
+        if (rd->scrolled) {                                             // every shown cell moved on the screen
+            appendChangedView(rd, occupied, apple);
+        } else {
+            for (i = 0; i < dirty->count; i++) {                        // only the cells touched this tick
+                column = dirty->cells[i].cell.x - rd->viewX;
+                row = dirty->cells[i].cell.y - rd->viewY;
+                if ((column >= 0) && (column < rd->viewWidth) && (row >= 0) && (row < rd->viewHeight)) {
+                    appendChangedCell(rd, occupied, apple, column, row);
+                }
+            }
+        }
+    }
+    return finishFrame(rd);
+} // renderDirty function ends
+
+/*! \fn static int cameraAxis(int view, int size, int boardSize, int focus)
+ * \brief First shown cell on one axis: kept while the focus is a quarter of the view from its edges, otherwise centred on it
+ */
+static int cameraAxis(int view, int size, int boardSize, int focus) {
+    int margin = size / 4;
+
+    if ((focus < view + margin) || (focus >= view + size - margin)) {
+        view = focus - size / 2;                                        // a jump, not a scroll on every step
+    }
+    if (view > boardSize - size) {
+        view = boardSize - size;
+    }
+    return view > 0 ? view : 0;
+}
+
+void renderResize(renderer * rd, int columns, int rows) {
+    rd->screenColumns = columns > 0 ? columns : 0;
+    rd->screenRows = rows > 0 ? rows : 0;
+    rd->viewWidth = rd->width;
+    rd->viewHeight = rd->height;
+    if ((rd->screenColumns > 0) && (rd->screenColumns - FRAMECOLUMNS < rd->viewWidth)) {
+        rd->viewWidth = rd->screenColumns - FRAMECOLUMNS > 1 ? rd->screenColumns - FRAMECOLUMNS : 1;
+    }
+    if ((rd->screenRows > 0) && (rd->screenRows - FRAMEROWS < rd->viewHeight)) {
+        rd->viewHeight = rd->screenRows - FRAMEROWS > 1 ? rd->screenRows - FRAMEROWS : 1;
+    }
+    rd->viewX = cameraAxis(rd->focusX - rd->viewWidth / 2, rd->viewWidth, rd->width, rd->focusX);  // centred on the focus
+    rd->viewY = cameraAxis(rd->focusY - rd->viewHeight / 2, rd->viewHeight, rd->height, rd->focusY);
+    rd->fullRepaint = 1;                                                // once, then differential again
+} // renderResize function ends
+
+void renderFollow(renderer * rd, int x, int y) {
+    /*! \var int viewX, viewY
+     *  \brief Camera position for the cell
+     */
+    int viewX = cameraAxis(rd->viewX, rd->viewWidth, rd->width, x);
+    int viewY = cameraAxis(rd->viewY, rd->viewHeight, rd->height, y);
+
+    rd->focusX = x;
+    rd->focusY = y;
+    if ((viewX != rd->viewX) || (viewY != rd->viewY)) {
+        rd->viewX = viewX;
+        rd->viewY = viewY;
+        rd->scrolled = 1;
+    }
+} // renderFollow function ends
+
+void renderStatus(renderer * rd, const char * text) {
+    rd->statusLine = text;
+} // renderStatus function ends
+
+// End of render.c
@@ -0,0 +1,176 @@
+/*! \file render.h
+ * \brief Differential terminal renderer header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * The renderer remembers the last frame it has drawn and only sends
+ * the changed cells to the terminal, collected into one buffer
+ * and written with one write() call
+ * Cells are read from the occupancy grid of the game and the apple position
+ *
+ * A board larger than the terminal is shown through a viewport: the
+ * camera follows the snake head and jumps to centre it when the head
+ * comes near the edge of the view, so only the visible cells are compared
+ * and sent and the cost of a frame depends on the terminal size, not on
+ * the board size. Edges of the view with more board behind them are
+ * drawn with SCROLLCHAR instead of the wall.
+ */
+
+#include <stddef.h>
+#include "snake.h"
+#include "bitboard.h"
+
+#ifndef SNAKEGAME_RENDER_H
+#define SNAKEGAME_RENDER_H
+
+/*! \def RENDERBUFFERSIZE
+ *  \brief Size of the output buffer, enough for a full repaint or a frame where every cell changed
+ */
+#define RENDERBUFFERSIZE(width, height) (((size_t) (width) + 2) * ((size_t) (height) + 2) * 12 + 512)
+
+/*! \typedef struct renderer
+ *  \brief Contains the state of the differential renderer
+ *
+ * \var int fd Output file descriptor, -1 if the caller sends the frames
+ * \var int fullRepaint If set, the next frame is drawn entirely
+ * \var int previousScore Score shown on the last frame
+ * \var int width, height Size of the board
+ * \var int screenColumns, screenRows Size of the terminal, 0 if unknown: the whole board is shown
+ * \var int viewX, viewY Board cell in the top left corner of the view
+ * \var int viewWidth, viewHeight Number of board columns and rows shown
+ * \var int focusX, focusY Cell the camera follows
+ * \var int scrolled True when the camera moved since the last frame, the next frame compares the whole view
+ * \var unsigned char * previous View shown on the last frame, row by row
+ * \var int cursorX, cursorY Terminal cursor position after the last output (1 based)
+ * \var char * buffer Output collected for one frame
+ * \var size_t bufferSize Size of buffer
+ * \var size_t length Number of bytes in buffer
+ * \var size_t lastFrameBytes Bytes written for the last frame
+ * \var unsigned long lastFrameSyscalls write() calls made for the last frame
+ * \var unsigned long long totalBytes Bytes written since start
+ * \var unsigned long totalSyscalls write() calls made since start
+ * \var unsigned long frames Number of frames rendered
+ * \var const char * statusLine Text drawn below the instructions with every frame, NULL for none
+ * \var int statusShown True when the terminal shows a status line
+ */
+typedef struct renderer_t {
+    int fd;
+    int fullRepaint;
+    int previousScore;
+    int width;
+    int height;
+    int screenColumns;
+    int screenRows;
+    int viewX;
+    int viewY;
+    int viewWidth;
+    int viewHeight;
+    int focusX;
+    int focusY;
+    int scrolled;
+    unsigned char * previous;
+    int cursorX;
+    int cursorY;
+    char * buffer;
+    size_t bufferSize;
+    size_t length;
+    size_t lastFrameBytes;
+    unsigned long lastFrameSyscalls;
+    unsigned long long totalBytes;
+    unsigned long totalSyscalls;
+    unsigned long frames;
+    const char * statusLine;
+    int statusShown;
+} renderer;
+
+/*! \fn size_t renderMemorySize(int width, int height)
+ * \brief Arena space needed by the renderer of a board
+ *
+ * \param width Number of columns
+ * \param height Number of rows
+ * \return size_t Number of bytes
+ */
+size_t renderMemorySize(int width, int height);
+
+/*! \fn int renderInit(renderer * rd, int fd, int width, int height, memArena * arena)
+ * \brief Initialize the renderer
+ *
+ * The first frame will be a full repaint, the whole board is shown until renderResize is called
+ *
+ * \param rd Pointer to renderer
+ * \param fd Output file descriptor, -1 to leave each frame in buffer (length bytes) for the caller to send
+ * \param width Number of columns
+ * \param height Number of rows
+ * \param arena Memory arena
+ * \return int 0 on success, -1 if the arena is exhausted
+ */
+int renderInit(renderer * rd, int fd, int width, int height, memArena * arena);
+
+/*! \fn int renderFrame(renderer * rd, const bitboard * occupied, const coord * apple, int score)
+ * \brief Render the game screen on terminal window
+ *
+ * Compares the view to the last drawn frame and sends cursor movement
+ * and cell updates only for the changed cells, in one write() call
+ * After the frame the cursor is parked below the board
+ *
+ * \param rd Pointer to renderer
+ * \param occupied Occupancy grid of the game, the snake body
+ * \param apple Position of the apple, NULL if there is none
+ * \param score Players current score
+ * \return int 0 on success, -1 on write error
+ */
+int renderFrame(renderer * rd, const bitboard * occupied, const coord * apple, int score);
+
+/*! \fn int renderDirty(renderer * rd, const bitboard * occupied, const coord * apple, dirtyList * dirty, int score)
+ * \brief Render only the cells changed in this tick
+ *
+ * Same as renderFrame, but instead of comparing the whole view
+ * only the cells in the changed cell list are checked, the ones outside the view are skipped
+ * After the camera moved the whole view is compared
+ * The grid must already contain the changes
+ *
+ * \param rd Pointer to renderer
+ * \param occupied Occupancy grid of the game, the snake body
+ * \param apple Position of the apple, NULL if there is none
+ * \param dirty Cells changed in this tick
+ * \param score Players current score
+ * \return int 0 on success, -1 on write error
+ */
+int renderDirty(renderer * rd, const bitboard * occupied, const coord * apple, dirtyList * dirty, int score);
+
+/*! \fn void renderResize(renderer * rd, int columns, int rows)
+ * \brief Fit the view to a new terminal size, the next frame is a full repaint
+ *
+ * \param rd Pointer to renderer
+ * \param columns Number of terminal columns, 0 if unknown
+ * \param rows Number of terminal rows, 0 if unknown
+ * \return void No values returned
+ */
+void renderResize(renderer * rd, int columns, int rows);
+
+/*! \fn void renderFollow(renderer * rd, int x, int y)
+ * \brief Keep a cell, the snake head, inside the view, moving the camera if needed
+ *
+ * \param rd Pointer to renderer
+ * \param x Column of the cell
+ * \param y Row of the cell
+ * \return void No values returned
+ */
+void renderFollow(renderer * rd, int x, int y);
+
+/*! \fn void renderStatus(renderer * rd, const char * text)
+ * \brief Set the status line sent with the following frames
+ *
+ * The line goes out in the same write() as the frame, hiding it clears the row once
+ * The text is not copied, it must stay valid while it is shown
+ *
+ * \param rd Pointer to renderer
+ * \param text One line of text without control characters, NULL hides the line
+ * \return void No values returned
+ */
+void renderStatus(renderer * rd, const char * text);
+
+#endif //SNAKEGAME_RENDER_H
+
+// End of render.h
@@ -0,0 +1,312 @@
+/*! \file replay.c
+ * \brief Game replay recording and playback
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "replay.h"
+
+#define DIRECTIONS "udlr"
+#define DELTABITS 6
+#define DELTAMASK 0x3F
+#define LONGDELTA 62
+#define ENDMARK 0xFF
+#define MAXVARINT 10
+
+/*! \fn static size_t putVarint(unsigned char * out, unsigned long long value)
+ * \brief Encode a number 7 bits per byte, lowest bits first
+ *
+ * \return size_t Number of bytes written, at most MAXVARINT
+ */
+static size_t putVarint(unsigned char * out, unsigned long long value) {
+    size_t length = 0;
+
+    while (value >= 0x80) {
+        out[length++] = (unsigned char) (value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (unsigned char) value;
+    return length;
+}
+
+/*! \fn static int getVarint(const replayData * rp, size_t * position, unsigned long long * value)
+ * \brief Decode a number written by putVarint
+ *
+ * \return int 0 on success, -1 if the data ends or the number is too long
+ */
+static int getVarint(const replayData * rp, size_t * position, unsigned long long * value) {
+    unsigned int shift = 0;
+    unsigned char byte;
+
+    *value = 0;
+    do {
+        if ((*position >= rp->size) || (shift >= 7 * MAXVARINT)) {
+            return -1;
+        }
+        byte = rp->data[(*position)++];
+        *value |= (unsigned long long) (byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return 0;
+}
+
+size_t replayMemorySize(void) {
+    return ARENABLOCK(REPLAYBUFFERSIZE);
+} // replayMemorySize function ends
+
+int replayOpen(replayWriter * rw, const char * fileName, int exclusive, int width, int height, uint64_t seed, memArena * arena) {
+    /*! \var int i
+     *  \brief Loop index variable
+     */
+    int i;
+
+    memset(rw, 0, sizeof(*rw));
+    rw->fd = open(fileName, O_WRONLY | O_CREAT | (exclusive ? O_EXCL : O_TRUNC) | O_CLOEXEC, 0644);
+    if (rw->fd < 0) {
+        return -1;                                                      // nothing taken from the arena, the caller may retry
+    }
+    rw->buffer = arenaAlloc(arena, REPLAYBUFFERSIZE);
+    if (rw->buffer == NULL) {
+        close(rw->fd);
+        rw->fd = -1;
+        return -1;
+    }
+
+    memcpy(rw->buffer, "SNKR", 4);
+    rw->buffer[4] = REPLAYVERSION;
+    rw->buffer[5] = 0;
+    rw->buffer[6] = (unsigned char) width;
+    rw->buffer[7] = (unsigned char) (width >> 8);
+    rw->buffer[8] = (unsigned char) height;
+    rw->buffer[9] = (unsigned char) (height >> 8);
+    for (i = 0; i < 8; i++) {
+        rw->buffer[10 + i] = (unsigned char) (seed >> (8 * i));
+    }
+    rw->length = REPLAYHEADERSIZE;
+    rw->bytes = REPLAYHEADERSIZE;
+    return 0;
+} // replayOpen function ends
+
+void replayRecord(replayWriter * rw, unsigned long tick, unsigned char direction) {
+    /*! \var const char * code
+     *  \brief Position of the direction in DIRECTIONS
+     */
+    const char * code = strchr(DIRECTIONS, direction);
+    /*! \var unsigned long delta
+     *  \brief Ticks since the previous event
+     */
+    unsigned long delta = tick - rw->lastTick;
+    /*! \var size_t start
+     *  \brief Length of the buffer before the event
+     */
+    size_t start;
+
+    if ((rw->fd < 0) || rw->error || (direction == '\0') || (code == NULL)) {
+        return;
+    }
+    if (rw->length + 1 + MAXVARINT > REPLAYBUFFERSIZE) {                // only if the caller never flushes
+        (void) replayFlush(rw);
+    }
+    start = rw->length;
+    if (delta < LONGDELTA) {                                            // the usual case, one byte
+        rw->buffer[rw->length++] = (unsigned char) (((code - DIRECTIONS) << DELTABITS) | delta);
+    } else {
+        rw->buffer[rw->length++] = (unsigned char) (((code - DIRECTIONS) << DELTABITS) | LONGDELTA);
+        rw->length += putVarint(rw->buffer + rw->length, delta - LONGDELTA);
+    }
+    rw->lastTick = tick;
+    rw->events++;
+    rw->bytes += rw->length - start;
+} // replayRecord function ends
+
+int replayFlush(replayWriter * rw) {
+    /*! \var size_t written
+     *  \brief Bytes of the buffer already written
+     */
+    size_t written = 0;
+    /*! \var ssize_t result
+     *  \brief Return value of write
+     */
+    ssize_t result;
+
+    if ((rw->fd < 0) || rw->error) {
+        return -1;
+    }
+    while (written < rw->length) {
+        result = write(rw->fd, rw->buffer + written, rw->length - written);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            rw->error = 1;
+            return -1;
+        }
+        written += (size_t) result;
+    }
+    rw->length = 0;
+    return 0;
+} // replayFlush function ends
+
+int replayClose(replayWriter * rw, unsigned long ticks, int score, size_t length) {
+    /*! \var int result
+     *  \brief Return value, -1 after the first error
+     */
+    int result = 0;
+
+    if (rw->fd < 0) {
+        return -1;
+    }
+    if (rw->length + 1 + 3 * MAXVARINT > REPLAYBUFFERSIZE) {
+        result = replayFlush(rw);
+    }
+    rw->buffer[rw->length++] = ENDMARK;
+    rw->length += putVarint(rw->buffer + rw->length, ticks);
+    rw->length += putVarint(rw->buffer + rw->length, (unsigned long long) score);
+    rw->length += putVarint(rw->buffer + rw->length, length);
+    if ((replayFlush(rw) != 0) || (close(rw->fd) != 0)) {
+        result = -1;
+    }
+    rw->fd = -1;
+    return (result != 0) || rw->error ? -1 : 0;
+} // replayClose function ends
+
+int replayLoad(replayData * rp, const char * fileName) {
+    /*! \var int fd
+     *  \brief File descriptor of the replay file
+     */
+    int fd;
+    /*! \var struct stat info
+     *  \brief Size of the replay file
+     */
+    struct stat info;
+    /*! \var void * data
+     *  \brief Mapped file
+     */
+    void * data;
+
+    rp->data = NULL;
+    rp->size = 0;
+    fd = open(fileName, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    if ((fstat(fd, &info) != 0) || (info.st_size < REPLAYHEADERSIZE)) {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    data = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);                                                          // the mapping stays valid
+    if (data == MAP_FAILED) {
+        return -1;
+    }
+    rp->data = data;
+    rp->size = (size_t) info.st_size;
+    return 0;
+} // replayLoad function ends
+
+void replayUnload(replayData * rp) {
+    if (rp->data != NULL) {
+        munmap((void *) rp->data, rp->size);
+    }
+    rp->data = NULL;
+    rp->size = 0;
+} // replayUnload function ends
+
+int replayHeader(const replayData * rp, replayResult * result) {
+    /*! \var int i
+     *  \brief Loop index variable
+     */
+    int i;
+
+    memset(result, 0, sizeof(*result));
+    if ((rp->size < REPLAYHEADERSIZE) || (memcmp(rp->data, "SNKR", 4) != 0) || (rp->data[4] != REPLAYVERSION)) {
+        return -1;
+    }
+    result->width = rp->data[6] | (rp->data[7] << 8);
+    result->height = rp->data[8] | (rp->data[9] << 8);
+    for (i = 0; i < 8; i++) {
+        result->seed |= (uint64_t) rp->data[10 + i] << (8 * i);
+    }
+    if ((result->width < MINBOARDSIZE) || (result->width > MAXBOARDSIZE)
+        || (result->height < MINBOARDSIZE) || (result->height > MAXBOARDSIZE)) {
+        return -1;
+    }
+    return 0;
+} // replayHeader function ends
+
+int replayPlay(const replayData * rp, gameState * game, replayResult * result) {
+    /*! \var size_t position
+     *  \brief Read position in the replay
+     */
+    size_t position = REPLAYHEADERSIZE;
+    /*! \var unsigned char byte
+     *  \brief First byte of an event
+     */
+    unsigned char byte;
+    /*! \var unsigned long long delta, ticks, score, length
+     *  \brief Decoded numbers
+     */
+    unsigned long long delta, ticks, score, length;
+    /*! \var unsigned long eventTick
+     *  \brief Tick of the current event
+     */
+    unsigned long eventTick = 0;
+
+    if ((replayHeader(rp, result) != 0) || (game->occupied.width != result->width) || (game->occupied.height != result->height)) {
+        return -1;
+    }
+    gameReset(game, result->seed);
+
+    for (;;) {                                                          // play the direction changes
+        if (position >= rp->size) {
+            return -1;                                                  // end of game missing
+        }
+        byte = rp->data[position++];
+        if (byte == ENDMARK) {
+            break;
+        }
+        delta = byte & DELTAMASK;
+        if (delta > LONGDELTA) {
+            return -1;
+        }
+        if (delta == LONGDELTA) {
+            if (getVarint(rp, &position, &delta) != 0) {
+                return -1;
+            }
+            delta += LONGDELTA;
+        }
+        eventTick += (unsigned long) delta;
+        while (game->running && (game->ticks < eventTick)) {            // no input until the event
+            gameStep(game, '\0');
+        }
+        updateSnakeDirection(&game->player, (unsigned char) DIRECTIONS[byte >> DELTABITS]);
+        result->events++;
+    }
+
+    if ((getVarint(rp, &position, &ticks) != 0) || (getVarint(rp, &position, &score) != 0)
+        || (getVarint(rp, &position, &length) != 0)) {
+        return -1;
+    }
+    result->recordedTicks = (unsigned long) ticks;
+    result->recordedScore = (int) score;
+    result->recordedLength = (size_t) length;
+    while (game->running && (game->ticks < result->recordedTicks)) {    // last straight run
+        gameStep(game, '\0');
+    }
+    result->ticks = game->ticks;
+    result->score = game->score;
+    result->length = game->player.snakeCurrentLength;
+
+    return (result->ticks == result->recordedTicks) && (result->score == result->recordedScore)
+        && (result->length == result->recordedLength) ? 0 : 1;
+} // replayPlay function ends
+
+// End of replay.c
@@ -0,0 +1,194 @@
+/*! \file replay.h
+ * \brief Game replay recording and playback header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * A replay is the seed of the game and the direction changes of the player.
+ * The engine is deterministic, so playing the inputs back through a new game
+ * with the same seed gives the same game, tick by tick.
+ *
+ * File layout, all numbers little endian:
+ *   header  "SNKR", version, 0, width (2 bytes), height (2 bytes), seed (8 bytes)
+ *   events  one byte per direction change: direction in bits 7-6 (u d l r),
+ *           ticks since the previous change in bits 5-0;
+ *           62 in bits 5-0 means the delta is 62 + a varint that follows
+ *   end     0xFF, then varints of ticks, score and snake length at the end of the game
+ */
+
+#ifndef SNAKEGAME_REPLAY_H
+#define SNAKEGAME_REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "engine.h"
+#include "memarena.h"
+
+/*! \def REPLAYVERSION
+ *  \brief Format version written into the header
+ */
+#define REPLAYVERSION 1
+
+/*! \def REPLAYHEADERSIZE
+ *  \brief Bytes of the file header
+ */
+#define REPLAYHEADERSIZE 18
+
+/*! \def REPLAYBUFFERSIZE
+ *  \brief Bytes buffered by the recorder, about 30000 direction changes before a write is forced
+ */
+#define REPLAYBUFFERSIZE 65536
+
+/*! \typedef struct replayWriter
+ *  \brief Contains a replay being recorded
+ *
+ * Events are only copied to the buffer, the file is written by replayFlush between ticks
+ *
+ * \var int fd File descriptor of the replay file
+ * \var unsigned long lastTick Tick of the previous event
+ * \var unsigned char * buffer Bytes not written yet
+ * \var size_t length Number of bytes in buffer
+ * \var unsigned long events Number of events recorded
+ * \var unsigned long long bytes Number of bytes recorded, header included
+ * \var int error True after a failed write, recording stops
+ */
+typedef struct replayWriter_t {
+    int fd;
+    unsigned long lastTick;
+    unsigned char * buffer;
+    size_t length;
+    unsigned long events;
+    unsigned long long bytes;
+    int error;
+} replayWriter;
+
+/*! \typedef struct replayData
+ *  \brief Contains a replay file mapped into memory
+ *
+ * \var const unsigned char * data Content of the file
+ * \var size_t size Size of the file
+ */
+typedef struct replayData_t {
+    const unsigned char * data;
+    size_t size;
+} replayData;
+
+/*! \typedef struct replayResult
+ *  \brief Result of playing back a replay
+ *
+ * \var int width, height Board size of the game
+ * \var uint64_t seed Random number seed of the game
+ * \var unsigned long events Number of direction changes played back
+ * \var unsigned long recordedTicks, ticks Game length in ticks, recorded and played back
+ * \var int recordedScore, score Final score, recorded and played back
+ * \var size_t recordedLength, length Final snake length, recorded and played back
+ */
+typedef struct replayResult_t {
+    int width;
+    int height;
+    uint64_t seed;
+    unsigned long events;
+    unsigned long recordedTicks;
+    unsigned long ticks;
+    int recordedScore;
+    int score;
+    size_t recordedLength;
+    size_t length;
+} replayResult;
+
+/*! \fn size_t replayMemorySize(void)
+ * \brief Arena space needed by the recorder
+ *
+ * \return size_t Number of bytes
+ */
+size_t replayMemorySize(void);
+
+/*! \fn int replayOpen(replayWriter * rw, const char * fileName, int exclusive, int width, int height, uint64_t seed, memArena * arena)
+ * \brief Create the replay file and record the header
+ *
+ * \param rw Pointer to recorder
+ * \param fileName Name of the replay file
+ * \param exclusive True to fail with errno EEXIST if the file exists, false to overwrite it
+ * \param width Number of columns
+ * \param height Number of rows
+ * \param seed Random number seed the game was started with
+ * \param arena Memory arena
+ * \return int 0 on success, -1 on error
+ */
+int replayOpen(replayWriter * rw, const char * fileName, int exclusive, int width, int height, uint64_t seed, memArena * arena);
+
+/*! \fn void replayRecord(replayWriter * rw, unsigned long tick, unsigned char direction)
+ * \brief Record a direction change
+ *
+ * Called after updateSnakeDirection changed the direction, before the step of the tick
+ * Only copies 1 or 2 bytes into the buffer, never calls the system
+ * unless the buffer is full because replayFlush was not called
+ *
+ * \param rw Pointer to recorder
+ * \param tick Number of steps made by the game so far
+ * \param direction New direction u, d, l or r
+ * \return void No values returned
+ */
+void replayRecord(replayWriter * rw, unsigned long tick, unsigned char direction);
+
+/*! \fn int replayFlush(replayWriter * rw)
+ * \brief Write the buffered bytes to the file
+ *
+ * \param rw Pointer to recorder
+ * \return int 0 on success, -1 on error
+ */
+int replayFlush(replayWriter * rw);
+
+/*! \fn int replayClose(replayWriter * rw, unsigned long ticks, int score, size_t length)
+ * \brief Record the end of the game and close the file
+ *
+ * \param rw Pointer to recorder
+ * \param ticks Number of steps made by the game
+ * \param score Final score
+ * \param length Final snake length
+ * \return int 0 on success, -1 if the replay could not be written completely
+ */
+int replayClose(replayWriter * rw, unsigned long ticks, int score, size_t length);
+
+/*! \fn int replayLoad(replayData * rp, const char * fileName)
+ * \brief Map a replay file into memory
+ *
+ * \param rp Pointer to replay data
+ * \param fileName Name of the replay file
+ * \return int 0 on success, -1 on error
+ */
+int replayLoad(replayData * rp, const char * fileName);
+
+/*! \fn void replayUnload(replayData * rp)
+ * \brief Unmap a replay file
+ *
+ * \param rp Pointer to replay data
+ * \return void No values returned
+ */
+void replayUnload(replayData * rp);
+
+/*! \fn int replayHeader(const replayData * rp, replayResult * result)
+ * \brief Read the board size and seed from the header
+ *
+ * \param rp Pointer to replay data
+ * \param result Width, height and seed are filled in
+ * \return int 0 on success, -1 if the data is not a replay
+ */
+int replayHeader(const replayData * rp, replayResult * result);
+
+/*! \fn int replayPlay(const replayData * rp, gameState * game, replayResult * result)
+ * \brief Play back a replay as fast as possible and compare the result
+ *
+ * The game is reset with the recorded seed, the recorded direction changes are fed
+ * through updateSnakeDirection and the game is stepped without any timer
+ *
+ * \param rp Pointer to replay data
+ * \param game Game with the board size of the replay, see replayHeader
+ * \param result Recorded and played back results
+ * \return int 0 if the results match, 1 if they differ, -1 if the replay is damaged
+ */
+int replayPlay(const replayData * rp, gameState * game, replayResult * result);
+
+#endif //SNAKEGAME_REPLAY_H
+
+// End of replay.h
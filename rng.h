@@ -0,0 +1,103 @@
+/*! \file rng.h
+ * \brief Per game random number generator
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * xoshiro128** generator, 16 bytes of state stored in each game,
+ * seeded explicitly, so games are reproducible and independent of each other.
+ * The functions are small and called on the hot path, so they are inline.
+ */
+
+#ifndef SNAKEGAME_RNG_H
+#define SNAKEGAME_RNG_H
+
+#include <stdint.h>
+
+/*! \typedef struct rngState
+ *  \brief Contains the state of one generator
+ *
+ * \var uint32_t s[4] Generator state, never all zero
+ */
+typedef struct rngState_t {
+    uint32_t s[4];
+} rngState;
+
+/*! \fn static inline uint32_t rngRotate(uint32_t value, int bits)
+ * \brief Rotate left
+ */
+static inline uint32_t rngRotate(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+/*! \fn static inline void rngSeed(rngState * rng, uint64_t seed)
+ * \brief Initialize the generator from a seed
+ *
+ * The state is filled with splitmix64 output, so similar seeds give unrelated sequences
+ *
+ * \param rng Pointer to generator
+ * \param seed Any value
+ * \return void No values returned
+ */
+static inline void rngSeed(rngState * rng, uint64_t seed) {
+    uint64_t z;
+    int i;
+
+    for (i = 0; i < 4; i += 2) {
+        seed += 0x9e3779b97f4a7c15ULL;                                  // splitmix64 step
+        z = seed;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        z ^= z >> 31;
+        rng->s[i] = (uint32_t) z;
+        rng->s[i + 1] = (uint32_t) (z >> 32);
+    }
+}
+
+/*! \fn static inline uint32_t rngNext(rngState * rng)
+ * \brief Next 32 bit random number
+ *
+ * \param rng Pointer to generator
+ * \return uint32_t Random number
+ */
+static inline uint32_t rngNext(rngState * rng) {
+    uint32_t result = rngRotate(rng->s[1] * 5, 7) * 9;
+    uint32_t t = rng->s[1] << 9;
+
+    rng->s[2] ^= rng->s[0];
+    rng->s[3] ^= rng->s[1];
+    rng->s[1] ^= rng->s[2];
+    rng->s[0] ^= rng->s[3];
+    rng->s[2] ^= t;
+    rng->s[3] = rngRotate(rng->s[3], 11);
+    return result;
+}
+
+/*! \fn static inline uint32_t rngBounded(rngState * rng, uint32_t bound)
+ * \brief Random number in 0 .. bound - 1, every value with the same chance
+ *
+ * Multiply and shift instead of modulo (Lemire), the rare biased results are
+ * rejected, so there is no modulo bias and usually no division at all
+ *
+ * \param rng Pointer to generator
+ * \param bound Number of possible values, at least 1
+ * \return uint32_t Random number
+ */
+static inline uint32_t rngBounded(rngState * rng, uint32_t bound) {
+    uint64_t product = (uint64_t) rngNext(rng) * bound;
+    uint32_t low = (uint32_t) product;
+    uint32_t threshold;
+
+    if (low < bound) {                                                  // maybe in the biased part
+        threshold = -bound % bound;                                     // 2^32 mod bound
+        while (low < threshold) {
+            product = (uint64_t) rngNext(rng) * bound;
+            low = (uint32_t) product;
+        }
+    }
+    return (uint32_t) (product >> 32);
+}
+
+#endif //SNAKEGAME_RNG_H
+
+// End of rng.h
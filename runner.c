@@ -0,0 +1,264 @@
+/*! \file runner.c
+ * \brief Parallel batch runner
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "runner.h"
+#include "memarena.h"
+
+/*! \typedef struct shardQueue
+ *  \brief Shards of one worker
+ *
+ * The owner takes shards from the front, thieves from the back
+ * Padded to cache lines, so workers do not share lines
+ *
+ * \var pthread_mutex_t lock Protects front and back
+ * \var long front, back Shard numbers front .. back - 1 are waiting
+ */
+typedef struct shardQueue_t {
+    pthread_mutex_t lock;
+    long front;
+    long back;
+} __attribute__((aligned(ARENAALIGN))) shardQueue;
+
+/*! \typedef struct worker
+ *  \brief Contains one worker thread
+ *
+ * \var runnerConfig * config Settings of the run
+ * \var runnerResult * results Results of all games
+ * \var shardQueue * queues Queues of all workers
+ * \var int index Number of this worker
+ * \var pthread_t thread The thread
+ * \var long games, steals, ticks Statistics of this worker
+ * \var int failed Set if memory could not be allocated
+ */
+typedef struct worker_t {
+    runnerConfig * config;
+    runnerResult * results;
+    shardQueue * queues;
+    pthread_t thread;
+    int index;
+    long games;
+    long steals;
+    unsigned long long ticks;
+    int failed;
+} __attribute__((aligned(ARENAALIGN))) worker;
+
+/*! \typedef struct slotShard
+ *  \brief Shard whose games a worker starts
+ *
+ * \var long next Next game to start
+ * \var long end Games up to end - 1 belong to the shard
+ */
+typedef struct slotShard_t {
+    long next;
+    long end;
+} slotShard;
+
+/*! \fn static int takeShard(worker * wk, long * shard)
+ * \brief Take a shard from own queue, or steal one from the back of another queue
+ */
+static int takeShard(worker * wk, long * shard) {
+    shardQueue * queue;
+    int i, victim;
+
+    queue = &wk->queues[wk->index];
+    pthread_mutex_lock(&queue->lock);
+    if (queue->front < queue->back) {                                   // own work first
+        *shard = queue->front++;
+        pthread_mutex_unlock(&queue->lock);
+        return 1;
+    }
+    pthread_mutex_unlock(&queue->lock);
+
+    for (i = 1; i < wk->config->threads; i++) {                         // then steal from the others
+        victim = (wk->index + i) % wk->config->threads;
+        queue = &wk->queues[victim];
+        pthread_mutex_lock(&queue->lock);
+        if (queue->front < queue->back) {
+            *shard = --queue->back;
+            pthread_mutex_unlock(&queue->lock);
+            wk->steals++;
+            return 1;
+        }
+        pthread_mutex_unlock(&queue->lock);
+    }
+    return 0;
+}
+
+/*! \fn static long nextGame(worker * wk, slotShard * sh)
+ * \brief Number of the next game to start, from the next shard once every game of this one is started, -1 if none is left
+ *
+ * The games of the old shard still running are collected as they finish, so no slot waits for them
+ */
+static long nextGame(worker * wk, slotShard * sh) {
+    long shardNumber;
+
+    if ((sh->next >= sh->end) && takeShard(wk, &shardNumber)) {
+        sh->next = shardNumber * wk->config->shardSize;
+        sh->end = sh->next + wk->config->shardSize;
+        if (sh->end > wk->config->games) {
+            sh->end = wk->config->games;
+        }
+    }
+    if (sh->next < sh->end) {
+        return sh->next++;
+    }
+    return -1;
+}
+
+/*! \fn static void * workerMain(void * argument)
+ * \brief Worker thread: play shards until every queue is empty
+ */
+static void * workerMain(void * argument) {
+    worker * wk = argument;
+    runnerConfig * config = wk->config;
+    memArena arena;
+    gameBatch batch;
+    policyState * states;
+    long * slotGame;
+    unsigned char * inputs;
+    slotShard shard;
+    long game, active = 0;
+    size_t i;
+
+    if (arenaInit(&arena, batchMemorySize(config->slots, config->width, config->height)
+                  + ARENABLOCK(config->slots * sizeof(policyState)) + ARENABLOCK(config->slots * sizeof(long))
+                  + ARENABLOCK(config->slots)) != 0) {
+        wk->failed = 1;
+        return NULL;
+    }
+    if (batchInit(&batch, config->slots, config->width, config->height, config->seed, &arena) != 0) {
+        wk->failed = 1;
+        arenaFree(&arena);
+        return NULL;
+    }
+    states = arenaAlloc(&arena, config->slots * sizeof(policyState));
+    slotGame = arenaAlloc(&arena, config->slots * sizeof(long));
+    inputs = arenaAlloc(&arena, config->slots);
+    shard.next = shard.end = 0;
+
+    for (i = 0; i < config->slots; i++) {
+        slotGame[i] = -1;
+        batch.running[i] = 0;
+    }
+
+    while (1) {
+        for (i = 0; i < config->slots; i++) {                           // fill idle slots
+            if (slotGame[i] >= 0) {
+                continue;
+            }
+            game = nextGame(wk, &shard);
+            if (game < 0) {
+                break;                                                  // every queue is empty
+            }
+            batchReset(&batch, i, config->seed + (unsigned int) game);
+            states[i].state = config->seed + (unsigned int) game;
+            states[i].position = 0;
+            slotGame[i] = game;
+            active++;
+        }
+        if (active == 0) {
+            break;                                                      // every game is finished
+        }
+
+        for (i = 0; i < config->slots; i++) {
+            inputs[i] = (slotGame[i] >= 0) ? config->policy(config->policyContext, &batch, i, &states[i]) : 0;
+        }
+        batchStep(&batch, inputs);
+
+        for (i = 0; i < config->slots; i++) {                           // collect finished games
+            if ((slotGame[i] < 0) || (batch.running[i] && ((unsigned long) batch.ticks[i] < config->maxTicks))) {
+                continue;
+            }
+            wk->results[slotGame[i]].score = batch.score[i];            // the lines of a shard are written by its worker only
+            wk->results[slotGame[i]].ticks = batch.ticks[i];
+            wk->ticks += (unsigned long long) batch.ticks[i];
+            wk->games++;
+            slotGame[i] = -1;
+            batch.running[i] = 0;
+            active--;
+        }
+    }
+    arenaFree(&arena);
+    return NULL;
+}
+
+int runGames(const runnerConfig * config, runnerResult * results, runnerStats * stats) {
+    /*! \var worker * workers
+     *  \brief Worker threads
+     */
+    worker * workers;
+    /*! \var shardQueue * queues
+     *  \brief Shard queue of each worker
+     */
+    shardQueue * queues;
+    /*! \var runnerConfig run
+     *  \brief Settings of the run with the shard size rounded, the caller's are left alone
+     */
+    runnerConfig run;
+    struct timespec start, end;
+    long shards, perWorker;
+    int i, started, result = 0;
+
+    if ((config->threads < 1) || (config->threads > RUNNERMAXTHREADS) || (config->slots < 1) || (config->shardSize < 1)) {
+        return -1;
+    }
+    run = *config;
+    run.shardSize = (config->shardSize + 7) / 8 * 8;                    // 8 results fill a cache line
+    shards = (run.games + run.shardSize - 1) / run.shardSize;
+    perWorker = (shards + run.threads - 1) / run.threads;
+    if (posix_memalign((void **) &workers, ARENAALIGN, (size_t) run.threads * sizeof(worker)) != 0) {
+        return -1;
+    }
+    if (posix_memalign((void **) &queues, ARENAALIGN, (size_t) run.threads * sizeof(shardQueue)) != 0) {
+        free(workers);
+        return -1;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    for (i = 0; i < run.threads; i++) {                                 // contiguous block of shards per worker
+        pthread_mutex_init(&queues[i].lock, NULL);
+        queues[i].front = i * perWorker < shards ? i * perWorker : shards;
+        queues[i].back = (i + 1) * perWorker < shards ? (i + 1) * perWorker : shards;
+        memset(&workers[i], 0, sizeof(worker));
+        workers[i].config = &run;
+        workers[i].results = results;
+        workers[i].queues = queues;
+        workers[i].index = i;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (started = 0; started < run.threads; started++) {
+        if (pthread_create(&workers[started].thread, NULL, workerMain, &workers[started]) != 0) {
+            result = -1;
+            break;
+        }
+    }
+    for (i = 0; i < started; i++) {
+        pthread_join(workers[i].thread, NULL);
+        if (workers[i].failed) {
+            result = -1;
+        }
+        stats->gamesPerThread[i] = workers[i].games;
+        stats->steals += workers[i].steals;
+        stats->ticks += workers[i].ticks;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    stats->elapsed = (double) (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    for (i = 0; i < run.threads; i++) {
+        pthread_mutex_destroy(&queues[i].lock);
+    }
+    free(workers);
+    free(queues);
+    return result;
+} // runGames function ends
+
+// End of runner.c
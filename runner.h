@@ -0,0 +1,111 @@
+/*! \file runner.h
+ * \brief Parallel batch runner header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Plays a large set of seeded games on all cores.
+ * The games are cut into shards, every worker thread has its own shard queue
+ * and steals shards from the other workers when its own queue is empty.
+ * Each worker steps its games in a gameBatch and refills a finished slot
+ * with the next game of its shard, or of the next shard once every game of
+ * its shard is started, so no slot waits for the last games of a shard.
+ */
+
+#ifndef SNAKEGAME_RUNNER_H
+#define SNAKEGAME_RUNNER_H
+
+#include <stdint.h>
+#include "batch.h"
+
+/*! \def RUNNERMAXTHREADS
+ *  \brief Largest number of worker threads
+ */
+#define RUNNERMAXTHREADS 256
+
+/*! \typedef struct policyState
+ *  \brief Per game state of an input policy
+ *
+ * Set to state = seed + game number, position = 0 when the game starts
+ *
+ * \var unsigned int state Random number state
+ * \var unsigned long position Position in a scripted input
+ */
+typedef struct policyState_t {
+    unsigned int state;
+    unsigned long position;
+} policyState;
+
+/*! \typedef inputPolicy
+ *  \brief Function choosing the next input of one game in a batch
+ *
+ * Called for every running game before each step, from the worker threads
+ */
+typedef unsigned char (*inputPolicy)(void * context, gameBatch * batch, size_t slot, policyState * ps);
+
+/*! \typedef struct runnerConfig
+ *  \brief Settings of a run
+ *
+ * \var int width, height Board size
+ * \var long games Number of games, game g is played with seed + g
+ * \var unsigned int seed Seed of game 0
+ * \var int threads Number of worker threads
+ * \var size_t slots Number of games stepped together by one worker
+ * \var long shardSize Number of games in one shard, runGames rounds it up to a multiple of 8 for the run
+ * \var unsigned long maxTicks A game is stopped after this many ticks
+ * \var inputPolicy policy Input of the games
+ * \var void * policyContext Passed to the policy
+ */
+typedef struct runnerConfig_t {
+    int width;
+    int height;
+    long games;
+    unsigned int seed;
+    int threads;
+    size_t slots;
+    long shardSize;
+    unsigned long maxTicks;
+    inputPolicy policy;
+    void * policyContext;
+} runnerConfig;
+
+/*! \typedef struct runnerResult
+ *  \brief Result of one game
+ *
+ * \var int32_t score Final score
+ * \var int32_t ticks Number of ticks played
+ */
+typedef struct runnerResult_t {
+    int32_t score;
+    int32_t ticks;
+} runnerResult;
+
+/*! \typedef struct runnerStats
+ *  \brief Statistics of a run
+ *
+ * \var double elapsed Wall clock time in seconds
+ * \var unsigned long long ticks Number of game steps made
+ * \var long gamesPerThread[RUNNERMAXTHREADS] Games finished by each worker
+ * \var long steals Number of shards taken from another worker
+ */
+typedef struct runnerStats_t {
+    double elapsed;
+    unsigned long long ticks;
+    long gamesPerThread[RUNNERMAXTHREADS];
+    long steals;
+} runnerStats;
+
+/*! \fn int runGames(const runnerConfig * config, runnerResult * results, runnerStats * stats)
+ * \brief Play all games on the worker threads
+ *
+ * \param config Settings of the run
+ * \param results Array of config->games results, filled by game number
+ *                If it is cache line aligned, no two workers write the same line
+ * \param stats Statistics of the run
+ * \return int 0 on success, -1 on error (memory or thread creation)
+ */
+int runGames(const runnerConfig * config, runnerResult * results, runnerStats * stats);
+
+#endif //SNAKEGAME_RUNNER_H
+
+// End of runner.h
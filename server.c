@@ -0,0 +1,629 @@
+/*! \file server.c
+ * \brief Multi-session game server
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Hosts many games for players connecting over TCP, with telnet or with
+ * nc from a raw terminal. Every thread is a reactor with its own listening
+ * socket on the shared port (SO_REUSEPORT, the kernel spreads the
+ * connections), its own epoll instance and its own 6 Hz timer. A session
+ * has its own game, key parser and differential renderer; the renderer
+ * leaves each frame in its buffer and the frame is queued for the socket.
+ * A slow client is never waited for: while its queue holds a frame not
+ * sent yet, its next frames are skipped, and when the queue drains the
+ * board is compared with the last frame queued, so the client catches up
+ * with one frame. A client that takes nothing for STALLTICKS is dropped.
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include "engine.h"
+#include "input.h"
+#include "netpeer.h"
+#include "render.h"
+#include "stats.h"
+#include "ticker.h"
+
+/*! \def SERVERPORT
+ *  \brief Default TCP port
+ */
+#define SERVERPORT 7070
+
+/*! \def MAXEVENTS
+ *  \brief Events handled per epoll_wait
+ */
+#define MAXEVENTS 256
+
+/*! \def MAXREACTORS
+ *  \brief Largest number of reactor threads
+ */
+#define MAXREACTORS 64
+
+/*! \def TICKSPERSECOND
+ *  \brief Game speed, the same as the terminal game
+ */
+#define TICKSPERSECOND 6
+
+/*! \def STALLTICKS
+ *  \brief A client that takes no bytes for this many ticks while frames wait is dropped
+ */
+#define STALLTICKS (TICKSPERSECOND * 10)
+
+/*! \def REPORTTICKS
+ *  \brief Ticks between two statistics lines with -v
+ */
+#define REPORTTICKS (TICKSPERSECOND * 5)
+
+/*! \def TELNET*
+ *  \brief Telnet protocol bytes: interpret as command, subnegotiation begin and end, option commands
+ */
+#define TELNETIAC 255
+#define TELNETSB 250
+#define TELNETSE 240
+#define TELNETWILL 251
+#define TELNETDONT 254
+
+/*! \typedef struct session
+ *  \brief Contains one connected player
+ *
+ * \var netPeer peer Socket and its epoll registration
+ * \var memArena memory Game, renderer and queue memory
+ * \var gameState game The game
+ * \var renderer screen Renderer leaving the frames in its buffer
+ * \var keyParser parser Escape sequence parser
+ * \var keyRing keys Keys waiting for the next ticks, only the reactor thread uses it
+ * \var int telnet Telnet command bytes being skipped: 0 none, 1 after IAC, 2 option, 3 subnegotiation, 4 IAC in subnegotiation
+ * \var unsigned char * queue Bytes waiting for the socket
+ * \var size_t queueSize Size of queue
+ * \var size_t queueStart, queueEnd Bytes queueStart .. queueEnd - 1 wait
+ * \var int behind True if frames were skipped since the last queued frame
+ * \var int over True after the game ended, until a new game
+ * \var unsigned long stalledTicks Ticks since the socket last took bytes while bytes waited
+ * \var size_t index Position in the session list of the reactor
+ * \var char statusText[96] Status line shown after a game
+ */
+typedef struct session_t {
+    netPeer peer;
+    memArena memory;
+    gameState game;
+    renderer screen;
+    keyParser parser;
+    keyRing keys;
+    int telnet;
+    unsigned char * queue;
+    size_t queueSize;
+    size_t queueStart;
+    size_t queueEnd;
+    int behind;
+    int over;
+    unsigned long stalledTicks;
+    size_t index;
+    char statusText[96];
+} session;
+
+/*! \typedef struct reactor
+ *  \brief Contains one reactor thread and its sessions
+ *
+ * \var pthread_t thread The thread
+ * \var int index Number of the reactor
+ * \var int listenFd Listening socket of this reactor
+ * \var int listenPaused True while listenFd is out of epoll because the descriptors ran out
+ * \var int epollFd Epoll instance of the listening socket, the timer and the sessions
+ * \var ticker tick The 6 Hz timer
+ * \var session ** sessions Sessions of the reactor
+ * \var size_t count, slots Number of sessions, size of the sessions array
+ * \var histogram tickWork Time spent on all sessions in one tick, nanoseconds
+ * \var unsigned long long accepted, closed, dropped Sessions started, ended, dropped as too slow
+ * \var unsigned long long framesSent, framesSkipped Frames queued, frames skipped because of a full queue
+ * \var unsigned long long bytesSent Bytes taken by the sockets
+ * \var size_t peak Largest number of sessions
+ */
+typedef struct reactor_t {
+    pthread_t thread;
+    int index;
+    int listenFd;
+    int listenPaused;
+    int epollFd;
+    ticker tick;
+    session ** sessions;
+    size_t count;
+    size_t slots;
+    histogram tickWork;
+    unsigned long long accepted;
+    unsigned long long closed;
+    unsigned long long dropped;
+    unsigned long long framesSent;
+    unsigned long long framesSkipped;
+    unsigned long long bytesSent;
+    size_t peak;
+} __attribute__((aligned(ARENAALIGN))) reactor;
+
+/*! \var static volatile sig_atomic_t stopRequested
+ *  \brief Set by SIGINT and SIGTERM
+ */
+static volatile sig_atomic_t stopRequested = 0;
+
+/*! \var static int boardWidth, boardHeight, port, verbose
+ *  \brief Settings shared by the reactors
+ */
+static int boardWidth = BOARDSIZEX, boardHeight = BOARDSIZEY, port = SERVERPORT, verbose = 0;
+
+/*! \fn static void onStop(int signalNumber)
+ * \brief Signal handler, ends the reactors
+ */
+static void onStop(int signalNumber) {
+    (void) signalNumber;
+    stopRequested = 1;
+}
+
+/*! \fn static void sendQueue(reactor * rc, session * ss)
+ * \brief Give the socket as much of the queue as it takes, never blocks
+ */
+static void sendQueue(reactor * rc, session * ss) {
+    ssize_t result;
+
+    while (ss->queueStart < ss->queueEnd) {
+        result = send(ss->peer.fd, ss->queue + ss->queueStart, ss->queueEnd - ss->queueStart, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                netCloseLater(rc->epollFd, &ss->peer);
+                return;
+            }
+            netWatchWrite(rc->epollFd, &ss->peer, ss, 1);              // socket buffer full
+            return;
+        }
+        ss->queueStart += (size_t) result;
+        ss->stalledTicks = 0;
+        rc->bytesSent += (unsigned long long) result;
+    }
+    ss->queueStart = ss->queueEnd = 0;                                  // all sent
+    netWatchWrite(rc->epollFd, &ss->peer, ss, 0);
+}
+
+/*! \fn static void queueBytes(session * ss, const void * bytes, size_t length)
+ * \brief Append bytes to the queue, the caller made sure they fit
+ */
+static void queueBytes(session * ss, const void * bytes, size_t length) {
+    if (ss->queueEnd + length > ss->queueSize) {                        // move the waiting bytes to the front
+        memmove(ss->queue, ss->queue + ss->queueStart, ss->queueEnd - ss->queueStart);
+        ss->queueEnd -= ss->queueStart;
+        ss->queueStart = 0;
+    }
+    memcpy(ss->queue + ss->queueEnd, bytes, length);
+    ss->queueEnd += length;
+}
+
+/*! \fn static void newGame(session * ss)
+ * \brief Start a game in the session, drawn completely with the next frame
+ */
+static void newGame(session * ss) {
+    gameReset(&ss->game, (uint64_t) inputNow() ^ (uint64_t) (size_t) ss);
+    ss->screen.fullRepaint = 1;
+    ss->over = 0;
+    renderStatus(&ss->screen, NULL);
+}
+
+/*! \fn static session * openSession(void)
+ * \brief Set up a session for a new connection, NULL if out of memory
+ */
+static session * openSession(void) {
+    static const unsigned char characterMode[] = { TELNETIAC, TELNETWILL, 1, TELNETIAC, TELNETWILL, 3 };   // server echoes (nothing), no go ahead
+    size_t frameSize = RENDERBUFFERSIZE(boardWidth, boardHeight);
+    session * ss;
+
+    if (posix_memalign((void **) &ss, ARENAALIGN, sizeof(session)) != 0) {   // the key ring is cache line aligned
+        return NULL;
+    }
+    memset(ss, 0, sizeof(session));
+    if ((arenaInit(&ss->memory, gameMemorySize(boardWidth, boardHeight) + renderMemorySize(boardWidth, boardHeight)
+                   + ARENABLOCK(2 * frameSize)) != 0)
+        || (gameInit(&ss->game, boardWidth, boardHeight, 0, &ss->memory) != 0)
+        || (renderInit(&ss->screen, -1, boardWidth, boardHeight, &ss->memory) != 0)) {
+        arenaFree(&ss->memory);
+        free(ss);
+        return NULL;
+    }
+    ss->queueSize = 2 * frameSize;                                      // a frame waiting and the next one
+    ss->queue = arenaAlloc(&ss->memory, ss->queueSize);
+    newGame(ss);
+    queueBytes(ss, characterMode, sizeof(characterMode));
+    return ss;
+}
+
+/*! \fn static int addSession(reactor * rc, int fd)
+ * \brief Register a new connection with the reactor, 0 on success
+ */
+static int addSession(reactor * rc, int fd) {
+    session ** grown;
+    session * ss;
+    size_t slots;
+
+    if (rc->count == rc->slots) {
+        slots = rc->slots > 0 ? rc->slots * 2 : 64;
+        grown = realloc(rc->sessions, slots * sizeof(session *));
+        if (grown == NULL) {
+            return -1;
+        }
+        rc->sessions = grown;
+        rc->slots = slots;
+    }
+    ss = openSession();
+    if (ss == NULL) {
+        return -1;
+    }
+    if (netAttach(rc->epollFd, &ss->peer, fd, ss, 2 * (int) RENDERBUFFERSIZE(boardWidth, boardHeight)) != 0) {
+        arenaFree(&ss->memory);
+        free(ss);
+        return -1;
+    }
+    ss->index = rc->count;
+    rc->sessions[rc->count++] = ss;
+    rc->peak = rc->count > rc->peak ? rc->count : rc->peak;
+    rc->accepted++;
+    return 0;
+}
+
+/*! \fn static void removeSession(reactor * rc, session * ss)
+ * \brief Close a session, the last session takes its place in the list
+ */
+static void removeSession(reactor * rc, session * ss) {
+    rc->sessions[ss->index] = rc->sessions[--rc->count];
+    rc->sessions[ss->index]->index = ss->index;
+    close(ss->peer.fd);                                                 // also removes it from epoll
+    arenaFree(&ss->memory);
+    free(ss);
+    rc->closed++;
+}
+
+/*! \fn static void acceptSessions(reactor * rc)
+ * \brief Accept every waiting connection
+ */
+static void acceptSessions(reactor * rc) {
+    int fd;
+
+    for (;;) {
+        fd = netAccept(rc->epollFd, rc->listenFd, &rc->listenPaused);
+        if (fd < 0) {
+            return;                                                     // EAGAIN, or out of descriptors until a session closes
+        }
+        if (addSession(rc, fd) != 0) {
+            close(fd);
+        }
+    }
+}
+
+/*! \fn static void parseByte(session * ss, unsigned char byte, long long timeNs)
+ * \brief Skip telnet commands, feed the other bytes to the key parser
+ */
+static void parseByte(session * ss, unsigned char byte, long long timeNs) {
+    keyEvent keys[2];
+    int count, i;
+
+    switch (ss->telnet) {
+        case 1:                                                         // after IAC
+            ss->telnet = byte == TELNETSB ? 3 : ((byte >= TELNETWILL) && (byte <= TELNETDONT) ? 2 : 0);
+            return;
+        case 2:                                                         // option of WILL, WONT, DO, DONT
+            ss->telnet = 0;
+            return;
+        case 3:                                                         // subnegotiation until IAC SE
+            ss->telnet = byte == TELNETIAC ? 4 : 3;
+            return;
+        case 4:
+            ss->telnet = byte == TELNETSE ? 0 : 3;
+            return;
+        default:
+            if (byte == TELNETIAC) {
+                ss->telnet = 1;
+                return;
+            }
+            break;
+    }
+    count = keyParse(&ss->parser, byte, timeNs, keys);
+    for (i = 0; i < count; i++) {
+        (void) keyRingPush(&ss->keys, &keys[i]);                        // a full ring drops the key
+    }
+}
+
+/*! \fn static void readSession(reactor * rc, session * ss)
+ * \brief Receive the bytes sent by the player
+ */
+static void readSession(reactor * rc, session * ss) {
+    unsigned char bytes[256];
+    long long now;
+    ssize_t result, i;
+
+    for (;;) {
+        result = recv(ss->peer.fd, bytes, sizeof(bytes), MSG_DONTWAIT);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                netCloseLater(rc->epollFd, &ss->peer);
+            }
+            return;
+        }
+        if (result == 0) {
+            netCloseLater(rc->epollFd, &ss->peer);
+            return;
+        }
+        now = inputNow();
+        for (i = 0; i < result; i++) {
+            parseByte(ss, bytes[i], now);
+        }
+    }
+}
+
+/*! \fn static void playTick(reactor * rc, session * ss)
+ * \brief Take at most one turn from the keys and step the game, like the terminal game
+ */
+static void playTick(reactor * rc, session * ss) {
+    keyEvent key;
+    unsigned char direction;
+
+    if (keyParseTimeout(&ss->parser, inputNow(), &key)) {
+        (void) keyRingPush(&ss->keys, &key);
+    }
+    while (keyRingPop(&ss->keys, &key)) {
+        if (key.key == KEYESCAPE) {
+            netCloseLater(rc->epollFd, &ss->peer);
+            return;
+        }
+        if (ss->over) {
+            if (key.key == ' ') {                                       // space starts a new game
+                newGame(ss);
+                return;
+            }
+            continue;
+        }
+        direction = ss->game.player.runningDirection;
+        updateSnakeDirection(&ss->game.player, key.key);
+        if (ss->game.player.runningDirection != direction) {
+            break;                                                      // one turn per tick, the rest waits
+        }
+    }
+    if (!ss->over && !gameStep(&ss->game, '\0')) {
+        ss->over = 1;
+        snprintf(ss->statusText, sizeof(ss->statusText), "Game over, score %d. Press SPACE to play again, ESC to quit.", ss->game.score);
+        renderStatus(&ss->screen, ss->statusText);
+    }
+}
+
+/*! \fn static void drawTick(reactor * rc, session * ss)
+ * \brief Queue the frame of the tick, or skip it while the previous frame waits
+ */
+static void drawTick(reactor * rc, session * ss) {
+    const coord * apple = ss->game.appleCount ? &ss->game.apple : NULL;
+
+    if (ss->queueEnd - ss->queueStart + ss->screen.bufferSize > ss->queueSize) {
+        ss->behind = 1;                                                 // slow client, the game goes on
+        rc->framesSkipped++;
+        if (++ss->stalledTicks > STALLTICKS) {
+            netCloseLater(rc->epollFd, &ss->peer);
+            rc->dropped++;
+        }
+        return;
+    }
+    if (ss->behind) {                                                   // compare the whole board with the last queued frame
+        (void) renderFrame(&ss->screen, &ss->game.occupied, apple, ss->game.score);
+        ss->behind = 0;
+    } else {
+        (void) renderDirty(&ss->screen, &ss->game.occupied, apple, &ss->game.dirty, ss->game.score);
+    }
+    ss->game.dirty.count = 0;                                           // drawn, a game over tick is not drawn twice
+    queueBytes(ss, ss->screen.buffer, ss->screen.length);
+    rc->framesSent++;
+    sendQueue(rc, ss);
+}
+
+/*! \fn static void report(reactor * rc)
+ * \brief Print one statistics line of a reactor
+ */
+static void report(reactor * rc) {
+    fprintf(stderr, "reactor %d: %zu sessions (peak %zu), tick work p50 %.1f us p99 %.1f us max %.1f us, missed ticks %lu, "
+            "frames sent %llu skipped %llu, %llu bytes, sessions accepted %llu closed %llu dropped %llu\n",
+            rc->index, rc->count, rc->peak, histogramPercentile(&rc->tickWork, 50.0) / 1e3,
+            histogramPercentile(&rc->tickWork, 99.0) / 1e3, rc->tickWork.max / 1e3, rc->tick.missedTicks,
+            rc->framesSent, rc->framesSkipped, rc->bytesSent, rc->accepted, rc->closed, rc->dropped);
+}
+
+/*! \fn static void runTick(reactor * rc)
+ * \brief Step, draw and send every session of the reactor
+ */
+static void runTick(reactor * rc) {
+    long long start = statsNow();
+    session * ss;
+    size_t i;
+
+    for (i = 0; i < rc->count; i++) {
+        ss = rc->sessions[i];
+        if (!ss->peer.closing) {
+            playTick(rc, ss);
+        }
+        if (!ss->peer.closing) {
+            drawTick(rc, ss);
+        }
+    }
+    for (i = rc->count; i > 0; i--) {                                   // backwards, removing moves the last one here
+        if (rc->sessions[i - 1]->peer.closing) {
+            removeSession(rc, rc->sessions[i - 1]);
+        }
+    }
+    netResume(rc->epollFd, &rc->listenFd, &rc->listenPaused);         // a closed session, or another process, may have freed one
+    histogramRecord(&rc->tickWork, (unsigned long long) (statsNow() - start));
+    if (verbose && (rc->tick.ticks % REPORTTICKS == 0)) {
+        report(rc);
+    }
+}
+
+/*! \fn static void * reactorMain(void * argument)
+ * \brief Reactor thread: accept, read keys and run the ticks until stopped
+ */
+static void * reactorMain(void * argument) {
+    reactor * rc = argument;
+    struct epoll_event events[MAXEVENTS];
+    session * ss;
+    int count, i, expired;
+
+    while (!stopRequested) {
+        count = epoll_wait(rc->epollFd, events, MAXEVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        expired = 0;
+        for (i = 0; i < count; i++) {
+            if (events[i].data.ptr == &rc->listenFd) {
+                acceptSessions(rc);
+            } else if (events[i].data.ptr == &rc->tick) {
+                expired = tickerExpired(&rc->tick);
+            } else {
+                ss = events[i].data.ptr;
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    readSession(rc, ss);
+                }
+                if ((events[i].events & EPOLLOUT) && !ss->peer.closing) {
+                    sendQueue(rc, ss);                                  // closed sessions are removed at the tick
+                }
+            }
+        }
+        if (expired) {                                                  // after the batch, its events may name removed sessions
+            runTick(rc);
+        }
+    }
+    while (rc->count > 0) {
+        removeSession(rc, rc->sessions[rc->count - 1]);
+    }
+    return NULL;
+}
+
+/*! \fn static int startReactor(reactor * rc, int index)
+ * \brief Open the socket, epoll instance and timer of a reactor and start its thread
+ */
+static int startReactor(reactor * rc, int index) {
+    struct epoll_event event;
+
+    memset(rc, 0, sizeof(*rc));
+    rc->index = index;
+    histogramReset(&rc->tickWork);
+    rc->listenFd = netListen(port, 1);                                  // every reactor listens, the kernel spreads the connections
+    if (rc->listenFd < 0) {
+        return -1;
+    }
+    rc->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if ((rc->epollFd < 0) || (tickerOpen(&rc->tick, TICKSPERSECOND) != 0)) {
+        return -1;
+    }
+    event.events = EPOLLIN;
+    event.data.ptr = &rc->listenFd;
+    if (epoll_ctl(rc->epollFd, EPOLL_CTL_ADD, rc->listenFd, &event) != 0) {
+        return -1;
+    }
+    event.data.ptr = &rc->tick;
+    if (epoll_ctl(rc->epollFd, EPOLL_CTL_ADD, rc->tick.timerFd, &event) != 0) {
+        return -1;
+    }
+    return pthread_create(&rc->thread, NULL, reactorMain, rc) == 0 ? 0 : -1;
+}
+
+int main(int argc, char **argv) {
+    /*! \var static reactor reactors[MAXREACTORS]
+     *  \brief The reactor threads
+     */
+    static reactor reactors[MAXREACTORS];
+    /*! \var struct sigaction action
+     *  \brief Stop signal handler, without restart so epoll_wait returns
+     */
+    struct sigaction action;
+    /*! \var struct rlimit files
+     *  \brief Open file limit, raised for thousands of sessions
+     */
+    struct rlimit files;
+    /*! \var int threads
+     *  \brief Number of reactors, one per core by default
+     */
+    int threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    /*! \var int option, started, i
+     *  \brief Command line option, number of reactors running, loop index
+     */
+    int option, started, i;
+
+    while ((option = getopt(argc, argv, "p:t:x:y:v")) != -1) {
+        switch (option) {
+            case 'p':
+                port = atoi(optarg);
+                break;
+            case 't':
+                threads = atoi(optarg);
+                break;
+            case 'x':
+                boardWidth = atoi(optarg);
+                break;
+            case 'y':
+                boardHeight = atoi(optarg);
+                break;
+            case 'v':
+                verbose = 1;
+                break;
+            default:
+                threads = 0;
+                break;
+        }
+    }
+    if ((threads < 1) || (threads > MAXREACTORS) || (port < 1) || (port > 65535)
+        || (boardWidth < MINBOARDSIZE) || (boardWidth > MAXBOARDSIZE) || (boardHeight < MINBOARDSIZE) || (boardHeight > MAXBOARDSIZE)) {
+        fprintf(stderr, "Usage: %s [-p port] [-t threads] [-x columns] [-y rows] [-v]\n", argv[0]);
+        return 1;
+    }
+
+    if (getrlimit(RLIMIT_NOFILE, &files) == 0) {
+        files.rlim_cur = files.rlim_max;
+        (void) setrlimit(RLIMIT_NOFILE, &files);
+    }
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onStop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    for (started = 0; started < threads; started++) {
+        if (startReactor(&reactors[started], started) != 0) {
+            perror("reactor");
+            stopRequested = 1;
+            break;
+        }
+    }
+    if (started == threads) {
+        fprintf(stderr, "Serving %dx%d games on port %d with %d reactors\n", boardWidth, boardHeight, port, threads);
+    }
+    while (!stopRequested) {
+        pause();                                                        // the reactors work, a signal ends the wait
+    }
+    for (i = 0; i < started; i++) {
+        pthread_kill(reactors[i].thread, SIGINT);                       // interrupt epoll_wait
+        pthread_join(reactors[i].thread, NULL);
+        report(&reactors[i]);
+        tickerClose(&reactors[i].tick);
+        close(reactors[i].epollFd);
+        close(reactors[i].listenFd);
+        free(reactors[i].sessions);
+    }
+    return started == threads ? 0 : 1;
+}
+
+// End of server.c
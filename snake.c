@@ -9,117 +9,111 @@
  * 02.10.2018
  */
 
-#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <unistd.h>
 #include "snake.h"
 
-#define WALLCHAR 'H'
 #define SNAKECHAR 'o'
 #define APPLECHAR 'b'
 #define EMPTYCHAR ' '
 
-void clearBoard(unsigned char gameBoard[BOARDSIZEX][BOARDSIZEY], size_t lengthX, size_t lengthY)
-{
-    /*! \var size_t i, j
-     *  \brief Loop index variables
-     */
-    size_t i,j;
-    for (i = 0; i< lengthX; i++) {              // Two loop run through all elements on the board...
-        for (j = 0; j< lengthY; j++) {
-            gameBoard[i][j] = EMPTYCHAR;              // .. and set to empty space character
+size_t boardMemorySize(int width, int height) {
+    return ARENABLOCK((size_t) width * (size_t) height);
+} // boardMemorySize function ends
+
+int initBoard(board * gameBoard, int width, int height, memArena * arena) {
+    if (arena != NULL) {
+        gameBoard->cells = arenaAlloc(arena, (size_t) width * (size_t) height);
+        if (gameBoard->cells == NULL) {
+            return -1;
+        }
+    }
+    gameBoard->width = width;
+    gameBoard->height = height;
+    clearBoard(gameBoard);
+    return 0;
+} // initBoard function ends
+
+size_t snakeMemorySize(int width, int height) {
+    return ARENABLOCK((size_t) width * (size_t) height * sizeof(coord));
+} // snakeMemorySize function ends
+
+int initSnake(snake * sn, int width, int height, memArena * arena) {
+    sn->capacity = (size_t) width * (size_t) height;                   // snake can cover the whole board
+    if (arena != NULL) {
+        sn->position = arenaAlloc(arena, sn->capacity * sizeof(coord));
+        if (sn->position == NULL) {
+            return -1;
         }
     }
+    memset(sn->position, 0, sn->capacity * sizeof(coord));             // Clear snake data.
+    sn->head = 0;
+    sn->tail = 0;
+    sn->position[sn->head].x = width / 2;                               // Positon snake at the center of the board
+    sn->position[sn->head].y = height / 2;
+
+    sn->snakeCurrentLength = 1;                                         // Initial snake length
+    sn->snakeSupposedLength = 4;                                        // The snake "flows in"
+    sn->runningDirection = 'l';                                         // Snake runs to the left
+    return 0;
+} // initSnake function ends
+
+void clearBoard(board * gameBoard)
+{
+    memset(gameBoard->cells, EMPTYCHAR, (size_t) gameBoard->width * (size_t) gameBoard->height);     // set all cells to empty space character
 } // clearBoard function ends
 
-void updateBoard(unsigned char gameBoard[BOARDSIZEX][BOARDSIZEY], coord * apple, snake * sn, int appleCount) {
+void updateBoard(board * gameBoard, coord * apple, snake * sn, int appleCount) {
     /*! \var size_t i, j
      *  \brief Loop index variables
      */
     size_t i;
 
-    clearBoard(gameBoard, BOARDSIZEX, BOARDSIZEY);                      // clear board
+    clearBoard(gameBoard);                                              // clear board
 
     if (appleCount == 1) {                                              // place apple on board
-        gameBoard[apple->x][apple->y] = APPLECHAR;
+        BOARDCELL(gameBoard, apple->x, apple->y) = APPLECHAR;
     }
 
     if (sn->head >= sn->tail) {                                         // ......tail..>>..head......
         for (i = sn->tail; i <= sn->head; i++) {                        // loop run forward from tail to head...
-            gameBoard[sn->position[i].x][sn->position[i].y] = SNAKECHAR;      // ...and place on board
+            BOARDCELL(gameBoard, sn->position[i].x, sn->position[i].y) = SNAKECHAR;    // ...and place on board
         }
     } else {                                                            // ..>>..head......tail..>>..
-        for (i = sn->tail; i < BOARDSIZEX * BOARDSIZEY; i++) {          // loop run forward from tail to end of array
-            gameBoard[sn->position[i].x][sn->position[i].y] = SNAKECHAR;      // ...and place on board
+        for (i = sn->tail; i < sn->capacity; i++) {                     // loop run forward from tail to end of array
+            BOARDCELL(gameBoard, sn->position[i].x, sn->position[i].y) = SNAKECHAR;    // ...and place on board
         }
         for (i = 0; i <= sn->head; i++) {                               // loop run forward from beginning of array to head
-            gameBoard[sn->position[i].x][sn->position[i].y] = SNAKECHAR;      // ...and place on board
+            BOARDCELL(gameBoard, sn->position[i].x, sn->position[i].y) = SNAKECHAR;    // ...and place on board
         }
     }
 } // updateBoard function ends
 
-unsigned char readInput()
-{
-    /*! \var unsigned char c[3]
-     *  \brief Character sequence read from input
-     */
-    unsigned char c[3];
-    /*! \var unsigned char upKey[3]
-     *  \brief Predefined character sequence for up arrow key
-     */
-    unsigned char upKey[3] = {27,91,65};
-    /*! \var unsigned char downKey[3]
-     *  \brief Predefined character sequence for down arrow key
-     */
-    unsigned char downKey[3] = {27,91,66};
-    /*! \var unsigned char leftKey[3]
-     *  \brief Predefined character sequence for left arrow key
-     */
-    unsigned char leftKey[3] = {27,91,68};
-    /*! \var unsigned char rightKey[3]
-     *  \brief Predefined character sequence for right arrow key
-     */
-    unsigned char rightKey[3] = {27,91,67};
-    /*! \var unsigned char escKey[3]
-     *  \brief Predefined character sequence for escape key
-     */
-    unsigned char escKey[3] = {27,0,0};
-    /*! \var unsigned char spaceKey[3]
-     *  \brief Predefined character sequence for space key
-     */
-    unsigned char spaceKey[3] = {32,0,0};
-    /*! \var unsigned char input
-     *  \brief 1 char corresponding value for pressed key
-     *          l - left arrow, r - right arrow, u - up arrow, d - down arrow, 32 - space key, 27 - escape key
-     */
-    unsigned char input = '\0';
+/*! \fn static void addDirtyCell(dirtyList * dirty, coord * cell, unsigned char value)
+ * \brief Append 1 cell to the changed cells
+ */
+static void addDirtyCell(dirtyList * dirty, coord * cell, unsigned char value) {
+    if (dirty->count < MAXDIRTYCELLS) {
+        dirty->cells[dirty->count].cell = *cell;
+        dirty->cells[dirty->count].value = value;
+        dirty->count++;
+    }
+}
 
-    // Read user input
-    memset(c, 0, sizeof(c));                    // Clear buffer
+void applyDirtyCells(board * gameBoard, dirtyList * dirty) {
+    /*! \var size_t i
+     *  \brief Loop index variable
+     */
+    size_t i;
 
-    if (read(0, &c, 3) != 0) {                  // Read input (0 = stdin, 3 char)
-        //printf("You pressed: ");
-        if (memcmp(c, upKey, 3) == 0) {         // Input sequence equals to stored up arrow sequence
-            //printf("up\n");
-            input = 'u';
-        } else if (memcmp(c, downKey, 3) == 0) {    // Input sequence equals to stored down arrow sequence
-            //printf("down\n");
-            input = 'd';
-        } else if (memcmp(c, leftKey, 3) == 0) {    // Input sequence equals to stored left arrow sequence
-            //printf("left\n");
-            input = 'l';
-        } else if (memcmp(c, rightKey, 3) == 0) {   // Input sequence equals to stored right arrow sequence
-            //printf("right\n");
-            input = 'r';
-        } else if (memcmp(c, escKey, 3) == 0) {     // Input sequence equals to stored escape key sequence
-            input = c[0];
-        } else if (memcmp(c, spaceKey, 3) == 0) {   // Input sequence equals to stored space bar key sequence
-            input = c[0];
-        }
+    for (i = 0; i < dirty->count; i++) {                                // write cells in order of change
+        BOARDCELL(gameBoard, dirty->cells[i].cell.x, dirty->cells[i].cell.y) = dirty->cells[i].value;
     }
-    return input;
-} // readInput function ends
+} // applyDirtyCells function ends
+
+void markApple(coord * apple, dirtyList * dirty) {
+    addDirtyCell(dirty, apple, APPLECHAR);
+} // markApple function ends
 
 void updateSnakeDirection(snake * sn, unsigned char input) {
     if ((input == 'u') || (input == 'd')) {                                     // if input is up or down
@@ -136,7 +130,7 @@ void updateSnakeDirection(snake * sn, unsigned char input) {
 void updateSnake(snake * sn)
 {
     // update snake position
-    if (sn->head < BOARDSIZEX * BOARDSIZEY - 1) {                               // head segment is not the last element
+    if (sn->head < sn->capacity - 1) {                                          // head segment is not the last element
                                                                                 // so the head pointer is increased
         switch (sn->runningDirection) {                                         // which way the snake moves
             case 'u':
@@ -193,14 +187,32 @@ void updateSnake(snake * sn)
     sn->snakeCurrentLength++;                                                   // because head moved forward, length is inceased
     if (sn->snakeCurrentLength > sn->snakeSupposedLength) {                     // if length is longer than it should
         sn->tail++;                                                             // tail is moved forward, after the head
-        if (sn->tail == BOARDSIZEX * BOARDSIZEY) {                              // tail segment is after the last element
+        if (sn->tail == sn->capacity) {                                         // tail segment is after the last element
             sn->tail = 0;                                                       // so the tail pointer is moved to 0 position
         }
         sn->snakeCurrentLength--;                                               // because tail moved forward, length is decreased
     }
 } // updateSnake function ends
 
-int placeApple(coord * apple, snake * sn) {
+void updateSnakeTracked(snake * sn, dirtyList * dirty) {
+    /*! \var coord oldTail
+     *  \brief Tail position before the move
+     */
+    coord oldTail = sn->position[sn->tail];
+    /*! \var size_t tailIndex
+     *  \brief Tail index before the move
+     */
+    size_t tailIndex = sn->tail;
+
+    updateSnake(sn);
+
+    if (sn->tail != tailIndex) {                                                // tail moved, its old cell is free
+        addDirtyCell(dirty, &oldTail, EMPTYCHAR);
+    }
+    addDirtyCell(dirty, &sn->position[sn->head], SNAKECHAR);                    // head always moves
+} // updateSnakeTracked function ends
+
+int placeApple(coord * apple, snake * sn, board * gameBoard, rngState * rng) {
     /*! \var int foundApplePosition
      *  \brief 1 is apple position successfully found
      */
@@ -210,10 +222,10 @@ int placeApple(coord * apple, snake * sn) {
      */
     size_t i;
 
-    if (sn->snakeSupposedLength != BOARDSIZEX * BOARDSIZEY) {                   // if snake not covering the whole board
+    if (sn->snakeSupposedLength != sn->capacity) {                              // if snake not covering the whole board
         while (foundApplePosition == 0) {                                       // find a random position for apple
-            apple->x = rand() % BOARDSIZEX;
-            apple->y = rand() % BOARDSIZEY;
+            apple->x = (int) rngBounded(rng, (uint32_t) gameBoard->width);
+            apple->y = (int) rngBounded(rng, (uint32_t) gameBoard->height);
             foundApplePosition = 1;                                             // found one position
 
                                                                                 // compare apple position with snake position
@@ -224,7 +236,7 @@ int placeApple(coord * apple, snake * sn) {
                     }                                                           // position not found
                 }
             } else {                                                            // ..>>..head......tail..>>..
-                for (i = sn->tail; i < BOARDSIZEX * BOARDSIZEY; i++) {
+                for (i = sn->tail; i < sn->capacity; i++) {
                     if ((sn->position[i].x == apple->x) && (sn->position[i].y == apple->y)) {   // compare position
                         foundApplePosition = 0;                                 // positions overlap
                     }                                                           // position not found
@@ -240,42 +252,4 @@ int placeApple(coord * apple, snake * sn) {
     return foundApplePosition;
 } // placeApple function ends
 
-void drawScreen(unsigned char gameBoard[BOARDSIZEX][BOARDSIZEY], int score, int rowNumber) {
-    /*! \var size_t i, j
-     *  \brief Loop index variables
-     */
-    size_t i,j;
-    char wall = WALLCHAR;
-
-    // draw board on the screen
-    printf ("Snake game\n                                    Your score: %d\n", score);     // Title line + player score
-    for (j = 0; j < BOARDSIZEX + 2; j++) {                                                  // Top edge of board
-        printf ("%c", wall);
-    }
-    printf("\n");
-
-    for (i = 0; i< BOARDSIZEY; i++) {                                                       // Game board
-        printf ("%c", wall);                                                                       // Left edge of board
-
-
-        for (j = 0; j < BOARDSIZEX; j++) {                                                  // Game board
-            printf ("%c", gameBoard[j][i]);
-        }
-
-
-        printf ("%c\n", wall);                                                                     // Right edge of board
-    }
-
-    for (j = 0; j < BOARDSIZEX + 2; j++) {                                                  // Bottom edge of board
-        printf ("%c", wall);
-    }
-
-    printf ("\n\n    Use arrow keys to turn snake. Press ESC to quit game.\n");             // Print instructions
-
-    for (i = BOARDSIZEY + 8; i< rowNumber; i++) {                                           // Fill remaining space
-        printf("\n");                                                                       // so board is always
-    }                                                                                       // at the same position
-    //(void) fflush(stdout);
-} // drawScreen function ends
-
 // End of snake.c
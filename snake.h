@@ -10,17 +10,29 @@
  */
 
 /*! \def BOARDSIZEX
- *  \brief Horizontal size of the game board
+ *  \brief Default horizontal size of the game board
  */
 #define BOARDSIZEX 20
 /*! \def BOARDSIZEY
- *  \brief Vertical size of the game board
+ *  \brief Default vertical size of the game board
  */
 #define BOARDSIZEY 14
+/*! \def MINBOARDSIZE
+ *  \brief Smallest allowed board width and height
+ */
+#define MINBOARDSIZE 5
+/*! \def MAXBOARDSIZE
+ *  \brief Largest allowed board width and height
+ */
+#define MAXBOARDSIZE 10000
 
 #ifndef SNAKEGAME_SNAKE_H
 #define SNAKEGAME_SNAKE_H
 
+#include <stddef.h>
+#include "memarena.h"
+#include "rng.h"
+
 /*! \typedef struct coord
  *  \brief Contains 1 coordinate on game board
  *
@@ -32,10 +44,31 @@ typedef struct coord_t {
     int y;
 } coord;
 
+/*! \typedef struct board
+ *  \brief Contains the game board
+ *
+ * Cells are stored row by row, the cell of x, y is cells[y * width + x]
+ *
+ * \var int width Number of columns
+ * \var int height Number of rows
+ * \var unsigned char * cells Content of the cells, width * height elements
+ */
+typedef struct board_t {
+    int width;
+    int height;
+    unsigned char * cells;
+} board;
+
+/*! \def BOARDCELL
+ *  \brief The cell of the board at position x, y
+ */
+#define BOARDCELL(gameBoard, x, y) ((gameBoard)->cells[(size_t) (y) * (size_t) (gameBoard)->width + (size_t) (x)])
+
 /*! \typedef struct snake
  *  \brief Contains 1 snake
  *
- * \var coord position[BOARDSIZEX * BOARDSIZEY] Snake segment poitions
+ * \var coord * position Snake segment poitions, ring buffer of capacity elements
+ * \var size_t capacity Size of the position ring buffer, number of cells on board
  * \var size_t head The head segment on the list
  * \var size_t tail The tail segment on the list
  * \var size_t snakeCurrentLength Length of the snake
@@ -43,7 +76,8 @@ typedef struct coord_t {
  * \var unsigned char runningDirection The direction the snake is facing and sliding
  */
 typedef struct snake_t {
-    coord position[BOARDSIZEX * BOARDSIZEY];
+    coord * position;
+    size_t capacity;
     size_t head;
     size_t tail;
     size_t snakeCurrentLength;
@@ -51,19 +85,91 @@ typedef struct snake_t {
     unsigned char runningDirection;           // u, d, l, r
 } snake;
 
-/*! \fn void clearBoard(unsigned char gameBoard[BOARDSIZEX][BOARDSIZEY], size_t lengthX, size_t lengthY)
+/*! \def MAXDIRTYCELLS
+ *  \brief Maximum number of board cells changed in one tick
+ *
+ * Vacated tail, new head and new apple
+ */
+#define MAXDIRTYCELLS 4
+
+/*! \typedef struct dirtyCell
+ *  \brief Contains 1 changed cell of the game board
+ *
+ * \var coord cell Position of the cell
+ * \var unsigned char value New content of the cell
+ */
+typedef struct dirtyCell_t {
+    coord cell;
+    unsigned char value;
+} dirtyCell;
+
+/*! \typedef struct dirtyList
+ *  \brief Contains the cells changed in one tick
+ *
+ * \var dirtyCell cells[MAXDIRTYCELLS] Changed cells in order of change
+ * \var size_t count Number of changed cells
+ */
+typedef struct dirtyList_t {
+    dirtyCell cells[MAXDIRTYCELLS];
+    size_t count;
+} dirtyList;
+
+/*! \fn size_t boardMemorySize(int width, int height)
+ * \brief Arena space needed by a board
+ *
+ * \param width Number of columns
+ * \param height Number of rows
+ * \return size_t Number of bytes
+ */
+size_t boardMemorySize(int width, int height);
+
+/*! \fn int initBoard(board * gameBoard, int width, int height, memArena * arena)
+ * \brief Set up an empty board with cells taken from the arena
+ *
+ * If arena is NULL, the cells already taken are reused (the board size must be the same)
+ *
+ * \param gameBoard Pointer to board
+ * \param width Number of columns
+ * \param height Number of rows
+ * \param arena Memory arena or NULL
+ * \return int 0 on success, -1 if the arena is exhausted
+ */
+int initBoard(board * gameBoard, int width, int height, memArena * arena);
+
+/*! \fn size_t snakeMemorySize(int width, int height)
+ * \brief Arena space needed by a snake on a board of the given size
+ *
+ * \param width Number of columns
+ * \param height Number of rows
+ * \return size_t Number of bytes
+ */
+size_t snakeMemorySize(int width, int height);
+
+/*! \fn int initSnake(snake * sn, int width, int height, memArena * arena)
+ * \brief Set up the starting snake at the center of the board
+ *
+ * The snake is 1 segment long, runs to the left and "flows in" to 4 segments
+ * If arena is NULL, the position buffer already taken is reused (the board size must be the same)
+ *
+ * \param sn Pointer to snake
+ * \param width Number of columns
+ * \param height Number of rows
+ * \param arena Memory arena or NULL
+ * \return int 0 on success, -1 if the arena is exhausted
+ */
+int initSnake(snake * sn, int width, int height, memArena * arena);
+
+/*! \fn void clearBoard(board * gameBoard)
  * \brief Clear the game board
  *
- * Fills the game boad with 0 values
+ * Fills the game boad with empty cells
  *
  * \param gameBoard Pointer to board
- * \param lengthX Number of columns
- * \param lengthY Number of rows
  * \return void No values returned
  */
-void clearBoard(unsigned char gameBoard[BOARDSIZEX][BOARDSIZEY], size_t lengthX, size_t lengthY);
+void clearBoard(board * gameBoard);
 
-/*! \fn void updateBoard(unsigned char gameBoard[BOARDSIZEX][BOARDSIZEY], coord * apple, snake * sn, int appleCount)
+/*! \fn void updateBoard(board * gameBoard, coord * apple, snake * sn, int appleCount)
  * \brief Place the snake and the apples on board
  *
  * Place the snake and the apples on board
@@ -74,20 +180,28 @@ void clearBoard(unsigned char gameBoard[BOARDSIZEX][BOARDSIZEY], size_t lengthX,
  * \param appleCount Number of apples on board
  * \return void No values returned
  */
-void updateBoard(unsigned char gameBoard[BOARDSIZEX][BOARDSIZEY], coord * apple, snake * sn, int appleCount);
+void updateBoard(board * gameBoard, coord * apple, snake * sn, int appleCount);
 
-/*! \fn unsigned char readInput()
- * \brief Reads keyboard input
+/*! \fn void applyDirtyCells(board * gameBoard, dirtyList * dirty)
+ * \brief Write the changed cells on the board
  *
- * Reads character input sequence from input
- * In raw mode keys generate many character long sequences
- * Reading compared the predefined character sequences
+ * Incremental alternative of updateBoard, the cost does not depend on board size or snake length
+ * The board must have been built with updateBoard once
  *
- * l - left arrow, r - right arrow, u - up arrow, d - down arrow, 32 - space key, 27 - escape key
+ * \param gameBoard Pointer to board
+ * \param dirty Changed cells
+ * \return void No values returned
+ */
+void applyDirtyCells(board * gameBoard, dirtyList * dirty);
+
+/*! \fn void markApple(coord * apple, dirtyList * dirty)
+ * \brief Record a newly placed apple in the changed cells
  *
- * \return unsigned char Letter equivalent for input key l, r, u, d, 32, 27
+ * \param apple Pointer to apple
+ * \param dirty Changed cells
+ * \return void No values returned
  */
-unsigned char readInput();
+void markApple(coord * apple, dirtyList * dirty);
 
 /*! \fn void updateSnakeDirection(snake * sn, unsigned char input)
  * \brief Update snake facing direction information
@@ -100,6 +214,14 @@ unsigned char readInput();
  */
 void updateSnakeDirection(snake * sn, unsigned char input);
 
+/*! \fn static inline int reverseDirection(unsigned char direction, unsigned char running)
+ * \brief True if direction is the opposite of the running direction, updateSnakeDirection ignores it
+ */
+static inline int reverseDirection(unsigned char direction, unsigned char running) {
+    return ((direction == 'u') && (running == 'd')) || ((direction == 'd') && (running == 'u'))
+        || ((direction == 'l') && (running == 'r')) || ((direction == 'r') && (running == 'l'));
+}
+
 /*! \fn void updateSnake(snake * sn)
  * \brief Update snake structure
  *
@@ -111,7 +233,20 @@ void updateSnakeDirection(snake * sn, unsigned char input);
  */
 void updateSnake(snake * sn);
 
-/*! \fn int placeApple(coord * apple, snake * sn)
+/*! \fn void updateSnakeTracked(snake * sn, dirtyList * dirty)
+ * \brief Update snake structure and record the changed board cells
+ *
+ * Same as updateSnake, in addition the vacated tail cell and the new head cell
+ * are appended to the changed cells, in this order
+ * The board itself is not touched, so collision can be checked before applyDirtyCells
+ *
+ * \param sn Snake
+ * \param dirty Changed cells
+ * \return void No values returned
+ */
+void updateSnakeTracked(snake * sn, dirtyList * dirty);
+
+/*! \fn int placeApple(coord * apple, snake * sn, board * gameBoard, rngState * rng)
  * \brief Place an apple on the board if it is possible
  *
  * Find a new position for apple
@@ -121,22 +256,11 @@ void updateSnake(snake * sn);
  *
  * \param apple Pointer to apple
  * \param sn Pointer to nake
+ * \param gameBoard Pointer to board, only its size is used
+ * \param rng Random number generator of the game
  * \return int No. of placed apples returned
  */
-int placeApple(coord * apple, snake * sn);
-
-/*! \fn void drawScreen(unsigned char gameBoard[BOARDSIZEX][BOARDSIZEY], int score, int rowNumber)
- * \brief Render the game screen on terminal window
- *
- * Render the game screen on terminal window
- * Screen line feed writing adjusted to terminal size, therefore the board appears at the same position
- *
- * \param gameBoard The game board with snake and apple on it
- * \param score Players current score
- * \param Number of rows on terminal
- * \return void No values returned
- */
-void drawScreen(unsigned char gameBoard[BOARDSIZEX][BOARDSIZEY], int score, int rowNumber);
+int placeApple(coord * apple, snake * sn, board * gameBoard, rngState * rng);
 
 #endif //SNAKEGAME_SNAKE_H
 
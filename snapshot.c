@@ -0,0 +1,390 @@
+/*! \file snapshot.c
+ * \brief Game snapshot
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "snapshot.h"
+#include "fileio.h"
+
+/*! \def DIRECTIONS
+ *  \brief Valid running directions
+ */
+#define DIRECTIONS "udlr"
+
+/*! \fn static void put16(unsigned char * out, uint32_t value)
+ * \brief Store 2 bytes little endian
+ */
+static void put16(unsigned char * out, uint32_t value) {
+    out[0] = (unsigned char) value;
+    out[1] = (unsigned char) (value >> 8);
+}
+
+/*! \fn static void put32(unsigned char * out, uint32_t value)
+ * \brief Store 4 bytes little endian
+ */
+static void put32(unsigned char * out, uint32_t value) {
+    out[0] = (unsigned char) value;
+    out[1] = (unsigned char) (value >> 8);
+    out[2] = (unsigned char) (value >> 16);
+    out[3] = (unsigned char) (value >> 24);
+}
+
+/*! \fn static uint32_t get16(const unsigned char * in)
+ * \brief Read 2 bytes little endian
+ */
+static uint32_t get16(const unsigned char * in) {
+    return (uint32_t) in[0] | ((uint32_t) in[1] << 8);
+}
+
+/*! \fn static uint32_t get32(const unsigned char * in)
+ * \brief Read 4 bytes little endian
+ */
+static uint32_t get32(const unsigned char * in) {
+    return (uint32_t) in[0] | ((uint32_t) in[1] << 8) | ((uint32_t) in[2] << 16) | ((uint32_t) in[3] << 24);
+}
+
+/*! \fn static size_t encode(const gameState * game, unsigned char * out)
+ * \brief Encode the game without the checksum, return the number of bytes
+ */
+static size_t encode(const gameState * game, unsigned char * out) {
+    const snake * sn = &game->player;
+    unsigned char * position = out + SNAPSHOTHEADERSIZE;
+    size_t i, segment = sn->tail;
+    int r;
+
+    memcpy(out, "SNKS", 4);
+    out[4] = SNAPSHOTVERSION;
+    out[5] = out[6] = out[7] = 0;
+    put32(out + 8, (uint32_t) game->occupied.width);
+    put32(out + 12, (uint32_t) game->occupied.height);
+    put32(out + 16, (uint32_t) game->ticks);
+    put32(out + 20, (uint32_t) ((unsigned long long) game->ticks >> 32));
+    for (r = 0; r < 4; r++) {
+        put32(out + 24 + 4 * r, game->rng.s[r]);
+    }
+    put32(out + 40, (uint32_t) game->score);
+    put32(out + 44, (uint32_t) game->apple.x);
+    put32(out + 48, (uint32_t) game->apple.y);
+    put32(out + 52, (uint32_t) game->appleCount);
+    out[56] = sn->runningDirection;
+    out[57] = out[58] = out[59] = 0;
+    put32(out + 60, (uint32_t) sn->snakeCurrentLength);
+    put32(out + 64, (uint32_t) sn->snakeSupposedLength);
+    put32(out + 68, (uint32_t) game->freeIndex.count);
+
+    for (i = 0; i < sn->snakeCurrentLength; i++) {                      // tail to head, the ring is unrolled
+        put16(position, (uint32_t) sn->position[segment].x);
+        put16(position + 2, (uint32_t) sn->position[segment].y);
+        position += 4;
+        segment = segment + 1 < sn->capacity ? segment + 1 : 0;
+    }
+    for (i = 0; i < game->freeIndex.count; i++) {                       // the order decides where the apples go
+        put32(position, (uint32_t) game->freeIndex.cells[i]);
+        position += 4;
+    }
+    return (size_t) (position - out);
+}
+
+/*! \fn static int writeFile(snapshotWriter * sw, int index)
+ * \brief Add the checksum to a buffer, write it to the temporary file, sync it and rename it over the snapshot
+ */
+static int writeFile(snapshotWriter * sw, int index) {
+    unsigned char * data = sw->buffer[index];
+    size_t length = sw->length[index];
+    int fd, result;
+
+    put32(data + length, fileCrc32(0, data, length));                          // here, not on the game thread
+    fd = open(sw->tempName, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+    result = fileWriteAll(fd, data, length + 4);
+    if ((result == 0) && (fdatasync(fd) != 0)) {                        // on disk before it replaces the old one
+        result = -1;
+    }
+    if ((close(fd) != 0) || (result != 0)) {
+        return -1;
+    }
+    return rename(sw->tempName, sw->fileName);
+}
+
+/*! \fn static void * writerMain(void * argument)
+ * \brief Writer thread: write every snapshot handed over until stopped
+ */
+static void * writerMain(void * argument) {
+    snapshotWriter * sw = argument;
+    long long start;
+    int index, result;
+
+    pthread_mutex_lock(&sw->lock);
+    while (!sw->stopping || (sw->ready >= 0)) {                         // the last snapshot is written before the end
+        if (sw->ready < 0) {
+            pthread_cond_wait(&sw->wake, &sw->lock);
+            continue;
+        }
+        index = sw->ready;
+        sw->ready = -1;
+        sw->writing = index;
+        pthread_mutex_unlock(&sw->lock);
+
+        start = statsNow();
+        result = writeFile(sw, index);
+
+        pthread_mutex_lock(&sw->lock);
+        sw->writing = -1;
+        sw->error = result != 0;
+        if (result == 0) {
+            sw->written++;
+            histogramRecord(&sw->writeNs, (unsigned long long) (statsNow() - start));
+        }
+    }
+    pthread_mutex_unlock(&sw->lock);
+    return NULL;
+}
+
+size_t snapshotSize(int width, int height) {
+    return SNAPSHOTHEADERSIZE + 4 * (size_t) width * (size_t) height + 4;  // every cell is a segment or a free cell
+} // snapshotSize function ends
+
+int snapshotStart(snapshotWriter * sw, const char * fileName, int width, int height) {
+    /*! \var size_t nameSize
+     *  \brief Bytes of the temporary file name
+     */
+    size_t nameSize = strlen(fileName) + 5;
+
+    memset(sw, 0, sizeof(*sw));
+    sw->ready = -1;
+    sw->writing = -1;
+    histogramReset(&sw->writeNs);
+    if (arenaInit(&sw->memory, 2 * ARENABLOCK(snapshotSize(width, height)) + 2 * ARENABLOCK(nameSize)) != 0) {
+        return -1;
+    }
+    sw->buffer[0] = arenaAlloc(&sw->memory, snapshotSize(width, height));
+    sw->buffer[1] = arenaAlloc(&sw->memory, snapshotSize(width, height));
+    sw->fileName = arenaAlloc(&sw->memory, nameSize);
+    sw->tempName = arenaAlloc(&sw->memory, nameSize);
+    memcpy(sw->fileName, fileName, nameSize - 4);
+    snprintf(sw->tempName, nameSize, "%s.tmp", fileName);
+    pthread_mutex_init(&sw->lock, NULL);
+    pthread_cond_init(&sw->wake, NULL);
+    if (pthread_create(&sw->thread, NULL, writerMain, sw) != 0) {
+        pthread_cond_destroy(&sw->wake);
+        pthread_mutex_destroy(&sw->lock);
+        arenaFree(&sw->memory);
+        return -1;
+    }
+    return 0;
+} // snapshotStart function ends
+
+int snapshotSave(snapshotWriter * sw, const gameState * game) {
+    /*! \var int index
+     *  \brief Buffer the game is encoded into, the one the thread is not writing
+     */
+    int index;
+
+    if (!game->running) {
+        return -1;
+    }
+    pthread_mutex_lock(&sw->lock);
+    index = sw->writing >= 0 ? 1 - sw->writing : (sw->ready >= 0 ? sw->ready : 0);
+    if (sw->ready >= 0) {                                               // the waiting one is always this buffer, take it back
+        sw->ready = -1;
+        sw->replaced++;
+    }
+    pthread_mutex_unlock(&sw->lock);
+
+    sw->length[index] = encode(game, sw->buffer[index]);               // the thread does not touch this buffer now
+
+    pthread_mutex_lock(&sw->lock);
+    sw->ready = index;
+    sw->saved++;
+    pthread_cond_signal(&sw->wake);
+    pthread_mutex_unlock(&sw->lock);
+    return 0;
+} // snapshotSave function ends
+
+void snapshotStop(snapshotWriter * sw, int discard) {
+    pthread_mutex_lock(&sw->lock);
+    if (discard) {
+        sw->ready = -1;
+    }
+    sw->stopping = 1;
+    pthread_cond_signal(&sw->wake);
+    pthread_mutex_unlock(&sw->lock);
+    pthread_join(sw->thread, NULL);
+    if (discard) {                                                      // the game is over, nothing to continue
+        (void) unlink(sw->fileName);
+        (void) unlink(sw->tempName);
+    }
+    pthread_cond_destroy(&sw->wake);
+    pthread_mutex_destroy(&sw->lock);
+    arenaFree(&sw->memory);
+} // snapshotStop function ends
+
+int snapshotLoad(snapshotData * sd, const char * fileName) {
+    /*! \var int fd
+     *  \brief File descriptor of the snapshot file
+     */
+    int fd;
+    /*! \var struct stat info
+     *  \brief Size of the snapshot file
+     */
+    struct stat info;
+    /*! \var void * data
+     *  \brief Mapped file
+     */
+    void * data;
+    /*! \var const unsigned char * bytes
+     *  \brief Content of the file
+     */
+    const unsigned char * bytes;
+    /*! \var unsigned long long cells
+     *  \brief Number of cells of the board
+     */
+    unsigned long long cells;
+
+    sd->data = NULL;
+    sd->size = 0;
+    fd = open(fileName, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    if ((fstat(fd, &info) != 0) || (info.st_size < SNAPSHOTHEADERSIZE + 4)) {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    data = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);                                                          // the mapping stays valid
+    if (data == MAP_FAILED) {
+        return -1;
+    }
+    bytes = data;
+    cells = (unsigned long long) get32(bytes + 60) + get32(bytes + 68);
+    if ((memcmp(bytes, "SNKS", 4) != 0) || (bytes[4] != SNAPSHOTVERSION)
+        || ((unsigned long long) info.st_size != SNAPSHOTHEADERSIZE + 4 * cells + 4)
+        || (fileCrc32(0, bytes, (size_t) info.st_size - 4) != get32(bytes + info.st_size - 4))
+        || (get32(bytes + 8) < MINBOARDSIZE) || (get32(bytes + 8) > MAXBOARDSIZE)      // the board is allocated from these
+        || (get32(bytes + 12) < MINBOARDSIZE) || (get32(bytes + 12) > MAXBOARDSIZE)
+        || ((unsigned long long) get32(bytes + 8) * get32(bytes + 12) != cells)) {
+        munmap(data, (size_t) info.st_size);
+        errno = EINVAL;
+        return -1;
+    }
+    sd->data = bytes;
+    sd->size = (size_t) info.st_size;
+    return 0;
+} // snapshotLoad function ends
+
+void snapshotHeader(const snapshotData * sd, snapshotInfo * info) {
+    info->width = (int) get32(sd->data + 8);
+    info->height = (int) get32(sd->data + 12);
+    info->ticks = (unsigned long) ((unsigned long long) get32(sd->data + 16) | ((unsigned long long) get32(sd->data + 20) << 32));
+    info->score = (int) get32(sd->data + 40);
+    info->length = get32(sd->data + 60);
+} // snapshotHeader function ends
+
+int snapshotRestore(const snapshotData * sd, gameState * game) {
+    /*! \var snapshotInfo info
+     *  \brief Header of the snapshot
+     */
+    snapshotInfo info;
+    /*! \var snake * sn
+     *  \brief The snake of the game
+     */
+    snake * sn = &game->player;
+    /*! \var freeCells * fc
+     *  \brief The free cell index of the game
+     */
+    freeCells * fc = &game->freeIndex;
+    /*! \var const unsigned char * position
+     *  \brief Read position in the body and free cell lists
+     */
+    const unsigned char * position = sd->data + SNAPSHOTHEADERSIZE;
+    /*! \var size_t cells, length, supposed, count, i
+     *  \brief Cells of the board, snake lengths, number of free cells, loop index
+     */
+    size_t cells, length, supposed, count, i;
+    /*! \var int x, y, cell, r
+     *  \brief Coordinates of a segment, number of a free cell, loop index
+     */
+    int x, y, cell, r;
+
+    snapshotHeader(sd, &info);
+    cells = (size_t) game->occupied.width * (size_t) game->occupied.height;
+    length = get32(sd->data + 60);
+    supposed = get32(sd->data + 64);
+    count = get32(sd->data + 68);
+    if ((info.width != game->occupied.width) || (info.height != game->occupied.height) || (length < 1) || (supposed < length)
+        || (supposed > cells) || (length + count != cells) || (strchr(DIRECTIONS, sd->data[56]) == NULL) || (sd->data[56] == '\0')
+        || (get32(sd->data + 52) > 1)) {
+        return -1;
+    }
+
+    clearBitboard(&game->occupied);
+    for (i = 0; i < length; i++) {                                      // the ring starts at 0 again, the order is the same
+        x = (int) get16(position);
+        y = (int) get16(position + 2);
+        position += 4;
+        if ((x >= game->occupied.width) || (y >= game->occupied.height) || bitTest(&game->occupied, x, y)) {
+            return -1;                                                  // off the board or a segment twice
+        }
+        bitAssign(&game->occupied, x, y, 1);
+        sn->position[i].x = x;
+        sn->position[i].y = y;
+    }
+    sn->tail = 0;
+    sn->head = length - 1;
+    sn->snakeCurrentLength = length;
+    sn->snakeSupposedLength = supposed;
+    sn->runningDirection = sd->data[56];
+
+    memset(fc->slot, 0xFF, cells * sizeof(int));                        // -1: not free
+    for (i = 0; i < count; i++) {
+        cell = (int) get32(position);
+        position += 4;
+        if ((cell < 0) || ((size_t) cell >= cells) || (fc->slot[cell] >= 0)
+            || bitTest(&game->occupied, cell % game->occupied.width, cell / game->occupied.width)) {
+            return -1;                                                  // off the board, listed twice or under the snake
+        }
+        fc->cells[i] = cell;
+        fc->slot[cell] = (int) i;
+    }
+    fc->count = count;
+
+    game->appleCount = (int) get32(sd->data + 52);
+    game->apple.x = (int) get32(sd->data + 44);
+    game->apple.y = (int) get32(sd->data + 48);
+    if ((game->appleCount != 0) && (((unsigned) game->apple.x >= (unsigned) game->occupied.width)
+                                    || ((unsigned) game->apple.y >= (unsigned) game->occupied.height)
+                                    || bitTest(&game->occupied, game->apple.x, game->apple.y))) {
+        return -1;
+    }
+    for (r = 0; r < 4; r++) {
+        game->rng.s[r] = get32(sd->data + 24 + 4 * r);
+    }
+    game->score = info.score;
+    game->ticks = info.ticks;
+    game->running = 1;
+    game->dirty.count = 0;
+    return 0;
+} // snapshotRestore function ends
+
+void snapshotUnload(snapshotData * sd) {
+    if (sd->data != NULL) {
+        munmap((void *) sd->data, sd->size);
+    }
+    sd->data = NULL;
+    sd->size = 0;
+} // snapshotUnload function ends
+
+// End of snapshot.c
@@ -0,0 +1,192 @@
+/*! \file snapshot.h
+ * \brief Game snapshot header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Saves the complete state of a running game, so a restarted process
+ * continues it exactly where it was: the same apples come, because the
+ * random number generator and the order of the free cell index are part
+ * of the snapshot. The game thread only encodes the state into one of two
+ * buffers; a background thread writes it to a temporary file, syncs it
+ * and renames it over the snapshot, so the file always holds a complete
+ * snapshot and the tick never waits for the disk. Restoring maps the file,
+ * checks it and copies the state into a game.
+ *
+ * File layout, all numbers little endian:
+ *   header  "SNKS", version, 0, 0, 0, width (4 bytes), height (4 bytes), ticks (8 bytes),
+ *           random number state (4 x 4 bytes), score (4 bytes), apple x, y and count (3 x 4 bytes),
+ *           running direction (1 byte), 0, 0, 0, snake length and supposed length (2 x 4 bytes),
+ *           number of free cells (4 bytes)
+ *   body    x and y (2 + 2 bytes) of every segment from the tail to the head
+ *   free    cell number (4 bytes) of every free cell, in the order of the free cell index
+ *   end     CRC32 (4 bytes) of everything before
+ */
+
+#ifndef SNAKEGAME_SNAPSHOT_H
+#define SNAKEGAME_SNAPSHOT_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "engine.h"
+#include "memarena.h"
+#include "stats.h"
+
+/*! \def SNAPSHOTVERSION
+ *  \brief Format version written into the header
+ */
+#define SNAPSHOTVERSION 1
+
+/*! \def SNAPSHOTHEADERSIZE
+ *  \brief Bytes of the file header
+ */
+#define SNAPSHOTHEADERSIZE 72
+
+/*! \typedef struct snapshotWriter
+ *  \brief Contains the two snapshot buffers and the thread writing them
+ *
+ * \var memArena memory Memory of the buffers and the file names
+ * \var char * fileName, * tempName Snapshot file and the file written before the rename
+ * \var unsigned char * buffer[2] Encoded snapshots
+ * \var size_t length[2] Bytes in each buffer
+ * \var int ready Buffer waiting for the thread, -1 if none
+ * \var int writing Buffer being written by the thread, -1 if none
+ * \var int stopping Set to end the thread
+ * \var int error True after a failed write, the next snapshot tries again
+ * \var unsigned long saved, written, replaced Snapshots encoded, written to disk, replaced by a newer one before they were written
+ * \var histogram writeNs Time of writing, syncing and renaming one file
+ * \var pthread_t thread The writer thread
+ * \var pthread_mutex_t lock Guards ready, writing, stopping and the counters
+ * \var pthread_cond_t wake Signals a ready buffer or stopping to the thread
+ */
+typedef struct snapshotWriter_t {
+    memArena memory;
+    char * fileName;
+    char * tempName;
+    unsigned char * buffer[2];
+    size_t length[2];
+    int ready;
+    int writing;
+    int stopping;
+    int error;
+    unsigned long saved;
+    unsigned long written;
+    unsigned long replaced;
+    histogram writeNs;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+} snapshotWriter;
+
+/*! \typedef struct snapshotData
+ *  \brief Contains a snapshot file mapped into memory
+ *
+ * \var const unsigned char * data Content of the file
+ * \var size_t size Size of the file
+ */
+typedef struct snapshotData_t {
+    const unsigned char * data;
+    size_t size;
+} snapshotData;
+
+/*! \typedef struct snapshotInfo
+ *  \brief Summary of a snapshot from its header
+ *
+ * \var int width, height Board size of the game
+ * \var unsigned long ticks Number of steps made
+ * \var int score Score of the game
+ * \var size_t length Snake length
+ */
+typedef struct snapshotInfo_t {
+    int width;
+    int height;
+    unsigned long ticks;
+    int score;
+    size_t length;
+} snapshotInfo;
+
+/*! \fn size_t snapshotSize(int width, int height)
+ * \brief Largest snapshot of a board
+ *
+ * \param width Number of columns
+ * \param height Number of rows
+ * \return size_t Number of bytes
+ */
+size_t snapshotSize(int width, int height);
+
+/*! \fn int snapshotStart(snapshotWriter * sw, const char * fileName, int width, int height)
+ * \brief Allocate the buffers and start the writer thread
+ *
+ * \param sw Pointer to writer
+ * \param fileName Snapshot file, replaced by every write
+ * \param width Number of columns
+ * \param height Number of rows
+ * \return int 0 on success, -1 on memory or thread creation error
+ */
+int snapshotStart(snapshotWriter * sw, const char * fileName, int width, int height);
+
+/*! \fn int snapshotSave(snapshotWriter * sw, const gameState * game)
+ * \brief Encode the game into the free buffer and hand it to the writer thread
+ *
+ * Never waits for the disk: if the thread is still writing the other buffer,
+ * a snapshot waiting in this one is replaced by the newer one
+ *
+ * \param sw Pointer to writer
+ * \param game A running game of the board size given to snapshotStart
+ * \return int 0 on success, -1 if the game is over
+ */
+int snapshotSave(snapshotWriter * sw, const gameState * game);
+
+/*! \fn void snapshotStop(snapshotWriter * sw, int discard)
+ * \brief Write the waiting snapshot, stop the thread and release the buffers
+ *
+ * \param sw Pointer to writer
+ * \param discard True if the game is over: the waiting snapshot is dropped and the file removed
+ * \return void No values returned
+ */
+void snapshotStop(snapshotWriter * sw, int discard);
+
+/*! \fn int snapshotLoad(snapshotData * sd, const char * fileName)
+ * \brief Map a snapshot file into memory and check its version, size, checksum and board size
+ *
+ * The board size is between MINBOARDSIZE and MAXBOARDSIZE and its cells are the body and free cells,
+ * so it can be given to gameInit before snapshotRestore checks the rest
+ *
+ * \param sd Pointer to snapshot data
+ * \param fileName Name of the snapshot file
+ * \return int 0 on success, -1 on error (errno EINVAL if the file is not a valid snapshot)
+ */
+int snapshotLoad(snapshotData * sd, const char * fileName);
+
+/*! \fn void snapshotHeader(const snapshotData * sd, snapshotInfo * info)
+ * \brief Read the board size and the summary of a loaded snapshot
+ *
+ * \param sd Pointer to snapshot data, loaded by snapshotLoad
+ * \param info Summary of the snapshot
+ * \return void No values returned
+ */
+void snapshotHeader(const snapshotData * sd, snapshotInfo * info);
+
+/*! \fn int snapshotRestore(const snapshotData * sd, gameState * game)
+ * \brief Put the saved state into a game
+ *
+ * The game must be set up by gameInit with the board size of the snapshot, its stats pointer is kept
+ *
+ * \param sd Pointer to snapshot data, loaded by snapshotLoad
+ * \param game Pointer to game
+ * \return int 0 on success, -1 if the board size differs or the saved state is inconsistent, the game must then be reset
+ */
+int snapshotRestore(const snapshotData * sd, gameState * game);
+
+/*! \fn void snapshotUnload(snapshotData * sd)
+ * \brief Unmap a snapshot file
+ *
+ * \param sd Pointer to snapshot data
+ * \return void No values returned
+ */
+void snapshotUnload(snapshotData * sd);
+
+#endif //SNAKEGAME_SNAPSHOT_H
+
+// End of snapshot.h
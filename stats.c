@@ -0,0 +1,174 @@
+/*! \file stats.c
+ * \brief Hot path instrumentation
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "stats.h"
+
+#define HISTSUBBITS 4                                                   // log2 of HISTSUBBUCKETS
+#define HISTMAXVALUE ((1ULL << HISTMAXBITS) - 1)
+
+/*! \var static const char * const statNames[STATCOUNT]
+ *  \brief Names of the histograms in the JSON dump
+ */
+static const char * const statNames[STATCOUNT] = {
+    "input", "updateSnake", "collision", "placeApple", "updateBoard", "drawScreen", "tick", "frameBytes", "tickLateness"
+};
+
+/*! \fn static int bucketIndex(unsigned long long value)
+ * \brief Bucket of a value: below 32 one bucket per value, above 16 buckets per power of two
+ */
+static int bucketIndex(unsigned long long value) {
+    int shift = (63 - __builtin_clzll(value | 1)) - HISTSUBBITS;       // position of the top bit above the sub-bucket bits
+
+    if (shift < 0) {
+        shift = 0;
+    }
+    return (shift << HISTSUBBITS) + (int) (value >> shift);
+}
+
+/*! \fn static unsigned long long bucketHighest(int index)
+ * \brief Largest value counted in a bucket
+ */
+static unsigned long long bucketHighest(int index) {
+    int shift = (index >> HISTSUBBITS) - 1;
+
+    if (shift <= 0) {
+        return (unsigned long long) index;
+    }
+    return ((unsigned long long) (index - (shift << HISTSUBBITS) + 1) << shift) - 1;
+}
+
+void histogramReset(histogram * h) {
+    memset(h, 0, sizeof(*h));
+} // histogramReset function ends
+
+void histogramRecord(histogram * h, unsigned long long value) {
+    if (value > HISTMAXVALUE) {
+        value = HISTMAXVALUE;
+    }
+    if ((h->count == 0) || (value < h->min)) {
+        h->min = value;
+    }
+    if (value > h->max) {
+        h->max = value;
+    }
+    h->count++;
+    h->sum += value;
+    h->buckets[bucketIndex(value)]++;
+} // histogramRecord function ends
+
+unsigned long long histogramPercentile(const histogram * h, double percentile) {
+    /*! \var unsigned long long target, seen
+     *  \brief Rank of the value looked for, values counted so far
+     */
+    unsigned long long target, seen = 0;
+    /*! \var int i
+     *  \brief Loop index variable
+     */
+    int i;
+
+    if (h->count == 0) {
+        return 0;
+    }
+    target = (unsigned long long) (percentile / 100.0 * (double) h->count + 0.5);
+    if (target == 0) {
+        return h->min;
+    }
+    for (i = 0; i < HISTBUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= target) {
+            return bucketHighest(i) < h->max ? bucketHighest(i) : h->max;
+        }
+    }
+    return h->max;
+} // histogramPercentile function ends
+
+void statsInit(tickStats * stats, int enabled) {
+    /*! \var int i
+     *  \brief Loop index variable
+     */
+    int i;
+
+    stats->enabled = enabled;
+    stats->tickNs = 0;
+    stats->markNs = 0;
+    stats->missedTicks = 0;
+    for (i = 0; i < STATCOUNT; i++) {
+        histogramReset(&stats->phase[i]);
+    }
+} // statsInit function ends
+
+size_t statsFormat(const tickStats * stats, char * line, size_t size) {
+    /*! \var int length
+     *  \brief Length of the text
+     */
+    int length;
+
+    length = snprintf(line, size, "p99 us: in %.1f move %.1f hit %.1f apple %.1f board %.1f draw %.1f tick %.1f | frame %llu B | late %.0f us, %lu missed",
+                      histogramPercentile(&stats->phase[STATINPUT], 99) / 1e3,
+                      histogramPercentile(&stats->phase[STATSNAKE], 99) / 1e3,
+                      histogramPercentile(&stats->phase[STATCOLLISION], 99) / 1e3,
+                      histogramPercentile(&stats->phase[STATAPPLE], 99) / 1e3,
+                      histogramPercentile(&stats->phase[STATBOARD], 99) / 1e3,
+                      histogramPercentile(&stats->phase[STATDRAW], 99) / 1e3,
+                      histogramPercentile(&stats->phase[STATTICK], 99) / 1e3,
+                      histogramPercentile(&stats->phase[STATBYTES], 99),
+                      histogramPercentile(&stats->phase[STATLATE], 99) / 1e3,
+                      stats->missedTicks);
+    if (length < 0) {
+        return 0;
+    }
+    return (size_t) length < size ? (size_t) length : size - 1;
+} // statsFormat function ends
+
+/*! \fn static void writeHistogram(FILE * out, const char * name, const char * unit, const histogram * h, int last)
+ * \brief Write one histogram as a JSON member
+ */
+static void writeHistogram(FILE * out, const char * name, const char * unit, const histogram * h, int last) {
+    int i, first = 1;
+
+    fprintf(out, "    \"%s\": {\"unit\": \"%s\", \"count\": %llu, \"min\": %llu, \"mean\": %.1f, "
+            "\"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"p999\": %llu, \"max\": %llu,\n      \"buckets\": [",
+            name, unit, h->count, h->min, h->count > 0 ? (double) h->sum / (double) h->count : 0.0,
+            histogramPercentile(h, 50), histogramPercentile(h, 90), histogramPercentile(h, 99), histogramPercentile(h, 99.9), h->max);
+    for (i = 0; i < HISTBUCKETS; i++) {                                 // [highest value of bucket, count], empty ones left out
+        if (h->buckets[i] != 0) {
+            fprintf(out, "%s[%llu, %u]", first ? "" : ", ", bucketHighest(i), (unsigned) h->buckets[i]);
+            first = 0;
+        }
+    }
+    fprintf(out, "]}%s\n", last ? "" : ",");
+}
+
+int statsWriteJson(const tickStats * stats, const char * fileName) {
+    /*! \var FILE * out
+     *  \brief The output file
+     */
+    FILE * out;
+    /*! \var int i
+     *  \brief Loop index variable
+     */
+    int i;
+
+    out = fopen(fileName, "w");
+    if (out == NULL) {
+        return -1;
+    }
+    fprintf(out, "{\n  \"missedTicks\": %lu,\n  \"histograms\": {\n", stats->missedTicks);
+    for (i = 0; i < STATCOUNT; i++) {
+        writeHistogram(out, statNames[i], i == STATBYTES ? "bytes" : "ns", &stats->phase[i], i == STATCOUNT - 1);
+    }
+    fprintf(out, "  }\n}\n");
+    if (ferror(out)) {
+        fclose(out);
+        return -1;
+    }
+    return fclose(out) == 0 ? 0 : -1;
+} // statsWriteJson function ends
+
+// End of stats.c
@@ -0,0 +1,225 @@
+/*! \file stats.h
+ * \brief Hot path instrumentation header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Per tick timings of the game phases, frame sizes and tick lateness are
+ * counted in HDR-style histograms: log-linear buckets with 16 sub-buckets
+ * per power of two, so any value up to 2^40 is kept with 1/16 relative
+ * precision in a fixed table and recording is a few instructions.
+ * The probes are always compiled in; they are inline and only compare
+ * the enabled flag while the instrumentation is switched off.
+ */
+
+#ifndef SNAKEGAME_STATS_H
+#define SNAKEGAME_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/*! \def HISTSUBBUCKETS
+ *  \brief Number of sub-buckets per power of two, values below 2 * HISTSUBBUCKETS are exact
+ */
+#define HISTSUBBUCKETS 16
+
+/*! \def HISTMAXBITS
+ *  \brief Values are clamped below 2^HISTMAXBITS (about 18 minutes in nanoseconds)
+ */
+#define HISTMAXBITS 40
+
+/*! \def HISTBUCKETS
+ *  \brief Number of buckets of a histogram
+ */
+#define HISTBUCKETS ((HISTMAXBITS - 3) * HISTSUBBUCKETS)
+
+/*! \def STATINPUT
+ *  \brief Phase: taking the keys of the tick from the input queue
+ */
+#define STATINPUT 0
+/*! \def STATSNAKE
+ *  \brief Phase: updateSnake, turn and move the snake
+ */
+#define STATSNAKE 1
+/*! \def STATCOLLISION
+ *  \brief Phase: wall, self and apple collision
+ */
+#define STATCOLLISION 2
+/*! \def STATAPPLE
+ *  \brief Phase: free cell index update and placeApple
+ */
+#define STATAPPLE 3
+/*! \def STATBOARD
+ *  \brief Phase: updateBoard, changed cells applied to the board
+ */
+#define STATBOARD 4
+/*! \def STATDRAW
+ *  \brief Phase: drawScreen, frame built and written
+ */
+#define STATDRAW 5
+/*! \def STATTICK
+ *  \brief Whole tick, input to frame written
+ */
+#define STATTICK 6
+/*! \def STATBYTES
+ *  \brief Bytes written for a frame
+ */
+#define STATBYTES 7
+/*! \def STATLATE
+ *  \brief Lateness of the tick compared to its deadline
+ */
+#define STATLATE 8
+/*! \def STATCOUNT
+ *  \brief Number of histograms
+ */
+#define STATCOUNT 9
+
+/*! \typedef struct histogram
+ *  \brief Contains the distribution of one measured value
+ *
+ * \var unsigned long long count Number of values recorded
+ * \var unsigned long long sum Sum of the values
+ * \var unsigned long long min, max Smallest and largest value, exact
+ * \var uint32_t buckets[HISTBUCKETS] Number of values per bucket
+ */
+typedef struct histogram_t {
+    unsigned long long count;
+    unsigned long long sum;
+    unsigned long long min;
+    unsigned long long max;
+    uint32_t buckets[HISTBUCKETS];
+} histogram;
+
+/*! \typedef struct tickStats
+ *  \brief Contains the instrumentation of the game loop
+ *
+ * \var int enabled The probes record only when set
+ * \var long long tickNs Time the current tick started
+ * \var long long markNs Time of the last probe, the next phase is measured from here
+ * \var unsigned long missedTicks Number of tick deadlines missed entirely
+ * \var histogram phase[STATCOUNT] One histogram per STAT* value
+ */
+typedef struct tickStats_t {
+    int enabled;
+    long long tickNs;
+    long long markNs;
+    unsigned long missedTicks;
+    histogram phase[STATCOUNT];
+} tickStats;
+
+/*! \fn void histogramReset(histogram * h)
+ * \brief Empty a histogram
+ *
+ * \param h Pointer to histogram
+ * \return void No values returned
+ */
+void histogramReset(histogram * h);
+
+/*! \fn void histogramRecord(histogram * h, unsigned long long value)
+ * \brief Count one value
+ *
+ * \param h Pointer to histogram
+ * \param value The value, clamped below 2^HISTMAXBITS
+ * \return void No values returned
+ */
+void histogramRecord(histogram * h, unsigned long long value);
+
+/*! \fn unsigned long long histogramPercentile(const histogram * h, double percentile)
+ * \brief Value below or at which the given percent of the recorded values are
+ *
+ * The result is the highest value of the bucket the percentile falls in, never above max
+ *
+ * \param h Pointer to histogram
+ * \param percentile 0..100
+ * \return unsigned long long The value, 0 if the histogram is empty
+ */
+unsigned long long histogramPercentile(const histogram * h, double percentile);
+
+/*! \fn void statsInit(tickStats * stats, int enabled)
+ * \brief Empty all histograms
+ *
+ * \param stats Pointer to instrumentation
+ * \param enabled Initial value of the enabled flag
+ * \return void No values returned
+ */
+void statsInit(tickStats * stats, int enabled);
+
+/*! \fn static inline long long statsNow(void)
+ * \brief Current time of the monotonic clock in nanoseconds
+ */
+static inline long long statsNow(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long) now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/*! \fn static inline int statsOn(const tickStats * stats)
+ * \brief True when the probes record, stats may be NULL
+ */
+static inline int statsOn(const tickStats * stats) {
+    return (stats != NULL) && stats->enabled;
+}
+
+/*! \fn static inline void statsBegin(tickStats * stats)
+ * \brief Probe at the start of a tick, the first phase is measured from here
+ */
+static inline void statsBegin(tickStats * stats) {
+    if (statsOn(stats)) {
+        stats->tickNs = stats->markNs = statsNow();
+    }
+}
+
+/*! \fn static inline void statsLap(tickStats * stats, int phase)
+ * \brief Probe at the end of a phase: count the time since the previous probe
+ */
+static inline void statsLap(tickStats * stats, int phase) {
+    long long now;
+
+    if (statsOn(stats)) {
+        now = statsNow();
+        histogramRecord(&stats->phase[phase], (unsigned long long) (now - stats->markNs));
+        stats->markNs = now;
+    }
+}
+
+/*! \fn static inline void statsEnd(tickStats * stats)
+ * \brief Probe at the end of a tick: count the time since statsBegin
+ */
+static inline void statsEnd(tickStats * stats) {
+    if (statsOn(stats)) {
+        histogramRecord(&stats->phase[STATTICK], (unsigned long long) (statsNow() - stats->tickNs));
+    }
+}
+
+/*! \fn static inline void statsRecord(tickStats * stats, int phase, long long value)
+ * \brief Count a value that is not a time measured by the probes, negative values as 0
+ */
+static inline void statsRecord(tickStats * stats, int phase, long long value) {
+    if (statsOn(stats)) {
+        histogramRecord(&stats->phase[phase], value > 0 ? (unsigned long long) value : 0);
+    }
+}
+
+/*! \fn size_t statsFormat(const tickStats * stats, char * line, size_t size)
+ * \brief Format the heads-up display line: 99th percentile of every histogram
+ *
+ * \param stats Pointer to instrumentation
+ * \param line Receives the text
+ * \param size Size of line
+ * \return size_t Length of the text
+ */
+size_t statsFormat(const tickStats * stats, char * line, size_t size);
+
+/*! \fn int statsWriteJson(const tickStats * stats, const char * fileName)
+ * \brief Dump every histogram as JSON: summary, percentiles and the non-empty buckets
+ *
+ * \param stats Pointer to instrumentation
+ * \param fileName Name of the output file
+ * \return int 0 on success, -1 on error
+ */
+int statsWriteJson(const tickStats * stats, const char * fileName);
+
+#endif //SNAKEGAME_STATS_H
+
+// End of stats.h
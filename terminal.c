@@ -0,0 +1,119 @@
+/*! \file terminal.c
+ * \brief Terminal input and output functions
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Written by Zoltan Gere
+ * 1706228
+ * 02.10.2018
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "terminal.h"
+
+#define WALLCHAR 'H'
+
+unsigned char readInput()
+{
+    /*! \var unsigned char c[3]
+     *  \brief Character sequence read from input
+     */
+    unsigned char c[3];
+    /*! \var unsigned char upKey[3]
+     *  \brief Predefined character sequence for up arrow key
+     */
+    unsigned char upKey[3] = {27,91,65};
+    /*! \var unsigned char downKey[3]
+     *  \brief Predefined character sequence for down arrow key
+     */
+    unsigned char downKey[3] = {27,91,66};
+    /*! \var unsigned char leftKey[3]
+     *  \brief Predefined character sequence for left arrow key
+     */
+    unsigned char leftKey[3] = {27,91,68};
+    /*! \var unsigned char rightKey[3]
+     *  \brief Predefined character sequence for right arrow key
+     */
+    unsigned char rightKey[3] = {27,91,67};
+    /*! \var unsigned char escKey[3]
+     *  \brief Predefined character sequence for escape key
+     */
+    unsigned char escKey[3] = {27,0,0};
+    /*! \var unsigned char spaceKey[3]
+     *  \brief Predefined character sequence for space key
+     */
+    unsigned char spaceKey[3] = {32,0,0};
+    /*! \var unsigned char input
+     *  \brief 1 char corresponding value for pressed key
+     *          l - left arrow, r - right arrow, u - up arrow, d - down arrow, 32 - space key, 27 - escape key
+     */
+    unsigned char input = '\0';
+
+    // Read user input
+    memset(c, 0, sizeof(c));                    // Clear buffer
+
+    if (read(0, &c, 3) != 0) {                  // Read input (0 = stdin, 3 char)
+        //printf("You pressed: ");
+        if (memcmp(c, upKey, 3) == 0) {         // Input sequence equals to stored up arrow sequence
+            //printf("up\n");
+            input = 'u';
+        } else if (memcmp(c, downKey, 3) == 0) {    // Input sequence equals to stored down arrow sequence
+            //printf("down\n");
+            input = 'd';
+        } else if (memcmp(c, leftKey, 3) == 0) {    // Input sequence equals to stored left arrow sequence
+            //printf("left\n");
+            input = 'l';
+        } else if (memcmp(c, rightKey, 3) == 0) {   // Input sequence equals to stored right arrow sequence
+            //printf("right\n");
+            input = 'r';
+        } else if (memcmp(c, escKey, 3) == 0) {     // Input sequence equals to stored escape key sequence
+            input = c[0];
+        } else if (memcmp(c, spaceKey, 3) == 0) {   // Input sequence equals to stored space bar key sequence
+            input = c[0];
+        }
+    }
+    return input;
+} // readInput function ends
+
+void drawScreen(board * gameBoard, int score, int rowNumber) {
+    /*! \var int i, j
+     *  \brief Loop index variables
+     */
+    int i,j;
+    char wall = WALLCHAR;
+
+    // draw board on the screen
+    printf ("Snake game\n                                    Your score: %d\n", score);     // Title line + player score
+    for (j = 0; j < gameBoard->width + 2; j++) {                                            // Top edge of board
+        printf ("%c", wall);
+    }
+    printf("\n");
+
+    for (i = 0; i< gameBoard->height; i++) {                                                // Game board
+        printf ("%c", wall);                                                                       // Left edge of board
+
+
+        for (j = 0; j < gameBoard->width; j++) {                                            // Game board
+            printf ("%c", BOARDCELL(gameBoard, j, i));
+        }
+
+
+        printf ("%c\n", wall);                                                                     // Right edge of board
+    }
+
+    for (j = 0; j < gameBoard->width + 2; j++) {                                            // Bottom edge of board
+        printf ("%c", wall);
+    }
+
+    printf ("\n\n    Use arrow keys to turn snake. Press ESC to quit game.\n");             // Print instructions
+
+    for (i = gameBoard->height + 8; i< rowNumber; i++) {                                        // Fill remaining space
+        printf("\n");                                                                       // so board is always
+    }                                                                                       // at the same position
+    //(void) fflush(stdout);
+} // drawScreen function ends
+
+// End of terminal.c
@@ -0,0 +1,45 @@
+/*! \file terminal.h
+ * \brief Terminal input and output functions header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Written by Zoltan Gere
+ * 1706228
+ * 02.10.2018
+ */
+
+#ifndef SNAKEGAME_TERMINAL_H
+#define SNAKEGAME_TERMINAL_H
+
+#include "snake.h"
+
+/*! \fn unsigned char readInput()
+ * \brief Reads keyboard input
+ *
+ * Reads character input sequence from input
+ * In raw mode keys generate many character long sequences
+ * Reading compared the predefined character sequences
+ *
+ * l - left arrow, r - right arrow, u - up arrow, d - down arrow, 32 - space key, 27 - escape key
+ *
+ * \return unsigned char Letter equivalent for input key l, r, u, d, 32, 27
+ */
+unsigned char readInput();
+
+/*! \fn void drawScreen(board * gameBoard, int score, int rowNumber)
+ * \brief Render the game screen on terminal window
+ *
+ * Render the game screen on terminal window
+ * Screen line feed writing adjusted to terminal size, therefore the board appears at the same position
+ *
+ * \param gameBoard The game board with snake and apple on it
+ * \param score Players current score
+ * \param Number of rows on terminal
+ * \return void No values returned
+ */
+void drawScreen(board * gameBoard, int score, int rowNumber);
+
+#endif //SNAKEGAME_TERMINAL_H
+
+// End of terminal.h
@@ -0,0 +1,118 @@
+/*! \file ticker.c
+ * \brief Game tick scheduler
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include "ticker.h"
+
+#define NSEC_PER_SEC 1000000000LL
+
+/*! \fn static long long monotonicNow(void)
+ * \brief Current time of the monotonic clock in nanoseconds
+ *
+ * \return long long Time in nanoseconds
+ */
+static long long monotonicNow(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long) now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+}
+
+int tickerOpen(ticker * tk, int ticksPerSecond) {
+    /*! \var struct itimerspec spec
+     *  \brief First deadline and period of the timer
+     */
+    struct itimerspec spec;
+
+    memset(tk, 0, sizeof(*tk));
+    tk->periodNs = (long) (NSEC_PER_SEC / ticksPerSecond);
+    tk->timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (tk->timerFd < 0) {
+        return -1;
+    }
+
+    tk->nextDeadlineNs = monotonicNow() + tk->periodNs;                 // first tick one period from now
+    spec.it_value.tv_sec = tk->nextDeadlineNs / NSEC_PER_SEC;           // absolute deadline, so the
+    spec.it_value.tv_nsec = tk->nextDeadlineNs % NSEC_PER_SEC;          // schedule does not drift
+    spec.it_interval.tv_sec = tk->periodNs / NSEC_PER_SEC;
+    spec.it_interval.tv_nsec = tk->periodNs % NSEC_PER_SEC;
+    if (timerfd_settime(tk->timerFd, TFD_TIMER_ABSTIME, &spec, NULL) != 0) {
+        close(tk->timerFd);
+        tk->timerFd = -1;
+        return -1;
+    }
+    return 0;
+} // tickerOpen function ends
+
+int tickerWait(ticker * tk, int inputFd) {
+    /*! \var struct pollfd fds[2]
+     *  \brief Polled descriptors, 0 - timer, 1 - input
+     */
+    struct pollfd fds[2];
+    /*! \var int events
+     *  \brief Collected event flags
+     */
+    int events = 0;
+
+    fds[0].fd = tk->timerFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = inputFd;                                                // negative fd is ignored by poll
+    fds[1].events = POLLIN;
+
+    while (poll(fds, 2, -1) < 0) {                                      // sleep until something happens
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+
+    if (fds[1].revents & POLLIN) {
+        events |= TICKER_INPUT;
+    } else if (fds[1].revents & (POLLHUP | POLLERR | POLLNVAL)) {       // input closed, stop polling it
+        events |= TICKER_HANGUP;
+    }
+
+    if ((fds[0].revents & POLLIN) && tickerExpired(tk)) {
+        events |= TICKER_TICK;
+    }
+    return events;
+} // tickerWait function ends
+
+int tickerExpired(ticker * tk) {
+    /*! \var uint64_t expirations
+     *  \brief Number of timer expirations since last read
+     */
+    uint64_t expirations;
+    long jitter;
+
+    if (read(tk->timerFd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+        return 0;
+    }
+    jitter = (long) (monotonicNow() - (tk->nextDeadlineNs + (long long) (expirations - 1) * tk->periodNs));
+    tk->lastJitterNs = jitter;                                          // lateness of the latest deadline
+    if (jitter > tk->maxJitterNs) {
+        tk->maxJitterNs = jitter;
+    }
+    tk->sumJitterNs += jitter;
+    tk->missedTicks += expirations - 1;                                 // more than 1 expiration: ticks were lost
+    tk->nextDeadlineNs += (long long) expirations * tk->periodNs;
+    tk->ticks++;
+    return 1;
+} // tickerExpired function ends
+
+void tickerClose(ticker * tk) {
+    if (tk->timerFd >= 0) {
+        close(tk->timerFd);
+        tk->timerFd = -1;
+    }
+} // tickerClose function ends
+
+// End of ticker.c
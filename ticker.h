@@ -0,0 +1,96 @@
+/*! \file ticker.h
+ * \brief Game tick scheduler header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * The scheduler blocks in poll() on the input and on a timerfd,
+ * so waiting for the next tick does not use any CPU time
+ */
+
+#ifndef SNAKEGAME_TICKER_H
+#define SNAKEGAME_TICKER_H
+
+/*! \def TICKER_INPUT
+ *  \brief Event flag: input is available for reading
+ */
+#define TICKER_INPUT 1
+/*! \def TICKER_TICK
+ *  \brief Event flag: the timer expired, a game tick is due
+ */
+#define TICKER_TICK 2
+/*! \def TICKER_HANGUP
+ *  \brief Event flag: the input was closed, it should not be polled any more
+ */
+#define TICKER_HANGUP 4
+
+/*! \typedef struct ticker
+ *  \brief Contains the state of the tick scheduler
+ *
+ * \var int timerFd Timer file descriptor (CLOCK_MONOTONIC)
+ * \var long periodNs Length of one tick in nanoseconds
+ * \var long long nextDeadlineNs Expected expiration time of the next tick
+ * \var long lastJitterNs Lateness of the last tick compared to its deadline
+ * \var long maxJitterNs Largest lateness seen so far
+ * \var long long sumJitterNs Sum of lateness of all ticks, for average calculation
+ * \var unsigned long ticks Number of ticks handled
+ * \var unsigned long missedTicks Number of ticks lost because the loop was late
+ */
+typedef struct ticker_t {
+    int timerFd;
+    long periodNs;
+    long long nextDeadlineNs;
+    long lastJitterNs;
+    long maxJitterNs;
+    long long sumJitterNs;
+    unsigned long ticks;
+    unsigned long missedTicks;
+} ticker;
+
+/*! \fn int tickerOpen(ticker * tk, int ticksPerSecond)
+ * \brief Start the periodic game timer
+ *
+ * Creates a timerfd on the monotonic clock and arms it with absolute deadlines,
+ * so the tick rate does not drift and does not depend on CPU usage
+ *
+ * \param tk Pointer to scheduler
+ * \param ticksPerSecond Number of game ticks per second
+ * \return int 0 on success, -1 on error
+ */
+int tickerOpen(ticker * tk, int ticksPerSecond);
+
+/*! \fn int tickerWait(ticker * tk, int inputFd)
+ * \brief Wait for the next input or tick event
+ *
+ * Blocks until input is available on inputFd or the timer expires
+ * When the timer expired, the jitter of the tick is calculated
+ * A negative inputFd is ignored, only the timer is waited for
+ *
+ * \param tk Pointer to scheduler
+ * \param inputFd File descriptor of the input
+ * \return int Combination of TICKER_INPUT, TICKER_TICK, TICKER_HANGUP flags, -1 on error
+ */
+int tickerWait(ticker * tk, int inputFd);
+
+/*! \fn int tickerExpired(ticker * tk)
+ * \brief Take the expirations of the timer and calculate the jitter of the tick
+ *
+ * For loops waiting on timerFd themselves, for example with epoll
+ * Blocks until the next deadline if the timer has not expired yet
+ *
+ * \param tk Pointer to scheduler
+ * \return int 1 if a tick is due, 0 on read error
+ */
+int tickerExpired(ticker * tk);
+
+/*! \fn void tickerClose(ticker * tk)
+ * \brief Stop the game timer
+ *
+ * \param tk Pointer to scheduler
+ * \return void No values returned
+ */
+void tickerClose(ticker * tk);
+
+#endif //SNAKEGAME_TICKER_H
+
+// End of ticker.h
@@ -0,0 +1,661 @@
+/*! \file tournament.c
+ * \brief Policy tournament
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "tournament.h"
+#include "autopilot.h"
+#include "memarena.h"
+#include "rng.h"
+#include "fileio.h"
+#include "stats.h"
+
+/*! \def FILEMAGIC
+ *  \brief First bytes of a results file, the last one is the format version
+ */
+#define FILEMAGIC "SNKTOUR2"
+
+/*! \def BLOCKMAGIC
+ *  \brief First word of a shard block
+ */
+#define BLOCKMAGIC 0x44524853u
+
+/*! \def COLUMNS
+ *  \brief Result columns of a block: scores, lengths, ticks, 32 bits each
+ */
+#define COLUMNS 3
+
+/*! \typedef struct fileHeader
+ *  \brief Start of the results file, the settings of the run
+ */
+typedef struct fileHeader_t {
+    char magic[8];
+    int32_t width;
+    int32_t height;
+    int64_t games;
+    uint64_t seed;
+    int64_t shardSize;
+    uint64_t maxTicks;
+    int32_t policyCount;
+    uint32_t checksum;
+    char names[TOURNAMENTMAXPOLICIES][TOURNAMENTNAMESIZE];
+} fileHeader;
+
+/*! \typedef struct blockHeader
+ *  \brief Start of the block of one shard, count scores, lengths and ticks follow
+ *
+ * The checksum covers the header, with the checksum field as zero, and the columns
+ */
+typedef struct blockHeader_t {
+    uint32_t magic;
+    int32_t policy;
+    int64_t shard;
+    int32_t count;
+    uint32_t checksum;
+} blockHeader;
+
+/*! \typedef struct player
+ *  \brief Per game state of the policies, one per worker
+ *
+ * \var autopilot pilot The autopilot, set up only if a policy of the run uses it
+ * \var rngState rng Random number generator of the random policy, seeded from the game seed
+ */
+typedef struct player_t {
+    autopilot pilot;
+    rngState rng;
+} player;
+
+/*! \typedef struct policyEntry
+ *  \brief One policy
+ *
+ * \var const char * name Name on the command line and in the results file
+ * \var unsigned char (*input)(player *, const gameState *) Input of the next step
+ * \var int piloted, replan True if the policy uses the autopilot, true to search every tick
+ */
+typedef struct policyEntry_t {
+    const char * name;
+    unsigned char (*input)(player * pl, const gameState * game);
+    int piloted;
+    int replan;
+} policyEntry;
+
+/*! \typedef struct worker
+ *  \brief Contains one worker thread
+ *
+ * \var tournament * tr The run
+ * \var pthread_t thread The thread
+ * \var long games, shards Games and shards finished
+ * \var unsigned long long ticks Game steps made
+ * \var long policyGames[TOURNAMENTMAXPOLICIES] Games of each policy
+ * \var long long policyNs[TOURNAMENTMAXPOLICIES] Time spent on each policy
+ * \var int failed Set if memory could not be allocated
+ */
+typedef struct worker_t {
+    tournament * tr;
+    pthread_t thread;
+    long games;
+    long shards;
+    unsigned long long ticks;
+    long policyGames[TOURNAMENTMAXPOLICIES];
+    long long policyNs[TOURNAMENTMAXPOLICIES];
+    int failed;
+} __attribute__((aligned(ARENAALIGN))) worker;
+
+/*! \fn static unsigned char randomInput(player * pl, const gameState * game)
+ * \brief No change or a turn, each half of the ticks
+ */
+static unsigned char randomInput(player * pl, const gameState * game) {
+    static const unsigned char turns[8] = { 'u', 'd', 'l', 'r', 0, 0, 0, 0 };
+
+    (void) game;
+    return turns[rngBounded(&pl->rng, 8)];
+}
+
+/*! \fn static unsigned char greedyInput(player * pl, const gameState * game)
+ * \brief The free neighbour closest to the apple, the running direction on a tie
+ */
+static unsigned char greedyInput(player * pl, const gameState * game) {
+    static const char directions[] = "udlr";
+    static const int dx[4] = { 0, 0, -1, 1 }, dy[4] = { -1, 1, 0, 0 };
+    const snake * sn = &game->player;
+    int x = sn->position[sn->head].x, y = sn->position[sn->head].y, k, distance, best = -1;
+    unsigned char choice = sn->runningDirection;
+
+    (void) pl;
+    for (k = 0; k < 4; k++) {
+        if (reverseDirection((unsigned char) directions[k], sn->runningDirection) || bitTest(&game->occupied, x + dx[k], y + dy[k])) {
+            continue;                                                   // walls and body, the tail cell too
+        }
+        distance = game->appleCount == 0 ? 0 : abs(game->apple.x - x - dx[k]) + abs(game->apple.y - y - dy[k]);
+        if ((best < 0) || (distance < best) || ((distance == best) && (directions[k] == sn->runningDirection))) {
+            best = distance;
+            choice = (unsigned char) directions[k];
+        }
+    }
+    return choice;
+}
+
+/*! \fn static unsigned char pilotInput(player * pl, const gameState * game)
+ * \brief The autopilot
+ */
+static unsigned char pilotInput(player * pl, const gameState * game) {
+    return autopilotInput(&pl->pilot, game);
+}
+
+/*! \var static const policyEntry policyTable[]
+ *  \brief Every policy, the policy number is the index
+ */
+static const policyEntry policyTable[] = {
+    { "random", randomInput, 0, 0 },
+    { "greedy", greedyInput, 0, 0 },
+    { "autopilot", pilotInput, 1, 0 },
+    { "replan", pilotInput, 1, 1 },
+};
+
+/*! \def POLICIES
+ *  \brief Number of policies
+ */
+#define POLICIES ((int) (sizeof(policyTable) / sizeof(policyTable[0])))
+
+int tournamentPolicyNumber(const char * name) {
+    /*! \var int p
+     *  \brief Policy number
+     */
+    int p;
+
+    for (p = 0; p < POLICIES; p++) {
+        if (strcmp(policyTable[p].name, name) == 0) {
+            return p;
+        }
+    }
+    return -1;
+} // tournamentPolicyNumber function ends
+
+const char * tournamentPolicyName(int policy) {
+    return (policy >= 0) && (policy < POLICIES) ? policyTable[policy].name : NULL;
+} // tournamentPolicyName function ends
+
+/*! \fn static int piloted(const tournamentConfig * config)
+ * \brief True if a policy of the run uses the autopilot
+ */
+static int piloted(const tournamentConfig * config) {
+    int i;
+
+    for (i = 0; i < config->policyCount; i++) {
+        if (policyTable[config->policies[i]].piloted) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*! \fn static long shardGames(const tournament * tr, long shard)
+ * \brief Number of games in a shard, the last one may be short
+ */
+static long shardGames(const tournament * tr, long shard) {
+    long first = shard * tr->config.shardSize;
+
+    return tr->config.games - first < tr->config.shardSize ? tr->config.games - first : tr->config.shardSize;
+}
+
+/*! \fn static void makeHeader(const tournamentConfig * config, fileHeader * header)
+ * \brief File header of a run
+ */
+static void makeHeader(const tournamentConfig * config, fileHeader * header) {
+    int i;
+
+    memset(header, 0, sizeof(*header));                                 // no stray bytes in the padding
+    memcpy(header->magic, FILEMAGIC, sizeof(header->magic));
+    header->width = config->width;
+    header->height = config->height;
+    header->games = config->games;
+    header->seed = config->seed;
+    header->shardSize = config->shardSize;
+    header->maxTicks = config->maxTicks;
+    header->policyCount = config->policyCount;
+    for (i = 0; i < config->policyCount; i++) {
+        strncpy(header->names[i], policyTable[config->policies[i]].name, TOURNAMENTNAMESIZE - 1);
+    }
+    header->checksum = fileCrc32(0, header, sizeof(*header));
+}
+
+/*! \fn static off_t nextBlock(const tournament * tr, off_t offset, off_t size, blockHeader * block, int32_t * columns)
+ * \brief Read and check the block at offset, return the offset after it, or -1 if there is no valid block
+ *
+ * columns has room for COLUMNS * shardSize values
+ */
+static off_t nextBlock(const tournament * tr, off_t offset, off_t size, blockHeader * block, int32_t * columns) {
+    blockHeader check;
+    size_t bytes;
+
+    if ((offset + (off_t) sizeof(*block) > size) || (fileReadAt(tr->fd, block, sizeof(*block), offset) != 0)
+        || (block->magic != BLOCKMAGIC) || (block->policy < 0) || (block->policy >= tr->config.policyCount)
+        || (block->shard < 0) || (block->shard >= tr->shards) || (block->count != shardGames(tr, (long) block->shard))) {
+        return -1;
+    }
+    bytes = (size_t) block->count * COLUMNS * sizeof(int32_t);
+    if ((offset + (off_t) (sizeof(*block) + bytes) > size) || (fileReadAt(tr->fd, columns, bytes, offset + (off_t) sizeof(*block)) != 0)) {
+        return -1;                                                      // torn by an interruption
+    }
+    check = *block;
+    check.checksum = 0;
+    if (fileCrc32(fileCrc32(0, &check, sizeof(check)), columns, bytes) != block->checksum) {
+        return -1;
+    }
+    return offset + (off_t) (sizeof(*block) + bytes);
+}
+
+int tournamentOpen(tournament * tr, const char * fileName, const tournamentConfig * config) {
+    /*! \var fileHeader header, stored
+     *  \brief Header of this run and header found in the file
+     */
+    fileHeader header, stored;
+    /*! \var blockHeader block
+     *  \brief Header of the block being checked
+     */
+    blockHeader block;
+    /*! \var int32_t * columns
+     *  \brief Columns of the block being checked
+     */
+    int32_t * columns;
+    /*! \var struct stat info
+     *  \brief Size of the file
+     */
+    struct stat info;
+    /*! \var off_t offset, end
+     *  \brief Position of the block being checked, end of the last valid block
+     */
+    off_t offset, end;
+    long shard;
+    int i;
+
+    memset(tr, 0, sizeof(*tr));
+    tr->fd = -1;
+    if ((config->width < MINBOARDSIZE) || (config->width > MAXBOARDSIZE) || (config->height < MINBOARDSIZE)
+        || (config->height > MAXBOARDSIZE) || (config->games < 1) || (config->policyCount < 1)
+        || (config->policyCount > TOURNAMENTMAXPOLICIES) || (config->shardSize < 1) || (config->maxTicks < 1)
+        || (config->maxTicks > UINT32_MAX) || (config->threads < 1) || (config->threads > TOURNAMENTMAXTHREADS)) {
+        errno = EINVAL;
+        return -1;
+    }
+    for (i = 0; i < config->policyCount; i++) {
+        if ((config->policies[i] < 0) || (config->policies[i] >= POLICIES)) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    if (piloted(config) && (config->width % 2 != 0) && (config->height % 2 != 0)) {
+        errno = EINVAL;                                                 // no cycle for the autopilot
+        return -1;
+    }
+    pthread_mutex_init(&tr->writeLock, NULL);
+    tr->config = *config;
+    tr->shards = (config->games + config->shardSize - 1) / config->shardSize;
+    tr->done = calloc((size_t) (tr->shards * config->policyCount), 1);
+    tr->pending = malloc((size_t) (tr->shards * config->policyCount) * sizeof(long));
+    columns = malloc((size_t) config->shardSize * COLUMNS * sizeof(int32_t));
+    if ((tr->done == NULL) || (tr->pending == NULL) || (columns == NULL)) {
+        free(columns);
+        tournamentClose(tr);
+        return -1;
+    }
+    tr->fd = open(fileName, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if ((tr->fd < 0) || (fstat(tr->fd, &info) != 0)) {
+        free(columns);
+        tournamentClose(tr);
+        return -1;
+    }
+
+    makeHeader(config, &header);
+    if ((info.st_size > 0) && (info.st_size < (off_t) sizeof(header))
+        && ((fileReadAt(tr->fd, &stored, (size_t) info.st_size, 0) != 0) || (memcmp(&stored, &header, (size_t) info.st_size) != 0))) {
+        free(columns);
+        tournamentClose(tr);
+        return -2;                                                      // not the start of this run, do not touch it
+    }
+    if (info.st_size < (off_t) sizeof(header)) {                        // new run, or torn in its own header
+        if ((ftruncate(tr->fd, 0) != 0) || (fileWriteAll(tr->fd, &header, sizeof(header)) != 0)) {
+            free(columns);
+            tournamentClose(tr);
+            return -1;
+        }
+    } else if ((fileReadAt(tr->fd, &stored, sizeof(stored), 0) != 0) || (memcmp(&stored, &header, sizeof(header)) != 0)) {
+        free(columns);
+        tournamentClose(tr);
+        return -2;                                                      // another run, do not touch it
+    } else {
+        end = offset = (off_t) sizeof(header);
+        while ((offset = nextBlock(tr, offset, info.st_size, &block, columns)) >= 0) {
+            end = offset;
+            if (!tr->done[block.policy * tr->shards + block.shard]) {
+                tr->done[block.policy * tr->shards + block.shard] = 1;
+                tr->doneCount++;
+            }
+        }
+        if ((end < info.st_size) && (ftruncate(tr->fd, end) != 0)) {   // cut the torn block
+            free(columns);
+            tournamentClose(tr);
+            return -1;
+        }
+    }
+    free(columns);
+
+    for (shard = 0; shard < tr->shards; shard++) {                      // policies side by side, a stopped run compares them fairly
+        for (i = 0; i < config->policyCount; i++) {
+            if (!tr->done[i * tr->shards + shard]) {
+                tr->pending[tr->pendingCount++] = shard * config->policyCount + i;
+            }
+        }
+    }
+    return 0;
+} // tournamentOpen function ends
+
+/*! \fn static int playShard(worker * wk, gameState * game, player * pl, blockHeader * block)
+ * \brief Play the games of the shard of block, the columns follow block, and append the block to the file
+ */
+static int playShard(worker * wk, gameState * game, player * pl, blockHeader * block) {
+    tournament * tr = wk->tr;
+    const policyEntry * policy = &policyTable[tr->config.policies[block->policy]];
+    int32_t * score = (int32_t *) (block + 1), * length = score + block->count, * ticks = length + block->count;
+    long first = (long) block->shard * tr->config.shardSize, g;
+    size_t bytes = sizeof(*block) + (size_t) block->count * COLUMNS * sizeof(int32_t);
+    long long start = statsNow();
+    int result;
+
+    for (g = 0; g < block->count; g++) {
+        gameReset(game, tr->config.seed + (uint64_t) (first + g));
+        rngSeed(&pl->rng, ~(tr->config.seed + (uint64_t) (first + g)));    // a stream of its own, not the one of the apples
+        if (policy->piloted) {
+            autopilotReset(&pl->pilot);
+            pl->pilot.replanEveryTick = policy->replan;
+        }
+        while (gameStep(game, policy->input(pl, game)) && (game->ticks < tr->config.maxTicks)) {
+            // the random and greedy policies may circle forever
+        }
+        score[g] = game->score;
+        length[g] = (int32_t) game->player.snakeSupposedLength;
+        ticks[g] = (int32_t) (uint32_t) game->ticks;
+        wk->ticks += game->ticks;
+    }
+    wk->policyNs[block->policy] += statsNow() - start;
+    wk->policyGames[block->policy] += block->count;
+    wk->games += block->count;
+    wk->shards++;
+
+    block->magic = BLOCKMAGIC;
+    block->checksum = 0;
+    block->checksum = fileCrc32(0, block, bytes);
+    pthread_mutex_lock(&tr->writeLock);
+    result = fileWriteAll(tr->fd, block, bytes);                            // one append per shard, O_APPEND keeps blocks whole
+    if (result == 0) {
+        tr->done[block->policy * tr->shards + block->shard] = 1;
+        tr->doneCount++;
+    } else {
+        tr->writeFailed = 1;
+    }
+    pthread_mutex_unlock(&tr->writeLock);
+    return result;
+}
+
+/*! \fn static void * workerMain(void * argument)
+ * \brief Worker thread: play pending shards until there are none, or the run is stopped
+ */
+static void * workerMain(void * argument) {
+    worker * wk = argument;
+    tournament * tr = wk->tr;
+    memArena arena;
+    gameState game;
+    player pl;
+    blockHeader * block;
+    long entry;
+    int pilot = piloted(&tr->config);
+
+    if (arenaInit(&arena, gameMemorySize(tr->config.width, tr->config.height)
+                  + (pilot ? autopilotMemorySize(tr->config.width, tr->config.height) : 0)
+                  + ARENABLOCK(sizeof(blockHeader) + (size_t) tr->config.shardSize * COLUMNS * sizeof(int32_t))) != 0) {
+        wk->failed = 1;
+        return NULL;
+    }
+    block = arenaAlloc(&arena, sizeof(blockHeader) + (size_t) tr->config.shardSize * COLUMNS * sizeof(int32_t));
+    if ((gameInit(&game, tr->config.width, tr->config.height, tr->config.seed, &arena) != 0) || (block == NULL)
+        || (pilot && (autopilotInit(&pl.pilot, tr->config.width, tr->config.height, &arena) != 0))) {
+        wk->failed = 1;
+        arenaFree(&arena);
+        return NULL;
+    }
+
+    while (((tr->stop == NULL) || !*tr->stop) && !__atomic_load_n(&tr->writeFailed, __ATOMIC_RELAXED)) {
+        entry = __atomic_fetch_add(&tr->nextPending, 1, __ATOMIC_RELAXED);
+        if (entry >= tr->pendingCount) {
+            break;
+        }
+        entry = tr->pending[entry];
+        block->policy = (int32_t) (entry % tr->config.policyCount);
+        block->shard = entry / tr->config.policyCount;
+        block->count = (int32_t) shardGames(tr, (long) block->shard);
+        if (playShard(wk, &game, &pl, block) != 0) {
+            break;
+        }
+    }
+    arenaFree(&arena);
+    return NULL;
+}
+
+int tournamentRun(tournament * tr, tournamentStats * stats) {
+    /*! \var worker * workers
+     *  \brief Worker threads
+     */
+    worker * workers;
+    /*! \var long long start
+     *  \brief Time the workers were started
+     */
+    long long start;
+    int i, p, started, result = 0;
+
+    memset(stats, 0, sizeof(*stats));
+    if (posix_memalign((void **) &workers, ARENAALIGN, (size_t) tr->config.threads * sizeof(worker)) != 0) {
+        return -1;
+    }
+    memset(workers, 0, (size_t) tr->config.threads * sizeof(worker));
+    tr->nextPending = 0;
+
+    start = statsNow();
+    for (started = 0; started < tr->config.threads; started++) {
+        workers[started].tr = tr;
+        if (pthread_create(&workers[started].thread, NULL, workerMain, &workers[started]) != 0) {
+            result = -1;
+            break;
+        }
+    }
+    for (i = 0; i < started; i++) {
+        pthread_join(workers[i].thread, NULL);
+        if (workers[i].failed) {
+            result = -1;
+        }
+        stats->games += workers[i].games;
+        stats->ticks += workers[i].ticks;
+        stats->shards += workers[i].shards;
+        for (p = 0; p < tr->config.policyCount; p++) {
+            stats->policyGames[p] += workers[i].policyGames[p];
+            stats->policySeconds[p] += (double) workers[i].policyNs[p] / 1e9;
+        }
+    }
+    stats->elapsed = (double) (statsNow() - start) / 1e9;
+
+    tr->pendingCount = 0;                                               // what is left, for the next call
+    for (i = 0; i < tr->shards * tr->config.policyCount; i++) {
+        if (!tr->done[(i % tr->config.policyCount) * tr->shards + i / tr->config.policyCount]) {
+            tr->pending[tr->pendingCount++] = i;
+        }
+    }
+    free(workers);
+    return tr->writeFailed ? -1 : result;
+} // tournamentRun function ends
+
+/*! \fn static int compareInt(const void * a, const void * b)
+ * \brief qsort order of int32_t values, smallest first
+ */
+static int compareInt(const void * a, const void * b) {
+    int32_t x = *(const int32_t *) a, y = *(const int32_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+/*! \fn static long rank(long count, double share)
+ * \brief Index of the percentile share of count sorted values, the nearest rank
+ */
+static long rank(long count, double share) {
+    long index = (long) ceil(share * (double) count) - 1;
+
+    return index < 0 ? 0 : index;
+}
+
+/*! \fn static void distribution(int32_t * values, long count, tournamentDistribution * d)
+ * \brief Mean, deviation and percentiles of count values, the values are sorted
+ *
+ * The 95% interval of the median is between the order statistics n / 2 -+ 1.96 * sqrt(n) / 2
+ */
+static void distribution(int32_t * values, long count, tournamentDistribution * d) {
+    double sum = 0.0, squares = 0.0, half;
+    long i, low, high;
+
+    memset(d, 0, sizeof(*d));
+    if (count == 0) {
+        return;
+    }
+    for (i = 0; i < count; i++) {
+        sum += values[i];
+    }
+    d->mean = sum / (double) count;
+    for (i = 0; i < count; i++) {
+        squares += (values[i] - d->mean) * (values[i] - d->mean);
+    }
+    d->deviation = count > 1 ? sqrt(squares / (double) (count - 1)) : 0.0;
+    half = 1.96 * d->deviation / sqrt((double) count);
+    d->meanLow = d->mean - half;
+    d->meanHigh = d->mean + half;
+
+    qsort(values, (size_t) count, sizeof(int32_t), compareInt);
+    d->p10 = values[rank(count, 0.1)];
+    d->p50 = values[rank(count, 0.5)];
+    d->p90 = values[rank(count, 0.9)];
+    d->max = values[count - 1];
+    low = (long) floor((double) count / 2.0 - 0.98 * sqrt((double) count));
+    high = (long) ceil((double) count / 2.0 + 0.98 * sqrt((double) count));
+    d->medianLow = values[low < 1 ? 0 : low - 1];
+    d->medianHigh = values[high > count ? count - 1 : high - 1];
+}
+
+int tournamentSummarize(tournament * tr, tournamentSummary * summaries) {
+    /*! \var int32_t * results
+     *  \brief Columns of every game of every policy, by game number; length 0 is a game not played
+     */
+    int32_t * results;
+    /*! \var int32_t * columns, * values
+     *  \brief Columns of the block being read, values of one policy for sorting
+     */
+    int32_t * columns, * values;
+    blockHeader block;
+    struct stat info;
+    off_t offset;
+    long games = tr->config.games, g, n, filled;
+    int p, c;
+    double sum, squares, d, mean, z = 1.96, share;
+    size_t cells = (size_t) tr->config.width * (size_t) tr->config.height;
+
+    results = calloc((size_t) (tr->config.policyCount * COLUMNS) * (size_t) games, sizeof(int32_t));
+    columns = malloc((size_t) tr->config.shardSize * COLUMNS * sizeof(int32_t));
+    values = malloc((size_t) games * sizeof(int32_t));
+    if ((results == NULL) || (columns == NULL) || (values == NULL) || (fstat(tr->fd, &info) != 0)) {
+        free(results);
+        free(columns);
+        free(values);
+        return -1;
+    }
+    offset = (off_t) sizeof(fileHeader);
+    while ((offset = nextBlock(tr, offset, info.st_size, &block, columns)) >= 0) {
+        for (c = 0; c < COLUMNS; c++) {                                 // column c of the policy starts at (policy * COLUMNS + c) * games
+            memcpy(&results[((size_t) block.policy * COLUMNS + (size_t) c) * (size_t) games + (size_t) (block.shard * tr->config.shardSize)],
+                   &columns[c * block.count], (size_t) block.count * sizeof(int32_t));
+        }
+    }
+
+    for (p = 0; p < tr->config.policyCount; p++) {
+        int32_t * score = &results[(size_t) p * COLUMNS * (size_t) games], * length = score + games, * ticks = length + games;
+        tournamentSummary * s = &summaries[p];
+
+        memset(s, 0, sizeof(*s));
+        for (n = 0, g = 0; g < games; g++) {
+            if (length[g] > 0) {
+                values[n++] = score[g];
+            }
+        }
+        s->games = n;
+        distribution(values, n, &s->score);
+        for (n = 0, filled = 0, sum = 0.0, g = 0; g < games; g++) {
+            if (length[g] > 0) {
+                values[n++] = length[g];
+                filled += (size_t) length[g] == cells;
+                sum += (uint32_t) ticks[g];
+            }
+        }
+        distribution(values, n, &s->length);
+        if (n > 0) {                                                    // Wilson interval, sane for shares near 0 and 1
+            share = (double) filled / (double) n;
+            s->filled = share;
+            d = z * sqrt(share * (1.0 - share) / (double) n + z * z / (4.0 * (double) n * (double) n)) / (1.0 + z * z / (double) n);
+            mean = (share + z * z / (2.0 * (double) n)) / (1.0 + z * z / (double) n);
+            s->filledLow = mean - d;
+            s->filledHigh = mean + d;
+            s->ticks = sum / (double) n;
+        }
+
+        for (n = 0, sum = 0.0, g = 0; g < games; g++) {                 // paired with the first policy, the seeds are the same
+            if ((length[g] > 0) && (results[(size_t) games + (size_t) g] > 0)) {
+                sum += score[g] - results[g];
+                n++;
+            }
+        }
+        s->paired = n;
+        if (n > 0) {
+            s->difference = sum / (double) n;
+            for (squares = 0.0, g = 0; g < games; g++) {
+                if ((length[g] > 0) && (results[(size_t) games + (size_t) g] > 0)) {
+                    d = score[g] - results[g] - s->difference;
+                    squares += d * d;
+                }
+            }
+            d = n > 1 ? z * sqrt(squares / (double) (n - 1)) / sqrt((double) n) : 0.0;
+            s->differenceLow = s->difference - d;
+            s->differenceHigh = s->difference + d;
+        }
+    }
+    free(results);
+    free(columns);
+    free(values);
+    return 0;
+} // tournamentSummarize function ends
+
+void tournamentClose(tournament * tr) {
+    if (tr->fd >= 0) {
+        (void) fdatasync(tr->fd);
+        close(tr->fd);
+    }
+    pthread_mutex_destroy(&tr->writeLock);
+    free(tr->done);
+    free(tr->pending);
+    tr->fd = -1;
+    tr->done = NULL;
+    tr->pending = NULL;
+} // tournamentClose function ends
+
+// End of tournament.c
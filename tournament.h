@@ -0,0 +1,216 @@
+/*! \file tournament.h
+ * \brief Policy tournament header file
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Plays a matrix of input policies and seeds on all cores: every policy
+ * plays games 0 .. games - 1, game g with seed + g, so the policies are
+ * compared on the same apples. The matrix is cut into shards of one
+ * policy and shardSize games. A worker thread plays a shard with gameStep
+ * and appends its results to the results file as one block of columns:
+ * the scores, the snake lengths and the ticks of the games, with a
+ * checksum. Opening an existing file of the same run finds the finished
+ * shards and cuts off a block torn by an interruption, so the run goes on
+ * with the shards that are missing.
+ */
+
+#ifndef SNAKEGAME_TOURNAMENT_H
+#define SNAKEGAME_TOURNAMENT_H
+
+#include <signal.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "engine.h"
+
+/*! \def TOURNAMENTMAXPOLICIES
+ *  \brief Largest number of policies in a run
+ */
+#define TOURNAMENTMAXPOLICIES 8
+
+/*! \def TOURNAMENTMAXTHREADS
+ *  \brief Largest number of worker threads
+ */
+#define TOURNAMENTMAXTHREADS 256
+
+/*! \def TOURNAMENTNAMESIZE
+ *  \brief Size of a policy name in the results file, the terminating zero included
+ */
+#define TOURNAMENTNAMESIZE 16
+
+/*! \typedef struct tournamentConfig
+ *  \brief Settings of a run, a results file is only continued with the same settings
+ *
+ * \var int width, height Board size, MINBOARDSIZE..MAXBOARDSIZE
+ * \var long games Number of games of every policy, game g is played with seed + g
+ * \var uint64_t seed Seed of game 0
+ * \var int policies[TOURNAMENTMAXPOLICIES] Numbers of the policies, see tournamentPolicyNumber
+ * \var int policyCount Number of policies
+ * \var long shardSize Number of games in one shard
+ * \var unsigned long maxTicks A game is stopped after this many ticks, at most UINT32_MAX
+ * \var int threads Number of worker threads, not part of the results file
+ */
+typedef struct tournamentConfig_t {
+    int width;
+    int height;
+    long games;
+    uint64_t seed;
+    int policies[TOURNAMENTMAXPOLICIES];
+    int policyCount;
+    long shardSize;
+    unsigned long maxTicks;
+    int threads;
+} tournamentConfig;
+
+/*! \typedef struct tournament
+ *  \brief Contains an open results file and the shards still to play
+ *
+ * \var tournamentConfig config Settings of the run
+ * \var int fd Results file, opened for appending
+ * \var long shards Number of shards of one policy
+ * \var unsigned char * done True for every finished shard, policy by policy
+ * \var long doneCount Number of finished shards of all policies
+ * \var long * pending Shards to play, shard * policyCount + policy, every policy's first shard before any second shard
+ * \var long pendingCount Number of entries in pending
+ * \var long nextPending Next entry of pending to take, taken with an atomic add
+ * \var const volatile sig_atomic_t * stop Workers take no new shard when it points to a non zero value, may be NULL
+ * \var pthread_mutex_t writeLock Serializes the blocks appended to the file
+ * \var int writeFailed Set when a block could not be written
+ */
+typedef struct tournament_t {
+    tournamentConfig config;
+    int fd;
+    long shards;
+    unsigned char * done;
+    long doneCount;
+    long * pending;
+    long pendingCount;
+    long nextPending;
+    const volatile sig_atomic_t * stop;
+    pthread_mutex_t writeLock;
+    int writeFailed;
+} tournament;
+
+/*! \typedef struct tournamentStats
+ *  \brief Statistics of one call of tournamentRun
+ *
+ * \var double elapsed Wall clock time in seconds
+ * \var long games Games played
+ * \var unsigned long long ticks Game steps made
+ * \var long shards Shards finished
+ * \var long policyGames[TOURNAMENTMAXPOLICIES] Games played by each policy
+ * \var double policySeconds[TOURNAMENTMAXPOLICIES] Worker time spent on each policy, summed over the threads
+ */
+typedef struct tournamentStats_t {
+    double elapsed;
+    long games;
+    unsigned long long ticks;
+    long shards;
+    long policyGames[TOURNAMENTMAXPOLICIES];
+    double policySeconds[TOURNAMENTMAXPOLICIES];
+} tournamentStats;
+
+/*! \typedef struct tournamentDistribution
+ *  \brief Distribution of one result column of one policy
+ *
+ * \var double mean, meanLow, meanHigh Mean and its 95% confidence interval
+ * \var double deviation Standard deviation
+ * \var int p10, p50, p90, max Percentiles and the largest value
+ * \var int medianLow, medianHigh 95% confidence interval of the median, from the order statistics
+ */
+typedef struct tournamentDistribution_t {
+    double mean;
+    double meanLow;
+    double meanHigh;
+    double deviation;
+    int p10;
+    int p50;
+    int p90;
+    int max;
+    int medianLow;
+    int medianHigh;
+} tournamentDistribution;
+
+/*! \typedef struct tournamentSummary
+ *  \brief Results of one policy over every finished game in the file
+ *
+ * \var long games Number of finished games
+ * \var tournamentDistribution score Final scores
+ * \var tournamentDistribution length Final snake lengths
+ * \var double filled, filledLow, filledHigh Share of games that filled the board and its 95% Wilson interval
+ * \var double ticks Mean ticks per game
+ * \var long paired Games also finished by the first policy
+ * \var double difference, differenceLow, differenceHigh Mean score minus the first policy's on the same seeds, 95% confidence interval
+ */
+typedef struct tournamentSummary_t {
+    long games;
+    tournamentDistribution score;
+    tournamentDistribution length;
+    double filled;
+    double filledLow;
+    double filledHigh;
+    double ticks;
+    long paired;
+    double difference;
+    double differenceLow;
+    double differenceHigh;
+} tournamentSummary;
+
+/*! \fn int tournamentPolicyNumber(const char * name)
+ * \brief Find a policy by name
+ *
+ * random: turns at random, greedy: turns toward the apple and away from the body,
+ * autopilot: the autopilot, replan: the autopilot searching its path every tick
+ *
+ * \param name Name of the policy
+ * \return int Policy number, -1 if there is no policy of that name
+ */
+int tournamentPolicyNumber(const char * name);
+
+/*! \fn const char * tournamentPolicyName(int policy)
+ * \brief Name of a policy
+ *
+ * \param policy Policy number
+ * \return const char * Name, NULL for a bad number
+ */
+const char * tournamentPolicyName(int policy);
+
+/*! \fn int tournamentOpen(tournament * tr, const char * fileName, const tournamentConfig * config)
+ * \brief Open or create the results file of a run and find the shards still to play
+ *
+ * \param tr Pointer to tournament
+ * \param fileName Results file
+ * \param config Settings of the run
+ * \return int 0 on success, -1 on bad settings, memory or file error (errno set), -2 if the file holds a different run or is no results file
+ */
+int tournamentOpen(tournament * tr, const char * fileName, const tournamentConfig * config);
+
+/*! \fn int tournamentRun(tournament * tr, tournamentStats * stats)
+ * \brief Play the missing shards on the worker threads, every finished shard is appended to the file at once
+ *
+ * \param tr Pointer to tournament
+ * \param stats Statistics of this call
+ * \return int 0 on success, also when stopped, -1 on memory, thread or write error
+ */
+int tournamentRun(tournament * tr, tournamentStats * stats);
+
+/*! \fn int tournamentSummarize(tournament * tr, tournamentSummary * summaries)
+ * \brief Read every finished shard back from the file and summarize the policies
+ *
+ * \param tr Pointer to tournament
+ * \param summaries Array of config.policyCount summaries, in the order of config.policies
+ * \return int 0 on success, -1 on memory or read error
+ */
+int tournamentSummarize(tournament * tr, tournamentSummary * summaries);
+
+/*! \fn void tournamentClose(tournament * tr)
+ * \brief Sync and close the results file and release the shard lists
+ *
+ * \param tr Pointer to tournament
+ * \return void No values returned
+ */
+void tournamentClose(tournament * tr);
+
+#endif //SNAKEGAME_TOURNAMENT_H
+
+// End of tournament.h
@@ -0,0 +1,227 @@
+/*! \file tourney.c
+ * \brief Policy tournament tool
+ *
+ * Simple snake implemented on linux terminal
+ * Includes a top list record in file for competition
+ *
+ * Plays every listed policy on the same seeded games on all cores, keeps
+ * the results in a columnar file and prints the score and length
+ * distributions of the policies with 95% confidence intervals, and the
+ * game throughput. Interrupted with Ctrl-C or killed, the same command
+ * continues the run with the shards that are not in the file yet.
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "tournament.h"
+
+/*! \var static volatile sig_atomic_t interrupted
+ *  \brief Set by SIGINT and SIGTERM, the workers finish their shards and stop
+ */
+static volatile sig_atomic_t interrupted = 0;
+
+/*! \fn static void onStop(int signal)
+ * \brief Stop signal handler
+ */
+static void onStop(int signal) {
+    (void) signal;
+    interrupted = 1;
+}
+
+/*! \fn static int parsePolicies(char * list, tournamentConfig * config)
+ * \brief Read a comma separated list of policy names, -1 on an unknown name or too many
+ */
+static int parsePolicies(char * list, tournamentConfig * config) {
+    char * name;
+
+    config->policyCount = 0;
+    for (name = strtok(list, ","); name != NULL; name = strtok(NULL, ",")) {
+        if ((config->policyCount == TOURNAMENTMAXPOLICIES) || ((config->policies[config->policyCount] = tournamentPolicyNumber(name)) < 0)) {
+            return -1;
+        }
+        config->policyCount++;
+    }
+    return config->policyCount > 0 ? 0 : -1;
+}
+
+/*! \fn static void printReport(const tournament * tr, const tournamentSummary * summaries)
+ * \brief Print the distributions of every policy
+ */
+static void printReport(const tournament * tr, const tournamentSummary * summaries) {
+    const tournamentSummary * s;
+    int p;
+
+    printf("\n%-10s %9s %26s %6s %20s %6s %6s   %-24s\n", "policy", "games", "score mean [95% CI]", "p10",
+           "p50 [95% CI]", "p90", "max", "vs first [95% CI]");
+    for (p = 0; p < tr->config.policyCount; p++) {
+        s = &summaries[p];
+        printf("%-10s %9ld %9.2f [%6.2f, %6.2f] %6d %6d [%5d, %5d] %6d %6d   %+8.2f [%+.2f, %+.2f]\n",
+               tournamentPolicyName(tr->config.policies[p]), s->games, s->score.mean, s->score.meanLow, s->score.meanHigh,
+               s->score.p10, s->score.p50, s->score.medianLow, s->score.medianHigh, s->score.p90, s->score.max,
+               s->difference, s->differenceLow, s->differenceHigh);
+    }
+    printf("\n%-10s %26s %6s %20s %6s %6s %24s %12s\n", "policy", "length mean [95% CI]", "p10", "p50 [95% CI]", "p90",
+           "max", "filled % [95% CI]", "ticks/game");
+    for (p = 0; p < tr->config.policyCount; p++) {
+        s = &summaries[p];
+        printf("%-10s %9.2f [%6.2f, %6.2f] %6d %6d [%5d, %5d] %6d %6d %7.2f [%6.2f, %6.2f] %12.0f\n",
+               tournamentPolicyName(tr->config.policies[p]), s->length.mean, s->length.meanLow, s->length.meanHigh,
+               s->length.p10, s->length.p50, s->length.medianLow, s->length.medianHigh, s->length.p90, s->length.max,
+               100.0 * s->filled, 100.0 * s->filledLow, 100.0 * s->filledHigh, s->ticks);
+    }
+}
+
+/*! \fn static void printThroughput(const tournament * tr, const tournamentStats * stats)
+ * \brief Print the games per second of one core and the wall clock time of a million games
+ */
+static void printThroughput(const tournament * tr, const tournamentStats * stats) {
+    int p;
+
+    if (stats->games == 0) {
+        printf("\nno games played, the file has every shard\n");
+        return;
+    }
+    printf("\nplayed %ld games (%ld shards, %llu ticks) in %.2f s on %d threads: %.0f games/s per core, %.2f s per million games, %.1f M ticks/s\n",
+           stats->games, stats->shards, stats->ticks, stats->elapsed, tr->config.threads,
+           (double) stats->games / stats->elapsed / tr->config.threads, stats->elapsed / (double) stats->games * 1e6,
+           (double) stats->ticks / stats->elapsed / 1e6);
+    for (p = 0; p < tr->config.policyCount; p++) {
+        if (stats->policyGames[p] > 0) {
+            printf("%-10s %10.0f games/s per core %12.2f us/game\n", tournamentPolicyName(tr->config.policies[p]),
+                   (double) stats->policyGames[p] / stats->policySeconds[p], stats->policySeconds[p] / (double) stats->policyGames[p] * 1e6);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    /*! \var static tournamentSummary summaries[TOURNAMENTMAXPOLICIES]
+     *  \brief Results of each policy
+     */
+    static tournamentSummary summaries[TOURNAMENTMAXPOLICIES];
+    /*! \var tournamentConfig config
+     *  \brief Settings of the run
+     */
+    tournamentConfig config;
+    /*! \var tournament tr
+     *  \brief The run
+     */
+    tournament tr;
+    /*! \var tournamentStats stats
+     *  \brief Games played by this process
+     */
+    tournamentStats stats;
+    /*! \var struct sigaction action
+     *  \brief Stop signal handler
+     */
+    struct sigaction action;
+    /*! \var const char * fileName
+     *  \brief Results file
+     */
+    const char * fileName = "tournament.col";
+    /*! \var char policyList[256]
+     *  \brief Policy names given with -p
+     */
+    char policyList[256] = "random,greedy,autopilot";
+    /*! \var unsigned long long cells
+     *  \brief Cells of the board, for the default tick limit
+     */
+    unsigned long long cells;
+    /*! \var int option, result
+     *  \brief Command line option, result of opening or running
+     */
+    int option, result;
+
+    memset(&config, 0, sizeof(config));
+    config.width = BOARDSIZEX;
+    config.height = BOARDSIZEY;
+    config.games = 100000;
+    config.seed = 1;
+    config.shardSize = 1024;
+    config.threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    while ((option = getopt(argc, argv, "o:p:n:x:y:s:j:g:t:")) != -1) {
+        switch (option) {
+            case 'o':
+                fileName = optarg;
+                break;
+            case 'p':
+                strncpy(policyList, optarg, sizeof(policyList) - 1);
+                break;
+            case 'n':
+                config.games = atol(optarg);
+                break;
+            case 'x':
+                config.width = atoi(optarg);
+                break;
+            case 'y':
+                config.height = atoi(optarg);
+                break;
+            case 's':
+                config.seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'j':
+                config.threads = atoi(optarg);
+                break;
+            case 'g':
+                config.shardSize = atol(optarg);
+                break;
+            case 't':
+                config.maxTicks = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-o resultfile] [-p policy,policy..] [-n games] [-x columns] [-y rows] [-s seed] [-j threads] [-g shard size] [-t max ticks]\n", argv[0]);
+                fprintf(stderr, "Policies: random greedy autopilot replan\n");
+                return 1;
+        }
+    }
+    if (parsePolicies(policyList, &config) != 0) {
+        fprintf(stderr, "Unknown policy or more than %d in %s\n", TOURNAMENTMAXPOLICIES, policyList);
+        return 1;
+    }
+    if ((config.width < MINBOARDSIZE) || (config.width > MAXBOARDSIZE) || (config.height < MINBOARDSIZE) || (config.height > MAXBOARDSIZE)) {
+        fprintf(stderr, "Invalid board size: %dx%d (allowed %d..%d)\n", config.width, config.height, MINBOARDSIZE, MAXBOARDSIZE);
+        return 1;
+    }
+    if (config.maxTicks == 0) {                                         // the autopilot reaches every apple within a lap
+        cells = (unsigned long long) config.width * (unsigned long long) config.height;
+        config.maxTicks = cells * (cells + 1) < UINT32_MAX ? (unsigned long) (cells * (cells + 1)) : UINT32_MAX;
+    }
+
+    result = tournamentOpen(&tr, fileName, &config);
+    if (result == -2) {
+        fprintf(stderr, "%s is not a results file of a run with these settings, it is left alone\n", fileName);
+        return 1;
+    }
+    if (result != 0) {
+        perror(fileName);
+        return 1;
+    }
+    printf("%s: %d policies x %ld games on %dx%d, %ld of %ld shards already done\n", fileName, config.policyCount,
+           config.games, config.width, config.height, tr.doneCount, tr.shards * config.policyCount);
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onStop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    tr.stop = &interrupted;
+    result = tournamentRun(&tr, &stats);
+    if (result != 0) {
+        fprintf(stderr, "Run failed: out of memory, no threads or the file could not be written\n");
+    }
+    if (tournamentSummarize(&tr, summaries) != 0) {
+        fprintf(stderr, "Could not read %s back\n", fileName);
+        result = -1;
+    } else {
+        printReport(&tr, summaries);
+    }
+    printThroughput(&tr, &stats);
+    if (tr.pendingCount > 0) {
+        printf("%ld shards left, run the same command again to continue\n", tr.pendingCount);
+    }
+    tournamentClose(&tr);
+    return result == 0 ? 0 : 1;
+}
+
+// End of tourney.c